@@ -57,6 +57,29 @@ struct VehicleInfo_t {
     bool alert;
     AvailableInfoTypes availableFlags;
 };
+
+/// Merges the available fields of update into target. Used to collapse multiple messages for the
+/// same aircraft into a single update.
+inline void mergeVehicleInfo(VehicleInfo_t &target, const VehicleInfo_t &update)
+{
+    if (update.availableFlags & CallsignAvailable) {
+        target.callsign = update.callsign;
+    }
+    if (update.availableFlags & LocationAvailable) {
+        target.location = update.location;
+    }
+    if (update.availableFlags & AltitudeAvailable) {
+        target.altitude = update.altitude;
+    }
+    if (update.availableFlags & HeadingAvailable) {
+        target.heading = update.heading;
+    }
+    if (update.availableFlags & AlertAvailable) {
+        target.alert = update.alert;
+    }
+    target.availableFlags |= update.availableFlags;
+}
 } // namespace ADSB
 
 Q_DECLARE_METATYPE(ADSB::VehicleInfo_t)
+Q_DECLARE_METATYPE(QList<ADSB::VehicleInfo_t>)
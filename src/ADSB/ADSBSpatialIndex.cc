@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBSpatialIndex.h"
+
+#include <QtCore/QtMath>
+
+namespace {
+    constexpr double kMetersPerDegreeLatitude = 111320.0;
+}
+
+ADSBSpatialIndex::ADSBSpatialIndex(double cellSizeDegrees)
+    : _cellSizeDegrees(cellSizeDegrees)
+{
+
+}
+
+int ADSBSpatialIndex::_latCell(double latitude) const
+{
+    return qFloor((latitude + 90.) / _cellSizeDegrees);
+}
+
+int ADSBSpatialIndex::_lonCell(double longitude) const
+{
+    return qFloor((longitude + 180.) / _cellSizeDegrees);
+}
+
+qint64 ADSBSpatialIndex::_cellKey(int latCell, int lonCell) const
+{
+    return (static_cast<qint64>(latCell) << 32) | static_cast<quint32>(lonCell);
+}
+
+void ADSBSpatialIndex::update(uint32_t icaoAddress, const QGeoCoordinate &coordinate)
+{
+    if (!coordinate.isValid()) {
+        remove(icaoAddress);
+        return;
+    }
+
+    const qint64 cellKey = _cellKey(_latCell(coordinate.latitude()), _lonCell(coordinate.longitude()));
+
+    auto it = _entries.find(icaoAddress);
+    if (it != _entries.end()) {
+        it->coordinate = coordinate;
+        if (it->cellKey == cellKey) {
+            return;
+        }
+
+        QList<uint32_t> &oldCell = _cells[it->cellKey];
+        (void) oldCell.removeOne(icaoAddress);
+        if (oldCell.isEmpty()) {
+            (void) _cells.remove(it->cellKey);
+        }
+        it->cellKey = cellKey;
+    } else {
+        (void) _entries.insert(icaoAddress, { cellKey, coordinate });
+    }
+
+    _cells[cellKey].append(icaoAddress);
+}
+
+void ADSBSpatialIndex::remove(uint32_t icaoAddress)
+{
+    const auto it = _entries.constFind(icaoAddress);
+    if (it == _entries.constEnd()) {
+        return;
+    }
+
+    const qint64 cellKey = it->cellKey;
+    (void) _entries.erase(it);
+
+    auto cellIt = _cells.find(cellKey);
+    if (cellIt != _cells.end()) {
+        (void) cellIt->removeOne(icaoAddress);
+        if (cellIt->isEmpty()) {
+            (void) _cells.erase(cellIt);
+        }
+    }
+}
+
+void ADSBSpatialIndex::clear()
+{
+    _entries.clear();
+    _cells.clear();
+}
+
+QList<uint32_t> ADSBSpatialIndex::query(const QGeoCoordinate &center, double radiusMeters) const
+{
+    QList<uint32_t> result;
+
+    if (!center.isValid() || _entries.isEmpty()) {
+        return result;
+    }
+
+    const double latDelta = radiusMeters / kMetersPerDegreeLatitude;
+    const double cosLat = qMax(qCos(qDegreesToRadians(center.latitude())), 0.01);
+    const double lonDelta = qMin(radiusMeters / (kMetersPerDegreeLatitude * cosLat), 180.);
+
+    const int minLatCell = _latCell(qMax(center.latitude() - latDelta, -90.));
+    const int maxLatCell = _latCell(qMin(center.latitude() + latDelta, 90.));
+    const int minLonCell = _lonCell(center.longitude() - lonDelta);
+    const int maxLonCell = _lonCell(center.longitude() + lonDelta);
+    const int lonCellCount = qCeil(360. / _cellSizeDegrees);
+
+    for (int latCell = minLatCell; latCell <= maxLatCell; latCell++) {
+        for (int lonCell = minLonCell; lonCell <= maxLonCell; lonCell++) {
+            // Wrap around the anti-meridian
+            const int wrappedLonCell = ((lonCell % lonCellCount) + lonCellCount) % lonCellCount;
+            const auto cellIt = _cells.constFind(_cellKey(latCell, wrappedLonCell));
+            if (cellIt == _cells.constEnd()) {
+                continue;
+            }
+
+            for (const uint32_t icaoAddress : cellIt.value()) {
+                if (_entries.value(icaoAddress).coordinate.distanceTo(center) <= radiusMeters) {
+                    result.append(icaoAddress);
+                }
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,49 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtPositioning/QGeoCoordinate>
+
+/// Uniform lat/lon grid over aircraft positions. Radius queries only visit the cells overlapping the
+/// bounding box of the search circle instead of every aircraft heard from.
+class ADSBSpatialIndex
+{
+public:
+    /// @param cellSizeDegrees Edge length of a grid cell in degrees of latitude/longitude
+    explicit ADSBSpatialIndex(double cellSizeDegrees = kDefaultCellSizeDegrees);
+
+    /// Adds or moves an entry. Invalid coordinates remove the entry from the index.
+    void update(uint32_t icaoAddress, const QGeoCoordinate &coordinate);
+    void remove(uint32_t icaoAddress);
+    void clear();
+
+    qsizetype count() const { return _entries.count(); }
+
+    /// @return All entries within radiusMeters of center
+    QList<uint32_t> query(const QGeoCoordinate &center, double radiusMeters) const;
+
+    static constexpr double kDefaultCellSizeDegrees = 0.1;
+
+private:
+    struct Entry_t {
+        qint64 cellKey;
+        QGeoCoordinate coordinate;
+    };
+
+    qint64 _cellKey(int latCell, int lonCell) const;
+    int _latCell(double latitude) const;
+    int _lonCell(double longitude) const;
+
+    double _cellSizeDegrees;
+    QHash<uint32_t, Entry_t> _entries;
+    QHash<qint64, QList<uint32_t>> _cells;
+};
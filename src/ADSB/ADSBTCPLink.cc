@@ -21,7 +21,7 @@ ADSBTCPLink::ADSBTCPLink(const QHostAddress &hostAddress, quint16 port, QObject
     , _hostAddress(hostAddress)
     , _port(port)
     , _socket(new QTcpSocket(this))
-    , _processTimer(new QTimer(this))
+    , _batchTimer(new QTimer(this))
 {
 #ifdef QT_DEBUG
     (void) connect(_socket, &QTcpSocket::stateChanged, this, [](QTcpSocket::SocketState state) {
@@ -52,8 +52,8 @@ ADSBTCPLink::ADSBTCPLink(const QHostAddress &hostAddress, quint16 port, QObject
 
     (void) connect(_socket, &QTcpSocket::readyRead, this, &ADSBTCPLink::_readBytes);
 
-    _processTimer->setInterval(_processInterval); // Set an interval for processing lines
-    (void) connect(_processTimer, &QTimer::timeout, this, &ADSBTCPLink::_processLines);
+    _batchTimer->setInterval(_batchInterval);
+    (void) connect(_batchTimer, &QTimer::timeout, this, &ADSBTCPLink::_emitBatch);
 
     init();
 
@@ -81,107 +81,144 @@ bool ADSBTCPLink::init()
 
 void ADSBTCPLink::_readBytes()
 {
-    while (_socket && _socket->canReadLine()) {
-        const QByteArray bytes = _socket->readLine();
-        (void) _lineBuffer.append(QString::fromLocal8Bit(bytes));
+    if (!_socket) {
+        return;
     }
 
-    // Start or restart the timer to process lines
-    if (!_processTimer->isActive()) {
-        _processTimer->start();
+    _readBuffer.append(_socket->readAll());
+
+    // Walk all complete lines in place and drop the consumed bytes in a single pass at the end
+    const QByteArrayView buffer(_readBuffer);
+    qsizetype lineStart = 0;
+    while (lineStart < buffer.size()) {
+        const qsizetype lineEnd = buffer.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            break;
+        }
+
+        ADSB::VehicleInfo_t adsbInfo;
+        if (parseLine(buffer.sliced(lineStart, lineEnd - lineStart), adsbInfo)) {
+            auto it = _pendingUpdates.find(adsbInfo.icaoAddress);
+            if (it == _pendingUpdates.end()) {
+                (void) _pendingUpdates.insert(adsbInfo.icaoAddress, adsbInfo);
+            } else {
+                ADSB::mergeVehicleInfo(it.value(), adsbInfo);
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    (void) _readBuffer.remove(0, lineStart);
+    if (_readBuffer.size() > _maxLineLength) {
+        qCDebug(ADSBTCPLinkLog) << "ADSB Dropping unterminated data" << _readBuffer.size();
+        _readBuffer.clear();
+    }
+
+    if (!_pendingUpdates.isEmpty() && !_batchTimer->isActive()) {
+        _batchTimer->start();
     }
 }
 
-void ADSBTCPLink::_processLines()
+void ADSBTCPLink::_emitBatch()
 {
-    int linesProcessed = 0;
-    while (!_lineBuffer.isEmpty() && (linesProcessed < _maxLinesToProcess)) {
-        const QString line = _lineBuffer.takeFirst();
-        _parseLine(line);
-        ++linesProcessed;
+    if (_pendingUpdates.isEmpty()) {
+        _batchTimer->stop();
+        return;
     }
 
-    // Stop the timer if there are no more lines to process
-    if (_lineBuffer.isEmpty()) {
-        _processTimer->stop();
-    }
+    const QList<ADSB::VehicleInfo_t> vehicleInfos = _pendingUpdates.values();
+    _pendingUpdates.clear();
+
+    emit adsbVehicleUpdates(vehicleInfos);
 }
 
-void ADSBTCPLink::_parseLine(const QString &line)
+bool ADSBTCPLink::parseLine(QByteArrayView line, ADSB::VehicleInfo_t &vehicleInfo)
 {
+    line = line.trimmed();
     if (line.size() <= 4) {
-        return;
+        return false;
     }
 
-    if (!line.startsWith(QStringLiteral("MSG"))) {
-        return;
+    if (!line.startsWith("MSG")) {
+        return false;
     }
 
-    const int msgType = line.at(4).digitValue();
-    if (msgType == ADSB::Unsupported) {
-        qCDebug(ADSBTCPLinkLog) << "ADSB Invalid message type" << msgType;
-        return;
+    const char msgTypeChar = line.at(4);
+    if ((msgTypeChar < '0') || (msgTypeChar > '9')) {
+        qCDebug(ADSBTCPLinkLog) << "ADSB Invalid message type" << msgTypeChar;
+        return false;
     }
+    const int msgType = msgTypeChar - '0';
 
     // Skip unsupported mesg types to avoid parsing
     if ((msgType == ADSB::SurfacePosition) || (msgType > ADSB::SurveillanceId)) {
-        return;
+        return false;
     }
 
-    qCDebug(ADSBTCPLinkLog) << "ADSB SBS-1" << line;
+    QByteArrayView values[_maxFields];
+    int valueCount = 0;
+    qsizetype fieldStart = 0;
+    while (valueCount < _maxFields) {
+        const qsizetype fieldEnd = line.indexOf(',', fieldStart);
+        if (fieldEnd < 0) {
+            values[valueCount++] = line.sliced(fieldStart);
+            break;
+        }
+        values[valueCount++] = line.sliced(fieldStart, fieldEnd - fieldStart);
+        fieldStart = fieldEnd + 1;
+    }
 
-    const QStringList values = line.split(QChar(','));
-    if (values.size() <= 4) {
-        return;
+    if (valueCount <= 4) {
+        return false;
     }
 
     bool icaoOk;
-    const uint32_t icaoAddress = values.at(4).toUInt(&icaoOk, 16);
+    const uint32_t icaoAddress = values[4].toUInt(&icaoOk, 16);
     if (!icaoOk) {
-        return;
+        return false;
     }
 
-    ADSB::VehicleInfo_t adsbInfo;
-    adsbInfo.icaoAddress = icaoAddress;
+    vehicleInfo.icaoAddress = icaoAddress;
+    vehicleInfo.availableFlags = ADSB::AvailableInfoTypes::fromInt(0);
 
     switch (msgType) {
     case ADSB::IdentificationAndCategory:
     case ADSB::SurveillanceAltitude:
     case ADSB::SurveillanceId:
-        _parseAndEmitCallsign(adsbInfo, values);
-        break;
+        return _parseCallsign(vehicleInfo, values, valueCount);
     case ADSB::AirbornePosition:
-        _parseAndEmitLocation(adsbInfo, values);
-        break;
+        return _parseLocation(vehicleInfo, values, valueCount);
     case ADSB::AirborneVelocity:
-        _parseAndEmitHeading(adsbInfo, values);
-        break;
+        return _parseHeading(vehicleInfo, values, valueCount);
     default:
         break;
     }
+
+    return false;
 }
 
-void ADSBTCPLink::_parseAndEmitCallsign(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values)
+bool ADSBTCPLink::_parseCallsign(ADSB::VehicleInfo_t &adsbInfo, const QByteArrayView *values, int valueCount)
 {
-    if (values.size() <= 10) {
-        return;
+    if (valueCount <= 10) {
+        return false;
     }
 
-    const QString callsign = values.at(10).trimmed();
+    const QByteArrayView callsign = values[10].trimmed();
     if (callsign.isEmpty()) {
-        return;
+        return false;
     }
 
-    adsbInfo.callsign = callsign;
+    adsbInfo.callsign = QString::fromLatin1(callsign);
     adsbInfo.availableFlags = ADSB::CallsignAvailable;
 
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
 }
 
-void ADSBTCPLink::_parseAndEmitLocation(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values)
+bool ADSBTCPLink::_parseLocation(ADSB::VehicleInfo_t &adsbInfo, const QByteArrayView *values, int valueCount)
 {
-    if (values.size() <= 19) {
-        return;
+    if (valueCount <= 19) {
+        return false;
     }
 
     // Altitude is either Barometric - based on pressure, in ft
@@ -189,50 +226,47 @@ void ADSBTCPLink::_parseAndEmitLocation(ADSB::VehicleInfo_t &adsbInfo, const QSt
     // If altitude ends with H, we have HAE
     // There's a slight difference between Barometric alt and HAE, but it would require
     // knowledge about Geoid shape in particular Lat, Lon. It's not worth complicating the code
-    QString altitudeStr = values.at(11);
+    QByteArrayView altitudeStr = values[11];
     if (altitudeStr.endsWith('H')) {
-        (void) altitudeStr.chop(1);
+        altitudeStr.chop(1);
     }
 
     bool altOk, latOk, lonOk, alertOk;
     const int modeCAltitude = altitudeStr.toInt(&altOk);
-    const double lat = values.at(14).toDouble(&latOk);
-    const double lon = values.at(15).toDouble(&lonOk);
-    const int alert = values.at(19).toInt(&alertOk);
+    const double lat = values[14].toDouble(&latOk);
+    const double lon = values[15].toDouble(&lonOk);
+    const int alert = values[19].toInt(&alertOk);
 
     if (!altOk || !latOk || !lonOk || !alertOk) {
-        return;
+        return false;
     }
 
     if (qFuzzyIsNull(lat) && qFuzzyIsNull(lon)) {
-        return;
+        return false;
     }
 
-    const double altitude = modeCAltitude * 0.3048;
-    const QGeoCoordinate location(lat, lon);
-
-    adsbInfo.location = location;
-    adsbInfo.altitude = altitude;
+    adsbInfo.location = QGeoCoordinate(lat, lon);
+    adsbInfo.altitude = modeCAltitude * 0.3048;
     adsbInfo.alert = (alert == 1);
     adsbInfo.availableFlags = ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable;
 
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
 }
 
-void ADSBTCPLink::_parseAndEmitHeading(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values)
+bool ADSBTCPLink::_parseHeading(ADSB::VehicleInfo_t &adsbInfo, const QByteArrayView *values, int valueCount)
 {
-    if (values.size() <= 13) {
-        return;
+    if (valueCount <= 13) {
+        return false;
     }
 
     bool headingOk;
-    const double heading = values.at(13).toDouble(&headingOk);
+    const double heading = values[13].toDouble(&headingOk);
     if (!headingOk) {
-        return;
+        return false;
     }
 
     adsbInfo.heading = heading;
     adsbInfo.availableFlags = ADSB::HeadingAvailable;
 
-    emit adsbVehicleUpdate(adsbInfo);
+    return true;
 }
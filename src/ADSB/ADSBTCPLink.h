@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtNetwork/QHostAddress>
@@ -22,6 +24,10 @@ class QTimer;
 
 /// The ADSBTCPLink class handles the TCP connection to an ADS-B server
 /// and processes incoming ADS-B data.
+///
+/// The link is meant to live on its own thread. Incoming SBS-1 lines are parsed straight out of the
+/// receive buffer and all messages for the same aircraft are merged, so at most one update per
+/// aircraft is emitted per batch interval.
 class ADSBTCPLink : public QObject
 {
     Q_OBJECT
@@ -39,49 +45,47 @@ public:
     /// Attempts connection to a host.
     bool init();
 
+    /// Parses a single SBS-1 line without allocating.
+    ///     @param line The line to parse, with or without line terminator.
+    ///     @param[out] vehicleInfo Filled in with the information contained in the line.
+    ///     @return true: vehicleInfo contains a valid update
+    static bool parseLine(QByteArrayView line, ADSB::VehicleInfo_t &vehicleInfo);
+
 signals:
-    /// Emitted when an ADS-B vehicle update is received.
-    ///     @param vehicleInfo The updated vehicle information.
-    void adsbVehicleUpdate(const ADSB::VehicleInfo_t &vehicleInfo);
+    /// Emitted once per batch interval with one merged update per aircraft heard from.
+    ///     @param vehicleInfos The updated vehicle information.
+    void adsbVehicleUpdates(const QList<ADSB::VehicleInfo_t> &vehicleInfos);
 
     /// Emitted when an error occurs.
     ///     @param errorMsg The error message.
     void errorOccurred(const QString &errorMsg, bool stopped = false);
 
 private slots:
-    /// Reads bytes from the TCP socket.
+    /// Reads bytes from the TCP socket and parses all complete lines.
     void _readBytes();
 
-    /// Processes buffered lines of ADS-B data.
-    void _processLines();
+    /// Emits the merged updates collected since the last batch.
+    void _emitBatch();
 
 private:
-    /// Parses a line of ADS-B data.
-    ///     @param line The line to parse.
-    void _parseLine(const QString &line);
-
-    /// Parses and emits the callsign from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitCallsign(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values);
+    /// Parses the callsign from ADS-B data.
+    static bool _parseCallsign(ADSB::VehicleInfo_t &adsbInfo, const QByteArrayView *values, int valueCount);
 
-    /// Parses and emits the location from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitLocation(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values);
+    /// Parses the location from ADS-B data.
+    static bool _parseLocation(ADSB::VehicleInfo_t &adsbInfo, const QByteArrayView *values, int valueCount);
 
-    /// Parses and emits the heading from ADS-B data.
-    ///     @param adsbInfo The ADS-B vehicle info structure to update.
-    ///     @param values The values parsed from the line.
-    void _parseAndEmitHeading(ADSB::VehicleInfo_t &adsbInfo, const QStringList &values);
+    /// Parses the heading from ADS-B data.
+    static bool _parseHeading(ADSB::VehicleInfo_t &adsbInfo, const QByteArrayView *values, int valueCount);
 
     QHostAddress _hostAddress;
     quint16 _port = 30003;
 
-    QTcpSocket *_socket = nullptr;     ///< Pointer to the TCP socket used for connection
-    QTimer *_processTimer = nullptr;   ///< Timer for periodic processing of ADS-B data
-    QStringList _lineBuffer;           ///< Buffer for storing incoming lines of ADS-B data
+    QTcpSocket *_socket = nullptr;      ///< Pointer to the TCP socket used for connection
+    QTimer *_batchTimer = nullptr;      ///< Timer for periodic emission of merged updates
+    QByteArray _readBuffer;             ///< Incoming bytes which do not yet form a complete line
+    QHash<uint32_t, ADSB::VehicleInfo_t> _pendingUpdates;  ///< Merged updates per ICAO address since the last batch
 
-    static constexpr int _processInterval = 50;     ///< Interval for processing lines
-    static constexpr int _maxLinesToProcess = 100;  ///< Maximum number of lines to process per timer timeout
+    static constexpr int _batchInterval = 100;      ///< Interval for emitting merged updates
+    static constexpr int _maxFields = 22;           ///< Number of fields in an SBS-1 line
+    static constexpr qsizetype _maxLineLength = 512; ///< Longer lines are considered garbage and dropped
 };
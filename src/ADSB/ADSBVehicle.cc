@@ -75,3 +75,11 @@ void ADSBVehicle::update(const ADSB::VehicleInfo_t &vehicleInfo)
 
     (void) _lastUpdateTimer.restart();
 }
+
+void ADSBVehicle::setProximityAlert(bool proximityAlert)
+{
+    if (proximityAlert != _proximityAlert) {
+        _proximityAlert = proximityAlert;
+        emit proximityAlertChanged();
+    }
+}
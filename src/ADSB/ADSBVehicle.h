@@ -31,6 +31,7 @@ class ADSBVehicle : public QObject
     Q_PROPERTY(double         altitude    READ altitude    NOTIFY altitudeChanged)
     Q_PROPERTY(double         heading     READ heading     NOTIFY headingChanged)
     Q_PROPERTY(bool           alert       READ alert       NOTIFY alertChanged)
+    Q_PROPERTY(bool           proximityAlert READ proximityAlert NOTIFY proximityAlertChanged)
 
 public:
     explicit ADSBVehicle(const ADSB::VehicleInfo_t &vehicleInfo, QObject *parent = nullptr);
@@ -42,6 +43,8 @@ public:
     double altitude() const { return _info.altitude; }
     double heading() const { return _info.heading; }
     bool alert() const { return _info.alert; }
+    bool proximityAlert() const { return _proximityAlert; }
+    void setProximityAlert(bool proximityAlert);
     bool expired() const { return _lastUpdateTimer.hasExpired(_expirationTimeoutMs); }
     void update(const ADSB::VehicleInfo_t &vehicleInfo);
 
@@ -51,10 +54,12 @@ signals:
     void altitudeChanged();
     void headingChanged();
     void alertChanged();
+    void proximityAlertChanged();
 
 private:
     ADSB::VehicleInfo_t _info{};
     QElapsedTimer _lastUpdateTimer;
+    bool _proximityAlert = false;   ///< Vehicle is within the proximity alert volume of one of our vehicles
 
     static constexpr qint64 _expirationTimeoutMs = 120000; ///< timeout with no update in ms after which the vehicle is removed.
 };
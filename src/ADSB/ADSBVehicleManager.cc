@@ -14,10 +14,13 @@
 #include "ADSBVehicleManagerSettings.h"
 #include "ADSBTCPLink.h"
 #include "ADSBVehicle.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
 #include "QmlObjectListModel.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/qapplicationstatic.h>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 #include <qassert.h>
 
@@ -32,6 +35,7 @@ ADSBVehicleManager::ADSBVehicleManager(ADSBVehicleManagerSettings *settings, QOb
     , _adsbVehicles(new QmlObjectListModel(this))
 {
     (void) qRegisterMetaType<ADSB::VehicleInfo_t>("ADSB::VehicleInfo_t");
+    (void) qRegisterMetaType<QList<ADSB::VehicleInfo_t>>("QList<ADSB::VehicleInfo_t>");
 
     _adsbVehicleCleanupTimer->setSingleShot(false);
     _adsbVehicleCleanupTimer->setInterval(1000);
@@ -58,6 +62,11 @@ ADSBVehicleManager::ADSBVehicleManager(ADSBVehicleManagerSettings *settings, QOb
 
 ADSBVehicleManager::~ADSBVehicleManager()
 {
+    if (_adsbTcpLinkThread) {
+        _adsbTcpLinkThread->quit();
+        _adsbTcpLinkThread->wait();
+    }
+
     // qCDebug(ADSBTCPLinkLog) << Q_FUNC_INFO << this;
 }
 
@@ -66,55 +75,198 @@ ADSBVehicleManager *ADSBVehicleManager::instance()
     return _adsbVehicleManager();
 }
 
+ADSBVehicle *ADSBVehicleManager::_updateExistingVehicle(const ADSB::VehicleInfo_t &vehicleInfo)
+{
+    ADSBVehicle* const adsbVehicle = _adsbICAOMap.value(vehicleInfo.icaoAddress, nullptr);
+    if (adsbVehicle) {
+        adsbVehicle->update(vehicleInfo);
+        if (vehicleInfo.availableFlags & ADSB::LocationAvailable) {
+            _spatialIndex.update(adsbVehicle->icaoAddress(), adsbVehicle->coordinate());
+        }
+    }
+
+    return adsbVehicle;
+}
+
+/// Creates a vehicle for a previously unknown aircraft. The caller is responsible for adding it to the model.
+ADSBVehicle *ADSBVehicleManager::_addVehicle(const ADSB::VehicleInfo_t &vehicleInfo)
+{
+    ADSBVehicle* const adsbVehicle = new ADSBVehicle(vehicleInfo, this);
+    _adsbICAOMap[vehicleInfo.icaoAddress] = adsbVehicle;
+    _spatialIndex.update(adsbVehicle->icaoAddress(), adsbVehicle->coordinate());
+
+    return adsbVehicle;
+}
+
 void ADSBVehicleManager::adsbVehicleUpdate(const ADSB::VehicleInfo_t &vehicleInfo)
 {
-    const uint32_t icaoAddress = vehicleInfo.icaoAddress;
-    if (_adsbICAOMap.contains(icaoAddress)) {
-        _adsbICAOMap[icaoAddress]->update(vehicleInfo);
+    if (_updateExistingVehicle(vehicleInfo)) {
         return;
     }
 
     if (vehicleInfo.availableFlags & ADSB::LocationAvailable) {
-        ADSBVehicle* const adsbVehicle = new ADSBVehicle(vehicleInfo, this);
-        _adsbICAOMap[icaoAddress] = adsbVehicle;
+        ADSBVehicle* const adsbVehicle = _addVehicle(vehicleInfo);
         (void) _adsbVehicles->append(adsbVehicle);
         qCDebug(ADSBVehicleManagerLog) << "Added" << QString::number(adsbVehicle->icaoAddress());
     }
 }
 
+void ADSBVehicleManager::adsbVehicleUpdates(const QList<ADSB::VehicleInfo_t> &vehicleInfos)
+{
+    QList<QObject*> newVehicles;
+
+    for (const ADSB::VehicleInfo_t &vehicleInfo : vehicleInfos) {
+        if (_updateExistingVehicle(vehicleInfo)) {
+            continue;
+        }
+
+        if (vehicleInfo.availableFlags & ADSB::LocationAvailable) {
+            newVehicles.append(_addVehicle(vehicleInfo));
+        }
+    }
+
+    if (!newVehicles.isEmpty()) {
+        qCDebug(ADSBVehicleManagerLog) << "Added" << newVehicles.count();
+        _adsbVehicles->append(newVehicles);
+    }
+}
+
 void ADSBVehicleManager::_start(const QString &hostAddress, quint16 port)
 {
-    Q_ASSERT(!_adsbTcpLink);
-    _adsbTcpLink = new ADSBTCPLink(QHostAddress(hostAddress), port, this);
-    (void) connect(_adsbTcpLink, &ADSBTCPLink::adsbVehicleUpdate, this, &ADSBVehicleManager::adsbVehicleUpdate, Qt::AutoConnection);
-    (void) connect(_adsbTcpLink, &ADSBTCPLink::errorOccurred, this, &ADSBVehicleManager::_linkError, Qt::AutoConnection);
+    Q_ASSERT(!_adsbTcpLinkThread);
+
+    // Parsing a busy feed is too much work for the GUI thread. The link is created on its own thread
+    // so the socket and all of its processing live there, only merged batches cross back over.
+    _adsbTcpLinkThread = new QThread(this);
+    _adsbTcpLinkThread->setObjectName(QStringLiteral("ADSBTCPLink"));
+
+    (void) connect(_adsbTcpLinkThread, &QThread::started, _adsbTcpLinkThread, [this, hostAddress, port]() {
+        ADSBTCPLink* const adsbTcpLink = new ADSBTCPLink(QHostAddress(hostAddress), port);
+        (void) connect(adsbTcpLink, &ADSBTCPLink::adsbVehicleUpdates, this, &ADSBVehicleManager::adsbVehicleUpdates, Qt::QueuedConnection);
+        (void) connect(adsbTcpLink, &ADSBTCPLink::errorOccurred, this, &ADSBVehicleManager::_linkError, Qt::QueuedConnection);
+        (void) connect(QThread::currentThread(), &QThread::finished, adsbTcpLink, &QObject::deleteLater);
+    }, Qt::DirectConnection);
+
+    _adsbTcpLinkThread->start();
 
     _adsbVehicleCleanupTimer->start();
 }
 
 void ADSBVehicleManager::_stop()
 {
-    Q_CHECK_PTR(_adsbTcpLink);
-    _adsbTcpLink->deleteLater();
-    _adsbTcpLink = nullptr;
+    Q_CHECK_PTR(_adsbTcpLinkThread);
+    _adsbTcpLinkThread->quit();
+    _adsbTcpLinkThread->wait();
+    _adsbTcpLinkThread->deleteLater();
+    _adsbTcpLinkThread = nullptr;
 
     _adsbVehicleCleanupTimer->stop();
 
     _adsbVehicles->clearAndDeleteContents();
     _adsbICAOMap.clear();
+    _spatialIndex.clear();
+    _proximityAlertVehicles.clear();
+}
+
+QList<ADSBVehicle*> ADSBVehicleManager::vehiclesWithin(const QGeoCoordinate &center, double radiusMeters, double minAltitude, double maxAltitude) const
+{
+    QList<ADSBVehicle*> result;
+
+    for (const uint32_t icaoAddress : _spatialIndex.query(center, radiusMeters)) {
+        ADSBVehicle* const adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+        if (!adsbVehicle) {
+            continue;
+        }
+
+        // Aircraft without known altitude are always reported, better a false alert than a missed one
+        const double altitude = adsbVehicle->altitude();
+        if (!qIsNaN(altitude)) {
+            if ((!qIsNaN(minAltitude) && (altitude < minAltitude)) || (!qIsNaN(maxAltitude) && (altitude > maxAltitude))) {
+                continue;
+            }
+        }
+
+        result.append(adsbVehicle);
+    }
+
+    return result;
 }
 
 void ADSBVehicleManager::_cleanupStaleVehicles()
 {
-    for (qsizetype i = _adsbVehicles->count() - 1; i >= 0; i--) {
+    // Collect all survivors first so the model is reset once per sweep instead of once per expired vehicle
+    QList<ADSBVehicle*> expiredVehicles;
+    QObjectList survivors;
+    survivors.reserve(_adsbVehicles->count());
+
+    for (qsizetype i = 0; i < _adsbVehicles->count(); i++) {
         ADSBVehicle* const adsbVehicle = _adsbVehicles->value<ADSBVehicle*>(i);
         if (adsbVehicle->expired()) {
-            qCDebug(ADSBVehicleManagerLog) << "Expired" << QString::number(adsbVehicle->icaoAddress());
-            (void) _adsbVehicles->removeAt(i);
+            expiredVehicles.append(adsbVehicle);
+        } else {
+            survivors.append(adsbVehicle);
+        }
+    }
+
+    if (!expiredVehicles.isEmpty()) {
+        qCDebug(ADSBVehicleManagerLog) << "Expired" << expiredVehicles.count();
+
+        for (ADSBVehicle *adsbVehicle : expiredVehicles) {
             (void) _adsbICAOMap.remove(adsbVehicle->icaoAddress());
+            _spatialIndex.remove(adsbVehicle->icaoAddress());
+        }
+
+        (void) _adsbVehicles->swapObjectList(survivors);
+
+        for (ADSBVehicle *adsbVehicle : expiredVehicles) {
             adsbVehicle->deleteLater();
         }
     }
+
+    _updateProximityAlerts();
+}
+
+void ADSBVehicleManager::_updateProximityAlerts()
+{
+    const double alertDistance = _adsbSettings->adsbProximityAlertDistance()->rawValue().toDouble();
+    const double alertAltitude = _adsbSettings->adsbProximityAlertAltitude()->rawValue().toDouble();
+
+    QSet<uint32_t> alertVehicles;
+
+    QmlObjectListModel* const vehicles = qgcApp()->toolbox()->multiVehicleManager()->vehicles();
+    for (qsizetype i = 0; i < vehicles->count(); i++) {
+        Vehicle* const vehicle = qobject_cast<Vehicle*>(vehicles->get(i));
+        if (!vehicle || !vehicle->coordinate().isValid()) {
+            continue;
+        }
+
+        const double altitude = vehicle->vehicleFactGroup()->getFact(QStringLiteral("altitudeAMSL"))->rawValue().toDouble();
+        const double minAltitude = qIsNaN(altitude) ? qQNaN() : (altitude - alertAltitude);
+        const double maxAltitude = qIsNaN(altitude) ? qQNaN() : (altitude + alertAltitude);
+
+        for (ADSBVehicle *adsbVehicle : vehiclesWithin(vehicle->coordinate(), alertDistance, minAltitude, maxAltitude)) {
+            if (!adsbVehicle->proximityAlert()) {
+                qCDebug(ADSBVehicleManagerLog) << "Proximity alert" << QString::number(adsbVehicle->icaoAddress(), 16) << "vehicle" << vehicle->id();
+                qgcApp()->showAppMessage(tr("Traffic %1 is within %2 m of vehicle %3")
+                                         .arg(adsbVehicle->callsign().isEmpty() ? QString::number(adsbVehicle->icaoAddress(), 16).toUpper() : adsbVehicle->callsign())
+                                         .arg(qRound(vehicle->coordinate().distanceTo(adsbVehicle->coordinate())))
+                                         .arg(vehicle->id()));
+            }
+            adsbVehicle->setProximityAlert(true);
+            (void) alertVehicles.insert(adsbVehicle->icaoAddress());
+        }
+    }
+
+    // Only the aircraft which were alerting on the previous pass need to be visited to clear alerts
+    for (const uint32_t icaoAddress : std::as_const(_proximityAlertVehicles)) {
+        if (!alertVehicles.contains(icaoAddress)) {
+            ADSBVehicle* const adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+            if (adsbVehicle) {
+                adsbVehicle->setProximityAlert(false);
+            }
+        }
+    }
+    _proximityAlertVehicles = alertVehicles;
 }
 
 void ADSBVehicleManager::_linkError(const QString &errorMsg, bool stopped)
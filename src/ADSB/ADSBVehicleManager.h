@@ -11,14 +11,18 @@
 
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtPositioning/QGeoCoordinate>
 
 #include "ADSB.h"
+#include "ADSBSpatialIndex.h"
 
 Q_DECLARE_LOGGING_CATEGORY(ADSBVehicleManagerLog)
 
 class ADSBTCPLink;
 class ADSBVehicle;
 class QmlObjectListModel;
+class QThread;
 class QTimer;
 class ADSBVehicleManagerSettings;
 
@@ -37,21 +41,37 @@ public:
 
     const QmlObjectListModel *adsbVehicles() const { return _adsbVehicles; }
 
+    /// Spatial query over all known traffic.
+    ///     @param center Center of the search area
+    ///     @param radiusMeters Horizontal search radius
+    ///     @param minAltitude Aircraft below this altitude are ignored, NaN for no lower limit
+    ///     @param maxAltitude Aircraft above this altitude are ignored, NaN for no upper limit
+    ///     @return Aircraft within the search volume
+    QList<ADSBVehicle*> vehiclesWithin(const QGeoCoordinate &center, double radiusMeters, double minAltitude = qQNaN(), double maxAltitude = qQNaN()) const;
+
 public slots:
     void adsbVehicleUpdate(const ADSB::VehicleInfo_t &vehicleInfo);
 
+    /// Applies a batch of updates, adding all new vehicles to the model in one go
+    void adsbVehicleUpdates(const QList<ADSB::VehicleInfo_t> &vehicleInfos);
+
 private slots:
     void _cleanupStaleVehicles();
     void _linkError(const QString &errorMsg, bool stopped = false);
+    void _updateProximityAlerts();
 
 private:
     void _start(const QString &hostAddress, quint16 port);
     void _stop();
+    ADSBVehicle *_updateExistingVehicle(const ADSB::VehicleInfo_t &vehicleInfo);
+    ADSBVehicle *_addVehicle(const ADSB::VehicleInfo_t &vehicleInfo);
 
     ADSBVehicleManagerSettings *_adsbSettings = nullptr;
     QTimer *_adsbVehicleCleanupTimer = nullptr;
     QmlObjectListModel *_adsbVehicles = nullptr;
 
     QMap<uint32_t, ADSBVehicle*> _adsbICAOMap;
-    ADSBTCPLink *_adsbTcpLink = nullptr;
+    ADSBSpatialIndex _spatialIndex;         ///< Positions of all vehicles in _adsbICAOMap
+    QSet<uint32_t> _proximityAlertVehicles; ///< Aircraft which were in proximity alert on the last check
+    QThread *_adsbTcpLinkThread = nullptr;  ///< Thread the ADSBTCPLink lives on while connected
 };
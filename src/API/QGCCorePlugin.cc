@@ -31,6 +31,8 @@
 #include <QtQml/QQmlApplicationEngine>
 #include <QtQml/QQmlContext>
 
+#include <typeinfo>
+
 /// @file
 ///     @brief Core Plugin Interface for QGroundControl - Default Implementation
 ///     @author Gus Grubba <gus@auterion.com>
@@ -325,6 +327,12 @@ QmlObjectListModel* QGCCorePlugin::customMapItems()
     return &_p->_emptyCustomMapItems;
 }
 
+bool QGCCorePlugin::streamPlanFileSaves() const
+{
+    // Custom builds may look at the mission items from their save hooks
+    return typeid(*this) == typeid(QGCCorePlugin);
+}
+
 VideoReceiver* QGCCorePlugin::createVideoReceiver(QObject* parent)
 {
 #ifdef QGC_GST_STREAMING
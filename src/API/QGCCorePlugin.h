@@ -134,6 +134,11 @@ public:
     /// Allows custom builds to add custom items to the mission section of the plan file after the item is created.
     virtual void    postSaveToMissionJson   (PlanMasterController* /*pController*/, QJsonObject& /*missionJson*/) {}
 
+    /// Plan files are normally streamed to disk with the mission items written one at a time. The post save hooks
+    /// above then run before the mission items are added to the json. Custom builds save plan files the way
+    /// saveToJson builds them, with the items in place, unless they override this to return true.
+    virtual bool    streamPlanFileSaves     () const;
+
     /// Allows custom builds to load custom items from the plan file before the document is parsed.
     virtual void    preLoadFromJson     (PlanMasterController* /*pController*/, QJsonObject& /*json*/) {}
     /// Allows custom builds to load custom items from the plan file after the document is parsed.
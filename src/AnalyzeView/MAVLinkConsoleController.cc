@@ -21,8 +21,13 @@
 QGC_LOGGING_CATEGORY(MAVLinkConsoleControllerLog, "qgc.analyzeview.mavlinkconsolecontroller")
 
 MAVLinkConsoleController::MAVLinkConsoleController()
-    : QStringListModel()
+    : QAbstractListModel()
 {
+    _lines.resize(_max_num_lines);
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(_flushIntervalMSecs);
+    connect(&_flushTimer, &QTimer::timeout, this, &MAVLinkConsoleController::_flushUpdates);
+
     auto *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &MAVLinkConsoleController::_setActiveVehicle);
     _setActiveVehicle(manager->activeVehicle());
@@ -63,6 +68,17 @@ MAVLinkConsoleController::historyDown(const QString& current)
     return _history.down(current);
 }
 
+void
+MAVLinkConsoleController::copyToClipboard() const
+{
+    QStringList lines;
+    lines.reserve(_lineCount);
+    for (qint64 i = _firstLine; i < _firstLine + _lineCount; ++i) {
+        lines.append(_line(i));
+    }
+    QGuiApplication::clipboard()->setText(lines.join('\n'));
+}
+
 QString
 MAVLinkConsoleController::handleClipboard(const QString& command_pre)
 {
@@ -86,12 +102,7 @@ MAVLinkConsoleController::_setActiveVehicle(Vehicle* vehicle)
     _vehicle = vehicle;
 
     if (_vehicle) {
-        _incoming_buffer.clear();
-        // Reset the model
-        setStringList(QStringList());
-        _cursorY = 0;
-        _cursorX = 0;
-        _cursor_home_pos = -1;
+        _clear();
         _uas_connections << connect(_vehicle, &Vehicle::mavlinkSerialControl, this, &MAVLinkConsoleController::_receiveData);
     }
 }
@@ -102,36 +113,45 @@ MAVLinkConsoleController::_receiveData(uint8_t device, uint8_t, uint16_t, uint32
     if (device != SERIAL_CONTROL_DEV_SHELL)
         return;
 
-    // Append incoming data and parse for ANSI codes
-    _incoming_buffer.append(data);
-    while(!_incoming_buffer.isEmpty()) {
-        bool newline = false;
-        int idx = _incoming_buffer.indexOf('\n');
-        if (idx == -1) {
-            // Read the whole incoming buffer
-            idx = _incoming_buffer.size();
-        } else {
-            newline = true;
-        }
-
-        QByteArray fragment = _incoming_buffer.mid(0, idx);
-        if (_processANSItext(fragment)) {
-            writeLine(_cursorY, fragment);
-            if (newline) {
-                _cursorY++;
+    for (const char c : data) {
+        switch (_ansiState) {
+        case AnsiText:
+            if (c == '\x1B') {
+                _writeText();
+                _ansiState = AnsiEscape;
+            } else if (c == '\n') {
+                _writeText();
+                _newLine();
+            } else if (c == '\r') {
+                _writeText();
                 _cursorX = 0;
-                // ensure line exists
-                int rc = rowCount();
-                if (_cursorY >= rc) {
-                    insertRows(rc, 1 + _cursorY - rc);
-                }
+            } else {
+                _pendingText.append(c);
             }
-            _incoming_buffer.remove(0, idx + (newline ? 1 : 0));
-        } else {
-            // ANSI processing failed, need more data
-            return;
+            break;
+        case AnsiEscape:
+            if (c == '[') {
+                _ansiParams.clear();
+                _ansiState = AnsiCsi;
+            } else {
+                // Not a control sequence we know, drop it
+                _ansiState = AnsiText;
+            }
+            break;
+        case AnsiCsi:
+            if (c >= 0x40 && c <= 0x7E) {
+                _processCsi(c);
+                _ansiState = AnsiText;
+            } else if (_ansiParams.size() < _maxAnsiParamsLength) {
+                _ansiParams.append(c);
+            } else {
+                // Garbage, give up on this sequence
+                _ansiState = AnsiText;
+            }
+            break;
         }
     }
+    _writeText(true /* endOfPacket */);
 }
 
 void
@@ -175,119 +195,221 @@ MAVLinkConsoleController::_sendSerialData(QByteArray data, bool close)
     }
 }
 
-bool
-MAVLinkConsoleController::_processANSItext(QByteArray &line)
+void
+MAVLinkConsoleController::_processCsi(char command)
+{
+    switch (command) {
+    case 'H':
+        if (_cursor_home_pos == -1) {
+            // Assign new home position if home is unset
+            _cursor_home_pos = _cursorY;
+        } else {
+            // Rewind write cursor position to home
+            _cursorY = _cursor_home_pos;
+            _cursorX = 0;
+        }
+        break;
+    case 'K':
+        // Erase the current line to the end
+        if (_cursorY >= _firstLine && _cursorY < _firstLine + _lineCount) {
+            QString& line = _line(_cursorY);
+            if (_cursorX < line.length()) {
+                line.truncate(_cursorX);
+                _lineChanged(_cursorY);
+            }
+        }
+        break;
+    case 'J':
+        if (_ansiParams == "2" && _cursor_home_pos != -1) {
+            // Erase everything from home on
+            for (qint64 i = _cursor_home_pos; i < _firstLine + _lineCount; i++) {
+                _line(i).clear();
+            }
+            _lineChanged(_cursor_home_pos);
+        }
+        break;
+    default:
+        // Colors and the like are not supported, drop them
+        break;
+    }
+}
+
+/// Writes the pending text at the cursor, overwriting what is there. At the end of a packet a UTF-8 sequence which is
+/// not complete yet stays pending, the rest of it comes with the next packet.
+void
+MAVLinkConsoleController::_writeText(bool endOfPacket)
 {
-    // Iterate over the incoming buffer to parse off known ANSI control codes
-    for (int i = 0; i < line.size(); i++) {
-        if (line.at(i) == '\x1B') {
-            // For ANSI codes we expect at least 3 incoming chars
-            if (i < line.size() - 2 && line.at(i+1) == '[') {
-                // Parse ANSI code
-                switch(line.at(i+2)) {
-                    default:
-                        continue;
-                    case 'H':
-                        if (_cursor_home_pos == -1) {
-                            // Assign new home position if home is unset
-                            _cursor_home_pos = _cursorY;
-                        } else {
-                            // Rewind write cursor position to home
-                            _cursorY = _cursor_home_pos;
-                            _cursorX = 0;
-                        }
-                        break;
-                    case 'K':
-                        // Erase the current line to the end
-                        if (_cursorY < rowCount()) {
-                            auto idx = index(_cursorY);
-                            QString updated = data(idx, Qt::DisplayRole).toString();
-                            int eraseIdx = _cursorX + i;
-                            if (eraseIdx < updated.length()) {
-                                setData(idx, updated.remove(eraseIdx, updated.length()));
-                            }
-                        }
-                        break;
-                    case '2':
-                        // Check for sufficient buffer size
-                        if ( i >= line.size() - 3)
-                            return false;
-
-                        if (line.at(i+3) == 'J' && _cursor_home_pos != -1) {
-                            // Erase everything and rewind to home
-                            bool blocked = blockSignals(true);
-                            for (int j = _cursor_home_pos; j < rowCount(); j++)
-                                setData(index(j), "");
-                            blockSignals(blocked);
-                            QVector<int> roles({Qt::DisplayRole, Qt::EditRole});
-                            emit dataChanged(index(_cursorY), index(rowCount()), roles);
-                        }
-                        // Even if we didn't understand this ANSI code, remove the 4th char
-                        line.remove(i+3,1);
-                        break;
+    qsizetype incomplete = 0;
+    if (endOfPacket) {
+        for (qsizetype i = 1; i <= qMin<qsizetype>(3, _pendingText.size()); i++) {
+            const uchar c = static_cast<uchar>(_pendingText[_pendingText.size() - i]);
+            if ((c & 0xC0) == 0x80) {
+                // Continuation byte, look further back for the lead byte
+                continue;
+            }
+            if ((c & 0xC0) == 0xC0) {
+                const qsizetype sequenceLength = (c >= 0xF0) ? 4 : ((c >= 0xE0) ? 3 : 2);
+                if (sequenceLength > i) {
+                    incomplete = i;
                 }
-                // Remove the parsed ANSI code and decrement the bufferpos
-                line.remove(i, 3);
-                i--;
-            } else {
-                // We can reasonably expect a control code was fragemented
-                // Stop parsing here and wait for it to come in
-                return false;
             }
+            break;
         }
     }
-    return true;
+    if (_pendingText.size() == incomplete) {
+        return;
+    }
+    const QString text = QString::fromUtf8(_pendingText.constData(), _pendingText.size() - incomplete);
+    _pendingText.remove(0, _pendingText.size() - incomplete);
+
+    _ensureLine(_cursorY);
+    QString& line = _line(_cursorY);
+    if (_cursorX > line.length()) {
+        line.append(QString(_cursorX - line.length(), ' '));
+    }
+    line.replace(_cursorX, text.length(), text);
+    _cursorX += text.length();
+    _lineChanged(_cursorY);
 }
 
-QString
-MAVLinkConsoleController::transformLineForRichText(const QString& line) const
+void
+MAVLinkConsoleController::_newLine()
 {
-    QString ret = line.toHtmlEscaped().replace(" ","&nbsp;").replace("\t", "&nbsp;&nbsp;&nbsp;&nbsp;");
+    _cursorY++;
+    _cursorX = 0;
+    _ensureLine(_cursorY);
+}
 
-    if (ret.startsWith("WARN", Qt::CaseSensitive)) {
-        ret.replace(0, 4, "<font color=\"" + _palette.colorOrange().name() + "\">WARN</font>");
-    } else if (ret.startsWith("ERROR", Qt::CaseSensitive)) {
-        ret.replace(0, 5, "<font color=\"" + _palette.colorRed().name() + "\">ERROR</font>");
+/// Grows the ring up to and including line, dropping the oldest lines once it is full
+void
+MAVLinkConsoleController::_ensureLine(qint64 line)
+{
+    if (line < _firstLine + _lineCount) {
+        return;
+    }
+    while (_firstLine + _lineCount <= line) {
+        if (_lineCount == _max_num_lines) {
+            _firstLine++;
+        } else {
+            _lineCount++;
+        }
+        _line(_firstLine + _lineCount - 1).clear();
+    }
+    if (_cursor_home_pos < _firstLine) {
+        _cursor_home_pos = -1;
     }
+    if (!_flushTimer.isActive()) {
+        _flushTimer.start();
+    }
+}
 
-    return ret;
+void
+MAVLinkConsoleController::_lineChanged(qint64 line)
+{
+    if (line < _publishedFirstLine + _publishedCount && (_dirtyFromLine == -1 || line < _dirtyFromLine)) {
+        _dirtyFromLine = line;
+    }
+    if (!_flushTimer.isActive()) {
+        _flushTimer.start();
+    }
 }
 
-QString
-MAVLinkConsoleController::getText() const
+/// Brings the views up to date with the ring: at most one remove, one change and one insert
+void
+MAVLinkConsoleController::_flushUpdates()
 {
-    QString ret;
-    if (rowCount() > 0) {
-        ret = transformLineForRichText(data(index(0), Qt::DisplayRole).toString());
+    // Lines which scrolled out of the ring
+    const int removed = static_cast<int>(qMin<qint64>(_firstLine - _publishedFirstLine, _publishedCount));
+    if (removed > 0) {
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+        _publishedFirstLine += removed;
+        _publishedCount -= removed;
+        endRemoveRows();
     }
-    for (int i = 1; i < rowCount(); ++i) {
-        ret += "<br>" + transformLineForRichText(data(index(i), Qt::DisplayRole).toString());
+    if (_publishedCount == 0) {
+        _publishedFirstLine = _firstLine;
     }
 
-    return ret;
+    if (_dirtyFromLine != -1) {
+        const qint64 first = qMax(_dirtyFromLine, _publishedFirstLine);
+        const qint64 last = _publishedFirstLine + _publishedCount - 1;
+        if (first <= last) {
+            emit dataChanged(index(static_cast<int>(first - _publishedFirstLine)), index(static_cast<int>(last - _publishedFirstLine)), { Qt::DisplayRole, Qt::EditRole, RichTextRole });
+        }
+        _dirtyFromLine = -1;
+    }
+
+    const int added = static_cast<int>(_firstLine + _lineCount - (_publishedFirstLine + _publishedCount));
+    if (added > 0) {
+        beginInsertRows(QModelIndex(), _publishedCount, _publishedCount + added - 1);
+        _publishedCount += added;
+        endInsertRows();
+    }
 }
 
 void
-MAVLinkConsoleController::writeLine(int line, const QByteArray &text)
+MAVLinkConsoleController::_clear()
 {
-    auto rc = rowCount();
-    if (line >= rc) {
-        insertRows(rc, 1 + line - rc);
+    _flushTimer.stop();
+    beginResetModel();
+    _firstLine = 0;
+    _lineCount = 0;
+    _publishedFirstLine = 0;
+    _publishedCount = 0;
+    _dirtyFromLine = -1;
+    endResetModel();
+
+    _ansiState = AnsiText;
+    _ansiParams.clear();
+    _pendingText.clear();
+    _cursorY = 0;
+    _cursorX = 0;
+    _cursor_home_pos = -1;
+}
+
+int
+MAVLinkConsoleController::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _publishedCount;
+}
+
+QVariant
+MAVLinkConsoleController::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= _publishedCount) {
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole && role != Qt::EditRole && role != RichTextRole) {
+        return QVariant();
+    }
+    // The line may have left the ring since the views were last updated
+    const qint64 line = _publishedFirstLine + index.row();
+    if (line < _firstLine) {
+        return QString();
     }
-    if (rowCount() > _max_num_lines) {
-        int count = rowCount() - _max_num_lines;
-        removeRows(0, count);
-        line -= count;
-        _cursorY -= count;
-        _cursor_home_pos -= count;
-        if (_cursor_home_pos < 0)
-            _cursor_home_pos = -1;
+    return (role == RichTextRole) ? transformLineForRichText(_line(line)) : _line(line);
+}
+
+QHash<int, QByteArray>
+MAVLinkConsoleController::roleNames() const
+{
+    QHash<int, QByteArray> roles = QAbstractListModel::roleNames();
+    roles[RichTextRole] = "richText";
+    return roles;
+}
+
+QString
+MAVLinkConsoleController::transformLineForRichText(const QString& line) const
+{
+    QString ret = line.toHtmlEscaped().replace(" ","&nbsp;").replace("\t", "&nbsp;&nbsp;&nbsp;&nbsp;");
+
+    if (ret.startsWith("WARN", Qt::CaseSensitive)) {
+        ret.replace(0, 4, "<font color=\"" + _palette.colorOrange().name() + "\">WARN</font>");
+    } else if (ret.startsWith("ERROR", Qt::CaseSensitive)) {
+        ret.replace(0, 5, "<font color=\"" + _palette.colorRed().name() + "\">ERROR</font>");
     }
-    auto idx = index(line);
-    QString updated = data(idx, Qt::DisplayRole).toString();
-    updated.replace(_cursorX, text.size(), text);
-    setData(idx, updated);
-    _cursorX += text.size();
+
+    return ret;
 }
 
 void MAVLinkConsoleController::CommandHistory::append(const QString& command)
@@ -9,10 +9,11 @@
 
 #pragma once
 
+#include <QtCore/QAbstractListModel>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QMetaObject>
-#include <QtCore/QStringListModel>
+#include <QtCore/QTimer>
 #include <QtQmlIntegration/QtQmlIntegration>
 #include <QtCore/QLoggingCategory>
 
@@ -23,7 +24,12 @@ Q_DECLARE_LOGGING_CATEGORY(MAVLinkConsoleControllerLog)
 class Vehicle;
 
 /// Controller for MavlinkConsole.qml.
-class MAVLinkConsoleController : public QStringListModel
+///
+/// The console output is kept in a fixed size ring of lines. Incoming bytes go through an incremental ANSI parser which
+/// keeps its state across packets, so a control sequence split over two packets is never rescanned. Model
+/// notifications are coalesced and sent at most once per frame, and the page shows the rows through a ListView so only
+/// the changed lines get laid out again.
+class MAVLinkConsoleController : public QAbstractListModel
 {
     Q_OBJECT
     QML_ELEMENT
@@ -45,20 +51,42 @@ public:
      */
     Q_INVOKABLE QString handleClipboard(const QString& command_pre);
 
-    Q_PROPERTY(QString text                     READ getText                    CONSTANT)
+    /// Copies the console output as plain text to the clipboard
+    Q_INVOKABLE void copyToClipboard() const;
+
+    enum Roles {
+        RichTextRole = Qt::UserRole + 1,    ///< Line as html, WARN and ERROR colored
+    };
+
+    // Overrides from QAbstractListModel
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray>  roleNames   () const override;
 
 private slots:
     void _setActiveVehicle  (Vehicle* vehicle);
     void _receiveData(uint8_t device, uint8_t flags, uint16_t timeout, uint32_t baudrate, QByteArray data);
+    void _flushUpdates();
 
 private:
-    bool _processANSItext(QByteArray &line);
+    enum AnsiState {
+        AnsiText,
+        AnsiEscape,     ///< Seen ESC
+        AnsiCsi,        ///< Seen ESC [, collecting parameters
+    };
+
     void _sendSerialData(QByteArray, bool close = false);
-    void writeLine(int line, const QByteArray &text);
+    void _processCsi(char command);
+    void _writeText(bool endOfPacket = false);
+    void _newLine();
+    void _ensureLine(qint64 line);
+    void _lineChanged(qint64 line);
+    void _clear();
 
-    QString transformLineForRichText(const QString& line) const;
+    QString&        _line(qint64 line)       { return _lines[static_cast<int>(line % _max_num_lines)]; }
+    const QString&  _line(qint64 line) const { return _lines[static_cast<int>(line % _max_num_lines)]; }
 
-    QString getText() const;
+    QString transformLineForRichText(const QString& line) const;
 
     class CommandHistory
     {
@@ -73,11 +101,27 @@ private:
     };
 
     static constexpr int _max_num_lines = 500; ///< history size (affects CPU load)
-
-    int           _cursor_home_pos{-1};
-    int           _cursorY{0};
+    static constexpr int _flushIntervalMSecs = 16;  ///< About one frame
+    static constexpr int _maxAnsiParamsLength = 16;
+
+    // Lines are addressed by their absolute line number since the last reset, the ring holds _firstLine.._firstLine+_lineCount-1
+    QStringList   _lines;
+    qint64        _firstLine{0};
+    int           _lineCount{0};
+
+    // Rows which the views currently know about
+    qint64        _publishedFirstLine{0};
+    int           _publishedCount{0};
+    qint64        _dirtyFromLine{-1};   ///< First published line changed since the last flush, -1 for none
+    QTimer        _flushTimer;
+
+    AnsiState     _ansiState{AnsiText};
+    QByteArray    _ansiParams;
+    QByteArray    _pendingText;         ///< Printable text not yet written at the cursor, may end in part of a UTF-8 sequence
+
+    qint64        _cursor_home_pos{-1};
+    qint64        _cursorY{0};
     int           _cursorX{0};
-    QByteArray    _incoming_buffer;
     Vehicle*      _vehicle{nullptr};
     QList<QMetaObject::Connection> _uas_connections;
     CommandHistory _history;
@@ -0,0 +1,374 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCCameraDefinition.h"
+#include "VehicleCameraControl.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QLocale>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QXmlStreamReader>
+
+QGC_LOGGING_CATEGORY(QGCCameraDefinitionLog, "QGCCameraDefinitionLog")
+
+namespace {
+
+using VCC = VehicleCameraControl;
+
+struct Locale_t {
+    QString                 name;
+    QHash<QString, QString> strings;    ///< original -> translated
+};
+
+bool isElement(const QXmlStreamReader& xml, const char* name)
+{
+    return xml.name() == QLatin1String(name);
+}
+
+bool readAttribute(const QXmlStreamReader& xml, const char* name, QString& target)
+{
+    const QXmlStreamAttributes attributes = xml.attributes();
+    if (!attributes.hasAttribute(QLatin1String(name))) {
+        return false;
+    }
+    target = attributes.value(QLatin1String(name)).toString();
+    return true;
+}
+
+void readAttribute(const QXmlStreamReader& xml, const char* name, bool& target)
+{
+    QString value;
+    if (readAttribute(xml, name, value)) {
+        target = value != QStringLiteral("0");
+    }
+}
+
+/// Reads the text of each child element named childName up to the end of the current element
+QStringList readTextList(QXmlStreamReader& xml, const char* childName)
+{
+    QStringList list;
+    while (xml.readNextStartElement()) {
+        if (isElement(xml, childName)) {
+            const QString text = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            if (!text.isEmpty()) {
+                list << text;
+            }
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    return list;
+}
+
+bool readDefinition(QXmlStreamReader& xml, QGCCameraDefinition& definition, QString& errorString)
+{
+    QString version;
+    if (!readAttribute(xml, VCC::kVersion, version)) {
+        errorString = QStringLiteral("Camera definition is missing its version");
+        return false;
+    }
+    definition.version = version.toInt();
+    bool haveModel = false;
+    bool haveVendor = false;
+    while (xml.readNextStartElement()) {
+        if (isElement(xml, VCC::kModel)) {
+            definition.model = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            haveModel = true;
+        } else if (isElement(xml, VCC::kVendor)) {
+            definition.vendor = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            haveVendor = true;
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    if (!haveModel || !haveVendor) {
+        errorString = QStringLiteral("Camera definition is missing its model or vendor");
+        return false;
+    }
+    return true;
+}
+
+bool readParameterRanges(QXmlStreamReader& xml, const QString& factName, QList<QGCCameraDefinition::ParameterRange_t>& ranges, QString& errorString)
+{
+    while (xml.readNextStartElement()) {
+        if (!isElement(xml, VCC::kParameterrange)) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        QGCCameraDefinition::ParameterRange_t range;
+        if (!readAttribute(xml, VCC::kParameter, range.targetParam)) {
+            errorString = QStringLiteral("Malformed option range for parameter %1").arg(factName);
+            return false;
+        }
+        (void) readAttribute(xml, VCC::kCondition, range.condition);
+        while (xml.readNextStartElement()) {
+            if (isElement(xml, VCC::kRoption)) {
+                QString optName;
+                QString optValue;
+                if (!readAttribute(xml, VCC::kName, optName)) {
+                    errorString = QStringLiteral("Malformed roption for parameter %1").arg(factName);
+                    return false;
+                }
+                if (!readAttribute(xml, VCC::kValue, optValue)) {
+                    errorString = QStringLiteral("Malformed rvalue for parameter %1").arg(factName);
+                    return false;
+                }
+                range.optNames  << optName;
+                range.optValues << optValue;
+            }
+            xml.skipCurrentElement();
+        }
+        if (range.optNames.size()) {
+            ranges.append(range);
+        }
+    }
+    return true;
+}
+
+bool readOptions(QXmlStreamReader& xml, QGCCameraDefinition::Parameter_t& parameter, QString& errorString)
+{
+    while (xml.readNextStartElement()) {
+        if (!isElement(xml, VCC::kOption)) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        QGCCameraDefinition::Option_t option;
+        if (!readAttribute(xml, VCC::kName, option.name)) {
+            errorString = QStringLiteral("Malformed option for parameter %1").arg(parameter.name);
+            return false;
+        }
+        if (!readAttribute(xml, VCC::kValue, option.value)) {
+            errorString = QStringLiteral("Malformed value for parameter %1").arg(parameter.name);
+            return false;
+        }
+        while (xml.readNextStartElement()) {
+            if (isElement(xml, VCC::kExclusions)) {
+                option.exclusions << readTextList(xml, VCC::kExclusion);
+            } else if (isElement(xml, VCC::kParameterranges)) {
+                if (!readParameterRanges(xml, parameter.name, option.ranges, errorString)) {
+                    return false;
+                }
+            } else {
+                xml.skipCurrentElement();
+            }
+        }
+        parameter.options.append(option);
+    }
+    return true;
+}
+
+bool readParameter(QXmlStreamReader& xml, QGCCameraDefinition::Parameter_t& parameter, QString& errorString)
+{
+    if (!readAttribute(xml, VCC::kName, parameter.name)) {
+        errorString = QStringLiteral("Parameter entry missing parameter name");
+        return false;
+    }
+    if (!readAttribute(xml, VCC::kType, parameter.type)) {
+        errorString = QStringLiteral("Parameter %1 missing parameter type").arg(parameter.name);
+        return false;
+    }
+    readAttribute(xml, VCC::kControl, parameter.control);
+    readAttribute(xml, VCC::kReadOnly, parameter.readOnly);
+    readAttribute(xml, VCC::kWriteOnly, parameter.writeOnly);
+    (void) readAttribute(xml, VCC::kDefault, parameter.defaultValue);
+    (void) readAttribute(xml, VCC::kMin, parameter.min);
+    (void) readAttribute(xml, VCC::kMax, parameter.max);
+    (void) readAttribute(xml, VCC::kStep, parameter.step);
+    (void) readAttribute(xml, VCC::kDecimalPlaces, parameter.decimalPlaces);
+    (void) readAttribute(xml, VCC::kUnit, parameter.unit);
+
+    bool haveDescription = false;
+    while (xml.readNextStartElement()) {
+        if (isElement(xml, VCC::kDescription)) {
+            parameter.description = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            haveDescription = true;
+        } else if (isElement(xml, VCC::kOptions)) {
+            if (!readOptions(xml, parameter, errorString)) {
+                return false;
+            }
+        } else if (isElement(xml, VCC::kUpdates)) {
+            parameter.updates << readTextList(xml, VCC::kUpdate);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    if (!haveDescription) {
+        errorString = QStringLiteral("Parameter %1 missing parameter description").arg(parameter.name);
+        return false;
+    }
+    return true;
+}
+
+bool readParameters(QXmlStreamReader& xml, QGCCameraDefinition& definition, QString& errorString)
+{
+    while (xml.readNextStartElement()) {
+        if (isElement(xml, VCC::kParameter)) {
+            QGCCameraDefinition::Parameter_t parameter;
+            if (!readParameter(xml, parameter, errorString)) {
+                return false;
+            }
+            definition.parameters.append(parameter);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    return true;
+}
+
+void readLocalization(QXmlStreamReader& xml, QList<Locale_t>& locales)
+{
+    while (xml.readNextStartElement()) {
+        if (!isElement(xml, VCC::kLocale)) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        Locale_t locale;
+        if (!readAttribute(xml, VCC::kName, locale.name)) {
+            qCWarning(QGCCameraDefinitionLog) << "Localization entry is missing its name attribute";
+            xml.skipCurrentElement();
+            continue;
+        }
+        while (xml.readNextStartElement()) {
+            QString original;
+            QString translated;
+            if (isElement(xml, VCC::kStrings) && readAttribute(xml, VCC::kOriginal, original) && readAttribute(xml, VCC::kTranslated, translated)) {
+                locale.strings[original] = translated;
+            }
+            xml.skipCurrentElement();
+        }
+        locales.append(locale);
+    }
+}
+
+const Locale_t* findLocale(const QList<Locale_t>& locales, const QString& localeName)
+{
+    //-- Direct match first
+    for (const Locale_t& locale: locales) {
+        if (localeName == locale.name.toLower().replace("-", "_")) {
+            return &locale;
+        }
+    }
+    //-- No direct match. Pick first matching language (if any)
+    const QString language = localeName.left(3);
+    for (const Locale_t& locale: locales) {
+        if (locale.name.toLower().startsWith(language)) {
+            return &locale;
+        }
+    }
+    return nullptr;
+}
+
+/// The displayed strings are the ones which get translated: parameter descriptions and option names
+void translate(QGCCameraDefinition& definition, const QHash<QString, QString>& strings)
+{
+    const auto translated = [&strings](QString& text) {
+        const auto it = strings.constFind(text);
+        if (it != strings.constEnd()) {
+            text = it.value();
+        }
+    };
+    for (QGCCameraDefinition::Parameter_t& parameter: definition.parameters) {
+        translated(parameter.description);
+        for (QGCCameraDefinition::Option_t& option: parameter.options) {
+            translated(option.name);
+            for (QGCCameraDefinition::ParameterRange_t& range: option.ranges) {
+                for (QString& optName: range.optNames) {
+                    translated(optName);
+                }
+            }
+        }
+    }
+}
+
+QMutex                                                      cacheMutex;
+QHash<QString, std::shared_ptr<const QGCCameraDefinition>> cache;
+
+} // namespace
+
+std::shared_ptr<const QGCCameraDefinition> QGCCameraDefinition::parse(const QByteArray& bytes, const QString& localeName, QString& errorString)
+{
+    auto definition = std::make_shared<QGCCameraDefinition>();
+    QList<Locale_t> locales;
+    bool haveDefinition = false;
+    bool haveParameters = false;
+
+    QXmlStreamReader xml(bytes);
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        // Sections may be nested anywhere below the root, only the first of each is used
+        if (!haveDefinition && isElement(xml, VCC::kDefnition)) {
+            if (!readDefinition(xml, *definition, errorString)) {
+                return nullptr;
+            }
+            haveDefinition = true;
+        } else if (!haveParameters && isElement(xml, VCC::kParameters)) {
+            if (!readParameters(xml, *definition, errorString)) {
+                return nullptr;
+            }
+            haveParameters = true;
+        } else if (locales.isEmpty() && isElement(xml, VCC::kLocalization)) {
+            readLocalization(xml, locales);
+        }
+    }
+    if (xml.hasError()) {
+        errorString = QStringLiteral("Unable to parse camera definition file on line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return nullptr;
+    }
+    if (!haveDefinition) {
+        errorString = QStringLiteral("Unable to load camera constants from camera definition");
+        return nullptr;
+    }
+    if (!haveParameters) {
+        errorString = QStringLiteral("No parameters to load from camera");
+        return nullptr;
+    }
+
+    qCDebug(QGCCameraDefinitionLog) << "Current locale:" << localeName;
+    if (localeName != QStringLiteral("en_us") && !locales.isEmpty()) {
+        const Locale_t* locale = findLocale(locales, localeName);
+        if (locale) {
+            translate(*definition, locale->strings);
+        } else {
+            //-- Just use default, en_US
+            qCWarning(QGCCameraDefinitionLog) << "No match for" << localeName << "in camera definition file";
+        }
+    }
+
+    return definition;
+}
+
+QString QGCCameraDefinition::currentLocaleName()
+{
+    QLocale locale = QLocale::system();
+#if defined (Q_OS_MAC)
+    locale = QLocale(locale.name());
+#endif
+    return locale.name().toLower().replace("-", "_");
+}
+
+QString QGCCameraDefinition::cacheKey(const QString& uri, int version, const QString& localeName)
+{
+    return QStringLiteral("%1|%2|%3").arg(uri).arg(version).arg(localeName);
+}
+
+std::shared_ptr<const QGCCameraDefinition> QGCCameraDefinition::cachedDefinition(const QString& key)
+{
+    QMutexLocker lock(&cacheMutex);
+    return cache.value(key);
+}
+
+void QGCCameraDefinition::cacheDefinition(const QString& key, std::shared_ptr<const QGCCameraDefinition> definition)
+{
+    QMutexLocker lock(&cacheMutex);
+    cache[key] = std::move(definition);
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <memory>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCCameraDefinitionLog)
+
+/// Parsed camera definition file. It only holds strings, so it can be built on any thread and once built it is never
+/// modified, which lets any number of cameras share one instance. The conversion to typed Facts happens later in
+/// VehicleCameraControl on the gui thread.
+class QGCCameraDefinition
+{
+public:
+    struct ParameterRange_t {
+        QString     targetParam;
+        QString     condition;
+        QStringList optNames;
+        QStringList optValues;
+    };
+
+    struct Option_t {
+        QString                 name;
+        QString                 value;
+        QStringList             exclusions;
+        QList<ParameterRange_t> ranges;
+    };
+
+    struct Parameter_t {
+        QString         name;
+        QString         type;
+        QString         description;
+        QString         defaultValue;   ///< Empty values below mean the attribute was not present
+        QString         min;
+        QString         max;
+        QString         step;
+        QString         decimalPlaces;
+        QString         unit;
+        bool            control     = true;
+        bool            readOnly    = false;
+        bool            writeOnly   = false;
+        QStringList     updates;
+        QList<Option_t> options;
+    };
+
+    int                 version = 0;
+    QString             model;
+    QString             vendor;
+    QList<Parameter_t>  parameters;
+
+    /// Parses a camera definition file, applying the translations for localeName (e.g. "pt_br") if the file has them.
+    /// Safe to call from any thread.
+    ///     @param errorString Set on failure
+    /// @return nullptr if the file is not a usable camera definition
+    static std::shared_ptr<const QGCCameraDefinition> parse(const QByteArray& bytes, const QString& localeName, QString& errorString);
+
+    /// @return Current locale name in the form used by the localization section of definition files
+    static QString currentLocaleName();
+
+    /// @return Key for the parsed definition cache. Cameras which report the same definition uri and version share
+    ///         the same definition.
+    static QString cacheKey(const QString& uri, int version, const QString& localeName);
+
+    /// Process wide cache of parsed definitions, thread safe
+    static std::shared_ptr<const QGCCameraDefinition> cachedDefinition(const QString& key);
+    static void cacheDefinition(const QString& key, std::shared_ptr<const QGCCameraDefinition> definition);
+};
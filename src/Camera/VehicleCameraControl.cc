@@ -16,12 +16,13 @@
 
 #include "VehicleCameraControl.h"
 #include "QGCCameraIO.h"
+#include "QGCCameraDefinition.h"
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "VideoManager.h"
 #include "QGCCameraManager.h"
 #include "FTPManager.h"
-#include "QGCLZMA.h"
+#include "QGCDecompressDevice.h"
 #include "QGCCorePlugin.h"
 #include "Vehicle.h"
 #include "LinkInterface.h"
@@ -30,8 +31,7 @@
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtCore/QDir>
 #include <QtCore/QSettings>
-#include <QtXml/QDomDocument>
-#include <QtXml/QDomNodeList>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtQml/QQmlEngine>
 #include <QtNetwork/QNetworkProxy>
 #include <QtNetwork/QNetworkReply>
@@ -57,66 +57,6 @@ QGCCameraOptionRange::QGCCameraOptionRange(QObject* parent, QString param_, QStr
 {
 }
 
-//-----------------------------------------------------------------------------
-static bool
-read_attribute(QDomNode& node, const char* tagName, bool& target)
-{
-    QDomNamedNodeMap attrs = node.attributes();
-    if(!attrs.count()) {
-        return false;
-    }
-    QDomNode subNode = attrs.namedItem(tagName);
-    if(subNode.isNull()) {
-        return false;
-    }
-    target = subNode.nodeValue() != "0";
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-static bool
-read_attribute(QDomNode& node, const char* tagName, int& target)
-{
-    QDomNamedNodeMap attrs = node.attributes();
-    if(!attrs.count()) {
-        return false;
-    }
-    QDomNode subNode = attrs.namedItem(tagName);
-    if(subNode.isNull()) {
-        return false;
-    }
-    target = subNode.nodeValue().toInt();
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-static bool
-read_attribute(QDomNode& node, const char* tagName, QString& target)
-{
-    QDomNamedNodeMap attrs = node.attributes();
-    if(!attrs.count()) {
-        return false;
-    }
-    QDomNode subNode = attrs.namedItem(tagName);
-    if(subNode.isNull()) {
-        return false;
-    }
-    target = subNode.nodeValue();
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-static bool
-read_value(QDomNode& element, const char* tagName, QString& target)
-{
-    QDomElement de = element.firstChildElement(tagName);
-    if(de.isNull()) {
-        return false;
-    }
-    target = de.text();
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 VehicleCameraControl::VehicleCameraControl(const mavlink_camera_information_t *info, Vehicle* vehicle, int compID, QObject* parent)
     : MavlinkCameraControl(parent)
@@ -126,6 +66,7 @@ VehicleCameraControl::VehicleCameraControl(const mavlink_camera_information_t *i
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     memcpy(&_info, info, sizeof(mavlink_camera_information_t));
     connect(this, &VehicleCameraControl::dataReady, this, &VehicleCameraControl::_dataReady);
+    connect(&_definitionWatcher, &QFutureWatcher<std::shared_ptr<const QGCCameraDefinition>>::finished, this, &VehicleCameraControl::_definitionParsed);
     _vendor = QString(reinterpret_cast<const char*>(info->vendor_name));
     _modelName = QString(reinterpret_cast<const char*>(info->model_name));
     int ver = static_cast<int>(_info.cam_definition_version);
@@ -773,116 +714,81 @@ VehicleCameraControl::_setPhotoStatus(PhotoCaptureStatus status)
 }
 
 //-----------------------------------------------------------------------------
-bool
-VehicleCameraControl::_loadCameraDefinitionFile(QByteArray& bytes)
-{
-    QByteArray originalData(bytes);
-    //-- Handle localization
-    if(!_handleLocalization(bytes)) {
-        return false;
-    }
-    int errorLine;
-    QString errorMsg;
-    QDomDocument doc;
-    if(!doc.setContent(bytes, false, &errorMsg, &errorLine)) {
-        qCCritical(CameraControlLog) << "Unable to parse camera definition file on line:" << errorLine;
-        qCCritical(CameraControlLog) << errorMsg;
-        return false;
-    }
-    //-- Load camera constants
-    QDomNodeList defElements = doc.elementsByTagName(kDefnition);
-    if(!defElements.size() || !_loadConstants(defElements)) {
-        qCWarning(CameraControlLog) <<  "Unable to load camera constants from camera definition";
-        return false;
-    }
-    //-- Load camera parameters
-    QDomNodeList paramElements = doc.elementsByTagName(kParameters);
-    if(!paramElements.size()) {
-        qCDebug(CameraControlLog) <<  "No parameters to load from camera";
-        return false;
-    }
-    if(!_loadSettings(paramElements)) {
-        qCWarning(CameraControlLog) <<  "Unable to load camera parameters from camera definition";
-        return false;
-    }
-    //-- If this is new, cache it
-    if(!_cached) {
-        qCDebug(CameraControlLog) << "Saving camera definition file" << _cacheFile;
-        QFile file(_cacheFile);
-        if (!file.open(QIODevice::WriteOnly)) {
-            qWarning() << QString("Could not save cache file %1. Error: %2").arg(_cacheFile).arg(file.errorString());
-        } else {
-            file.write(originalData);
+void
+VehicleCameraControl::_parseDefinitionFile(const QByteArray& bytes, bool cacheParsed)
+{
+    //-- The xml is parsed on a worker, only the Facts are built on the gui thread
+    const QString localeName = QGCCameraDefinition::currentLocaleName();
+    const QString cacheFile  = _cached ? QString() : _cacheFile;
+    const QString cacheKey   = cacheParsed ? _definitionCacheKey : QString();
+    _definitionWatcher.setFuture(QtConcurrent::run([bytes, localeName, cacheFile, cacheKey]() {
+        QString errorString;
+        std::shared_ptr<const QGCCameraDefinition> definition = QGCCameraDefinition::parse(bytes, localeName, errorString);
+        if(!definition) {
+            qCWarning(CameraControlLog) << errorString;
+            return definition;
         }
-    }
-    return true;
+        if(!cacheKey.isEmpty()) {
+            QGCCameraDefinition::cacheDefinition(cacheKey, definition);
+        }
+        //-- If this is new, cache it
+        if(!cacheFile.isEmpty()) {
+            qCDebug(CameraControlLog) << "Saving camera definition file" << cacheFile;
+            QFile file(cacheFile);
+            if (!file.open(QIODevice::WriteOnly)) {
+                qWarning() << QString("Could not save cache file %1. Error: %2").arg(cacheFile).arg(file.errorString());
+            } else {
+                (void) file.write(bytes);
+            }
+        }
+        return definition;
+    }));
 }
 
 //-----------------------------------------------------------------------------
-bool
-VehicleCameraControl::_loadConstants(const QDomNodeList nodeList)
+void
+VehicleCameraControl::_definitionParsed()
 {
-    QDomNode node = nodeList.item(0);
-    if(!read_attribute(node, kVersion, _version)) {
-        return false;
-    }
-    if(!read_value(node, kModel, _modelName)) {
-        return false;
+    const std::shared_ptr<const QGCCameraDefinition> definition = _definitionWatcher.result();
+    const bool fromDiskCache = _definitionFromDiskCache;
+    _definitionFromDiskCache = false;
+    if(!definition && fromDiskCache) {
+        qWarning() << "Could not parse cached camera definition file:" << _cacheFile;
+        _cached = false;
+        _httpRequest(_definitionUri);
+        return;
     }
-    if(!read_value(node, kVendor, _vendor)) {
-        return false;
+    if(definition) {
+        _loadDefinition(*definition);
     }
-    return true;
+    _initWhenReady();
 }
 
 //-----------------------------------------------------------------------------
 bool
-VehicleCameraControl::_loadSettings(const QDomNodeList nodeList)
+VehicleCameraControl::_loadDefinition(const QGCCameraDefinition& definition)
 {
-    QDomNode node = nodeList.item(0);
-    QDomElement elem = node.toElement();
-    QDomNodeList parameters = elem.elementsByTagName(kParameter);
+    //-- Load camera constants
+    _version   = definition.version;
+    _modelName = definition.model;
+    _vendor    = definition.vendor;
     //-- Pre-process settings (maintain order and skip non-controls)
-    for(int i = 0; i < parameters.size(); i++) {
-        QDomNode parameterNode = parameters.item(i);
-        QString name;
-        if(read_attribute(parameterNode, kName, name)) {
-            bool control = true;
-            read_attribute(parameterNode, kControl, control);
-            if(control) {
-                _settings << name;
-            }
-        } else {
-            qCritical() << "Parameter entry missing parameter name";
-            return false;
+    for(const QGCCameraDefinition::Parameter_t& parameter: definition.parameters) {
+        if(parameter.control) {
+            _settings << parameter.name;
         }
     }
     //-- Load parameters
-    for(int i = 0; i < parameters.size(); i++) {
-        QDomNode parameterNode = parameters.item(i);
-        QString factName;
-        read_attribute(parameterNode, kName, factName);
-        QString type;
-        if(!read_attribute(parameterNode, kType, type)) {
-            qCritical() << QString("Parameter %1 missing parameter type").arg(factName);
-            return false;
-        }
-        //-- Does it have a control?
-        bool control = true;
-        read_attribute(parameterNode, kControl, control);
-        //-- Is it read only?
-        bool readOnly = false;
-        read_attribute(parameterNode, kReadOnly, readOnly);
-        //-- Is it write only?
-        bool writeOnly = false;
-        read_attribute(parameterNode, kWriteOnly, writeOnly);
+    for(const QGCCameraDefinition::Parameter_t& parameter: definition.parameters) {
+        const QString& factName = parameter.name;
+        bool control = parameter.control;
         //-- It can't be both
-        if(readOnly && writeOnly) {
+        if(parameter.readOnly && parameter.writeOnly) {
             qCritical() << QString("Parameter %1 cannot be both read only and write only").arg(factName);
         }
         //-- Param type
         bool unknownType;
-        FactMetaData::ValueType_t factType = FactMetaData::stringToType(type, unknownType);
+        FactMetaData::ValueType_t factType = FactMetaData::stringToType(parameter.type, unknownType);
         if (unknownType) {
             qCritical() << QString("Unknown type for parameter %1").arg(factName);
             return false;
@@ -891,71 +797,55 @@ VehicleCameraControl::_loadSettings(const QDomNodeList nodeList)
         if(factType == FactMetaData::valueTypeCustom) {
             control = false;
         }
-        //-- Description
-        QString description;
-        if(!read_value(parameterNode, kDescription, description)) {
-            qCritical() << QString("Parameter %1 missing parameter description").arg(factName);
-            return false;
-        }
         //-- Check for updates
-        QStringList updates = _loadUpdates(parameterNode);
-        if(updates.size()) {
-            qCDebug(CameraControlVerboseLog) << "Parameter" << factName << "requires updates for:" << updates;
-            _requestUpdates[factName] = updates;
+        if(parameter.updates.size()) {
+            qCDebug(CameraControlVerboseLog) << "Parameter" << factName << "requires updates for:" << parameter.updates;
+            _requestUpdates[factName] = parameter.updates;
         }
         //-- Build metadata
         FactMetaData* metaData = new FactMetaData(factType, factName, this);
         QQmlEngine::setObjectOwnership(metaData, QQmlEngine::CppOwnership);
-        metaData->setShortDescription(description);
-        metaData->setLongDescription(description);
+        metaData->setShortDescription(parameter.description);
+        metaData->setLongDescription(parameter.description);
         metaData->setHasControl(control);
-        metaData->setReadOnly(readOnly);
-        metaData->setWriteOnly(writeOnly);
+        metaData->setReadOnly(parameter.readOnly);
+        metaData->setWriteOnly(parameter.writeOnly);
         //-- Options (enums)
-        QDomElement optionElem = parameterNode.toElement();
-        QDomNodeList optionsRoot = optionElem.elementsByTagName(kOptions);
-        if(optionsRoot.size()) {
-            //-- Iterate options
-            QDomNode node = optionsRoot.item(0);
-            QDomElement elem = node.toElement();
-            QDomNodeList options = elem.elementsByTagName(kOption);
-            for(int i = 0; i < options.size(); i++) {
-                QDomNode option = options.item(i);
-                QString optName;
-                QString optValue;
-                QVariant optVariant;
-                if(!_loadNameValue(option, factName, metaData, optName, optValue, optVariant)) {
-                    delete metaData;
-                    return false;
-                }
-                metaData->addEnumInfo(optName, optVariant);
-                _originalOptNames[factName]  << optName;
-                _originalOptValues[factName] << optVariant;
-                //-- Check for exclusions
-                QStringList exclusions = _loadExclusions(option);
-                if(exclusions.size()) {
-                    qCDebug(CameraControlVerboseLog) << "New exclusions:" << factName << optValue << exclusions;
-                    QGCCameraOptionExclusion* pExc = new QGCCameraOptionExclusion(this, factName, optValue, exclusions);
-                    QQmlEngine::setObjectOwnership(pExc, QQmlEngine::CppOwnership);
-                    _valueExclusions.append(pExc);
-                }
-                //-- Check for range rules
-                if(!_loadRanges(option, factName, optValue)) {
-                    delete metaData;
-                    return false;
-                }
+        for(const QGCCameraDefinition::Option_t& option: parameter.options) {
+            QVariant optVariant;
+            QString  errorString;
+            if (!metaData->convertAndValidateRaw(option.value, false, optVariant, errorString)) {
+                qWarning() << "Invalid option value, name:" << factName
+                           << " type:"  << metaData->type()
+                           << " value:" << option.value
+                           << " error:" << errorString;
+            }
+            metaData->addEnumInfo(option.name, optVariant);
+            _originalOptNames[factName]  << option.name;
+            _originalOptValues[factName] << optVariant;
+            //-- Check for exclusions
+            if(option.exclusions.size()) {
+                qCDebug(CameraControlVerboseLog) << "New exclusions:" << factName << option.value << option.exclusions;
+                QGCCameraOptionExclusion* pExc = new QGCCameraOptionExclusion(this, factName, option.value, option.exclusions);
+                QQmlEngine::setObjectOwnership(pExc, QQmlEngine::CppOwnership);
+                _valueExclusions.append(pExc);
+            }
+            //-- Check for range rules
+            for(const QGCCameraDefinition::ParameterRange_t& range: option.ranges) {
+                QGCCameraOptionRange* pRange = new QGCCameraOptionRange(this, factName, option.value, range.targetParam, range.condition, range.optNames, range.optValues);
+                _optionRanges.append(pRange);
+                qCDebug(CameraControlVerboseLog) << "New range limit:" << factName << option.value << range.targetParam << range.condition << range.optNames << range.optValues;
             }
         }
-        QString defaultValue;
-        if(read_attribute(parameterNode, kDefault, defaultValue)) {
+        if(!parameter.defaultValue.isEmpty()) {
             QVariant defaultVariant;
             QString  errorString;
-            if (metaData->convertAndValidateRaw(defaultValue, false, defaultVariant, errorString)) {
+            if (metaData->convertAndValidateRaw(parameter.defaultValue, false, defaultVariant, errorString)) {
                 metaData->setRawDefaultValue(defaultVariant);
             } else {
                 qWarning() << "Invalid default value for" << factName
                            << " type:"  << metaData->type()
-                           << " value:" << defaultValue
+                           << " value:" << parameter.defaultValue
                            << " error:" << errorString;
             }
         }
@@ -966,76 +856,71 @@ VehicleCameraControl::_loadSettings(const QDomNodeList nodeList)
         } else {
             {
                 //-- Check for Min Value
-                QString attr;
-                if(read_attribute(parameterNode, kMin, attr)) {
+                if(!parameter.min.isEmpty()) {
                     QVariant typedValue;
                     QString  errorString;
-                    if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
+                    if (metaData->convertAndValidateRaw(parameter.min, true /* convertOnly */, typedValue, errorString)) {
                         metaData->setRawMin(typedValue);
                     } else {
                         qWarning() << "Invalid min value for" << factName
                                    << " type:"  << metaData->type()
-                                   << " value:" << attr
+                                   << " value:" << parameter.min
                                    << " error:" << errorString;
                     }
                 }
             }
             {
                 //-- Check for Max Value
-                QString attr;
-                if(read_attribute(parameterNode, kMax, attr)) {
+                if(!parameter.max.isEmpty()) {
                     QVariant typedValue;
                     QString  errorString;
-                    if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
+                    if (metaData->convertAndValidateRaw(parameter.max, true /* convertOnly */, typedValue, errorString)) {
                         metaData->setRawMax(typedValue);
                     } else {
                         qWarning() << "Invalid max value for" << factName
                                    << " type:"  << metaData->type()
-                                   << " value:" << attr
+                                   << " value:" << parameter.max
                                    << " error:" << errorString;
                     }
                 }
             }
             {
                 //-- Check for Step Value
-                QString attr;
-                if(read_attribute(parameterNode, kStep, attr)) {
+                if(!parameter.step.isEmpty()) {
                     QVariant typedValue;
                     QString  errorString;
-                    if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
+                    if (metaData->convertAndValidateRaw(parameter.step, true /* convertOnly */, typedValue, errorString)) {
                         metaData->setRawIncrement(typedValue.toDouble());
                     } else {
                         qWarning() << "Invalid step value for" << factName
                                    << " type:"  << metaData->type()
-                                   << " value:" << attr
+                                   << " value:" << parameter.step
                                    << " error:" << errorString;
                     }
                 }
             }
             {
                 //-- Check for Decimal Places
-                QString attr;
-                if(read_attribute(parameterNode, kDecimalPlaces, attr)) {
+                if(!parameter.decimalPlaces.isEmpty()) {
                     QVariant typedValue;
                     QString  errorString;
-                    if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
+                    if (metaData->convertAndValidateRaw(parameter.decimalPlaces, true /* convertOnly */, typedValue, errorString)) {
                         metaData->setDecimalPlaces(typedValue.toInt());
                     } else {
                         qWarning() << "Invalid decimal places value for" << factName
                                    << " type:"  << metaData->type()
-                                   << " value:" << attr
+                                   << " value:" << parameter.decimalPlaces
                                    << " error:" << errorString;
                     }
                 }
             }
             {
                 //-- Check for Units
-                QString attr;
-                if(read_attribute(parameterNode, kUnit, attr)) {
-                    metaData->setRawUnits(attr);
+                if(!parameter.unit.isEmpty()) {
+                    metaData->setRawUnits(parameter.unit);
                 }
             }
-            qCDebug(CameraControlLog) << "New parameter:" << factName << (readOnly ? "ReadOnly" : "Writable") << (writeOnly ? "WriteOnly" : "Readable");
+            qCDebug(CameraControlLog) << "New parameter:" << factName << (parameter.readOnly ? "ReadOnly" : "Writable") << (parameter.writeOnly ? "WriteOnly" : "Readable");
             _nameToFactMetaDataMap[factName] = metaData;
             Fact* pFact = new Fact(_compID, factName, factType, this);
             QQmlEngine::setObjectOwnership(pFact, QQmlEngine::CppOwnership);
@@ -1057,90 +942,6 @@ VehicleCameraControl::_loadSettings(const QDomNodeList nodeList)
     return false;
 }
 
-//-----------------------------------------------------------------------------
-bool
-VehicleCameraControl::_handleLocalization(QByteArray& bytes)
-{
-    QString errorMsg;
-    int errorLine;
-    QDomDocument doc;
-    if(!doc.setContent(bytes, false, &errorMsg, &errorLine)) {
-        qCritical() << "Unable to parse camera definition file on line:" << errorLine;
-        qCritical() << errorMsg;
-        return false;
-    }
-    //-- Find out where we are
-    QLocale locale = QLocale::system();
-#if defined (Q_OS_MAC)
-    locale = QLocale(locale.name());
-#endif
-    QString localeName = locale.name().toLower().replace("-", "_");
-    qCDebug(CameraControlLog) << "Current locale:" << localeName;
-    if(localeName == "en_us") {
-        // Nothing to do
-        return true;
-    }
-    QDomNodeList locRoot = doc.elementsByTagName(kLocalization);
-    if(!locRoot.size()) {
-        // Nothing to do
-        return true;
-    }
-    //-- Iterate locales
-    QDomNode node = locRoot.item(0);
-    QDomElement elem = node.toElement();
-    QDomNodeList locales = elem.elementsByTagName(kLocale);
-    for(int i = 0; i < locales.size(); i++) {
-        QDomNode locale = locales.item(i);
-        QString name;
-        if(!read_attribute(locale, kName, name)) {
-            qWarning() << "Localization entry is missing its name attribute";
-            continue;
-        }
-        // If we found a direct match, deal with it now
-        if(localeName == name.toLower().replace("-", "_")) {
-            return _replaceLocaleStrings(locale, bytes);
-        }
-    }
-    //-- No direct match. Pick first matching language (if any)
-    localeName = localeName.left(3);
-    for(int i = 0; i < locales.size(); i++) {
-        QDomNode locale = locales.item(i);
-        QString name;
-        read_attribute(locale, kName, name);
-        if(name.toLower().startsWith(localeName)) {
-            return _replaceLocaleStrings(locale, bytes);
-        }
-    }
-    //-- Could not find a language to use
-    qWarning() <<  "No match for" << QLocale::system().name() << "in camera definition file";
-    //-- Just use default, en_US
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-bool
-VehicleCameraControl::_replaceLocaleStrings(const QDomNode node, QByteArray& bytes)
-{
-    QDomElement stringElem = node.toElement();
-    QDomNodeList strings = stringElem.elementsByTagName(kStrings);
-    for(int i = 0; i < strings.size(); i++) {
-        QDomNode stringNode = strings.item(i);
-        QString original;
-        QString translated;
-        if(read_attribute(stringNode, kOriginal, original)) {
-            if(read_attribute(stringNode, kTranslated, translated)) {
-                QString o; o = "\"" + original + "\"";
-                QString t; t = "\"" + translated + "\"";
-                bytes.replace(o.toUtf8(), t.toUtf8());
-                o = ">" + original + "<";
-                t = ">" + translated + "<";
-                bytes.replace(o.toUtf8(), t.toUtf8());
-            }
-        }
-    }
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 void
 VehicleCameraControl::_requestAllParameters()
@@ -1882,100 +1683,6 @@ VehicleCameraControl::_streamStatusTimeout()
     }
 }
 
-//-----------------------------------------------------------------------------
-QStringList
-VehicleCameraControl::_loadExclusions(QDomNode option)
-{
-    QStringList exclusionList;
-    QDomElement optionElem = option.toElement();
-    QDomNodeList excRoot = optionElem.elementsByTagName(kExclusions);
-    if(excRoot.size()) {
-        //-- Iterate exclusions
-        QDomNode node = excRoot.item(0);
-        QDomElement elem = node.toElement();
-        QDomNodeList exclusions = elem.elementsByTagName(kExclusion);
-        for(int i = 0; i < exclusions.size(); i++) {
-            QString exclude = exclusions.item(i).toElement().text();
-            if(!exclude.isEmpty()) {
-                exclusionList << exclude;
-            }
-        }
-    }
-    return exclusionList;
-}
-
-//-----------------------------------------------------------------------------
-QStringList
-VehicleCameraControl::_loadUpdates(QDomNode option)
-{
-    QStringList updateList;
-    QDomElement optionElem = option.toElement();
-    QDomNodeList updateRoot = optionElem.elementsByTagName(kUpdates);
-    if(updateRoot.size()) {
-        //-- Iterate updates
-        QDomNode node = updateRoot.item(0);
-        QDomElement elem = node.toElement();
-        QDomNodeList updates = elem.elementsByTagName(kUpdate);
-        for(int i = 0; i < updates.size(); i++) {
-            QString update = updates.item(i).toElement().text();
-            if(!update.isEmpty()) {
-                updateList << update;
-            }
-        }
-    }
-    return updateList;
-}
-
-//-----------------------------------------------------------------------------
-bool
-VehicleCameraControl::_loadRanges(QDomNode option, const QString factName, QString paramValue)
-{
-    QDomElement optionElem = option.toElement();
-    QDomNodeList rangeRoot = optionElem.elementsByTagName(kParameterranges);
-    if(rangeRoot.size()) {
-        QDomNode node = rangeRoot.item(0);
-        QDomElement elem = node.toElement();
-        QDomNodeList parameterRanges = elem.elementsByTagName(kParameterrange);
-        //-- Iterate parameter ranges
-        for(int i = 0; i < parameterRanges.size(); i++) {
-            QString param;
-            QString condition;
-            QDomNode paramRange = parameterRanges.item(i);
-            if(!read_attribute(paramRange, kParameter, param)) {
-                qCritical() << QString("Malformed option range for parameter %1").arg(factName);
-                return false;
-            }
-            read_attribute(paramRange, kCondition, condition);
-            QDomElement pelem = paramRange.toElement();
-            QDomNodeList rangeOptions = pelem.elementsByTagName(kRoption);
-            QStringList  optNames;
-            QStringList  optValues;
-            //-- Iterate options
-            for(int i = 0; i < rangeOptions.size(); i++) {
-                QString optName;
-                QString optValue;
-                QDomNode roption = rangeOptions.item(i);
-                if(!read_attribute(roption, kName, optName)) {
-                    qCritical() << QString("Malformed roption for parameter %1").arg(factName);
-                    return false;
-                }
-                if(!read_attribute(roption, kValue, optValue)) {
-                    qCritical() << QString("Malformed rvalue for parameter %1").arg(factName);
-                    return false;
-                }
-                optNames  << optName;
-                optValues << optValue;
-            }
-            if(optNames.size()) {
-                QGCCameraOptionRange* pRange = new QGCCameraOptionRange(this, factName, paramValue, param, condition, optNames, optValues);
-                _optionRanges.append(pRange);
-                qCDebug(CameraControlVerboseLog) << "New range limit:" << factName << paramValue << param << condition << optNames << optValues;
-            }
-        }
-    }
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 void
 VehicleCameraControl::_processRanges()
@@ -2000,33 +1707,23 @@ VehicleCameraControl::_processRanges()
     }
 }
 
-//-----------------------------------------------------------------------------
-bool
-VehicleCameraControl::_loadNameValue(QDomNode option, const QString factName, FactMetaData* metaData, QString& optName, QString& optValue, QVariant& optVariant)
-{
-    if(!read_attribute(option, kName, optName)) {
-        qCritical() << QString("Malformed option for parameter %1").arg(factName);
-        return false;
-    }
-    if(!read_attribute(option, kValue, optValue)) {
-        qCritical() << QString("Malformed value for parameter %1").arg(factName);
-        return false;
-    }
-    QString  errorString;
-    if (!metaData->convertAndValidateRaw(optValue, false, optVariant, errorString)) {
-        qWarning() << "Invalid option value, name:" << factName
-                   << " type:"  << metaData->type()
-                   << " value:" << optValue
-                   << " error:" << errorString;
-    }
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 void
 VehicleCameraControl::_handleDefinitionFile(const QString &url)
 {
-    //-- First check and see if we have it cached
+    _definitionUri = url;
+    _definitionCacheKey = QGCCameraDefinition::cacheKey(url, static_cast<int>(_info.cam_definition_version), QGCCameraDefinition::currentLocaleName());
+    //-- Another camera (or an earlier connection of this one) may have already parsed it
+    const std::shared_ptr<const QGCCameraDefinition> definition = QGCCameraDefinition::cachedDefinition(_definitionCacheKey);
+    if(definition) {
+        qCDebug(CameraControlLog) << "Using parsed camera definition:" << url;
+        _cached = true;
+        _loadDefinition(*definition);
+        _initWhenReady();
+        return;
+    }
+
+    //-- Then check and see if we have it cached on disk
     QFile xmlFile(_cacheFile);
 
     QString ftpPrefix(QStringLiteral("%1://").arg(FTPManager::mavlinkFTPScheme));
@@ -2058,17 +1755,11 @@ VehicleCameraControl::_handleDefinitionFile(const QString &url)
         _httpRequest(url);
         return;
     }
-    QByteArray bytes = xmlFile.readAll();
-    QDomDocument doc;
-    if(!doc.setContent(bytes, false)) {
-        qWarning() << "Could not parse cached camera definition file:" << _cacheFile;
-        _httpRequest(url);
-        return;
-    }
-    //-- We have it
+    //-- We have it, if it fails to parse it is downloaded again
     qCDebug(CameraControlLog) << "Using cached camera definition file:" << _cacheFile;
     _cached = true;
-    emit dataReady(bytes);
+    _definitionFromDiskCache = true;
+    emit dataReady(xmlFile.readAll());
 }
 
 //-----------------------------------------------------------------------------
@@ -2124,31 +1815,25 @@ void VehicleCameraControl::_ftpDownloadComplete(const QString& fileName, const Q
 
     disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete, this, &VehicleCameraControl::_ftpDownloadComplete);
 
-    QString outputFileName = fileName;
-
-    if (fileName.endsWith(".lzma", Qt::CaseInsensitive) || fileName.endsWith(".xz", Qt::CaseInsensitive)) {
-        outputFileName = fileName.left(fileName.lastIndexOf("."));
-        if (QGCLZMA::inflateLZMAFile(fileName, outputFileName)) {
-            QFile(fileName).remove();
-        } else {
-            qCWarning(CameraControlLog) << "Inflate of compressed xml failed" << fileName;
-            outputFileName.clear();
-        }
-    }
-
-    QFile xmlFile(outputFileName);
-
-    if (!xmlFile.exists()) {
+    if (!QFile::exists(fileName)) {
         qCDebug(CameraControlLog) << "No camera definition file present after ftp download completed";
         return;
     }
-    if (!xmlFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not read downloaded camera definition file: " << fileName;
+
+    // Compressed definitions are decompressed in memory
+    QByteArray bytes;
+    QString errorString;
+    if (!QGCDecompressDevice::readFile(fileName, bytes, errorString)) {
+        qWarning() << "Could not read downloaded camera definition file: " << errorString;
         return;
     }
+    //-- An uncompressed download is already the cache file, a compressed one is cached once it parses
+    const bool compressed = fileName.endsWith(".lzma", Qt::CaseInsensitive) || fileName.endsWith(".xz", Qt::CaseInsensitive);
+    if (compressed) {
+        (void) QFile::remove(fileName);
+    }
 
-    _cached = true;
-    QByteArray bytes = xmlFile.readAll();
+    _cached = !compressed;
     emit dataReady(bytes);
 }
 
@@ -2158,15 +1843,17 @@ VehicleCameraControl::_dataReady(QByteArray data)
 {
     if(data.size()) {
         qCDebug(CameraControlLog) << "Parsing camera definition";
-        _loadCameraDefinitionFile(data);
+        _parseDefinitionFile(data, true /* cacheParsed */);
+        return;
     } else {
         qCDebug(CameraControlLog) << "No camera definition received, trying to search on our own...";
         QFile definitionFile;
         if(qgcApp()->toolbox()->corePlugin()->getOfflineCameraDefinitionFile(_modelName, definitionFile)) {
             qCDebug(CameraControlLog) << "Found offline definition file for: " << _modelName << ", loading: " << definitionFile.fileName();
             if (definitionFile.open(QIODevice::ReadOnly)) {
-                QByteArray newData = definitionFile.readAll();
-                _loadCameraDefinitionFile(newData);
+                //-- Not kept in the parsed cache so a later connection still tries the camera's own definition
+                _parseDefinitionFile(definitionFile.readAll(), false /* cacheParsed */);
+                return;
             } else {
                 qCDebug(CameraControlLog) << "error opening offline definition file for: " << _modelName;
             }
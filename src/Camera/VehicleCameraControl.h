@@ -12,9 +12,12 @@
 #include "MavlinkCameraControl.h"
 #include "QmlObjectListModel.h"
 
+#include <QtCore/QFutureWatcher>
+
+#include <memory>
+
 class QNetworkAccessManager;
-class QDomNode;
-class QDomNodeList;
+class QGCCameraDefinition;
 
 //-----------------------------------------------------------------------------
 /// Camera option exclusions
@@ -228,6 +231,7 @@ protected slots:
     virtual void    _downloadFinished       ();
     virtual void    _mavCommandResult       (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
     virtual void    _dataReady              (QByteArray data);
+    virtual void    _definitionParsed       ();
     virtual void    _paramDone              ();
     virtual void    _streamInfoTimeout      ();
     virtual void    _streamStatusTimeout    ();
@@ -235,24 +239,17 @@ protected slots:
     virtual void    _checkForVideoStreams   ();
 
 private:
-    bool    _handleLocalization             (QByteArray& bytes);
-    bool    _replaceLocaleStrings           (const QDomNode node, QByteArray& bytes);
-    bool    _loadCameraDefinitionFile       (QByteArray& bytes);
-    bool    _loadConstants                  (const QDomNodeList nodeList);
-    bool    _loadSettings                   (const QDomNodeList nodeList);
+    void    _parseDefinitionFile            (const QByteArray& bytes, bool cacheParsed);
+    bool    _loadDefinition                 (const QGCCameraDefinition& definition);
     void    _processRanges                  ();
     bool    _processCondition               (const QString condition);
     bool    _processConditionTest           (const QString conditionTest);
-    bool    _loadNameValue                  (QDomNode option, const QString factName, FactMetaData* metaData, QString& optName, QString& optValue, QVariant& optVariant);
-    bool    _loadRanges                     (QDomNode option, const QString factName, QString paramValue);
     void    _updateActiveList               ();
     void    _updateRanges                   (Fact* pFact);
     void    _httpRequest                    (const QString& url);
     void    _handleDefinitionFile           (const QString& url);
     void    _ftpDownloadComplete            (const QString& fileName, const QString& errorMsg);
 
-    QStringList     _loadExclusions         (QDomNode option);
-    QStringList     _loadUpdates            (QDomNode option);
     QString         _getParamName           (const char* param_id);
 
 protected:
@@ -271,6 +268,10 @@ protected:
     QString                             _modelName;
     QString                             _vendor;
     QString                             _cacheFile;
+    QString                             _definitionUri;
+    QString                             _definitionCacheKey;
+    bool                                _definitionFromDiskCache = false;
+    QFutureWatcher<std::shared_ptr<const QGCCameraDefinition>> _definitionWatcher;
     CameraMode                          _cameraMode         = CAM_MODE_UNDEFINED;
     StorageStatus                       _storageStatus      = STORAGE_NOT_SUPPORTED;
     PhotoCaptureMode                    _photoMode          = PHOTO_CAPTURE_SINGLE;
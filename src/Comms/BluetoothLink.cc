@@ -48,9 +48,7 @@ void BluetoothLink::run()
 void BluetoothLink::_writeBytes(const QByteArray &bytes)
 {
     if (_targetSocket) {
-        if(_targetSocket->write(bytes) > 0) {
-            emit bytesSent(this, bytes);
-        } else {
+        if(_targetSocket->write(bytes) <= 0) {
             qWarning() << "Bluetooth write error";
         }
     }
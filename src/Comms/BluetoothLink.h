@@ -143,6 +143,7 @@ private:
 
     // LinkInterface overrides
     bool _connect(void) override;
+    bool _logSentBytes(void) const override { return true; }
 
     bool _hardwareConnect   (void);
     void _createSocket      (void);
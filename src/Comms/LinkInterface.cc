@@ -19,6 +19,7 @@
 #include "MockLink.h"
 #endif
 
+#include <QtCore/QMetaMethod>
 #include <QtQml/QQmlEngine>
 
 QGC_LOGGING_CATEGORY(LinkInterfaceLog, "LinkInterfaceLog")
@@ -28,6 +29,8 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPtr &config, QObject *parent
     , _config(config)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+
+    _transmitDropTimer.start();
 }
 
 LinkInterface::~LinkInterface()
@@ -109,10 +112,83 @@ void LinkInterface::_freeMavlinkChannel()
     _mavlinkChannel = LinkManager::invalidMavlinkChannel();
 }
 
-void LinkInterface::writeBytesThreadSafe(const char *bytes, int length)
+void LinkInterface::writeBytesThreadSafe(const char *bytes, int length, LinkTransmitQueue::Priority priority, bool resequence)
+{
+    if (!_transmitQueue.enqueue(priority, bytes, length, resequence)) {
+        _warnTransmitDrop(priority);
+        return;
+    }
+
+    // Only the first packet since the last drain posts to the link thread
+    if (!_transmitDrainScheduled.exchange(true)) {
+        (void) QMetaObject::invokeMethod(this, &LinkInterface::_drainTransmitQueue, Qt::QueuedConnection);
+    }
+}
+
+void LinkInterface::_drainTransmitQueue()
+{
+    _transmitDrainScheduled = false;
+
+    // Packets are counted and logged one by one since the log format expects a single packet per entry
+    const bool logPackets = _logSentBytes() && isSignalConnected(QMetaMethod::fromSignal(&LinkInterface::bytesSent));
+    const auto packetCallback = [this, logPackets](char *bytes, int length, bool resequence) {
+        // The lanes reorder packets, so sequence numbers and signing timestamps are only handed out now. The
+        // vehicle would otherwise count the gaps as lost packets and drop older signatures as replays.
+        if (resequence && mavlinkChannelIsSet() && LinkTransmitQueue::resequencePacket(bytes, length, _transmitSequence, _mavlinkChannel)) {
+            _transmitSequence++;
+        }
+        _statistics.countSentPacket(bytes, length);
+        if (logPackets) {
+            emit bytesSent(this, QByteArray(bytes, length));
+        }
+    };
+
+    for (;;) {
+        QByteArray buffer;
+        buffer.reserve(kMaxCoalescedBytes);
+        if (_transmitQueue.dequeue(buffer, kMaxCoalescedBytes, packetCallback) == 0) {
+            break;
+        }
+        _writeBytes(buffer);
+    }
+}
+
+/// Drops are counted in the queue stats. The warning goes out at most once per interval so a stalled link can't
+/// flood the log from every sending thread.
+void LinkInterface::_warnTransmitDrop(LinkTransmitQueue::Priority priority)
 {
-    const QByteArray data(bytes, length);
-    (void) QMetaObject::invokeMethod(this, "_writeBytes", Qt::AutoConnection, data);
+    const qint64 nowMsecs = _transmitDropTimer.elapsed();
+    qint64 lastMsecs = _transmitDropWarningMsecs.load(std::memory_order_relaxed);
+    if ((nowMsecs - lastMsecs) < kTransmitDropWarningIntervalMsecs) {
+        return;
+    }
+    if (!_transmitDropWarningMsecs.compare_exchange_strong(lastMsecs, nowMsecs, std::memory_order_relaxed)) {
+        return;
+    }
+
+    qCWarning(LinkInterfaceLog) << "transmit queue full, dropping packets priority:total dropped" << priority << _transmitQueue.stats(priority).dropped;
+}
+
+QVariantList LinkInterface::transmitQueueStats() const
+{
+    static const QStringList priorityNames = { QStringLiteral("control"), QStringLiteral("command"), QStringLiteral("bulk") };
+
+    QVariantList result;
+    for (int priority = 0; priority < LinkTransmitQueue::PriorityCount; priority++) {
+        const LinkTransmitQueue::Stats_t stats = _transmitQueue.stats(static_cast<LinkTransmitQueue::Priority>(priority));
+
+        QVariantMap map;
+        map[QStringLiteral("priority")] = priorityNames[priority];
+        map[QStringLiteral("depth")] = stats.depth;
+        map[QStringLiteral("maxDepth")] = stats.maxDepth;
+        map[QStringLiteral("sent")] = stats.sent;
+        map[QStringLiteral("dropped")] = stats.dropped;
+        map[QStringLiteral("meanLatencyUs")] = stats.meanLatencyUs;
+        map[QStringLiteral("maxLatencyUs")] = stats.maxLatencyUs;
+        result.append(map);
+    }
+
+    return result;
 }
 
 void LinkInterface::removeVehicleReference()
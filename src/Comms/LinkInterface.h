@@ -9,10 +9,16 @@
 
 #pragma once
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QThread>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QVariantMap>
 
 #include "LinkConfiguration.h"
+#include "LinkStatistics.h"
+#include "LinkTransmitQueue.h"
+
+#include <atomic>
 
 class LinkManager;
 
@@ -23,6 +29,8 @@ class LinkInterface : public QThread
 {
     Q_OBJECT
 
+    Q_PROPERTY(LinkStatistics *statistics READ statistics CONSTANT)
+
     friend class LinkManager;
 
 public:
@@ -40,12 +48,23 @@ public:
     bool mavlinkChannelIsSet() const;
     bool decodedFirstMavlinkPacket(void) const { return _decodedFirstMavlinkPacket; }
     void setDecodedFirstMavlinkPacket(bool decodedFirstMavlinkPacket) { _decodedFirstMavlinkPacket = decodedFirstMavlinkPacket; }
-    void writeBytesThreadSafe(const char *bytes, int length);
+    /// Queues bytes for transmission on the link thread. Queued packets are written in priority order.
+    ///     @param resequence true: bytes are a MAVLink packet packed by this application on mavlinkChannel(). Its
+    ///                       sequence number and signature are replaced when it is written, so they stay in order.
+    void writeBytesThreadSafe(const char *bytes, int length, LinkTransmitQueue::Priority priority = LinkTransmitQueue::PriorityBulk, bool resequence = false);
     void addVehicleReference() { ++_vehicleReferenceCount; }
     void removeVehicleReference();
     bool initMavlinkSigning();
     void setSigningSignatureFailure(bool failure);
 
+    LinkTransmitQueue::Stats_t transmitQueueStats(LinkTransmitQueue::Priority priority) const { return _transmitQueue.stats(priority); }
+
+    /// @return Transmit queue depth and latency stats per priority, for display/debugging
+    Q_INVOKABLE QVariantList transmitQueueStats() const;
+
+    /// Traffic counters, the counting methods are thread safe
+    LinkStatistics *statistics() { return &_statistics; }
+
 signals:
     void bytesReceived(LinkInterface *link, const QByteArray &data);
     void bytesSent(LinkInterface *link, const QByteArray &data);
@@ -65,12 +84,20 @@ protected:
 
     void _connectionRemoved();
 
+    /// @return true: bytesSent is emitted for every packet written, for the telemetry log
+    virtual bool _logSentBytes() const { return false; }
+
     SharedLinkConfigurationPtr _config;
 
 private slots:
     /// Not thread safe if called directly, only writeBytesThreadSafe is thread safe
     virtual void _writeBytes(const QByteArray &bytes) = 0;
 
+    /// Drains the transmit queue into as few _writeBytes calls as possible
+    void _drainTransmitQueue();
+
+    void _warnTransmitDrop(LinkTransmitQueue::Priority priority);
+
 private:
     /// connect is private since all links should be created through LinkManager::createConnectedLink calls
     virtual bool _connect() = 0;
@@ -79,6 +106,16 @@ private:
     bool _decodedFirstMavlinkPacket = false;
     int _vehicleReferenceCount = 0;
     bool _signingSignatureFailure = false;
+
+    LinkTransmitQueue _transmitQueue;
+    LinkStatistics _statistics;
+    std::atomic_bool _transmitDrainScheduled = false;   ///< true: _drainTransmitQueue is already posted to the link thread
+    uint8_t _transmitSequence = 0;                      ///< Sequence number of the next resequenced packet
+    QElapsedTimer _transmitDropTimer;
+    std::atomic<qint64> _transmitDropWarningMsecs = -kTransmitDropWarningIntervalMsecs; ///< _transmitDropTimer time of the last drop warning
+
+    static constexpr int kMaxCoalescedBytes = 1400;     ///< Keeps coalesced UDP datagrams below the typical MTU
+    static constexpr qint64 kTransmitDropWarningIntervalMsecs = 1000;
 };
 
 typedef std::shared_ptr<LinkInterface> SharedLinkInterfacePtr;
@@ -47,6 +47,10 @@
 #include <qmdnsengine/service.h>
 #endif
 
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTextStream>
 #include <QtCore/QTimer>
 #include <QtQml/qqml.h>
 
@@ -56,6 +60,7 @@ QGC_LOGGING_CATEGORY(LinkManagerVerboseLog, "qgc.comms.linkmanager:verbose")
 LinkManager::LinkManager(QGCApplication *app, QGCToolbox *toolbox)
     : QGCTool(app, toolbox)
     , _portListTimer(new QTimer(this))
+    , _linkStatisticsTimer(new QTimer(this))
     , _qmlConfigurations(new QmlObjectListModel(this))
 #ifndef NO_SERIAL_LINK
     , _nmeaSocket(new UdpIODevice(this))
@@ -66,6 +71,7 @@ LinkManager::LinkManager(QGCApplication *app, QGCToolbox *toolbox)
     (void) qmlRegisterUncreatableType<LinkManager>("QGroundControl",       1, 0, "LinkManager",         "Reference only");
     (void) qmlRegisterUncreatableType<LinkConfiguration>("QGroundControl", 1, 0, "LinkConfiguration",   "Reference only");
     (void) qmlRegisterUncreatableType<LinkInterface>("QGroundControl",     1, 0, "LinkInterface",       "Reference only");
+    (void) qmlRegisterUncreatableType<LinkStatistics>("QGroundControl",    1, 0, "LinkStatistics",      "Reference only");
 
     (void) qmlRegisterUncreatableType<LinkInterface>("QGroundControl.Vehicle", 1, 0, "LinkInterface", "Reference only");
     (void) qmlRegisterUncreatableType<LogReplayLink>("QGroundControl",         1, 0, "LogReplayLink", "Reference only");
@@ -94,6 +100,60 @@ void LinkManager::setToolbox(QGCToolbox *toolbox)
         (void) connect(_portListTimer, &QTimer::timeout, this, &LinkManager::_updateAutoConnectLinks);
         _portListTimer->start(_autoconnectUpdateTimerMSecs); // timeout must be long enough to get past bootloader on second pass
     }
+
+    (void) connect(_linkStatisticsTimer, &QTimer::timeout, this, &LinkManager::_updateLinkStatistics);
+    _linkStatisticsTimer->start(_linkStatisticsUpdateMSecs);
+}
+
+void LinkManager::_updateLinkStatistics()
+{
+    for (SharedLinkInterfacePtr &link : _rgLinks) {
+        link->statistics()->update();
+    }
+}
+
+bool LinkManager::saveLinkStatistics(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(LinkManagerLog) << "Unable to save link statistics" << fileName << file.errorString();
+        return false;
+    }
+
+    if (fileName.endsWith(QStringLiteral(".csv"), Qt::CaseInsensitive)) {
+        QTextStream stream(&file);
+        stream << "link,msgid,name,received,sent,receivedRate,sentRate,bytesReceivedRate,bytesSentRate\n";
+        for (const SharedLinkInterfacePtr &link : _rgLinks) {
+            const QString linkName = link->linkConfiguration()->name();
+            LinkStatistics *statistics = link->statistics();
+            stream << linkName << ",,total,,," << statistics->messagesReceivedRate() << "," << statistics->messagesSentRate() << ","
+                   << statistics->bytesReceivedRate() << "," << statistics->bytesSentRate() << "\n";
+            for (const QVariant &messageStat : statistics->messageStats()) {
+                const QVariantMap map = messageStat.toMap();
+                stream << linkName << "," << map[QStringLiteral("msgid")].toUInt() << "," << map[QStringLiteral("name")].toString() << ","
+                       << map[QStringLiteral("received")].toULongLong() << "," << map[QStringLiteral("sent")].toULongLong() << ","
+                       << map[QStringLiteral("receivedRate")].toDouble() << "," << map[QStringLiteral("sentRate")].toDouble() << ","
+                       << map[QStringLiteral("bytesReceivedRate")].toDouble() << "," << map[QStringLiteral("bytesSentRate")].toDouble() << "\n";
+            }
+        }
+        stream.flush();
+    } else {
+        QJsonArray links;
+        for (const SharedLinkInterfacePtr &link : _rgLinks) {
+            QJsonObject json = link->statistics()->toJson();
+            json[QStringLiteral("name")] = link->linkConfiguration()->name();
+            json[QStringLiteral("transmitQueues")] = QJsonArray::fromVariantList(link->transmitQueueStats());
+            links.append(json);
+        }
+        (void) file.write(QJsonDocument(links).toJson());
+    }
+
+    if (!file.commit()) {
+        qCWarning(LinkManagerLog) << "Unable to save link statistics" << fileName << file.errorString();
+        return false;
+    }
+
+    return true;
 }
 
 QmlObjectListModel *LinkManager::_qmlLinkConfigurations()
@@ -68,6 +68,8 @@ public:
     /// Called to signal app shutdown. Disconnects all links while turning off auto-connect.
     Q_INVOKABLE void shutdown();
     Q_INVOKABLE LogReplayLink *startLogReplay(const QString &logFile);
+    /// Writes the traffic statistics of all links to a file, as CSV if the file name ends in .csv otherwise as JSON
+    Q_INVOKABLE bool saveLinkStatistics(const QString &fileName) const;
 
     QList<SharedLinkInterfacePtr> links() { return _rgLinks; }
     QStringList linkTypeStrings() const;
@@ -127,6 +129,7 @@ signals:
 
 private slots:
     void _linkDisconnected();
+    void _updateLinkStatistics();
 
 private:
     QmlObjectListModel *_qmlLinkConfigurations();
@@ -151,6 +154,7 @@ private:
     AutoConnectSettings *_autoConnectSettings = nullptr;
     MAVLinkProtocol *_mavlinkProtocol = nullptr;
     QTimer *_portListTimer = nullptr;
+    QTimer *_linkStatisticsTimer = nullptr;
     QmlObjectListModel *_qmlConfigurations = nullptr;
 
     QList<SharedLinkInterfacePtr> _rgLinks;
@@ -161,6 +165,7 @@ private:
     static constexpr const char* _mavlinkForwardingSupportLinkName = "MAVLink Support Forwarding Link";
 
     static constexpr int _autoconnectUpdateTimerMSecs = 1000;
+    static constexpr int _linkStatisticsUpdateMSecs = 1000;
 #ifdef Q_OS_WIN
     // Have to manually let the bootloader go by on Windows to get a working connect
     static constexpr int _autoconnectConnectDelayMSecs = 6000;
@@ -0,0 +1,313 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkStatistics.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QtEndian>
+#include <QtCore/QtNumeric>
+#include <QtCore/QVariantMap>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr quint64 kPingKeyMultiplier = 0x9E3779B97F4A7C15ull;
+
+    quint64 pingKey(quint64 timeUSecs, uint32_t seq)
+    {
+        return timeUSecs ^ (seq * kPingKeyMultiplier);
+    }
+
+    const char *roundTripName(LinkStatistics::RoundTripSource source)
+    {
+        switch (source) {
+        case LinkStatistics::RoundTripPing:
+            return "ping";
+        case LinkStatistics::RoundTripTimesync:
+            return "timesync";
+        default:
+            return "commandAck";
+        }
+    }
+}
+
+LinkStatistics::LinkStatistics(QObject *parent)
+    : QObject(parent)
+{
+    // std::atomic is not initialized by its default constructor prior to C++20
+    for (std::atomic<uint32_t> &next : _nextPendingRequest) {
+        next.store(0, std::memory_order_relaxed);
+    }
+
+    _clock.start();
+}
+
+LinkStatistics::~LinkStatistics()
+{
+
+}
+
+void LinkStatistics::countReceivedMessage(const mavlink_message_t &message)
+{
+    int length = message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        length = message.len + MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + MAVLINK_NUM_CHECKSUM_BYTES;
+    } else if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        length += MAVLINK_SIGNATURE_BLOCK_LEN;
+    }
+    _countMessage(Received, message.msgid, length);
+
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_TIMESYNC: {
+        mavlink_timesync_t timesync;
+        mavlink_msg_timesync_decode(&message, &timesync);
+        if (timesync.tc1 != 0) {
+            _matchPendingRequest(RoundTripTimesync, static_cast<quint64>(timesync.ts1));
+        }
+        break;
+    }
+    case MAVLINK_MSG_ID_PING: {
+        mavlink_ping_t ping;
+        mavlink_msg_ping_decode(&message, &ping);
+        if ((ping.target_system != 0) || (ping.target_component != 0)) {
+            _matchPendingRequest(RoundTripPing, pingKey(ping.time_usec, ping.seq));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void LinkStatistics::countSentPacket(const char *bytes, int length)
+{
+    (void) _directions[Sent].bytes.fetch_add(static_cast<quint64>(length), std::memory_order_relaxed);
+
+    const uint8_t *packet = reinterpret_cast<const uint8_t*>(bytes);
+    uint32_t msgid;
+    int headerLength;
+    if ((length >= (MAVLINK_CORE_HEADER_LEN + 1)) && (packet[0] == MAVLINK_STX)) {
+        msgid = packet[7] | (packet[8] << 8) | (packet[9] << 16);
+        headerLength = MAVLINK_CORE_HEADER_LEN + 1;
+    } else if ((length >= (MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1)) && (packet[0] == MAVLINK_STX_MAVLINK1)) {
+        msgid = packet[5];
+        headerLength = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+    } else {
+        return;
+    }
+    const int payloadLength = packet[1];
+    if ((headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES) > length) {
+        return;
+    }
+
+    _countMessage(Sent, msgid, length);
+
+    if ((msgid != MAVLINK_MSG_ID_TIMESYNC) && (msgid != MAVLINK_MSG_ID_PING)) {
+        return;
+    }
+
+    // MAVLink 2 truncates trailing zero bytes from the payload
+    uint8_t payload[MAVLINK_MAX_PAYLOAD_LEN] = {};
+    (void) memcpy(payload, packet + headerLength, static_cast<size_t>(payloadLength));
+
+    if (msgid == MAVLINK_MSG_ID_TIMESYNC) {
+        // tc1 == 0 marks a request, the reply echoes ts1
+        const int64_t tc1 = qFromLittleEndian<int64_t>(payload);
+        const int64_t ts1 = qFromLittleEndian<int64_t>(payload + 8);
+        if (tc1 == 0) {
+            _addPendingRequest(RoundTripTimesync, static_cast<quint64>(ts1));
+        }
+    } else {
+        // A ping request targets all systems, the reply echoes time_usec and seq
+        const quint64 timeUSecs = qFromLittleEndian<quint64>(payload);
+        const uint32_t seq = qFromLittleEndian<uint32_t>(payload + 8);
+        if ((payload[12] == 0) && (payload[13] == 0)) {
+            _addPendingRequest(RoundTripPing, pingKey(timeUSecs, seq));
+        }
+    }
+}
+
+void LinkStatistics::countRoundTrip(RoundTripSource source, qint64 usecs)
+{
+    RoundTripCounters_t &counters = _roundTrips[source];
+
+    (void) counters.sumUSecs.fetch_add(usecs, std::memory_order_relaxed);
+    counters.lastUSecs.store(usecs, std::memory_order_relaxed);
+    qint64 maxUSecs = counters.maxUSecs.load(std::memory_order_relaxed);
+    while ((usecs > maxUSecs) && !counters.maxUSecs.compare_exchange_weak(maxUSecs, usecs, std::memory_order_relaxed)) {}
+    (void) counters.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Open addressing hash table which only ever grows. A slot is claimed by swapping its msgid in, after that the slot
+/// belongs to that msgid for the lifetime of the link.
+void LinkStatistics::_countMessage(Direction direction, uint32_t msgid, int length)
+{
+    DirectionCounters_t &counters = _directions[direction];
+
+    (void) counters.messages.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t index = (msgid * 2654435761u) & (kMessageSlots - 1);
+    for (int probe = 0; probe < kMessageSlots; probe++) {
+        MessageCounters_t &slot = counters.perMessage[index];
+        uint32_t slotMsgId = slot.msgid.load(std::memory_order_relaxed);
+        if ((slotMsgId == kEmptyMsgId) && slot.msgid.compare_exchange_strong(slotMsgId, msgid, std::memory_order_relaxed)) {
+            slotMsgId = msgid;
+        }
+        if (slotMsgId == msgid) {
+            (void) slot.count.fetch_add(1, std::memory_order_relaxed);
+            (void) slot.bytes.fetch_add(static_cast<quint64>(length), std::memory_order_relaxed);
+            return;
+        }
+        index = (index + 1) & (kMessageSlots - 1);
+    }
+}
+
+void LinkStatistics::_addPendingRequest(RoundTripSource source, quint64 key)
+{
+    if (key == 0) {
+        return;
+    }
+
+    PendingRequest_t &request = _pendingRequests[source][_nextPendingRequest[source].fetch_add(1, std::memory_order_relaxed) % kPendingRequests];
+    request.sentNSecs.store(_clock.nsecsElapsed(), std::memory_order_relaxed);
+    request.key.store(key, std::memory_order_release);
+}
+
+void LinkStatistics::_matchPendingRequest(RoundTripSource source, quint64 key)
+{
+    if (key == 0) {
+        return;
+    }
+
+    for (PendingRequest_t &request : _pendingRequests[source]) {
+        quint64 expected = key;
+        // Clearing the key first makes sure duplicated replies are only counted once
+        if (request.key.compare_exchange_strong(expected, 0, std::memory_order_acquire)) {
+            countRoundTrip(source, (_clock.nsecsElapsed() - request.sentNSecs.load(std::memory_order_relaxed)) / 1000);
+            return;
+        }
+    }
+}
+
+double LinkStatistics::_meanRoundTripMSecs(RoundTripSource source) const
+{
+    const RoundTripCounters_t &counters = _roundTrips[source];
+
+    const quint64 count = counters.count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return qQNaN();
+    }
+
+    return (counters.sumUSecs.load(std::memory_order_relaxed) / static_cast<double>(count)) / 1000.;
+}
+
+void LinkStatistics::update()
+{
+    if (!_updateTimer.isValid()) {
+        _updateTimer.start();
+        for (int direction = 0; direction < DirectionCount; direction++) {
+            _lastBytes[direction] = _directions[direction].bytes.load(std::memory_order_relaxed);
+            _lastMessages[direction] = _directions[direction].messages.load(std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    const qint64 elapsedMSecs = _updateTimer.restart();
+    if (elapsedMSecs <= 0) {
+        return;
+    }
+    const double seconds = elapsedMSecs / 1000.;
+
+    for (int direction = 0; direction < DirectionCount; direction++) {
+        const DirectionCounters_t &counters = _directions[direction];
+
+        const quint64 bytes = counters.bytes.load(std::memory_order_relaxed);
+        const quint64 messages = counters.messages.load(std::memory_order_relaxed);
+        _rates[direction].bytes = (bytes - _lastBytes[direction]) / seconds;
+        _rates[direction].messages = (messages - _lastMessages[direction]) / seconds;
+        _lastBytes[direction] = bytes;
+        _lastMessages[direction] = messages;
+
+        for (const MessageCounters_t &slot : counters.perMessage) {
+            const uint32_t msgid = slot.msgid.load(std::memory_order_relaxed);
+            if (msgid == kEmptyMsgId) {
+                continue;
+            }
+
+            MessageRates_t &messageRates = _messageRates[msgid];
+            const quint64 count = slot.count.load(std::memory_order_relaxed);
+            const quint64 messageBytes = slot.bytes.load(std::memory_order_relaxed);
+            messageRates.rate[direction] = (count - messageRates.lastCount[direction]) / seconds;
+            messageRates.byteRate[direction] = (messageBytes - messageRates.lastBytes[direction]) / seconds;
+            messageRates.lastCount[direction] = count;
+            messageRates.lastBytes[direction] = messageBytes;
+        }
+    }
+
+    emit updated();
+}
+
+QVariantList LinkStatistics::messageStats() const
+{
+    QList<uint32_t> msgids = _messageRates.keys();
+    std::sort(msgids.begin(), msgids.end());
+
+    QVariantList result;
+    for (const uint32_t msgid : msgids) {
+        const MessageRates_t &messageRates = _messageRates[msgid];
+        const mavlink_message_info_t *info = mavlink_get_message_info_by_id(msgid);
+
+        QVariantMap map;
+        map[QStringLiteral("msgid")] = msgid;
+        map[QStringLiteral("name")] = info ? QString::fromLatin1(info->name) : QString::number(msgid);
+        map[QStringLiteral("received")] = messageRates.lastCount[Received];
+        map[QStringLiteral("sent")] = messageRates.lastCount[Sent];
+        map[QStringLiteral("receivedRate")] = messageRates.rate[Received];
+        map[QStringLiteral("sentRate")] = messageRates.rate[Sent];
+        map[QStringLiteral("bytesReceivedRate")] = messageRates.byteRate[Received];
+        map[QStringLiteral("bytesSentRate")] = messageRates.byteRate[Sent];
+        result.append(map);
+    }
+
+    return result;
+}
+
+QJsonObject LinkStatistics::toJson() const
+{
+    QJsonObject json;
+    json[QStringLiteral("bytesReceived")] = static_cast<qint64>(bytesReceived());
+    json[QStringLiteral("bytesSent")] = static_cast<qint64>(bytesSent());
+    json[QStringLiteral("bytesReceivedRate")] = bytesReceivedRate();
+    json[QStringLiteral("bytesSentRate")] = bytesSentRate();
+    json[QStringLiteral("messagesReceivedRate")] = messagesReceivedRate();
+    json[QStringLiteral("messagesSentRate")] = messagesSentRate();
+    json[QStringLiteral("parseErrors")] = static_cast<qint64>(parseErrors());
+
+    QJsonObject roundTrips;
+    for (int source = 0; source < RoundTripSourceCount; source++) {
+        const RoundTripCounters_t &counters = _roundTrips[source];
+        const quint64 count = counters.count.load(std::memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+
+        QJsonObject roundTrip;
+        roundTrip[QStringLiteral("count")] = static_cast<qint64>(count);
+        roundTrip[QStringLiteral("meanMSecs")] = _meanRoundTripMSecs(static_cast<RoundTripSource>(source));
+        roundTrip[QStringLiteral("maxMSecs")] = counters.maxUSecs.load(std::memory_order_relaxed) / 1000.;
+        roundTrip[QStringLiteral("lastMSecs")] = counters.lastUSecs.load(std::memory_order_relaxed) / 1000.;
+        roundTrips[QString::fromLatin1(roundTripName(static_cast<RoundTripSource>(source)))] = roundTrip;
+    }
+    json[QStringLiteral("roundTrips")] = roundTrips;
+
+    json[QStringLiteral("messages")] = QJsonArray::fromVariantList(messageStats());
+
+    return json;
+}
@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QObject>
+#include <QtCore/QVariantList>
+
+#include <atomic>
+
+#include "MAVLinkLib.h"
+
+/// Always on traffic counters for a single link.
+///
+/// Counting is thread safe and lock free. Normally the receive counters are only written by the MAVLink protocol thread
+/// and the send counters by the link thread, so a message costs a few uncontended relaxed atomic increments.
+/// update() turns the counters into rates once per second on the gui thread, which is also where Qml reads them.
+class LinkStatistics : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(double   bytesReceivedRate       READ bytesReceivedRate      NOTIFY updated)    ///< bytes/sec
+    Q_PROPERTY(double   bytesSentRate           READ bytesSentRate          NOTIFY updated)    ///< bytes/sec
+    Q_PROPERTY(double   messagesReceivedRate    READ messagesReceivedRate   NOTIFY updated)    ///< messages/sec
+    Q_PROPERTY(double   messagesSentRate        READ messagesSentRate       NOTIFY updated)    ///< messages/sec
+    Q_PROPERTY(quint64  bytesReceived           READ bytesReceived          NOTIFY updated)
+    Q_PROPERTY(quint64  bytesSent               READ bytesSent              NOTIFY updated)
+    Q_PROPERTY(quint64  parseErrors             READ parseErrors            NOTIFY updated)    ///< Packets dropped due to bad CRC or signature
+    Q_PROPERTY(double   pingRttMSecs            READ pingRttMSecs           NOTIFY updated)    ///< NaN until measured
+    Q_PROPERTY(double   timesyncRttMSecs        READ timesyncRttMSecs       NOTIFY updated)    ///< NaN until measured
+    Q_PROPERTY(double   commandAckRttMSecs      READ commandAckRttMSecs     NOTIFY updated)    ///< NaN until measured
+
+public:
+    enum RoundTripSource {
+        RoundTripPing,
+        RoundTripTimesync,
+        RoundTripCommandAck,
+        RoundTripSourceCount
+    };
+    Q_ENUM(RoundTripSource)
+
+    explicit LinkStatistics(QObject *parent = nullptr);
+    ~LinkStatistics();
+
+    /// Called for each chunk of bytes read from the link
+    void countReceivedBytes(int length) { (void) _directions[Received].bytes.fetch_add(static_cast<quint64>(length), std::memory_order_relaxed); }
+
+    /// Called for each received message which passed CRC
+    void countReceivedMessage(const mavlink_message_t &message);
+
+    /// Called for each received packet dropped by the parser
+    void countParseError() { (void) _parseErrors.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Called for each packet written to the link. Bytes which are not a single MAVLink packet are only counted
+    /// towards the byte totals.
+    void countSentPacket(const char *bytes, int length);
+
+    void countRoundTrip(RoundTripSource source, qint64 usecs);
+
+    /// Recomputes the rates from the counters, call about once per second from the gui thread
+    void update();
+
+    double bytesReceivedRate() const { return _rates[Received].bytes; }
+    double bytesSentRate() const { return _rates[Sent].bytes; }
+    double messagesReceivedRate() const { return _rates[Received].messages; }
+    double messagesSentRate() const { return _rates[Sent].messages; }
+    quint64 bytesReceived() const { return _directions[Received].bytes.load(std::memory_order_relaxed); }
+    quint64 bytesSent() const { return _directions[Sent].bytes.load(std::memory_order_relaxed); }
+    quint64 messagesReceived() const { return _directions[Received].messages.load(std::memory_order_relaxed); }
+    quint64 messagesSent() const { return _directions[Sent].messages.load(std::memory_order_relaxed); }
+    quint64 parseErrors() const { return _parseErrors.load(std::memory_order_relaxed); }
+    double pingRttMSecs() const { return _meanRoundTripMSecs(RoundTripPing); }
+    double timesyncRttMSecs() const { return _meanRoundTripMSecs(RoundTripTimesync); }
+    double commandAckRttMSecs() const { return _meanRoundTripMSecs(RoundTripCommandAck); }
+
+    /// @return One map per message id seen: msgid, name, received, sent, receivedRate, sentRate, bytesReceivedRate, bytesSentRate
+    Q_INVOKABLE QVariantList messageStats() const;
+
+    QJsonObject toJson() const;
+
+signals:
+    void updated();
+
+private:
+    static constexpr uint32_t kEmptyMsgId = UINT32_MAX;
+    static constexpr int kMessageSlots = 256;       ///< Must be a power of two, more distinct ids than this are only counted in the totals
+    static constexpr int kPendingRequests = 8;
+
+    enum Direction {
+        Received,
+        Sent,
+        DirectionCount
+    };
+
+    struct MessageCounters_t {
+        std::atomic<uint32_t> msgid{kEmptyMsgId};
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> bytes{0};
+    };
+
+    struct DirectionCounters_t {
+        std::atomic<quint64> bytes{0};
+        std::atomic<quint64> messages{0};
+        MessageCounters_t perMessage[kMessageSlots];
+    };
+
+    struct RoundTripCounters_t {
+        std::atomic<quint64> count{0};
+        std::atomic<qint64> sumUSecs{0};
+        std::atomic<qint64> maxUSecs{0};
+        std::atomic<qint64> lastUSecs{0};
+    };
+
+    /// Outstanding PING or TIMESYNC request we sent, matched against the reply by key
+    struct PendingRequest_t {
+        std::atomic<quint64> key{0};
+        std::atomic<qint64> sentNSecs{0};
+    };
+
+    struct Rates_t {
+        double bytes = 0;
+        double messages = 0;
+    };
+
+    struct MessageRates_t {
+        quint64 lastCount[DirectionCount] = {};
+        quint64 lastBytes[DirectionCount] = {};
+        double rate[DirectionCount] = {};
+        double byteRate[DirectionCount] = {};
+    };
+
+    void _countMessage(Direction direction, uint32_t msgid, int length);
+    void _addPendingRequest(RoundTripSource source, quint64 key);
+    void _matchPendingRequest(RoundTripSource source, quint64 key);
+    double _meanRoundTripMSecs(RoundTripSource source) const;
+
+    DirectionCounters_t _directions[DirectionCount];
+    std::atomic<quint64> _parseErrors{0};
+    RoundTripCounters_t _roundTrips[RoundTripSourceCount];
+    PendingRequest_t _pendingRequests[RoundTripSourceCount][kPendingRequests];
+    std::atomic<uint32_t> _nextPendingRequest[RoundTripSourceCount];
+    QElapsedTimer _clock;
+
+    // Gui thread only
+    QElapsedTimer _updateTimer;
+    quint64 _lastBytes[DirectionCount] = {};
+    quint64 _lastMessages[DirectionCount] = {};
+    Rates_t _rates[DirectionCount];
+    QHash<uint32_t, MessageRates_t> _messageRates;
+};
@@ -0,0 +1,202 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkTransmitQueue.h"
+#include "MAVLinkLib.h"
+
+#include <cstring>
+
+static_assert(LinkTransmitQueue::kMaxPacketLength == MAVLINK_MAX_PACKET_LEN);
+
+LinkTransmitQueue::LinkTransmitQueue()
+{
+    for (int priority = 0; priority < PriorityCount; priority++) {
+        Lane_t &lane = _lanes[priority];
+        const size_t capacity = kLaneCapacity[priority];
+        Q_ASSERT((capacity & (capacity - 1)) == 0);
+
+        lane.slots = std::make_unique<Slot_t[]>(capacity);
+        lane.mask = capacity - 1;
+        for (size_t i = 0; i < capacity; i++) {
+            lane.slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    _timer.start();
+}
+
+LinkTransmitQueue::~LinkTransmitQueue()
+{
+
+}
+
+/// Bounded MPMC queue by Dmitry Vyukov, reduced to a single consumer. Each slot carries a sequence number which tells
+/// producers whether the slot is free for the current lap around the ring and the consumer whether it has been filled.
+bool LinkTransmitQueue::enqueue(Priority priority, const char *bytes, int length, bool resequence)
+{
+    if (length <= 0) {
+        return false;
+    }
+
+    Lane_t &lane = _lanes[priority];
+
+    Slot_t *slot = nullptr;
+    size_t pos = lane.enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        slot = &lane.slots[pos & lane.mask];
+        const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (lane.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            (void) lane.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = lane.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->enqueueNs = _timer.nsecsElapsed();
+    slot->length = length;
+    slot->resequence = resequence;
+    if (length > kMaxPacketLength) {
+        slot->oversize = QByteArray(bytes, length);
+    } else {
+        (void) memcpy(slot->data, bytes, static_cast<size_t>(length));
+    }
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    const int depth = lane.depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    int maxDepth = lane.maxDepth.load(std::memory_order_relaxed);
+    while ((depth > maxDepth) && !lane.maxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed)) {}
+
+    return true;
+}
+
+const LinkTransmitQueue::Slot_t *LinkTransmitQueue::_peek(Lane_t &lane) const
+{
+    const Slot_t *slot = &lane.slots[lane.dequeuePos & lane.mask];
+    if (slot->sequence.load(std::memory_order_acquire) != (lane.dequeuePos + 1)) {
+        return nullptr;
+    }
+
+    return slot;
+}
+
+void LinkTransmitQueue::_release(Lane_t &lane, qint64 nowNs)
+{
+    Slot_t &slot = lane.slots[lane.dequeuePos & lane.mask];
+
+    const qint64 latencyNs = qMax(nowNs - slot.enqueueNs, qint64(0));
+    (void) lane.latencySumNs.fetch_add(latencyNs, std::memory_order_relaxed);
+    if (latencyNs > lane.latencyMaxNs.load(std::memory_order_relaxed)) {
+        lane.latencyMaxNs.store(latencyNs, std::memory_order_relaxed);
+    }
+    (void) lane.sent.fetch_add(1, std::memory_order_relaxed);
+    (void) lane.depth.fetch_sub(1, std::memory_order_relaxed);
+
+    if (!slot.oversize.isEmpty()) {
+        slot.oversize = QByteArray();
+    }
+    slot.sequence.store(lane.dequeuePos + lane.mask + 1, std::memory_order_release);
+    lane.dequeuePos++;
+}
+
+LinkTransmitQueue::Stats_t LinkTransmitQueue::stats(Priority priority) const
+{
+    const Lane_t &lane = _lanes[priority];
+
+    Stats_t stats;
+    stats.depth = lane.depth.load(std::memory_order_relaxed);
+    stats.maxDepth = lane.maxDepth.load(std::memory_order_relaxed);
+    stats.sent = lane.sent.load(std::memory_order_relaxed);
+    stats.dropped = lane.dropped.load(std::memory_order_relaxed);
+    if (stats.sent > 0) {
+        stats.meanLatencyUs = (lane.latencySumNs.load(std::memory_order_relaxed) / static_cast<double>(stats.sent)) / 1000.;
+    }
+    stats.maxLatencyUs = lane.latencyMaxNs.load(std::memory_order_relaxed) / 1000.;
+
+    return stats;
+}
+
+LinkTransmitQueue::Priority LinkTransmitQueue::priorityForMessage(uint32_t msgid)
+{
+    switch (msgid) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+    case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+    case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+    case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        return PriorityControl;
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+    case MAVLINK_MSG_ID_COMMAND_INT:
+    case MAVLINK_MSG_ID_COMMAND_ACK:
+    case MAVLINK_MSG_ID_COMMAND_CANCEL:
+    case MAVLINK_MSG_ID_SET_MODE:
+        return PriorityCommand;
+    default:
+        return PriorityBulk;
+    }
+}
+
+bool LinkTransmitQueue::resequencePacket(char *packet, int length, uint8_t sequence, uint8_t channel)
+{
+    uint8_t *const bytes = reinterpret_cast<uint8_t*>(packet);
+    if (length < 1) {
+        return false;
+    }
+
+    int headerLength;
+    int sequenceIndex;
+    uint32_t msgid;
+    bool isSigned = false;
+    if ((bytes[0] == MAVLINK_STX) && (length >= MAVLINK_NUM_NON_PAYLOAD_BYTES)) {
+        headerLength = MAVLINK_CORE_HEADER_LEN + 1;
+        sequenceIndex = 4;
+        msgid = bytes[7] | (bytes[8] << 8) | (static_cast<uint32_t>(bytes[9]) << 16);
+        isSigned = (bytes[2] & MAVLINK_IFLAG_SIGNED) != 0;
+    } else if ((bytes[0] == MAVLINK_STX_MAVLINK1) && (length >= (MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + MAVLINK_NUM_CHECKSUM_BYTES))) {
+        headerLength = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+        sequenceIndex = 2;
+        msgid = bytes[5];
+    } else {
+        return false;
+    }
+
+    const int payloadLength = bytes[1];
+    if (length != (headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES + (isSigned ? MAVLINK_SIGNATURE_BLOCK_LEN : 0))) {
+        return false;
+    }
+    const mavlink_msg_entry_t *const entry = mavlink_get_msg_entry(msgid);
+    if (!entry) {
+        return false;
+    }
+
+    bytes[sequenceIndex] = sequence;
+
+    // The checksum covers everything but the start byte
+    uint16_t checksum = crc_calculate(bytes + 1, static_cast<uint16_t>(headerLength - 1));
+    crc_accumulate_buffer(&checksum, packet + headerLength, static_cast<uint16_t>(payloadLength));
+    crc_accumulate(entry->crc_extra, &checksum);
+    uint8_t *const checksumBytes = bytes + headerLength + payloadLength;
+    checksumBytes[0] = static_cast<uint8_t>(checksum & 0xFF);
+    checksumBytes[1] = static_cast<uint8_t>(checksum >> 8);
+
+    if (isSigned) {
+        mavlink_signing_t *const signing = mavlink_get_channel_status(channel)->signing;
+        if (signing) {
+            (void) mavlink_sign_packet(signing, checksumBytes + MAVLINK_NUM_CHECKSUM_BYTES, bytes, static_cast<uint8_t>(headerLength), bytes + headerLength, static_cast<uint8_t>(payloadLength), checksumBytes);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+/// Transmit queue of a link. Any number of threads can enqueue packets without locking or allocating, the link
+/// thread is the single consumer which drains the queue into coalesced writes. Writes larger than a MAVLink packet
+/// go through the same lanes to keep their order, only those allocate.
+///
+/// Packets are queued in priority lanes which are drained strictly in order so control traffic never waits
+/// behind bulk transfers. Since that reorders packets, MAVLink packets packed by this application are marked for
+/// resequencing: the consumer gives them their sequence number and signature as they are written, see
+/// resequencePacket.
+class LinkTransmitQueue
+{
+public:
+    enum Priority {
+        PriorityControl,    ///< MANUAL_CONTROL, heartbeats, ...
+        PriorityCommand,    ///< Commands and mode changes
+        PriorityBulk,       ///< Parameters, missions, FTP, RTCM, forwarding, ...
+        PriorityCount
+    };
+
+    struct Stats_t {
+        int     depth           = 0;    ///< Packets currently queued
+        int     maxDepth        = 0;    ///< High water mark of depth
+        quint64 sent            = 0;
+        quint64 dropped         = 0;    ///< Packets dropped because the lane was full
+        double  meanLatencyUs   = 0;    ///< Mean time from enqueue to write
+        double  maxLatencyUs    = 0;
+    };
+
+    LinkTransmitQueue();
+    ~LinkTransmitQueue();
+
+    /// Thread safe, lock free
+    ///     @param resequence Passed on to the dequeue packetCallback
+    ///     @return false: packet is empty or the lane is full
+    bool enqueue(Priority priority, const char *bytes, int length, bool resequence = false);
+
+    /// Single consumer only. Appends packets to buffer in priority order until the queue is empty or the next
+    /// packet would push buffer past maxBytes.
+    ///     @param packetCallback Called as (char *bytes, int length, bool resequence) with each packet once it is
+    ///                           appended, bytes points into buffer and may be modified in place. May be nullptr.
+    ///     @return Number of packets appended
+    template<typename PacketCallback>
+    int dequeue(QByteArray &buffer, int maxBytes, PacketCallback packetCallback);
+
+    /// Thread safe
+    Stats_t stats(Priority priority) const;
+
+    static Priority priorityForMessage(uint32_t msgid);
+
+    /// Gives a serialized MAVLink 1/2 packet a new sequence number, recomputes its checksum and signs it again
+    /// with the signing of channel if it was signed.
+    ///     @return false: not a complete MAVLink packet or unknown message, the packet is left as is
+    static bool resequencePacket(char *packet, int length, uint8_t sequence, uint8_t channel);
+
+    static constexpr int kMaxPacketLength = 280;   ///< MAVLINK_MAX_PACKET_LEN
+
+private:
+    struct Slot_t {
+        std::atomic<size_t> sequence;
+        qint64 enqueueNs;
+        int length;
+        bool resequence;
+        char data[kMaxPacketLength];
+        QByteArray oversize;                    ///< Data of writes longer than kMaxPacketLength
+    };
+
+    struct Lane_t {
+        std::unique_ptr<Slot_t[]> slots;
+        size_t mask = 0;
+        std::atomic<size_t> enqueuePos{0};
+        size_t dequeuePos = 0;                  ///< Consumer only
+
+        std::atomic<int> depth{0};
+        std::atomic<int> maxDepth{0};
+        std::atomic<quint64> sent{0};
+        std::atomic<quint64> dropped{0};
+        std::atomic<qint64> latencySumNs{0};
+        std::atomic<qint64> latencyMaxNs{0};
+    };
+
+    const Slot_t *_peek(Lane_t &lane) const;
+    void _release(Lane_t &lane, qint64 nowNs);
+
+    Lane_t _lanes[PriorityCount];
+    QElapsedTimer _timer;
+
+    static constexpr size_t kLaneCapacity[PriorityCount] = { 64, 256, 1024 };  ///< Must be powers of two
+};
+
+template<typename PacketCallback>
+int LinkTransmitQueue::dequeue(QByteArray &buffer, int maxBytes, PacketCallback packetCallback)
+{
+    int count = 0;
+    const qint64 nowNs = _timer.nsecsElapsed();
+
+    for (;;) {
+        Lane_t *lane = nullptr;
+        const Slot_t *slot = nullptr;
+        for (Lane_t &candidate : _lanes) {
+            slot = _peek(candidate);
+            if (slot) {
+                lane = &candidate;
+                break;
+            }
+        }
+
+        if (!slot || ((count > 0) && ((buffer.size() + slot->length) > maxBytes))) {
+            break;
+        }
+
+        const char *data = slot->oversize.isEmpty() ? slot->data : slot->oversize.constData();
+        const qsizetype offset = buffer.size();
+        (void) buffer.append(data, slot->length);
+        if constexpr (!std::is_same_v<PacketCallback, std::nullptr_t>) {
+            packetCallback(buffer.data() + offset, slot->length, slot->resequence);
+        }
+        _release(*lane, nowNs);
+        count++;
+    }
+
+    return count;
+}
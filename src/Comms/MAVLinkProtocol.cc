@@ -197,9 +197,20 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
     }
 
     uint8_t mavlinkChannel = link->mavlinkChannel();
+    LinkStatistics* statistics = link->statistics();
+    const mavlink_status_t* channelStatus = mavlink_get_channel_status(mavlinkChannel);
+
+    statistics->countReceivedBytes(b.size());
 
     for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
+        if (!mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
+            // A packet failing CRC or signature checks leaves the channel parse error set until the next byte
+            if (channelStatus->parse_error) {
+                statistics->countParseError();
+            }
+        } else {
+            statistics->countReceivedMessage(_message);
+
             // Got a valid message
             if (!link->decodedFirstMavlinkPacket()) {
                 link->setDecodedFirstMavlinkPacket(true);
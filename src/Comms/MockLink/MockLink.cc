@@ -18,6 +18,7 @@
 #include <QtCore/QTimer>
 #include <QtCore/QTemporaryFile>
 #include <QtCore/QRandomGenerator>
+#include <QtCore/QtMath>
 
 #include <string.h>
 
@@ -79,6 +80,8 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
     _vehicleLongitude   = _defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001);
     _boardVendorId      = mockConfig->boardVendorId();
     _boardProductId     = mockConfig->boardProductId();
+    _streamRateHz       = mockConfig->streamRateHz();
+    _responseLatencyMSecs = mockConfig->responseLatencyMSecs();
 
     QObject::connect(this, &MockLink::writeBytesQueuedSignal, this, &MockLink::_writeBytesQueued, Qt::QueuedConnection);
 
@@ -184,6 +187,7 @@ void MockLink::run(void)
     QTimer  timer10HzTasks;
     QTimer  timer500HzTasks;
     QTimer  timerStatusText;
+    QTimer  timerStream;
 
     QObject::connect(&timer1HzTasks,   &QTimer::timeout, this, &MockLink::_run1HzTasks);
     QObject::connect(&timer10HzTasks,  &QTimer::timeout, this, &MockLink::_run10HzTasks);
@@ -194,6 +198,12 @@ void MockLink::run(void)
     timer10HzTasks.start(100);
     timer500HzTasks.start(2);
 
+    if (_streamRateHz > 0) {
+        QObject::connect(&timerStream, &QTimer::timeout, this, &MockLink::_runStreamTasks);
+        timerStream.setTimerType(Qt::PreciseTimer);
+        timerStream.start(qMax(1, 1000 / _streamRateHz));
+    }
+
     // Wait a little bit for the ui to finish loading up before sending out status text messages
     if (_sendStatusText) {
         timerStatusText.setSingleShot(true);
@@ -269,6 +279,19 @@ void MockLink::_run500HzTasks(void)
     }
 }
 
+void MockLink::_runStreamTasks(void)
+{
+    if (linkConfiguration()->isHighLatency()) {
+        return;
+    }
+
+    if (_mavlinkStarted && _connected) {
+        _sendAttitude();
+        _sendGlobalPositionInt();
+        _sendVfrHud();
+    }
+}
+
 void MockLink::_loadParams(void)
 {
     QFile paramFile;
@@ -532,7 +555,11 @@ void MockLink::respondWithMavlinkMessage(const mavlink_message_t& msg)
 
         int cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
         QByteArray bytes((char *)buffer, cBuffer);
-        emit bytesReceived(this, bytes);
+        if (_responseLatencyMSecs > 0) {
+            QTimer::singleShot(_responseLatencyMSecs, Qt::PreciseTimer, this, [this, bytes]() { emit bytesReceived(this, bytes); });
+        } else {
+            emit bytesReceived(this, bytes);
+        }
     }
 }
 
@@ -1336,6 +1363,40 @@ void MockLink::_sendGlobalPositionInt(void)
     respondWithMavlinkMessage(msg);
 }
 
+void MockLink::_sendAttitude(void)
+{
+    mavlink_message_t msg;
+
+    // Slowly rotate so the values change on every message
+    const float yaw = static_cast<float>(std::fmod(_runningTime.elapsed() / 1000.0, 2.0 * M_PI) - M_PI);
+
+    mavlink_msg_attitude_pack_chan(_vehicleSystemId,
+                                   _vehicleComponentId,
+                                   mavlinkChannel(),
+                                   &msg,
+                                   static_cast<uint32_t>(_runningTime.elapsed()),  // time since boot
+                                   0.0f, 0.0f, yaw,                                // roll, pitch, yaw
+                                   0.0f, 0.0f, 1.0f);                              // roll, pitch, yaw speed
+    respondWithMavlinkMessage(msg);
+}
+
+void MockLink::_sendVfrHud(void)
+{
+    mavlink_message_t msg;
+
+    mavlink_msg_vfr_hud_pack_chan(_vehicleSystemId,
+                                  _vehicleComponentId,
+                                  mavlinkChannel(),
+                                  &msg,
+                                  0.0f,                                                     // airspeed
+                                  0.0f,                                                     // groundspeed
+                                  0,                                                        // heading
+                                  0,                                                        // throttle
+                                  static_cast<float>(_vehicleAltitudeAMSL),                 // altitude
+                                  0.0f);                                                    // climb rate
+    respondWithMavlinkMessage(msg);
+}
+
 void MockLink::_sendExtendedSysState(void)
 {
     mavlink_message_t msg;
@@ -1442,6 +1503,8 @@ MockConfiguration::MockConfiguration(const MockConfiguration* source)
     _sendStatusText     = source->_sendStatusText;
     _incrementVehicleId = source->_incrementVehicleId;
     _failureMode        = source->_failureMode;
+    _streamRateHz       = source->_streamRateHz;
+    _responseLatencyMSecs = source->_responseLatencyMSecs;
 }
 
 void MockConfiguration::copyFrom(const LinkConfiguration *source)
@@ -1459,6 +1522,8 @@ void MockConfiguration::copyFrom(const LinkConfiguration *source)
     _sendStatusText     = usource->_sendStatusText;
     _incrementVehicleId = usource->_incrementVehicleId;
     _failureMode        = usource->_failureMode;
+    _streamRateHz       = usource->_streamRateHz;
+    _responseLatencyMSecs = usource->_responseLatencyMSecs;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -52,12 +52,21 @@ public:
     uint16_t        boardProductId      (void)                          { return _boardProductId; }
     MAV_TYPE        vehicleType         (void)                          { return _vehicleType; }
     bool            sendStatusText      (void) const                         { return _sendStatusText; }
+    int             streamRateHz        (void) const                    { return _streamRateHz; }
+    int             responseLatencyMSecs(void) const                    { return _responseLatencyMSecs; }
 
     void            setFirmwareType     (MAV_AUTOPILOT firmwareType)    { _firmwareType = firmwareType; emit firmwareChanged(); }
     void            setBoardVendorProduct(uint16_t vendorId, uint16_t productId) { _boardVendorId = vendorId; _boardProductId = productId; }
     void            setVehicleType      (MAV_TYPE vehicleType)          { _vehicleType = vehicleType; emit vehicleChanged(); }
     void            setSendStatusText   (bool sendStatusText)           { _sendStatusText = sendStatusText; emit sendStatusChanged(); }
 
+    /// Rate at which ATTITUDE, GLOBAL_POSITION_INT and VFR_HUD are streamed on top of the normal telemetry.
+    /// 0 (the default) disables the extra stream. Only used for load testing, so it is not saved to settings.
+    void            setStreamRateHz     (int streamRateHz)              { _streamRateHz = streamRateHz; }
+
+    /// Delays everything the vehicle sends by this much, to simulate a slow link. Not saved to settings.
+    void            setResponseLatencyMSecs(int latencyMSecs)           { _responseLatencyMSecs = latencyMSecs; }
+
     typedef enum {
         FailNone,                                                   // No failures
         FailParamNoReponseToRequestList,                            // Do no respond to PARAM_REQUEST_LIST
@@ -93,6 +102,8 @@ private:
     bool            _incrementVehicleId = true;
     uint16_t        _boardVendorId      = 0;
     uint16_t        _boardProductId     = 0;
+    int             _streamRateHz       = 0;
+    int             _responseLatencyMSecs = 0;
 
     static constexpr const char* _firmwareTypeKey         = "FirmwareType";
     static constexpr const char* _vehicleTypeKey          = "VehicleType";
@@ -198,6 +209,7 @@ private slots:
     void _run1HzTasks           (void);
     void _run10HzTasks          (void);
     void _run500HzTasks         (void);
+    void _runStreamTasks        (void);
     void _sendStatusTextMessages(void);
 
 private:
@@ -239,6 +251,8 @@ private:
     void _sendGpsRawInt                 (void);
     void _sendGlobalPositionInt         (void);
     void _sendExtendedSysState          (void);
+    void _sendAttitude                  (void);
+    void _sendVfrHud                    (void);
     void _sendVibration                 (void);
     void _sendSysStatus                 (void);
     void _sendBatteryStatus             (void);
@@ -299,6 +313,9 @@ private:
     uint16_t                    _boardVendorId      = 0;
     uint16_t                    _boardProductId     = 0;
 
+    int                         _streamRateHz       = 0;    ///< Extra high rate telemetry stream, 0 for none
+    int                         _responseLatencyMSecs = 0;  ///< Simulated link latency for everything sent to QGC
+
     MockLinkFTP* _mockLinkFTP = nullptr;
 
     bool _sendStatusText;
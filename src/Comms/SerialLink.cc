@@ -61,7 +61,6 @@ bool SerialLink::_isBootloader()
 void SerialLink::_writeBytes(const QByteArray &data)
 {
     if(_port && _port->isOpen()) {
-        emit bytesSent(this, data);
         _port->write(data);
     } else {
         // Error occurred
@@ -127,6 +127,7 @@ private slots:
 private:
     // LinkInterface overrides
     bool _connect(void) override;
+    bool _logSentBytes(void) const override { return true; }
 
     void _emitLinkError     (const QString& errorMsg);
     bool _hardwareConnect   (QSerialPort::SerialPortError& error, QString& errorString);
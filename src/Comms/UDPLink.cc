@@ -78,6 +78,7 @@ UDPLink::UDPLink(SharedLinkConfigurationPtr& config)
         QHostAddress &address = allAddresses[i];
         _localAddresses.append(QHostAddress(address));
     }
+    _receiveBuffers.resize(kReceiveBufferCount);
     moveToThread(this);
 }
 
@@ -89,6 +90,7 @@ UDPLink::~UDPLink()
     // Clear client list
     qDeleteAll(_sessionTargets);
     _sessionTargets.clear();
+    _sessionTargetSet.clear();
     quit();
     // Wait for it to exit
     wait();
@@ -137,7 +139,6 @@ void UDPLink::_writeBytes(const QByteArray &data)
     if (!_socket) {
         return;
     }
-    emit bytesSent(this, data);
 
     QMutexLocker locker(&_sessionTargetsMutex);
 
@@ -145,7 +146,7 @@ void UDPLink::_writeBytes(const QByteArray &data)
     for (int i=0; i<_udpConfig->targetHosts().count(); i++) {
         UDPCLient* target = _udpConfig->targetHosts()[i];
         // Skip it if it's part of the session clients below
-        if(!contains_target(_sessionTargets, target->address, target->port)) {
+        if(!_sessionTargetSet.contains(qMakePair(target->address, target->port))) {
             _writeDataGram(data, target);
         }
     }
@@ -163,16 +164,31 @@ void UDPLink::_writeDataGram(const QByteArray data, const UDPCLient* target)
     }
 }
 
+/// The receiver of bytesReceived holds a reference to the buffer until it has parsed it. Buffers which have been
+/// released are detached again and are reused without allocating, as long as the datagram fits.
+QByteArray& UDPLink::_nextReceiveBuffer()
+{
+    QByteArray& buffer = _receiveBuffers[_receiveBufferIndex];
+    _receiveBufferIndex = (_receiveBufferIndex + 1) % kReceiveBufferCount;
+    if (!buffer.isDetached()) {
+        buffer = QByteArray();
+    }
+    return buffer;
+}
+
 void UDPLink::readBytes()
 {
     if (!_socket) {
         return;
     }
-    QByteArray databuffer;
     while (_socket->hasPendingDatagrams())
     {
-        QByteArray datagram;
-        datagram.resize(_socket->pendingDatagramSize());
+        const qint64 datagramSize = _socket->pendingDatagramSize();
+        if (datagramSize < 0) {
+            break;
+        }
+        QByteArray& datagram = _nextReceiveBuffer();
+        datagram.resize(datagramSize);
         QHostAddress sender;
         quint16 senderPort;
         // If the other end is reset then it will still report data available,
@@ -181,31 +197,36 @@ void UDPLink::readBytes()
         if (slen == -1) {
             break;
         }
-        databuffer.append(datagram);
-        //-- Wait a bit before sending it over
-        if (databuffer.size() > 10 * 1024) {
-            emit bytesReceived(this, databuffer);
-            databuffer.clear();
-        }
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
-        }
-        QMutexLocker locker(&_sessionTargetsMutex);
-        if (!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
+        datagram.resize(slen);
+
+        if ((senderPort != _lastSenderPort) || (sender != _lastSender)) {
+            _addSessionTarget(sender, senderPort);
+            _lastSender = sender;
+            _lastSenderPort = senderPort;
         }
-        locker.unlock();
+
+        // Each datagram holds whole MAVLink packets so it is parsed on its own
+        emit bytesReceived(this, datagram);
     }
-    //-- Send whatever is left
-    if (databuffer.size()) {
-        emit bytesReceived(this, databuffer);
+}
+
+void UDPLink::_addSessionTarget(const QHostAddress& sender, quint16 senderPort)
+{
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    const QPair<QHostAddress, quint16> key = qMakePair(asender, senderPort);
+    QMutexLocker locker(&_sessionTargetsMutex);
+    if (!_sessionTargetSet.contains(key)) {
+        qDebug() << "Adding target" << asender << senderPort;
+        UDPCLient* target = new UDPCLient(asender, senderPort);
+        _sessionTargets.append(target);
+        _sessionTargetSet.insert(key);
     }
 }
 
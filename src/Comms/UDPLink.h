@@ -16,6 +16,8 @@
 #include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QByteArray>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
 #include <QtNetwork/QHostAddress>
 
 #if defined(QGC_ZEROCONF_ENABLED)
@@ -116,8 +118,11 @@ private:
 
     // LinkInterface overrides
     bool _connect(void) override;
+    bool _logSentBytes(void) const override { return true; }
 
     bool _isIpLocal         (const QHostAddress& add);
+    void _addSessionTarget  (const QHostAddress& sender, quint16 senderPort);
+    QByteArray& _nextReceiveBuffer(void);
     bool _hardwareConnect   (void);
     void _registerZeroconf  (uint16_t port, const std::string& regType);
     void _deregisterZeroconf(void);
@@ -128,11 +133,17 @@ private:
     const UDPConfiguration*   _udpConfig;
     bool                _connectState;
     QList<UDPCLient*>   _sessionTargets;
+    QSet<QPair<QHostAddress, quint16>> _sessionTargetSet;  ///< Same targets as _sessionTargets, for lookups
     QMutex              _sessionTargetsMutex;
+    QHostAddress        _lastSender;                        ///< Most datagrams come from the sender of the previous one
+    quint16             _lastSenderPort = 0;
+    QList<QByteArray>   _receiveBuffers;                    ///< Reused once the receiver has released them
+    int                 _receiveBufferIndex = 0;
     QList<QHostAddress> _localAddresses;
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef       _dnssServiceRef;
 #endif
 
     static constexpr const char* kZeroconfRegistration = "_qgroundcontrol._udp";
+    static constexpr int kReceiveBufferCount = 64;
 };
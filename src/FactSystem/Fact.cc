@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "Fact.h"
+#include "FactGroup.h"
 #include "FactValueSliderListModel.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
@@ -61,7 +62,15 @@ Fact::Fact(const QString& settingsGroup, FactMetaData* metaData, QObject* parent
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
 {
-    qgcApp()->toolbox()->corePlugin()->adjustSettingMetaData(settingsGroup, *metaData);
+    QGCCorePlugin* const corePlugin = qgcApp()->toolbox()->corePlugin();
+    if (metaData->shared()) {
+        bool visible;
+        metaData = FactMetaData::sharedAdjustedMetaData(metaData, settingsGroup, [corePlugin, &settingsGroup](FactMetaData& adjustedMetaData) {
+            return corePlugin->adjustSettingMetaData(settingsGroup, adjustedMetaData);
+        }, visible);
+    } else {
+        corePlugin->adjustSettingMetaData(settingsGroup, *metaData);
+    }
     setMetaData(metaData, true /* setDefaultFromMetaData */);
 
     _init();
@@ -126,11 +135,16 @@ void Fact::setRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             if (typedValue != _rawValue) {
+                const bool deferred = _deferToSignalBatch();
                 _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
+                if (!deferred) {
+                    _sendValueChangedSignal(cookedValue());
+                }
                 //-- Must be in this order
                 emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+                if (!deferred) {
+                    emit rawValueChanged(_rawValue);
+                }
             }
         }
     } else {
@@ -176,9 +190,12 @@ void Fact::setEnumIndex(int index)
 void Fact::_containerSetRawValue(const QVariant& value)
 {
     if(_rawValue != value) {
+        const bool deferred = _deferToSignalBatch();
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
-        emit rawValueChanged(_rawValue);
+        if (!deferred) {
+            _sendValueChangedSignal(cookedValue());
+            emit rawValueChanged(_rawValue);
+        }
     }
 
     // This always need to be signalled in order to support forceSetRawValue usage and waiting for vehicleUpdated signal
@@ -677,6 +694,13 @@ void Fact::_sendValueChangedSignal(QVariant value)
     }
 }
 
+/// Must be called before _rawValue is changed
+///     @return true: the change signals will be sent later by the FactGroup
+bool Fact::_deferToSignalBatch(void)
+{
+    return _signalBatchGroup && _signalBatchGroup->_deferFactSignals(this);
+}
+
 void Fact::sendDeferredValueChangedSignal(void)
 {
     if (_deferredValueChangeSignal) {
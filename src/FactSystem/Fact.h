@@ -10,11 +10,13 @@
 #pragma once
 
 #include <QtCore/QObject>
+#include <QtCore/QPointer>
 #include <QtCore/QString>
 #include <QtCore/QVariant>
 
 #include "FactMetaData.h"
 
+class FactGroup;
 class FactValueSliderListModel;
 
 /// @brief A Fact is used to hold a single value within the system.
@@ -195,7 +197,13 @@ private slots:
 
 private:
     void _init(void);
-    
+    bool _deferToSignalBatch(void);
+
+    QPointer<FactGroup>         _signalBatchGroup;                  ///< Group which may hold back the change signals
+    bool                        _signalBatchPending     = false;    ///< Change signals are held back by _signalBatchGroup
+
+    friend class FactGroup;
+
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
     void _sendValueChangedSignal(QVariant value);
@@ -12,6 +12,8 @@
 
 #include <QtQml/QQmlEngine>
 
+bool FactGroup::_signalBatchingEnabled = true;
+
 FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent, bool ignoreCamelCase)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
@@ -39,6 +41,10 @@ void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
 
 void FactGroup::_setupTimer()
 {
+    _batchTimer.setSingleShot(true);
+    _batchTimer.setInterval(_batchIntervalMSecs);
+    connect(&_batchTimer, &QTimer::timeout, this, &FactGroup::_sendBatchedSignals);
+
     if (_updateRateMSecs > 0) {
         connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
         _updateTimer.setSingleShot(false);
@@ -124,6 +130,7 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
     }
 
     fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    fact->_signalBatchGroup = this;
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name], true /* setDefaultFromMetaData */);
     }
@@ -179,6 +186,59 @@ void FactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_message_t& /* mess
     // Default implementation does nothing
 }
 
+void FactGroup::beginUpdate(void)
+{
+    _batchDepth++;
+}
+
+void FactGroup::commitUpdate(void)
+{
+    if (_batchDepth == 0) {
+        qWarning() << "commitUpdate without beginUpdate";
+        return;
+    }
+    if (--_batchDepth == 0 && !_batchedFacts.isEmpty() && !_batchTimer.isActive()) {
+        _batchTimer.start();
+    }
+}
+
+/// Called by a fact in this group just before its raw value changes
+///     @return true: the fact must not send its change signals, they will be sent by _sendBatchedSignals
+bool FactGroup::_deferFactSignals(Fact* fact)
+{
+    if (fact->_signalBatchPending) {
+        return true;
+    }
+    if (_batchDepth == 0 || !_signalBatchingEnabled) {
+        return false;
+    }
+    fact->_signalBatchPending = true;
+    _batchedFacts.append({ fact, fact->rawValue() });
+    return true;
+}
+
+void FactGroup::_sendBatchedSignals(void)
+{
+    if (_batchDepth > 0) {
+        // An update is open again, its commit restarts the timer
+        return;
+    }
+
+    const QList<BatchedFact_t> batchedFacts = std::move(_batchedFacts);
+    _batchedFacts.clear();
+    for (const BatchedFact_t& batchedFact: batchedFacts) {
+        Fact* fact = batchedFact.fact;
+        if (!fact) {
+            continue;
+        }
+        fact->_signalBatchPending = false;
+        if (fact->rawValue() != batchedFact.rawValue) {
+            fact->_sendValueChangedSignal(fact->cookedValue());
+            emit fact->rawValueChanged(fact->rawValue());
+        }
+    }
+}
+
 void FactGroup::_setTelemetryAvailable (bool telemetryAvailable)
 {
     if (telemetryAvailable != _telemetryAvailable) {
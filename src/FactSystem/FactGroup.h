@@ -11,6 +11,7 @@
 
 #include <QtCore/QStringList>
 #include <QtCore/QMap>
+#include <QtCore/QPointer>
 #include <QtCore/QTimer>
 #include <QtCore/QJsonArray>
 
@@ -54,6 +55,20 @@ public:
     /// Allows a FactGroup to parse incoming messages and fill in values
     virtual void handleMessage(Vehicle* vehicle, mavlink_message_t& message);
 
+    /// Starts holding back the change signals of the facts in this group. Calls can be nested. Once the outermost
+    /// commitUpdate is done the held back signals go out on the next frame: once per changed fact, and not at all for
+    /// a fact which ended up back at the value it had before.
+    ///
+    /// Only the signals wait, rawValue() and cookedValue() return the new value as soon as it is set. A listener
+    /// connected to rawValueChanged or valueChanged hears about a change up to _batchIntervalMSecs late and may miss
+    /// intermediate values. C++ code which must see every value, or react within the same message, should read the
+    /// fact where the message is handled rather than connect to its signals.
+    void beginUpdate    (void);
+    void commitUpdate   (void);
+
+    /// Batching is on by default. With it off beginUpdate/commitUpdate have no effect, which benchmarks use for comparison.
+    static void setSignalBatchingEnabled(bool enabled) { _signalBatchingEnabled = enabled; }
+
 signals:
     void factNamesChanged           (void);
     void factGroupNamesChanged      (void);
@@ -62,6 +77,9 @@ signals:
 protected slots:
     virtual void _updateAllValues(void);
 
+private slots:
+    void _sendBatchedSignals(void);
+
 protected:
     void _addFact               (Fact* fact, const QString& name);
     void _addFactGroup          (FactGroup* factGroup, const QString& name);
@@ -76,10 +94,25 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
+    struct BatchedFact_t {
+        QPointer<Fact>  fact;
+        QVariant        rawValue;   ///< Value at the time of the last change signal
+    };
+
+    void    _setupTimer         (void);
+    QString _camelCase          (const QString& text);
+    bool    _deferFactSignals   (Fact* fact);
 
     bool    _ignoreCamelCase    = false;
     QTimer  _updateTimer;
     bool    _telemetryAvailable = false;
+
+    int                     _batchDepth = 0;
+    QList<BatchedFact_t>    _batchedFacts;
+    QTimer                  _batchTimer;
+
+    static constexpr int    _batchIntervalMSecs = 16;   ///< About one frame
+    static bool             _signalBatchingEnabled;
+
+    friend class Fact;
 };
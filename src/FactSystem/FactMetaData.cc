@@ -13,6 +13,8 @@
 #include "QGCApplication.h"
 #include <MAVLinkLib.h>
 
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
 #include <QtCore/QtMath>
 
 // Built in translations for all Facts
@@ -1410,6 +1412,60 @@ QMap<QString, FactMetaData*> FactMetaData::createMapFromJsonFile(const QString&
     return createMapFromJsonArray(factArray, defineMap, metaDataParent);
 }
 
+QMap<QString, FactMetaData*> FactMetaData::sharedMapFromJsonFile(const QString& jsonFilename)
+{
+    static QMutex cacheMutex;
+    static QHash<QString, NameToMetaDataMap_t> cache;
+
+    // Unit translators are resolved while parsing, so meta data parsed under different unit settings can't be shared.
+    // Maps for previous unit settings stay alive since Facts created back then still reference them.
+    QString cacheKey = jsonFilename;
+    UnitsSettings* unitsSettings = qgcApp()->toolbox()->settingsManager()->unitsSettings();
+    if (unitsSettings) {
+        for (const Fact* unitsFact: { unitsSettings->horizontalDistanceUnits(), unitsSettings->verticalDistanceUnits(), unitsSettings->areaUnits(),
+                                      unitsSettings->speedUnits(), unitsSettings->temperatureUnits(), unitsSettings->weightUnits() }) {
+            cacheKey += QStringLiteral("|%1").arg(unitsFact->rawValue().toUInt());
+        }
+    }
+
+    QMutexLocker locker(&cacheMutex);
+
+    auto it = cache.constFind(cacheKey);
+    if (it == cache.constEnd()) {
+        const NameToMetaDataMap_t metaDataMap = createMapFromJsonFile(jsonFilename, nullptr /* metaDataParent */);
+        for (FactMetaData* metaData: metaDataMap) {
+            metaData->_shared = true;
+        }
+        it = cache.insert(cacheKey, metaDataMap);
+    }
+
+    return *it;
+}
+
+FactMetaData* FactMetaData::sharedAdjustedMetaData(FactMetaData* metaData, const QString& settingsGroup, const std::function<bool(FactMetaData&)>& adjust, bool& visible)
+{
+    struct Adjusted_t {
+        FactMetaData*   metaData;
+        bool            visible;
+    };
+    static QMutex cacheMutex;
+    static QHash<QPair<const FactMetaData*, QString>, Adjusted_t> cache;
+
+    QMutexLocker locker(&cacheMutex);
+
+    auto it = cache.constFind(qMakePair(metaData, settingsGroup));
+    if (it == cache.constEnd()) {
+        // Lives as long as the shared meta data it was copied from
+        FactMetaData* const adjustedMetaData = new FactMetaData(*metaData, nullptr /* parent */);
+        const bool adjustedVisible = adjust(*adjustedMetaData);
+        adjustedMetaData->_shared = true;
+        it = cache.insert(qMakePair(metaData, settingsGroup), { adjustedMetaData, adjustedVisible });
+    }
+
+    visible = it->visible;
+    return it->metaData;
+}
+
 QMap<QString, FactMetaData*> FactMetaData::createMapFromJsonArray(const QJsonArray jsonArray, QMap<QString, QString>& defineMap, QObject* metaDataParent)
 {
     QMap<QString, FactMetaData*> metaDataMap;
@@ -15,6 +15,8 @@
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
 
+#include <functional>
+
 /// Holds the meta data associated with a Fact.
 ///
 /// Holds the meta data associated with a Fact. This is kept in a separate object from the Fact itself
@@ -60,6 +62,18 @@ public:
     static QMap<QString, FactMetaData*> createMapFromJsonFile(const QString& jsonFilename, QObject* metaDataParent);
     static QMap<QString, FactMetaData*> createMapFromJsonArray(const QJsonArray jsonArray, DefineMap_t& defineMap, QObject* metaDataParent);
 
+    /// Process wide, thread safe cache on top of createMapFromJsonFile. Each file is only parsed once and the resulting
+    /// meta data is shared by all callers, so it must be treated as read-only. Callers which need to tweak meta data
+    /// per instance must use createMapFromJsonFile instead. Settings Facts use sharedAdjustedMetaData to apply
+    /// QGCCorePlugin::adjustSettingMetaData.
+    static QMap<QString, FactMetaData*> sharedMapFromJsonFile(const QString& jsonFilename);
+
+    /// Thread safe. Adjusts a copy of shared meta data once per settings group and shares that copy as well.
+    ///     @param adjust Called with the copy the first time metaData is used for settingsGroup, returns the visibility
+    ///     @param visible Set to what adjust returned for this settings group
+    /// @return Shared meta data adjusted for settingsGroup
+    static FactMetaData* sharedAdjustedMetaData(FactMetaData* metaData, const QString& settingsGroup, const std::function<bool(FactMetaData&)>& adjust, bool& visible);
+
     static FactMetaData* createFromJsonObject(const QJsonObject& json, QMap<QString, QString>& defineMap, QObject* metaDataParent);
 
     const FactMetaData& operator=(const FactMetaData& other);
@@ -140,6 +154,7 @@ public:
     bool            readOnly                (void) const { return _readOnly; }
     bool            writeOnly               (void) const { return _writeOnly; }
     bool            volatileValue           (void) const { return _volatile; }
+    bool            shared                  (void) const { return _shared; }    ///< true: Owned by the sharedMapFromJsonFile cache, must not be modified
 
     /// Amount to increment value when used in controls such as spin button or slider with detents.
     /// NaN for no increment available.
@@ -338,6 +353,7 @@ private:
     bool            _readOnly;
     bool            _writeOnly;
     bool            _volatile;
+    bool            _shared = false;        ///< Not copied by operator=, copies are never shared
     CustomCookedValidator _customCookedValidator = nullptr;
 
     // Exact conversion constants
@@ -11,8 +11,8 @@
 #include "SettingsFact.h"
 #include "QGCCorePlugin.h"
 #include "QGCApplication.h"
+#include "SettingsStore.h"
 
-#include <QtCore/QSettings>
 #include <QtQml/QQmlEngine>
 
 SettingsFact::SettingsFact(QObject* parent)
@@ -26,14 +26,17 @@ SettingsFact::SettingsFact(QString settingsGroup, FactMetaData* metaData, QObjec
     , _settingsGroup(settingsGroup)
     , _visible      (true)
 {
-    QSettings settings;
-
-    if (!_settingsGroup.isEmpty()) {
-        settings.beginGroup(_settingsGroup);
-    }
+    SettingsStore* const settings = SettingsStore::instance();
 
     // Allow core plugin a chance to override the default value
-    _visible = qgcApp()->toolbox()->corePlugin()->adjustSettingMetaData(settingsGroup, *metaData);
+    QGCCorePlugin* const corePlugin = qgcApp()->toolbox()->corePlugin();
+    if (metaData->shared()) {
+        metaData = FactMetaData::sharedAdjustedMetaData(metaData, settingsGroup, [corePlugin, &settingsGroup](FactMetaData& adjustedMetaData) {
+            return corePlugin->adjustSettingMetaData(settingsGroup, adjustedMetaData);
+        }, _visible);
+    } else {
+        _visible = corePlugin->adjustSettingMetaData(settingsGroup, *metaData);
+    }
     setMetaData(metaData);
 
     if (metaData->defaultValueAvailable()) {
@@ -45,11 +48,11 @@ SettingsFact::SettingsFact(QString settingsGroup, FactMetaData* metaData, QObjec
             if (_visible) {
                 QVariant typedValue;
                 QString errorString;
-                metaData->convertAndValidateRaw(settings.value(_name, rawDefaultValue), true /* conertOnly */, typedValue, errorString);
+                metaData->convertAndValidateRaw(settings->value(_settingsKey(), rawDefaultValue), true /* conertOnly */, typedValue, errorString);
                 _rawValue = typedValue;
             } else {
                 // Setting is not visible, force to default value always
-                settings.setValue(_name, rawDefaultValue);
+                settings->setValue(_settingsKey(), rawDefaultValue);
                 _rawValue = rawDefaultValue;
             }
         }
@@ -73,13 +76,12 @@ const SettingsFact& SettingsFact::operator=(const SettingsFact& other)
     return *this;
 }
 
-void SettingsFact::_rawValueChanged(QVariant value)
+QString SettingsFact::_settingsKey() const
 {
-    QSettings settings;
-
-    if (!_settingsGroup.isEmpty()) {
-        settings.beginGroup(_settingsGroup);
-    }
+    return _settingsGroup.isEmpty() ? _name : (_settingsGroup + QLatin1Char('/') + _name);
+}
 
-    settings.setValue(_name, value);
+void SettingsFact::_rawValueChanged(QVariant value)
+{
+    SettingsStore::instance()->setValue(_settingsKey(), value);
 }
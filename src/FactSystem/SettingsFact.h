@@ -35,6 +35,8 @@ private slots:
     void _rawValueChanged(QVariant value);
 
 private:
+    QString _settingsKey() const;
+
     QString _settingsGroup;
     bool    _visible;
 };
@@ -243,6 +243,14 @@ FlightMap {
         planMasterController:       _planMasterController
     }
 
+    // Warm the tile and terrain caches ahead of the mission and the vehicle
+    TilePrefetchController {
+        missionController:  pipMode ? null : _missionController
+        vehicle:            pipMode ? null : _activeVehicle
+        mapType:            _root.activeMapType.name
+        zoomLevel:          _root.zoomLevel
+    }
+
     ObstacleDistanceOverlayMap {
         id: obstacleDistance
         showText: !pipMode
@@ -268,6 +276,22 @@ FlightMap {
             onPointAdded: (coordinate) =>       trajectoryPolyline.addCoordinate(coordinate)
             onUpdateLastPoint: (coordinate) =>  trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
             onPointsCleared:                    trajectoryPolyline.path = []
+            onPointsChanged:                    trajectoryPolyline.path = _activeVehicle.trajectoryPoints.list()
+        }
+
+        // Only hand the map as much trail detail as the current zoom level can show
+        Binding {
+            target:     _activeVehicle ? _activeVehicle.trajectoryPoints : null
+            property:   "lodLevel"
+            when:       _activeVehicle
+            value: {
+                if (!_activeVehicle) {
+                    return 0
+                }
+                // Reading levelRevision re-evaluates the binding when a level tolerance changes, not just on zoom
+                var levelRevision = _activeVehicle.trajectoryPoints.levelRevision
+                return _activeVehicle.trajectoryPoints.lodLevelForZoom(_root.zoomLevel)
+            }
         }
     }
 
@@ -300,7 +324,7 @@ FlightMap {
             altitude:       object.altitude
             callsign:       object.callsign
             heading:        object.heading
-            alert:          object.alert
+            alert:          object.alert || object.proximityAlert
             map:            _root
             size:           pipMode ? ScreenTools.defaultFontPixelHeight : ScreenTools.defaultFontPixelHeight * 2.5
             z:              QGroundControl.zOrderVehicles
@@ -21,8 +21,11 @@
 #include "GimbalController.h"
 #include "QmlObjectListModel.h"
 
+#include <QtCore/QMutexLocker>
 #include <QtCore/QSettings>
 
+#include <algorithm>
+
 // JoystickLog Category declaration moved to QGCLoggingCategory.cc to allow access in Vehicle
 QGC_LOGGING_CATEGORY(JoystickValuesLog, "JoystickValuesLog")
 
@@ -205,6 +208,7 @@ void Joystick::_loadSettings()
     _axisFrequencyHz    = settings.value(_axisFrequencySettingsKey,     _defaultAxisFrequencyHz).toFloat();
     _buttonFrequencyHz  = settings.value(_buttonFrequencySettingsKey,   _defaultButtonFrequencyHz).toFloat();
     _circleCorrection   = settings.value(_circleCorrectionSettingsKey,  false).toBool();
+    _eventDriven        = settings.value(_eventDrivenSettingsKey,       true).toBool();
     _negativeThrust     = settings.value(_negativeThrustSettingsKey,    false).toBool();
 
 
@@ -312,6 +316,7 @@ void Joystick::_saveSettings()
     settings.setValue(_throttleModeSettingsKey,     _throttleMode);
     settings.setValue(_negativeThrustSettingsKey,   _negativeThrust);
     settings.setValue(_circleCorrectionSettingsKey, _circleCorrection);
+    settings.setValue(_eventDrivenSettingsKey,      _eventDriven);
 
     qCDebug(JoystickLog) << "_saveSettings calibrated:throttlemode:deadband:txmode" << _calibrated << _throttleMode << _deadband << _circleCorrection << _transmitterMode;
 
@@ -441,22 +446,136 @@ void Joystick::run()
     _open();
     //-- Reset timers
     _axisTime.start();
+    _latencyTimer.start();
+    _pendingInputNs = -1;
     for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
         if(_buttonActionArray[buttonIndex]) {
             _buttonActionArray[buttonIndex]->buttonTime.start();
         }
     }
     while (!_exitThread) {
+        qint64 inputAgeNs = 0;
+        bool inputReceived = false;
+        if (_eventDriven) {
+            inputReceived = _waitForInput(_waitTimeoutMSecs(), inputAgeNs);
+        } else {
+            QGC::SLEEP::msleep(qMin(static_cast<int>(1000.0f / _maxAxisFrequencyHz), static_cast<int>(1000.0f / _maxButtonFrequencyHz)) / 2);
+            // Input is still picked up when polling so the latency of both modes can be compared
+            inputReceived = _waitForInput(0, inputAgeNs);
+        }
+        if (inputReceived && _pendingInputNs < 0) {
+            _pendingInputNs = _latencyTimer.nsecsElapsed() - inputAgeNs;
+        }
         _update();
         _handleButtons();
         if (axisCount() != 0) {
             _handleAxis();
         }
-        QGC::SLEEP::msleep(qMin(static_cast<int>(1000.0f / _maxAxisFrequencyHz), static_cast<int>(1000.0f / _maxButtonFrequencyHz)) / 2);
     }
     _close();
 }
 
+bool Joystick::_waitForInput(int timeoutMs, qint64& inputAgeNs)
+{
+    inputAgeNs = 0;
+    if (timeoutMs > 0) {
+        QGC::SLEEP::msleep(static_cast<unsigned long>(timeoutMs));
+    }
+    return false;
+}
+
+/// Time until the loop has work to do even without new input: axis keep alive resend, button repeat or the
+/// earliest time a pending input may be sent given the max axis frequency.
+int Joystick::_waitTimeoutMSecs() const
+{
+    const int axisElapsed = static_cast<int>(_axisTime.elapsed());
+
+    int timeout = static_cast<int>(1000.0f / _buttonFrequencyHz);
+    timeout = qMin(timeout, static_cast<int>(1000.0f / _axisFrequencyHz) - axisElapsed + 1);
+    if (_pendingInputNs >= 0) {
+        timeout = qMin(timeout, _minAxisIntervalMSecs - axisElapsed);
+    }
+
+    return qMax(timeout, 0);
+}
+
+void Joystick::_recordInputLatency()
+{
+    if (_pendingInputNs < 0) {
+        return;
+    }
+
+    const qint64 latencyNs = _latencyTimer.nsecsElapsed() - _pendingInputNs;
+    const qint64 latencyUs = latencyNs / 1000;
+
+    int bucket = 0;
+    while ((bucket < _latencyBucketCount - 1) && (latencyUs >= _latencyBucketLimitsUs[bucket])) {
+        bucket++;
+    }
+
+    {
+        QMutexLocker locker(&_latencyMutex);
+        _latencyHistogram[bucket]++;
+        _latencySampleCount++;
+        _latencySumNs += latencyNs;
+        _latencyMaxNs = qMax(_latencyMaxNs, latencyNs);
+    }
+
+    qCDebug(JoystickValuesLog) << "input to send latency (us)" << latencyUs;
+
+    // Throttle notifications, the stats can change at up to the max axis frequency
+    if (!_latencyNotifyTimer.isValid() || _latencyNotifyTimer.hasExpired(1000)) {
+        _latencyNotifyTimer.start();
+        emit latencyStatsChanged();
+    }
+}
+
+void Joystick::resetLatencyStats()
+{
+    {
+        QMutexLocker locker(&_latencyMutex);
+        std::fill(std::begin(_latencyHistogram), std::end(_latencyHistogram), 0);
+        _latencySampleCount = 0;
+        _latencySumNs = 0;
+        _latencyMaxNs = 0;
+    }
+    emit latencyStatsChanged();
+}
+
+QList<int> Joystick::latencyHistogram()
+{
+    QMutexLocker locker(&_latencyMutex);
+    return QList<int>(std::begin(_latencyHistogram), std::end(_latencyHistogram));
+}
+
+QStringList Joystick::latencyHistogramLabels() const
+{
+    QStringList labels;
+    for (int bucket = 0; bucket < _latencyBucketCount - 1; bucket++) {
+        labels.append(QStringLiteral("< %1 ms").arg(_latencyBucketLimitsUs[bucket] / 1000.0));
+    }
+    labels.append(QStringLiteral(">= %1 ms").arg(_latencyBucketLimitsUs[_latencyBucketCount - 2] / 1000.0));
+    return labels;
+}
+
+int Joystick::latencySampleCount()
+{
+    QMutexLocker locker(&_latencyMutex);
+    return _latencySampleCount;
+}
+
+double Joystick::latencyMeanMs()
+{
+    QMutexLocker locker(&_latencyMutex);
+    return _latencySampleCount ? (_latencySumNs / static_cast<double>(_latencySampleCount)) / 1e6 : 0;
+}
+
+double Joystick::latencyMaxMs()
+{
+    QMutexLocker locker(&_latencyMutex);
+    return _latencyMaxNs / 1e6;
+}
+
 void Joystick::_handleButtons()
 {
     int lastBbuttonValues[256];
@@ -559,8 +678,9 @@ void Joystick::_handleAxis()
 {
     //-- Get frequency
     int axisDelay = static_cast<int>(1000.0f / _axisFrequencyHz);
-    //-- Check elapsed time since last run
-    if(_axisTime.elapsed() > axisDelay) {
+    //-- Check elapsed time since last run. In event driven mode new input goes out right away, limited only by the max axis frequency.
+    const qint64 axisElapsed = _axisTime.elapsed();
+    if((axisElapsed > axisDelay) || (_eventDriven && (_pendingInputNs >= 0) && (axisElapsed >= _minAxisIntervalMSecs))) {
         _axisTime.start();
         //-- Update axis
         for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
@@ -648,7 +768,9 @@ void Joystick::_handleAxis()
 
             uint16_t shortButtons = static_cast<uint16_t>(buttonPressedBits & 0xFFFF);
             _activeVehicle->sendJoystickDataThreadSafe(roll, pitch, yaw, throttle, shortButtons);
+            _recordInputLatency();
         }
+        _pendingInputNs = -1;
     }
 }
 
@@ -928,6 +1050,15 @@ void Joystick::setCircleCorrection(bool circleCorrection)
     emit circleCorrectionChanged(_circleCorrection);
 }
 
+void Joystick::setEventDriven(bool eventDriven)
+{
+    if (eventDriven != _eventDriven) {
+        _eventDriven = eventDriven;
+        _saveSettings();
+        emit eventDrivenChanged(_eventDriven);
+    }
+}
+
 void Joystick::setAxisFrequency(float val)
 {
     //-- Arbitrary limits
@@ -16,6 +16,7 @@
 #include "CustomActionManager.h"
 #include "QmlObjectListModel.h"
 
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
@@ -122,11 +123,20 @@ public:
     Q_PROPERTY(float    exponential             READ exponential            WRITE setExponential        NOTIFY exponentialChanged)
     Q_PROPERTY(bool     accumulator             READ accumulator            WRITE setAccumulator        NOTIFY accumulatorChanged)
     Q_PROPERTY(bool     circleCorrection        READ circleCorrection       WRITE setCircleCorrection   NOTIFY circleCorrectionChanged)
+    Q_PROPERTY(bool     eventDriven             READ eventDriven            WRITE setEventDriven        NOTIFY eventDrivenChanged)
+
+    //-- Input to MANUAL_CONTROL send latency
+    Q_PROPERTY(QList<int>   latencyHistogram        READ latencyHistogram       NOTIFY latencyStatsChanged)
+    Q_PROPERTY(QStringList  latencyHistogramLabels  READ latencyHistogramLabels CONSTANT)
+    Q_PROPERTY(int          latencySampleCount      READ latencySampleCount     NOTIFY latencyStatsChanged)
+    Q_PROPERTY(double       latencyMeanMs           READ latencyMeanMs          NOTIFY latencyStatsChanged)
+    Q_PROPERTY(double       latencyMaxMs            READ latencyMaxMs           NOTIFY latencyStatsChanged)
 
     Q_INVOKABLE void    setButtonRepeat     (int button, bool repeat);
     Q_INVOKABLE bool    getButtonRepeat     (int button);
     Q_INVOKABLE void    setButtonAction     (int button, const QString& action);
     Q_INVOKABLE QString getButtonAction     (int button);
+    Q_INVOKABLE void    resetLatencyStats   ();
 
     // Property accessors
 
@@ -177,6 +187,16 @@ public:
     bool  circleCorrection  () const;
     void  setCircleCorrection(bool circleCorrection);
 
+    /// Event driven: wake up on input from the joystick and send it right away instead of waiting for the next axis period
+    bool  eventDriven       () const { return _eventDriven; }
+    void  setEventDriven    (bool eventDriven);
+
+    QList<int>  latencyHistogram        ();
+    QStringList latencyHistogramLabels  () const;
+    int         latencySampleCount      ();
+    double      latencyMeanMs           ();
+    double      latencyMaxMs            ();
+
     void  setTXMode         (int mode);
     int   getTXMode         () { return _transmitterMode; }
 
@@ -206,6 +226,8 @@ signals:
     void accumulatorChanged         (bool accumulator);
     void enabledChanged             (bool enabled);
     void circleCorrectionChanged    (bool circleCorrection);
+    void eventDrivenChanged         (bool eventDriven);
+    void latencyStatsChanged        ();
     void axisValues                 (float roll, float pitch, float yaw, float throttle);
 
     void axisFrequencyHzChanged     ();
@@ -246,6 +268,8 @@ protected:
     void    _handleAxis             ();
     void    _handleButtons          ();
     void    _buildActionList        (Vehicle* activeVehicle);
+    int     _waitTimeoutMSecs       () const;
+    void    _recordInputLatency     ();
 
 private:
     virtual bool _open      ()          = 0;
@@ -256,6 +280,12 @@ private:
     virtual int  _getAxis   (int i)      = 0;
     virtual bool _getHat    (int hat,int i) = 0;
 
+    /// Waits for input from the joystick. The default implementation has no way to detect input and simply sleeps.
+    ///     @param timeoutMs Max time to wait, 0 to only check for input which already arrived
+    ///     @param[out] inputAgeNs How long ago the first pending input arrived
+    ///     @return true: input arrived
+    virtual bool _waitForInput(int timeoutMs, qint64& inputAgeNs);
+
     void _updateTXModeSettingsKey(Vehicle* activeVehicle);
     int _mapFunctionMode(int mode, int function);
     void _remapAxes(int currentMode, int newMode, int (&newMapping)[maxFunction]);
@@ -286,6 +316,7 @@ protected:
     bool    _accumulator            = false;
     bool    _deadband               = false;
     bool    _circleCorrection       = true;
+    bool    _eventDriven            = true;
     float   _axisFrequencyHz        = _defaultAxisFrequencyHz;
     float   _buttonFrequencyHz      = _defaultButtonFrequencyHz;
     Vehicle* _activeVehicle         = nullptr;
@@ -304,6 +335,18 @@ protected:
     int                 _rgFunctionAxis[maxFunction] = {};
     QElapsedTimer       _axisTime;
 
+    static constexpr int    _latencyBucketCount = 10;
+    static constexpr qint64 _latencyBucketLimitsUs[_latencyBucketCount - 1] = { 250, 500, 1000, 2000, 4000, 8000, 16000, 32000, 64000 };
+
+    QElapsedTimer       _latencyTimer;
+    qint64              _pendingInputNs         = -1;   ///< Time the oldest input not yet sent to the vehicle arrived, -1 for none
+    QElapsedTimer       _latencyNotifyTimer;
+    QMutex              _latencyMutex;                  ///< Protects the latency stats which are written by the joystick thread
+    int                 _latencyHistogram[_latencyBucketCount] = {};
+    int                 _latencySampleCount     = 0;
+    qint64              _latencySumNs           = 0;
+    qint64              _latencyMaxNs           = 0;
+
     QmlObjectListModel              _assignableButtonActions;
     QList<AssignedButtonAction*>    _buttonActionArray;
     QStringList                     _availableActionTitles;
@@ -315,6 +358,7 @@ protected:
     static constexpr const float _maxAxisFrequencyHz       = 200.0f;
     static constexpr const float _minButtonFrequencyHz     = 0.25f;
     static constexpr const float _maxButtonFrequencyHz     = 50.0f;
+    static constexpr const int   _minAxisIntervalMSecs     = static_cast<int>(1000.0f / _maxAxisFrequencyHz);
 
 private:
     const char* _txModeSettingsKey = nullptr;
@@ -338,6 +382,7 @@ private:
     static constexpr const char* _accumulatorSettingsKey =         "Accumulator";
     static constexpr const char* _deadbandSettingsKey =            "Deadband";
     static constexpr const char* _circleCorrectionSettingsKey =    "Circle_Correction";
+    static constexpr const char* _eventDrivenSettingsKey =         "EventDriven";
     static constexpr const char* _axisFrequencySettingsKey =       "AxisFrequency";
     static constexpr const char* _buttonFrequencySettingsKey =     "ButtonFrequency";
     static constexpr const char* _fixedWingTXModeSettingsKey =     "TXMode_FixedWing";
@@ -187,12 +187,11 @@ bool JoystickManager::setActiveJoystickName(const QString &name)
 void JoystickManager::_updateAvailableJoysticks()
 {
 #ifdef QGC_SDL_JOYSTICK
+    // Only the device events are taken from the queue, the input events belong to the joystick thread
+    SDL_PumpEvents();
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
+    while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_JOYDEVICEADDED, SDL_JOYDEVICEREMOVED) > 0) {
         switch(event.type) {
-        case SDL_QUIT:
-            qCDebug(JoystickManagerLog) << "SDL ERROR:" << SDL_GetError();
-            break;
         case SDL_JOYDEVICEADDED:
             qCDebug(JoystickManagerLog) << "Joystick added:" << event.jdevice.which;
             _setActiveJoystickFromSettings();
@@ -205,6 +204,14 @@ void JoystickManager::_updateAvailableJoysticks()
             break;
         }
     }
+    if (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_QUIT, SDL_QUIT) > 0) {
+        qCDebug(JoystickManagerLog) << "SDL ERROR:" << SDL_GetError();
+    }
+
+    // Nothing else in the queue is used. Dropping it keeps the joystick thread blocked in SDL_WaitEventTimeout.
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_JOYAXISMOTION - 1);
+    SDL_FlushEvents(SDL_JOYDEVICEREMOVED + 1, SDL_CONTROLLERAXISMOTION - 1);
+    SDL_FlushEvents(SDL_CONTROLLERBUTTONUP + 1, SDL_LASTEVENT);
 #elif defined(Q_OS_ANDROID)
     _joystickCheckTimerCounter--;
     _setActiveJoystickFromSettings();
@@ -11,9 +11,11 @@
 #include "MultiVehicleManager.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QDeadlineTimer>
 #include <QtCore/QTextStream>
 #include <QtCore/QFile>
 #include <QtCore/QIODevice>
+#include <QtCore/QThread>
 
 JoystickSDL::JoystickSDL(const QString& name, int axisCount, int buttonCount, int hatCount, int index, bool isGameController, MultiVehicleManager* multiVehicleManager)
     : Joystick(name,axisCount,buttonCount,hatCount,multiVehicleManager)
@@ -166,6 +168,48 @@ bool JoystickSDL::_update(void)
     return true;
 }
 
+/// Waits on the SDL event queue and takes only the joystick/controller input events from it. Device added/removed
+/// events are left in the queue for JoystickManager.
+bool JoystickSDL::_waitForInput(int timeoutMs, qint64& inputAgeNs)
+{
+    const QDeadlineTimer deadline(timeoutMs);
+    _update();
+    forever {
+        SDL_Event event;
+        int eventCount = SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_JOYAXISMOTION, SDL_JOYBUTTONUP);
+        if (eventCount <= 0) {
+            eventCount = SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_CONTROLLERAXISMOTION, SDL_CONTROLLERBUTTONUP);
+        }
+
+        if (eventCount > 0) {
+            // Only the arrival time of the oldest input matters, the state itself is read from the device
+            SDL_FlushEvents(SDL_JOYAXISMOTION, SDL_JOYBUTTONUP);
+            SDL_FlushEvents(SDL_CONTROLLERAXISMOTION, SDL_CONTROLLERBUTTONUP);
+
+            const Uint32 now = SDL_GetTicks();
+            inputAgeNs = (now > event.common.timestamp) ? static_cast<qint64>(now - event.common.timestamp) * 1000000 : 0;
+            return true;
+        }
+
+        const qint64 remainingMs = deadline.remainingTime();
+        if (remainingMs <= 0) {
+            break;
+        }
+
+        if (SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0) {
+            // SDL_WaitEventTimeout returns right away while JoystickManager has yet to pick up its events
+            QThread::msleep(1);
+            _update();
+        } else {
+            // Leaves the event in the queue, the input events are taken above
+            (void) SDL_WaitEventTimeout(nullptr, static_cast<int>(remainingMs));
+        }
+    }
+
+    inputAgeNs = 0;
+    return false;
+}
+
 bool JoystickSDL::_getButton(int i) {
     if (_isGameController) {
         return SDL_GameControllerGetButton(sdlController, SDL_GameControllerButton(i)) == 1;
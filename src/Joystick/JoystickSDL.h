@@ -47,6 +47,8 @@ private:
     int  _getAxis   (int i) final;
     bool _getHat    (int hat,int i) final;
 
+    bool _waitForInput(int timeoutMs, qint64& inputAgeNs) final;
+
     SDL_Joystick*       sdlJoystick;
     SDL_GameController* sdlController;
 
@@ -9,6 +9,7 @@
 
 
 #include "EventHandler.h"
+#include "QGCDecompressDevice.h"
 
 #include <QtCore/QSharedPointer>
 
@@ -95,7 +96,14 @@ void EventHandler::handleEvents(const mavlink_message_t& message)
 
 void EventHandler::setMetadata(const QString &metadataJsonFileName)
 {
-    if (_parser.loadDefinitionsFile(metadataJsonFileName.toStdString())) {
+    QByteArray bytes;
+    QString errorString;
+    if (!QGCDecompressDevice::readFile(metadataJsonFileName, bytes, errorString)) {
+        qCWarning(EventsLog) << "Failed to read events JSON metadata file:" << errorString;
+        return;
+    }
+
+    if (_parser.loadDefinitions(bytes.toStdString())) {
         if (_parser.hasDefinitions()) {
             // do we have queued events?
             for (const auto& event : _pendingEvents) {
@@ -19,7 +19,7 @@ CameraCalc::CameraCalc(PlanMasterController* masterController, const QString& se
     : CameraSpec                    (settingsGroup, parent)
     , _distanceMode                 (masterController->missionController()->globalAltitudeModeDefault())
     , _knownCameraList              (masterController->controllerVehicle()->staticCameraList())
-    , _metaDataMap                  (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/CameraCalc.FactMetaData.json"), this))
+    , _metaDataMap                  (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/CameraCalc.FactMetaData.json")))
     , _cameraNameFact               (settingsGroup, _metaDataMap[cameraNameName])
     , _valueSetIsDistanceFact       (settingsGroup, _metaDataMap[valueSetIsDistanceName])
     , _distanceToSurfaceFact        (settingsGroup, _metaDataMap[distanceToSurfaceName])
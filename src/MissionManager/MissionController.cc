@@ -33,8 +33,12 @@
 #include "QGC.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
+#include <QtCore/QScopeGuard>
+#include <QtCore/QScopedValueRollback>
+#include <QtCore/QSignalBlocker>
 
 #define UPDATE_TIMEOUT 5000 ///< How often we check for bounding box changes
 
@@ -608,7 +612,7 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
     // Validate root object keys
     QList<JsonHelper::KeyValidateInfo> rootKeyInfoList = {
         { _jsonPlannedHomePositionKey,      QJsonValue::Object, true },
-        { _jsonItemsKey,                    QJsonValue::Array,  true },
+        { jsonItemsKey,                    QJsonValue::Array,  true },
         { _jsonMavAutopilotKey,             QJsonValue::Double, true },
         { _jsonComplexItemsKey,             QJsonValue::Array,  true },
     };
@@ -644,7 +648,7 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
     int nextSimpleItemIndex= 0;
     int nextComplexItemIndex= 0;
     int nextSequenceNumber = 1; // Start with 1 since home is in 0
-    QJsonArray itemArray(json[_jsonItemsKey].toArray());
+    QJsonArray itemArray(json[jsonItemsKey].toArray());
 
     MissionSettingsItem* settingsItem = _addMissionSettings(visualItems);
     if (json.contains(_jsonPlannedHomePositionKey)) {
@@ -710,7 +714,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     // Validate root object keys
     QList<JsonHelper::KeyValidateInfo> rootKeyInfoList = {
         { _jsonPlannedHomePositionKey,      QJsonValue::Array,  true },
-        { _jsonItemsKey,                    QJsonValue::Array,  true },
+        { jsonItemsKey,                    QJsonValue::Array,  true },
         { _jsonFirmwareTypeKey,             QJsonValue::Double, true },
         { _jsonVehicleTypeKey,              QJsonValue::Double, false },
         { _jsonCruiseSpeedKey,              QJsonValue::Double, false },
@@ -723,7 +727,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
 
     setGlobalAltitudeMode(QGroundControlQmlGlobal::AltitudeModeMixed);
 
-    qCDebug(MissionControllerLog) << "MissionController::_loadJsonMissionFileV2 itemCount:" << json[_jsonItemsKey].toArray().count();
+    qCDebug(MissionControllerLog) << "MissionController::_loadJsonMissionFileV2 itemCount:" << json[jsonItemsKey].toArray().count();
 
     AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
 
@@ -768,8 +772,15 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
 
     // Read mission items
 
+    // Items are collected and added to the model in one go, on success as well as failure. This way a large
+    // plan doesn't pay for a model insert notification per item.
+    QList<QObject*> loadedItems;
+    auto appendLoadedItems = qScopeGuard([visualItems, &loadedItems]() {
+        visualItems->append(loadedItems);
+    });
+
     int nextSequenceNumber = 1; // Start with 1 since home is in 0
-    const QJsonArray rgMissionItems(json[_jsonItemsKey].toArray());
+    const QJsonArray rgMissionItems(json[jsonItemsKey].toArray());
     for (int i=0; i<rgMissionItems.count(); i++) {
         // Convert to QJsonObject
         const QJsonValue& itemValue = rgMissionItems[i];
@@ -801,7 +812,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 qCDebug(MissionControllerLog) << "Loading simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
                 nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
-                visualItems->append(simpleItem);
+                loadedItems.append(simpleItem);
             } else {
                 return false;
             }
@@ -822,7 +833,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = surveyItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Survey load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(surveyItem);
+                loadedItems.append(surveyItem);
             } else if (complexItemType == FixedWingLandingComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Fixed Wing Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
                 FixedWingLandingComplexItem* landingItem = new FixedWingLandingComplexItem(_masterController, _flyView);
@@ -831,7 +842,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "FW Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                loadedItems.append(landingItem);
             } else if (complexItemType == VTOLLandingComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading VTOL Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
                 VTOLLandingComplexItem* landingItem = new VTOLLandingComplexItem(_masterController, _flyView);
@@ -840,7 +851,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "VTOL Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                loadedItems.append(landingItem);
             } else if (complexItemType == StructureScanComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Structure Scan: nextSequenceNumber" << nextSequenceNumber;
                 StructureScanComplexItem* structureItem = new StructureScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
@@ -849,7 +860,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = structureItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Structure Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(structureItem);
+                loadedItems.append(structureItem);
             } else if (complexItemType == CorridorScanComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Corridor Scan: nextSequenceNumber" << nextSequenceNumber;
                 CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_masterController, _flyView, QString() /* kmlFile */);
@@ -858,7 +869,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = corridorItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Corridor Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(corridorItem);
+                loadedItems.append(corridorItem);
             } else {
                 errorString = tr("Unsupported complex item type: %1").arg(complexItemType);
             }
@@ -869,27 +880,22 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     }
 
     // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId
-    for (int i=0; i<visualItems->count(); i++) {
-        if (visualItems->value<VisualMissionItem*>(i)->isSimpleItem()) {
-            SimpleMissionItem* doJumpItem = visualItems->value<SimpleMissionItem*>(i);
-            if (doJumpItem->command() == MAV_CMD_DO_JUMP) {
-                bool found = false;
-                int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
-                for (int j=0; j<visualItems->count(); j++) {
-                    if (visualItems->value<VisualMissionItem*>(j)->isSimpleItem()) {
-                        SimpleMissionItem* targetItem = visualItems->value<SimpleMissionItem*>(j);
-                        if (targetItem->missionItem().doJumpId() == findDoJumpId) {
-                            doJumpItem->missionItem().setParam1(targetItem->sequenceNumber());
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-                if (!found) {
-                    errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
-                    return false;
-                }
+    QHash<int, int> doJumpIdToSequenceNumber;
+    for (QObject* loadedItem: loadedItems) {
+        SimpleMissionItem* targetItem = qobject_cast<SimpleMissionItem*>(loadedItem);
+        if (targetItem && !doJumpIdToSequenceNumber.contains(targetItem->missionItem().doJumpId())) {
+            doJumpIdToSequenceNumber[targetItem->missionItem().doJumpId()] = targetItem->sequenceNumber();
+        }
+    }
+    for (QObject* loadedItem: loadedItems) {
+        SimpleMissionItem* doJumpItem = qobject_cast<SimpleMissionItem*>(loadedItem);
+        if (doJumpItem && doJumpItem->command() == MAV_CMD_DO_JUMP) {
+            const int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
+            if (!doJumpIdToSequenceNumber.contains(findDoJumpId)) {
+                errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
+                return false;
             }
+            doJumpItem->missionItem().setParam1(doJumpIdToSequenceNumber[findDoJumpId]);
         }
     }
 
@@ -1015,7 +1021,13 @@ bool MissionController::load(const QJsonObject& json, QString& errorString)
     QString errorMessage = tr("Mission: %1");
     QmlObjectListModel* loadedVisualItems = new QmlObjectListModel(this);
 
-    if (!_loadJsonMissionFileV2(json, loadedVisualItems, errorStr)) {
+    bool success;
+    {
+        QScopedValueRollback<bool> loadingItems(_loadingItems, true);
+        const QSignalBlocker blocker(loadedVisualItems);
+        success = _loadJsonMissionFileV2(json, loadedVisualItems, errorStr);
+    }
+    if (!success) {
         errorString = errorMessage.arg(errorStr);
         return false;
     }
@@ -1038,7 +1050,13 @@ bool MissionController::loadJsonFile(QFile& file, QString& errorString)
 
     QJsonObject json = jsonDoc.object();
     QmlObjectListModel* loadedVisualItems = new QmlObjectListModel(this);
-    if (!_loadItemsFromJson(json, loadedVisualItems, errorStr)) {
+    bool success;
+    {
+        QScopedValueRollback<bool> loadingItems(_loadingItems, true);
+        const QSignalBlocker blocker(loadedVisualItems);
+        success = _loadItemsFromJson(json, loadedVisualItems, errorStr);
+    }
+    if (!success) {
         errorString = errorMessage.arg(errorStr);
         return false;
     }
@@ -1058,7 +1076,13 @@ bool MissionController::loadTextFile(QFile& file, QString& errorString)
     setGlobalAltitudeMode(QGroundControlQmlGlobal::AltitudeModeMixed);
 
     QmlObjectListModel* loadedVisualItems = new QmlObjectListModel(this);
-    if (!_loadTextMissionFile(stream, loadedVisualItems, errorStr)) {
+    bool success;
+    {
+        QScopedValueRollback<bool> loadingItems(_loadingItems, true);
+        const QSignalBlocker blocker(loadedVisualItems);
+        success = _loadTextMissionFile(stream, loadedVisualItems, errorStr);
+    }
+    if (!success) {
         errorString = errorMessage.arg(errorStr);
         return false;
     }
@@ -1080,7 +1104,7 @@ int MissionController::readyForSaveState(void) const
     return VisualMissionItem::ReadyForSave;
 }
 
-void MissionController::save(QJsonObject& json)
+bool MissionController::saveHeader(QJsonObject& json)
 {
     json[JsonHelper::jsonVersionKey] = _missionFileVersion;
 
@@ -1089,7 +1113,7 @@ void MissionController::save(QJsonObject& json)
     MissionSettingsItem* settingsItem = _visualItems->value<MissionSettingsItem*>(0);
     if (!settingsItem) {
         qWarning() << "First item is not MissionSettingsItem";
-        return;
+        return false;
     }
     QJsonValue coordinateValue;
     JsonHelper::saveGeoCoordinate(settingsItem->coordinate(), true /* writeAltitude */, coordinateValue);
@@ -1100,31 +1124,50 @@ void MissionController::save(QJsonObject& json)
     json[_jsonHoverSpeedKey]                = _controllerVehicle->defaultHoverSpeed();
     json[_jsonGlobalPlanAltitudeModeKey]    = _globalAltMode;
 
+    return true;
+}
+
+void MissionController::saveItems(const std::function<void(const QJsonObject&)>& writeItem)
+{
     // Save the visual items
 
-    QJsonArray rgJsonMissionItems;
     for (int i=0; i<_visualItems->count(); i++) {
         VisualMissionItem* visualItem = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
-        visualItem->save(rgJsonMissionItems);
+        // Items may save as more than one json object, so they go through a small array which is flushed per item
+        QJsonArray rgJsonItem;
+        visualItem->save(rgJsonItem);
+        for (const QJsonValue& itemValue: rgJsonItem) {
+            writeItem(itemValue.toObject());
+        }
     }
 
     // Mission settings has a special case for end mission action
-    if (settingsItem) {
-        QList<MissionItem*> rgMissionItems;
+    QList<MissionItem*> rgMissionItems;
 
-        if (_convertToMissionItems(_visualItems, rgMissionItems, this /* missionItemParent */)) {
-            QJsonObject saveObject;
-            MissionItem* missionItem = rgMissionItems[rgMissionItems.count() - 1];
-            missionItem->save(saveObject);
-            rgJsonMissionItems.append(saveObject);
-        }
-        for (int i=0; i<rgMissionItems.count(); i++) {
-            rgMissionItems[i]->deleteLater();
-        }
+    if (_convertToMissionItems(_visualItems, rgMissionItems, this /* missionItemParent */)) {
+        QJsonObject saveObject;
+        MissionItem* missionItem = rgMissionItems[rgMissionItems.count() - 1];
+        missionItem->save(saveObject);
+        writeItem(saveObject);
+    }
+    for (int i=0; i<rgMissionItems.count(); i++) {
+        rgMissionItems[i]->deleteLater();
     }
+}
 
-    json[_jsonItemsKey] = rgJsonMissionItems;
+void MissionController::save(QJsonObject& json)
+{
+    if (!saveHeader(json)) {
+        return;
+    }
+
+    QJsonArray rgJsonMissionItems;
+    saveItems([&rgJsonMissionItems](const QJsonObject& itemObject) {
+        rgJsonMissionItems.append(itemObject);
+    });
+
+    json[jsonItemsKey] = rgJsonMissionItems;
 }
 
 void MissionController::_calcPrevWaypointValues(VisualMissionItem* currentItem, VisualMissionItem* prevItem, double* azimuth, double* distance, double* altDifference)
@@ -1242,6 +1285,10 @@ void MissionController::_recalcROISpecialVisuals(void)
 
 void MissionController::_recalcFlightPathSegments(void)
 {
+    if (_loadingItems) {
+        return;
+    }
+
     VisualItemPair      lastSegmentVisualItemPair;
     int                 segmentCount =              0;
     bool                firstCoordinateNotFound =   true;
@@ -1511,7 +1558,7 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
 
 void MissionController::_recalcMissionFlightStatus()
 {
-    if (!_visualItems->count()) {
+    if (_loadingItems || !_visualItems->count()) {
         return;
     }
 
@@ -1865,6 +1912,10 @@ void MissionController::_setPlannedHomePositionFromFirstCoordinate(const QGeoCoo
 
 void MissionController::_recalcAllWithCoordinate(const QGeoCoordinate& coordinate)
 {
+    if (_loadingItems) {
+        // _initLoadedVisualItems does a single recalc once the new items are in place
+        return;
+    }
     if (!_flyView) {
         _setPlannedHomePositionFromFirstCoordinate(coordinate);
     }
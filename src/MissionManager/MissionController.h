@@ -13,6 +13,8 @@
 #include <QtCore/QFile>
 #include <QtCore/QLoggingCategory>
 
+#include <functional>
+
 #include "PlanElementController.h"
 #include "QmlObjectListModel.h"
 #include "QGCGeoBoundingCube.h"
@@ -199,6 +201,16 @@ public:
     bool loadJsonFile(QFile& file, QString& errorString);
     bool loadTextFile(QFile& file, QString& errorString);
 
+    /// Saves everything but the mission items. The items go under jsonItemsKey and are written separately using saveItems.
+    ///     @return false: mission could not be saved
+    bool saveHeader(QJsonObject& json);
+
+    /// Saves the mission items one json object at a time. This allows callers to stream large missions out without
+    /// building the complete json tree in memory.
+    void saveItems(const std::function<void(const QJsonObject&)>& writeItem);
+
+    static constexpr const char* jsonItemsKey = "items";
+
     QGCGeoBoundingCube* travelBoundingCube  () { return &_travelBoundingCube; }
     QGeoCoordinate      takeoffCoordinate   () { return _takeoffCoordinate; }
 
@@ -380,6 +392,7 @@ private:
     bool                        _firstItemsFromVehicle =        false;
     bool                        _itemsRequested =               false;
     bool                        _inRecalcSequence =             false;
+    bool                        _loadingItems =                 false;  ///< Recalcs are held off while a plan is being built
     MissionFlightStatus_t       _missionFlightStatus;
     AppSettings*                _appSettings =                  nullptr;
     double                      _progressPct =                  0;
@@ -407,7 +420,6 @@ private:
 
     static constexpr const char* _settingsGroup =                 "MissionController";
     static constexpr const char* _jsonFileTypeValue =             "Mission";
-    static constexpr const char* _jsonItemsKey =                  "items";
     static constexpr const char* _jsonPlannedHomePositionKey =    "plannedHomePosition";
     static constexpr const char* _jsonFirmwareTypeKey =           "firmwareType";
     static constexpr const char* _jsonVehicleTypeKey =            "vehicleType";
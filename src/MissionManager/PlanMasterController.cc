@@ -26,11 +26,36 @@
 #include "RallyPointManager.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
 
 QGC_LOGGING_CATEGORY(PlanMasterControllerLog, "PlanMasterControllerLog")
 
+namespace {
+    /// QJsonDocument only serializes objects and arrays. Scalars are written as a single element array with the
+    /// brackets stripped.
+    void writeJsonValue(QIODevice& device, const QJsonValue& value)
+    {
+        if (value.isObject()) {
+            (void) device.write(QJsonDocument(value.toObject()).toJson().trimmed());
+        } else if (value.isArray()) {
+            (void) device.write(QJsonDocument(value.toArray()).toJson().trimmed());
+        } else {
+            const QByteArray bytes = QJsonDocument(QJsonArray({ value })).toJson(QJsonDocument::Compact);
+            (void) device.write(bytes.mid(1, bytes.length() - 2));
+        }
+    }
+
+    void writeJsonKey(QIODevice& device, const QString& key)
+    {
+        writeJsonValue(device, QJsonValue(key));
+        (void) device.write(":");
+    }
+}
+
 PlanMasterController::PlanMasterController(QObject* parent)
     : QObject               (parent)
     , _multiVehicleMgr      (qgcApp()->toolbox()->multiVehicleManager())
@@ -73,6 +98,8 @@ void PlanMasterController::_commonInit(void)
 
     // Offline vehicle can change firmware/vehicle type
     connect(_controllerVehicle,     &Vehicle::vehicleTypeChanged,                   this, &PlanMasterController::_updatePlanCreatorsList);
+
+    connect(&_planFileReadWatcher,  &QFutureWatcher<PlanFileRead_t>::finished,      this, &PlanMasterController::_planFileReadFinished);
 }
 
 
@@ -327,6 +354,33 @@ void PlanMasterController::sendToVehicle(void)
     }
 }
 
+bool PlanMasterController::_isPlanJsonFile(const QString& filename)
+{
+    const QString suffix = QFileInfo(filename).suffix();
+    return (suffix != AppSettings::missionFileExtension) && (suffix != AppSettings::waypointsFileExtension) && (suffix != QStringLiteral("txt"));
+}
+
+PlanMasterController::PlanFileRead_t PlanMasterController::_readPlanFile(const QString& filename)
+{
+    PlanFileRead_t planFileRead;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        planFileRead.errorString = file.errorString() + QStringLiteral(" ") + filename;
+        return planFileRead;
+    }
+
+    QJsonDocument jsonDoc;
+    if (!JsonHelper::isJsonFile(file.readAll(), jsonDoc, planFileRead.errorString)) {
+        return planFileRead;
+    }
+
+    planFileRead.json = jsonDoc.object();
+    planFileRead.success = true;
+
+    return planFileRead;
+}
+
 void PlanMasterController::loadFromFile(const QString& filename)
 {
     QString errorString;
@@ -336,6 +390,16 @@ void PlanMasterController::loadFromFile(const QString& filename)
         return;
     }
 
+    if (_isPlanJsonFile(filename)) {
+        const PlanFileRead_t planFileRead = _readPlanFile(filename);
+        if (!planFileRead.success) {
+            qgcApp()->showAppMessage(errorMessage.arg(planFileRead.errorString));
+            return;
+        }
+        _loadPlanJson(filename, planFileRead.json);
+        return;
+    }
+
     QFileInfo fileInfo(filename);
     QFile file(filename);
 
@@ -352,53 +416,103 @@ void PlanMasterController::loadFromFile(const QString& filename)
         } else {
             success = true;
         }
-    } else if (fileInfo.suffix() == AppSettings::waypointsFileExtension || fileInfo.suffix() == QStringLiteral("txt")) {
+    } else {
         if (!_missionController.loadTextFile(file, errorString)) {
             qgcApp()->showAppMessage(errorMessage.arg(errorString));
         } else {
             success = true;
         }
+    }
+
+    _loadFromFileComplete(filename, success);
+}
+
+void PlanMasterController::loadFromFileAsync(const QString& filename)
+{
+    if (filename.isEmpty()) {
+        return;
+    }
+
+    if (!_isPlanJsonFile(filename)) {
+        // Legacy formats are small, not worth the thread hop
+        loadFromFile(filename);
+        emit loadFromFileAsyncComplete();
+        return;
+    }
+
+    qCDebug(PlanMasterControllerLog) << "loadFromFileAsync" << filename;
+
+    // A new load replaces any load which is still in progress
+    _loadAsyncFilename = filename;
+    _setLoadInProgress(true);
+    _planFileReadWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_readPlanFile, filename));
+}
+
+void PlanMasterController::_planFileReadFinished(void)
+{
+    const PlanFileRead_t planFileRead = _planFileReadWatcher.result();
+
+    if (planFileRead.success) {
+        _loadPlanJson(_loadAsyncFilename, planFileRead.json);
     } else {
-        QJsonDocument   jsonDoc;
-        QByteArray      bytes = file.readAll();
+        qgcApp()->showAppMessage(tr("Error loading Plan file (%1). %2").arg(_loadAsyncFilename, planFileRead.errorString));
+    }
 
-        if (!JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
+    _setLoadInProgress(false);
+    emit loadFromFileAsyncComplete();
+}
 
-        QJsonObject json = jsonDoc.object();
-        //-- Allow plugins to pre process the load
-        qgcApp()->toolbox()->corePlugin()->preLoadFromJson(this, json);
+void PlanMasterController::_setLoadInProgress(bool loadInProgress)
+{
+    if (loadInProgress != _loadInProgress) {
+        _loadInProgress = loadInProgress;
+        emit loadInProgressChanged(_loadInProgress);
+    }
+}
 
-        int version;
-        if (!JsonHelper::validateExternalQGCJsonFile(json, kPlanFileType, kPlanFileVersion, kPlanFileVersion, version, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
+/// Creates the plan from an already parsed plan file. Must be called on the gui thread.
+void PlanMasterController::_loadPlanJson(const QString& filename, QJsonObject json)
+{
+    QString errorString;
+    QString errorMessage = tr("Error loading Plan file (%1). %2").arg(filename).arg("%1");
 
-        QList<JsonHelper::KeyValidateInfo> rgKeyInfo = {
-            { kJsonMissionObjectKey,        QJsonValue::Object, true },
-            { kJsonGeoFenceObjectKey,       QJsonValue::Object, true },
-            { kJsonRallyPointsObjectKey,    QJsonValue::Object, true },
-        };
-        if (!JsonHelper::validateKeys(json, rgKeyInfo, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
+    //-- Allow plugins to pre process the load
+    qgcApp()->toolbox()->corePlugin()->preLoadFromJson(this, json);
 
-        if (!_missionController.load(json[kJsonMissionObjectKey].toObject(), errorString) ||
-                !_geoFenceController.load(json[kJsonGeoFenceObjectKey].toObject(), errorString) ||
-                !_rallyPointController.load(json[kJsonRallyPointsObjectKey].toObject(), errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-        } else {
-            //-- Allow plugins to post process the load
-            qgcApp()->toolbox()->corePlugin()->postLoadFromJson(this, json);
-            success = true;
-        }
+    int version;
+    if (!JsonHelper::validateExternalQGCJsonFile(json, kPlanFileType, kPlanFileVersion, kPlanFileVersion, version, errorString)) {
+        qgcApp()->showAppMessage(errorMessage.arg(errorString));
+        return;
     }
 
+    QList<JsonHelper::KeyValidateInfo> rgKeyInfo = {
+        { kJsonMissionObjectKey,        QJsonValue::Object, true },
+        { kJsonGeoFenceObjectKey,       QJsonValue::Object, true },
+        { kJsonRallyPointsObjectKey,    QJsonValue::Object, true },
+    };
+    if (!JsonHelper::validateKeys(json, rgKeyInfo, errorString)) {
+        qgcApp()->showAppMessage(errorMessage.arg(errorString));
+        return;
+    }
+
+    bool success = false;
+    if (!_missionController.load(json[kJsonMissionObjectKey].toObject(), errorString) ||
+            !_geoFenceController.load(json[kJsonGeoFenceObjectKey].toObject(), errorString) ||
+            !_rallyPointController.load(json[kJsonRallyPointsObjectKey].toObject(), errorString)) {
+        qgcApp()->showAppMessage(errorMessage.arg(errorString));
+    } else {
+        //-- Allow plugins to post process the load
+        qgcApp()->toolbox()->corePlugin()->postLoadFromJson(this, json);
+        success = true;
+    }
+
+    _loadFromFileComplete(filename, success);
+}
+
+void PlanMasterController::_loadFromFileComplete(const QString& filename, bool success)
+{
     if(success){
+        QFileInfo fileInfo(filename);
         _currentPlanFile = QString::asprintf("%s/%s.%s", fileInfo.path().toLocal8Bit().data(), fileInfo.completeBaseName().toLocal8Bit().data(), AppSettings::planFileExtension);
     } else {
         _currentPlanFile.clear();
@@ -432,6 +546,84 @@ QJsonDocument PlanMasterController::saveToJson()
     return QJsonDocument(planJson);
 }
 
+/// Writes the same plan as saveToJson, but the mission items are streamed straight to the device one at a time
+/// instead of first being collected into a single json tree. Falls back to saveToJson if the core plugin doesn't
+/// stream plan file saves.
+void PlanMasterController::_writePlanFile(QIODevice& device)
+{
+    // The post save hooks of custom builds get to see the mission items
+    if (!qgcApp()->toolbox()->corePlugin()->streamPlanFileSaves()) {
+        (void) device.write(saveToJson().toJson());
+        return;
+    }
+
+    QJsonObject planJson;
+    qgcApp()->toolbox()->corePlugin()->preSaveToJson(this, planJson);
+    QJsonObject missionJson;
+    QJsonObject fenceJson;
+    QJsonObject rallyJson;
+    JsonHelper::saveQGCJsonFileHeader(planJson, kPlanFileType, kPlanFileVersion);
+    //-- Allow plugin to preemptly add its own keys to mission
+    qgcApp()->toolbox()->corePlugin()->preSaveToMissionJson(this, missionJson);
+    const bool saveMissionItems = _missionController.saveHeader(missionJson);
+    //-- Allow plugin to add its own keys to mission. Note that mission items are not part of the json at this point.
+    qgcApp()->toolbox()->corePlugin()->postSaveToMissionJson(this, missionJson);
+    _geoFenceController.save(fenceJson);
+    _rallyPointController.save(rallyJson);
+    planJson[kJsonMissionObjectKey] = missionJson;
+    planJson[kJsonGeoFenceObjectKey] = fenceJson;
+    planJson[kJsonRallyPointsObjectKey] = rallyJson;
+    qgcApp()->toolbox()->corePlugin()->postSaveToJson(this, planJson);
+
+    // Keys are written in sorted order to match QJsonDocument output
+    (void) device.write("{\n");
+    bool firstPlanKey = true;
+    for (auto planIt = planJson.constBegin(); planIt != planJson.constEnd(); planIt++) {
+        (void) device.write(firstPlanKey ? "" : ",\n");
+        firstPlanKey = false;
+        writeJsonKey(device, planIt.key());
+
+        if (planIt.key() != QLatin1String(kJsonMissionObjectKey)) {
+            writeJsonValue(device, planIt.value());
+            continue;
+        }
+
+        const QJsonObject mission = planIt.value().toObject();
+        bool itemsWritten = !saveMissionItems;
+        bool firstMissionKey = true;
+        auto writeMissionItems = [this, &device, &firstMissionKey]() {
+            (void) device.write(firstMissionKey ? "" : ",\n");
+            firstMissionKey = false;
+            writeJsonKey(device, MissionController::jsonItemsKey);
+            (void) device.write("[\n");
+            bool firstItem = true;
+            _missionController.saveItems([&device, &firstItem](const QJsonObject& itemObject) {
+                (void) device.write(firstItem ? "" : ",\n");
+                firstItem = false;
+                writeJsonValue(device, itemObject);
+            });
+            (void) device.write("\n]");
+        };
+
+        (void) device.write("{\n");
+        for (auto missionIt = mission.constBegin(); missionIt != mission.constEnd(); missionIt++) {
+            if (!itemsWritten && (missionIt.key() > QLatin1String(MissionController::jsonItemsKey))) {
+                writeMissionItems();
+                itemsWritten = true;
+            }
+            (void) device.write(firstMissionKey ? "" : ",\n");
+            firstMissionKey = false;
+            writeJsonKey(device, missionIt.key());
+            writeJsonValue(device, missionIt.value());
+        }
+        if (!itemsWritten) {
+            writeMissionItems();
+        }
+        (void) device.write("\n}");
+    }
+    (void) device.write("\n}\n");
+}
+
 void
 PlanMasterController::saveToCurrent()
 {
@@ -451,15 +643,20 @@ void PlanMasterController::saveToFile(const QString& filename)
         planFilename += QString(".%1").arg(fileExtension());
     }
 
-    QFile file(planFilename);
+    QSaveFile file(planFilename);
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    bool saved = false;
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        // QSaveFile keeps track of write errors, commit will fail and leave any previous file intact
+        _writePlanFile(file);
+        saved = file.commit();
+    }
+
+    if (!saved) {
         qgcApp()->showAppMessage(tr("Plan save error %1 : %2").arg(filename).arg(file.errorString()));
         _currentPlanFile.clear();
         emit currentPlanFileChanged();
     } else {
-        QJsonDocument saveDoc = saveToJson();
-        file.write(saveDoc.toJson());
         if(_currentPlanFile != planFilename) {
             _currentPlanFile = planFilename;
             emit currentPlanFileChanged();
@@ -11,6 +11,8 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QJsonObject>
 
 #include "MissionController.h"
 #include "GeoFenceController.h"
@@ -18,6 +20,7 @@
 
 Q_DECLARE_LOGGING_CATEGORY(PlanMasterControllerLog)
 
+class QIODevice;
 class QmlObjectListModel;
 class MultiVehicleManager;
 class Vehicle;
@@ -48,6 +51,7 @@ public:
     Q_PROPERTY(bool                     containsItems           READ containsItems                          NOTIFY containsItemsChanged)    ///< true: Elemement is non-empty
     Q_PROPERTY(bool                     syncInProgress          READ syncInProgress                         NOTIFY syncInProgressChanged)   ///< true: Information is currently being saved/sent, false: no active save/send in progress
     Q_PROPERTY(bool                     dirty                   READ dirty                  WRITE setDirty  NOTIFY dirtyChanged)            ///< true: Unsaved/sent changes are present, false: no changes since last save/send
+    Q_PROPERTY(bool                     loadInProgress          READ loadInProgress                         NOTIFY loadInProgressChanged)   ///< true: loadFromFileAsync is reading the plan file
     Q_PROPERTY(QString                  fileExtension           READ fileExtension                          CONSTANT)                       ///< File extension for missions
     Q_PROPERTY(QString                  kmlFileExtension        READ kmlFileExtension                       CONSTANT)
     Q_PROPERTY(QString                  currentPlanFile         READ currentPlanFile                        NOTIFY currentPlanFileChanged)
@@ -78,6 +82,10 @@ public:
     Q_INVOKABLE void loadFromVehicle(void);
     Q_INVOKABLE void sendToVehicle(void);
     Q_INVOKABLE void loadFromFile(const QString& filename);
+
+    /// Same as loadFromFile, but the file is read and parsed on a worker thread. Items are still created on the
+    /// gui thread once parsing completes. Signals loadFromFileAsyncComplete when done, successful or not.
+    Q_INVOKABLE void loadFromFileAsync(const QString& filename);
     Q_INVOKABLE void saveToCurrent();
     Q_INVOKABLE void saveToFile(const QString& filename);
     Q_INVOKABLE void saveToKml(const QString& filename);
@@ -92,6 +100,7 @@ public:
     bool        containsItems   (void) const;
     bool        syncInProgress  (void) const;
     bool        dirty           (void) const;
+    bool        loadInProgress  (void) const { return _loadInProgress; }
     void        setDirty        (bool dirty);
     QString     fileExtension   (void) const;
     QString     kmlFileExtension(void) const;
@@ -119,6 +128,8 @@ signals:
     void dirtyChanged                       (bool dirty);
     void offlineChanged                     (bool offlineEditing);
     void currentPlanFileChanged             (void);
+    void loadInProgressChanged              (bool loadInProgress);
+    void loadFromFileAsyncComplete          (void);
     void planCreatorsChanged                (QmlObjectListModel* planCreators);
     void managerVehicleChanged              (Vehicle* managerVehicle);
     void promptForPlanUsageOnVehicleChange  (void);
@@ -132,10 +143,25 @@ private slots:
     void _sendGeoFenceComplete      (void);
     void _sendRallyPointsComplete   (void);
     void _updatePlanCreatorsList    (void);
+    void _planFileReadFinished      (void);
 
 private:
+    struct PlanFileRead_t {
+        bool        success = false;
+        QJsonObject json;
+        QString     errorString;
+    };
+
     void _commonInit                (void);
     void _showPlanFromManagerVehicle(void);
+    void _loadPlanJson              (const QString& filename, QJsonObject json);
+    void _loadFromFileComplete      (const QString& filename, bool success);
+    void _setLoadInProgress         (bool loadInProgress);
+    void _writePlanFile             (QIODevice& device);
+
+    /// Reads and parses a plan file. Thread safe.
+    static PlanFileRead_t _readPlanFile(const QString& filename);
+    static bool _isPlanJsonFile     (const QString& filename);
 
     MultiVehicleManager*    _multiVehicleMgr =          nullptr;
     Vehicle*                _controllerVehicle =        nullptr;    ///< Offline controller vehicle
@@ -152,4 +178,7 @@ private:
     QString                 _currentPlanFile;
     bool                    _deleteWhenSendCompleted =  false;
     QmlObjectListModel*     _planCreators =             nullptr;
+    bool                    _loadInProgress =           false;
+    QString                 _loadAsyncFilename;
+    QFutureWatcher<PlanFileRead_t> _planFileReadWatcher;
 };
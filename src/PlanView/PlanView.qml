@@ -167,6 +167,11 @@ Item {
             _missionController.setCurrentPlanViewSeqNum(0, true)
         }
 
+        onLoadFromFileAsyncComplete: {
+            fitViewportToItems()
+            _missionController.setCurrentPlanViewSeqNum(0, true)
+        }
+
         onPromptForPlanUsageOnVehicleChange: {
             if (!_promptForPlanUsageShowing) {
                 _promptForPlanUsageShowing = true
@@ -319,9 +324,7 @@ Item {
         }
 
         onAcceptedForLoad: (file) => {
-            _planMasterController.loadFromFile(file)
-            _planMasterController.fitViewportToItems()
-            _missionController.setCurrentPlanViewSeqNum(0, true)
+            _planMasterController.loadFromFileAsync(file)
             close()
         }
     }
@@ -69,6 +69,8 @@
 #include "QGCMapCircle.h"
 #include "ParameterManager.h"
 #include "SettingsManager.h"
+#include "SettingsStore.h"
+#include "AppSettings.h"
 #include "QGCCorePlugin.h"
 #include "QGCCameraManager.h"
 #include "CameraCalc.h"
@@ -88,6 +90,7 @@
 #include "RCToParamDialogController.h"
 #include "QGCImageProvider.h"
 #include "TerrainProfile.h"
+#include "TilePrefetchController.h"
 #include "ToolStripAction.h"
 #include "ToolStripActionList.h"
 #include "VehicleLinkManager.h"
@@ -97,6 +100,7 @@
 #include "CustomActionManager.h"
 #include "AudioOutput.h"
 #include "FollowMe.h"
+#include "TerrainDEMDatabase.h"
 #include "JsonHelper.h"
 // #ifdef QGC_VIEWER3D
 #include "Viewer3DManager.h"
@@ -244,6 +248,10 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     // We need to set language as early as possible prior to loading on JSON files.
     setLanguage();
 
+    // From here on settings facts read and write through the in memory store. Anything above which clears or
+    // upgrades settings must be done by then.
+    SettingsStore::instance()->load();
+
     _toolbox = new QGCToolbox(this);
     _toolbox->setChildToolboxes();
 
@@ -335,6 +343,7 @@ void QGCApplication::init()
     qmlRegisterType<RCToParamDialogController>       ("QGroundControl.Controllers",           1, 0, "RCToParamDialogController");
     qmlRegisterType<ScreenToolsController>           ("QGroundControl.Controllers",           1, 0, "ScreenToolsController");
     qmlRegisterType<TerrainProfile>                  ("QGroundControl.Controls",              1, 0, "TerrainProfile");
+    qmlRegisterType<TilePrefetchController>          ("QGroundControl.FlightMap",             1, 0, "TilePrefetchController");
     qmlRegisterType<ToolStripAction>                 ("QGroundControl.Controls",              1, 0, "ToolStripAction");
     qmlRegisterType<ToolStripActionList>             ("QGroundControl.Controls",              1, 0, "ToolStripActionList");
     qmlRegisterSingletonType<QGroundControlQmlGlobal>("QGroundControl",                       1, 0, "QGroundControl",         qgroundcontrolQmlGlobalSingletonFactory);
@@ -420,6 +429,12 @@ void QGCApplication::_initForNormalAppBoot()
     AudioOutput::instance()->init(_toolbox->settingsManager()->appSettings()->audioMuted());
     FollowMe::instance()->init();
 
+    AppSettings* const appSettings = _toolbox->settingsManager()->appSettings();
+    TerrainDEMDatabase::instance()->setDirectory(appSettings->terrainSavePath());
+    (void) connect(appSettings, &AppSettings::savePathsChanged, this, [appSettings]() {
+        TerrainDEMDatabase::instance()->setDirectory(appSettings->terrainSavePath());
+    });
+
     // Image provider for Optical Flow
     _qmlAppEngine->addImageProvider(qgcImageProviderId, new QGCImageProvider());
 
@@ -879,6 +894,7 @@ QGCImageProvider* QGCApplication::qgcImageProvider()
 void QGCApplication::shutdown()
 {
     qCDebug(QGCApplicationLog) << "Exit";
+    SettingsStore::instance()->flush();
     // This is bad, but currently qobject inheritances are incorrect and cause crashes on exit without
     delete _qmlAppEngine;
 }
@@ -17,9 +17,13 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
-#include <QtCore/QStringListModel>
 #include <QtConcurrent/QtConcurrent>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
 
 Q_GLOBAL_STATIC(AppLogModel, debug_model)
 
@@ -54,27 +58,182 @@ AppLogModel *AppMessages::getModel()
     return debug_model;
 }
 
-AppLogModel::AppLogModel() : QStringListModel()
+/// Writes log lines to a file from a background thread. Lines are written in batches and the file is rotated once it
+/// reaches _maxFileSize, keeping _maxRotatedFiles older files next to it as <name>.1.log, <name>.2.log, ...
+class AppLogFileWriter : public QThread
 {
-#ifdef __mobile__
-    Qt::ConnectionType contype = Qt::QueuedConnection;
-#else
-    Qt::ConnectionType contype = Qt::AutoConnection;
-#endif
-    connect(this, &AppLogModel::emitLog, this, &AppLogModel::threadsafeLog, contype);
+public:
+    AppLogFileWriter(const QString& filePath)
+        : _filePath(filePath)
+    {
+
+    }
+
+    ~AppLogFileWriter()
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            _stop = true;
+        }
+        _wake.wakeOne();
+        (void) wait();
+    }
+
+    /// Opens the file, rotating out the one from the previous run. Must be called before start().
+    bool open()
+    {
+        if (QFileInfo(_filePath).size() > 0) {
+            _rotate();
+        }
+        _file.setFileName(_filePath);
+        return _file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+    }
+
+    QString errorString() const { return _file.errorString(); }
+
+    void enqueue(const QString& line)
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            if (_failed) {
+                return;
+            }
+            _queue.append(line);
+        }
+        _wake.wakeOne();
+    }
+
+    void enqueue(const QStringList& lines)
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            if (_failed) {
+                return;
+            }
+            _queue.append(lines);
+        }
+        _wake.wakeOne();
+    }
+
+protected:
+    void run() final
+    {
+        QByteArray buffer;
+
+        forever {
+            QStringList lines;
+            bool stop;
+            {
+                QMutexLocker lock(&_mutex);
+                while (_queue.isEmpty() && !_stop) {
+                    (void) _wake.wait(&_mutex);
+                }
+                lines.swap(_queue);
+                stop = _stop;
+            }
+
+            buffer.clear();
+            for (const QString& line: lines) {
+                buffer.append(line.toUtf8());
+                buffer.append('\n');
+            }
+            if (!buffer.isEmpty()) {
+                (void) _file.write(buffer);
+                (void) _file.flush();
+                if (_file.size() >= _maxFileSize) {
+                    _file.close();
+                    _rotate();
+                    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+                        {
+                            QMutexLocker lock(&_mutex);
+                            _failed = true;
+                            _queue.clear();
+                        }
+                        // Outside of the lock since this logs as well, the line itself is dropped
+                        qWarning() << "Reopening console log output file after rotation failed, no further lines are written:" << _filePath << _file.errorString();
+                        return;
+                    }
+                }
+            }
+
+            if (stop) {
+                break;
+            }
+        }
+
+        _file.close();
+    }
+
+private:
+    QString _rotatedFilePath(int index) const
+    {
+        const QFileInfo info(_filePath);
+        return info.dir().absoluteFilePath(QStringLiteral("%1.%2.%3").arg(info.completeBaseName()).arg(index).arg(info.suffix()));
+    }
+
+    void _rotate()
+    {
+        (void) QFile::remove(_rotatedFilePath(_maxRotatedFiles));
+        for (int i = _maxRotatedFiles - 1; i > 0; i--) {
+            (void) QFile::rename(_rotatedFilePath(i), _rotatedFilePath(i + 1));
+        }
+        (void) QFile::rename(_filePath, _rotatedFilePath(1));
+    }
+
+    const QString   _filePath;
+    QFile           _file;
+    QMutex          _mutex;
+    QWaitCondition  _wake;
+    QStringList     _queue;     ///< Protected by _mutex
+    bool            _stop = false;
+    bool            _failed = false;    ///< The file could not be reopened after rotation, lines are dropped. Protected by _mutex
+
+    static constexpr qint64 _maxFileSize = 10 * 1024 * 1024;
+    static constexpr int _maxRotatedFiles = 5;
+};
+
+AppLogModel::AppLogModel() : QAbstractListModel()
+{
+    _lines.resize(_maxLines);
+}
+
+AppLogModel::~AppLogModel()
+{
+    delete _fileWriter;
+}
+
+int AppLogModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _count;
+}
+
+QVariant AppLogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (index.row() >= _count) || ((role != Qt::DisplayRole) && (role != Qt::EditRole))) {
+        return QVariant();
+    }
+    return _line(index.row());
 }
 
 void AppLogModel::writeMessages(const QString dest_file)
 {
-    const QString writebuffer(stringList().join('\n').append('\n'));
+    // Copying the ring only copies string references, the lines are streamed out on the worker thread
+    QStringList lines;
+    lines.reserve(_count);
+    for (int row = 0; row < _count; row++) {
+        lines.append(_line(row));
+    }
 
-    QFuture<void> future = QtConcurrent::run([dest_file, writebuffer] {
+    QFuture<void> future = QtConcurrent::run([dest_file, lines] {
         emit debug_model->writeStarted();
         bool success = false;
         QFile file(dest_file);
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&file);
-            out << writebuffer;
+            for (const QString& line: lines) {
+                out << line << '\n';
+            }
+            out.flush();
             success = out.status() == QTextStream::Ok;
         } else {
             qWarning() << "AppLogModel::writeMessages write failed:" << file.errorString();
@@ -85,34 +244,116 @@ void AppLogModel::writeMessages(const QString dest_file)
 
 void AppLogModel::log(const QString message)
 {
-    emit debug_model->emitLog(message);
+    debug_model->_queue(message);
 }
 
-void AppLogModel::threadsafeLog(const QString message)
+void AppLogModel::_queue(const QString& message)
 {
-    const int line = rowCount();
-    insertRows(line, 1);
-    setData(index(line), message, Qt::DisplayRole);
-
-    if (qgcApp() && qgcApp()->logOutput() && _logFile.fileName().isEmpty()) {
-        qDebug() << _logFile.fileName().isEmpty() << qgcApp()->logOutput();
-        QGCToolbox* toolbox = qgcApp()->toolbox();
-        // Be careful of toolbox not being open yet
-        if (toolbox) {
-            QString saveDirPath = qgcApp()->toolbox()->settingsManager()->appSettings()->crashSavePath();
-            QDir saveDir(saveDirPath);
-            QString saveFilePath = saveDir.absoluteFilePath(QStringLiteral("QGCConsole.log"));
-
-            _logFile.setFileName(saveFilePath);
-            if (!_logFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                qgcApp()->showAppMessage(tr("Open console log output file failed %1 : %2").arg(_logFile.fileName()).arg(_logFile.errorString()));
-            }
+    bool scheduleFlush = false;
+    {
+        QMutexLocker lock(&_pendingMutex);
+        // The log file gets every message, only the model is limited
+        if (_fileWriter) {
+            _fileWriter->enqueue(message);
+        } else if (!_fileWriterDone) {
+            _pendingFile.append(message);
+        }
+        // Anything beyond the ring would be dropped by the model anyway, this keeps a stalled gui thread bounded too
+        if (_pending.count() >= _maxLines) {
+            _pending.removeFirst();
+        }
+        _pending.append(message);
+        // Messages logged before the application object exists are picked up by the first flush after it does
+        if (!_flushScheduled && QCoreApplication::instance()) {
+            _flushScheduled = true;
+            scheduleFlush = true;
         }
     }
 
-    if (_logFile.isOpen()) {
-        QTextStream out(&_logFile);
-        out << message << "\n";
-        _logFile.flush();
+    if (scheduleFlush) {
+        (void) QMetaObject::invokeMethod(this, &AppLogModel::_flushPending, Qt::QueuedConnection);
+    }
+}
+
+void AppLogModel::_flushPending()
+{
+    QStringList pending;
+    bool openLogFile;
+    {
+        QMutexLocker lock(&_pendingMutex);
+        pending.swap(_pending);
+        _flushScheduled = false;
+        openLogFile = !_fileWriterDone;
     }
+
+    if (openLogFile && qgcApp()) {
+        _openLogFile();
+    }
+
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    const int overflow = _count + pending.count() - _maxLines;
+    if (overflow > 0) {
+        // Drop the oldest rows to make room
+        const int removeCount = qMin(overflow, _count);
+        if (removeCount > 0) {
+            beginRemoveRows(QModelIndex(), 0, removeCount - 1);
+            _first = (_first + removeCount) % _maxLines;
+            _count -= removeCount;
+            endRemoveRows();
+        }
+        if (pending.count() > _maxLines) {
+            pending = pending.mid(pending.count() - _maxLines);
+        }
+    }
+
+    beginInsertRows(QModelIndex(), _count, _count + pending.count() - 1);
+    for (const QString& message: pending) {
+        _lines[(_first + _count) % _maxLines] = message;
+        _count++;
+    }
+    endInsertRows();
+}
+
+void AppLogModel::_openLogFile()
+{
+    if (!qgcApp()->logOutput()) {
+        QMutexLocker lock(&_pendingMutex);
+        _fileWriterDone = true;
+        _pendingFile.clear();
+        return;
+    }
+
+    QGCToolbox* toolbox = qgcApp()->toolbox();
+    // Be careful of toolbox not being open yet
+    if (!toolbox) {
+        return;
+    }
+
+    QString saveDirPath = toolbox->settingsManager()->appSettings()->crashSavePath();
+    QDir saveDir(saveDirPath);
+    QString saveFilePath = saveDir.absoluteFilePath(QStringLiteral("QGCConsole.log"));
+
+    AppLogFileWriter* fileWriter = new AppLogFileWriter(saveFilePath);
+    if (!fileWriter->open()) {
+        {
+            QMutexLocker lock(&_pendingMutex);
+            _fileWriterDone = true;
+            _pendingFile.clear();
+        }
+        // Outside of the lock since this logs as well
+        qgcApp()->showAppMessage(tr("Open console log output file failed %1 : %2").arg(saveFilePath).arg(fileWriter->errorString()));
+        delete fileWriter;
+        return;
+    }
+
+    fileWriter->start(QThread::LowPriority);
+
+    QMutexLocker lock(&_pendingMutex);
+    fileWriter->enqueue(_pendingFile);
+    _pendingFile.clear();
+    _fileWriter = fileWriter;
+    _fileWriterDone = true;
 }
@@ -10,31 +10,60 @@
 
 #pragma once
 
-#include <QtCore/QStringListModel>
-#include <QtCore/QFile>
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
 
 // Hackish way to force only this translation unit to have public ctor access
 #ifndef _LOG_CTOR_ACCESS_
 #define _LOG_CTOR_ACCESS_ private
 #endif
 
-class AppLogModel : public QStringListModel
+class AppLogFileWriter;
+
+/// Application log shown in the console page.
+///
+/// Messages can be logged from any thread. They are queued and appended to the model in one batch per event loop
+/// tick, into a ring which keeps the last _maxLines messages. The --log-output file is written by a background thread
+/// which is handed every message as it is logged, so only the model is limited.
+class AppLogModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
+    ~AppLogModel();
+
     Q_INVOKABLE void writeMessages(const QString dest_file);
     static void log(const QString message);
 
+    // Overrides from QAbstractListModel
+    int         rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant    data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
 signals:
-    void emitLog(const QString message);
     void writeStarted();
     void writeFinished(bool success);
 
 private slots:
-    void threadsafeLog(const QString message);
+    void _flushPending();
 
 private:
-    QFile _logFile;
+    void _queue(const QString& message);
+    void _openLogFile();
+    const QString& _line(int row) const { return _lines[(_first + row) % _maxLines]; }
+
+    QMutex              _pendingMutex;
+    QStringList         _pending;                   ///< Messages not yet added to the model, protected by _pendingMutex
+    bool                _flushScheduled = false;    ///< Protected by _pendingMutex
+    QStringList         _pendingFile;               ///< Messages logged before the log file is open, protected by _pendingMutex
+
+    QStringList         _lines;                     ///< Ring of _maxLines entries
+    int                 _first = 0;                 ///< Ring index of row 0
+    int                 _count = 0;
+
+    AppLogFileWriter*   _fileWriter = nullptr;      ///< Protected by _pendingMutex
+    bool                _fileWriterDone = false;    ///< true: log file is open or won't be opened, protected by _pendingMutex
+
+    static constexpr int _maxLines = 20000;
 
 _LOG_CTOR_ACCESS_:
     AppLogModel();
@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TilePrefetchController.h"
+#include "MissionController.h"
+#include "Vehicle.h"
+#include "QGCApplication.h"
+#include "QGCToolbox.h"
+#include "SettingsManager.h"
+#include "MapsSettings.h"
+#include "QGCTilePrefetcher.h"
+#include "TerrainTileManager.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QtMath>
+
+QGC_LOGGING_CATEGORY(TilePrefetchControllerLog, "qgc.qmlcontrols.tileprefetchcontroller")
+
+TilePrefetchController::TilePrefetchController(QObject *parent)
+    : QObject(parent)
+{
+    // qCDebug(TilePrefetchControllerLog) << Q_FUNC_INFO << this;
+
+    _missionPrefetchTimer.setSingleShot(true);
+    _missionPrefetchTimer.setInterval(kMissionPrefetchDelayMSecs);
+    (void) connect(&_missionPrefetchTimer, &QTimer::timeout, this, &TilePrefetchController::_prefetchMission);
+
+    MapsSettings* const mapsSettings = qgcApp()->toolbox()->settingsManager()->mapsSettings();
+    (void) connect(mapsSettings->prefetchEnabled(), &Fact::rawValueChanged, this, &TilePrefetchController::_updateSettings);
+    (void) connect(mapsSettings->prefetchBandwidth(), &Fact::rawValueChanged, this, &TilePrefetchController::_updateSettings);
+    _updateSettings();
+}
+
+TilePrefetchController::~TilePrefetchController()
+{
+    // qCDebug(TilePrefetchControllerLog) << Q_FUNC_INFO << this;
+}
+
+void TilePrefetchController::setMissionController(MissionController *missionController)
+{
+    if (missionController == _missionController) {
+        return;
+    }
+
+    if (_missionController) {
+        (void) disconnect(_missionController, nullptr, this, nullptr);
+    }
+
+    _missionController = missionController;
+
+    if (_missionController) {
+        (void) connect(_missionController, &MissionController::waypointPathChanged, this, &TilePrefetchController::_missionPathChanged);
+        _missionPathChanged();
+    }
+
+    emit missionControllerChanged();
+}
+
+void TilePrefetchController::setVehicle(Vehicle *vehicle)
+{
+    if (vehicle == _vehicle) {
+        return;
+    }
+
+    if (_vehicle) {
+        (void) disconnect(_vehicle, nullptr, this, nullptr);
+    }
+
+    _vehicle = vehicle;
+    _lastVehiclePrefetchCoord = QGeoCoordinate();
+
+    if (_vehicle) {
+        (void) connect(_vehicle, &Vehicle::coordinateChanged, this, &TilePrefetchController::_vehicleCoordinateChanged);
+    }
+
+    emit vehicleChanged();
+}
+
+void TilePrefetchController::setMapType(const QString &mapType)
+{
+    if (mapType != _mapType) {
+        _mapType = mapType;
+        emit mapTypeChanged();
+        _missionPathChanged();
+    }
+}
+
+void TilePrefetchController::setZoomLevel(double zoomLevel)
+{
+    if (qFloor(zoomLevel) != qFloor(_zoomLevel)) {
+        _missionPathChanged();
+    }
+
+    if (!qFuzzyCompare(zoomLevel, _zoomLevel)) {
+        _zoomLevel = zoomLevel;
+        emit zoomLevelChanged();
+    }
+}
+
+void TilePrefetchController::_updateSettings()
+{
+    MapsSettings* const mapsSettings = qgcApp()->toolbox()->settingsManager()->mapsSettings();
+
+    QGCTilePrefetcher* const prefetcher = QGCTilePrefetcher::instance();
+    prefetcher->setEnabled(mapsSettings->prefetchEnabled()->rawValue().toBool());
+    prefetcher->setBandwidthBudget(mapsSettings->prefetchBandwidth()->rawValue().toUInt() * 1024);
+}
+
+bool TilePrefetchController::_prefetchEnabled() const
+{
+    return QGCTilePrefetcher::instance()->enabled() && !_mapType.isEmpty() && (_zoomLevel >= 1);
+}
+
+QList<int> TilePrefetchController::_zoomLevels() const
+{
+    // The zoom level currently displayed plus the next level out, which is what the map falls back to while zooming
+    const int zoom = qFloor(_zoomLevel);
+
+    QList<int> zoomLevels = { zoom };
+    if (zoom > 1) {
+        zoomLevels.append(zoom - 1);
+    }
+
+    return zoomLevels;
+}
+
+void TilePrefetchController::_missionPathChanged()
+{
+    _missionPrefetchTimer.start();
+}
+
+void TilePrefetchController::_prefetchMission()
+{
+    if (!_missionController || !_prefetchEnabled()) {
+        return;
+    }
+
+    QList<QGeoCoordinate> path;
+    for (const QVariant &coordVariant : _missionController->waypointPath()) {
+        path.append(coordVariant.value<QGeoCoordinate>());
+    }
+
+    if (path.isEmpty()) {
+        return;
+    }
+
+    qCDebug(TilePrefetchControllerLog) << Q_FUNC_INFO << "mission path count" << path.count();
+
+    (void) QGCTilePrefetcher::instance()->prefetchPath(_mapType, path, _zoomLevels(), kMissionCorridorMeters);
+    TerrainTileManager::instance()->prefetchPath(path, kMissionCorridorMeters);
+}
+
+void TilePrefetchController::_vehicleCoordinateChanged(const QGeoCoordinate &coordinate)
+{
+    if (!_vehicle || !coordinate.isValid() || !_prefetchEnabled()) {
+        return;
+    }
+
+    if (_lastVehiclePrefetchCoord.isValid() &&
+            (_lastVehiclePrefetchCoord.distanceTo(coordinate) < kVehicleRefreshMeters) &&
+            (_lastVehiclePrefetchTimer.elapsed() < kVehicleRefreshMSecs)) {
+        return;
+    }
+    _lastVehiclePrefetchCoord = coordinate;
+    _lastVehiclePrefetchTimer.start();
+
+    FactGroup* const vehicleFactGroup = _vehicle->vehicleFactGroup();
+    const double groundSpeed = vehicleFactGroup->getFact(QStringLiteral("groundSpeed"))->rawValue().toDouble();
+    const double heading = vehicleFactGroup->getFact(QStringLiteral("heading"))->rawValue().toDouble();
+
+    // Project the current velocity forward to get the area the vehicle is about to fly into
+    double lookahead = kVehicleMinLookaheadMeters;
+    if (!qIsNaN(groundSpeed)) {
+        lookahead = qMax(groundSpeed * kVehicleLookaheadSecs, kVehicleMinLookaheadMeters);
+    }
+
+    QList<QGeoCoordinate> path = { coordinate };
+    if (!qIsNaN(heading)) {
+        path.append(coordinate.atDistanceAndAzimuth(lookahead, heading));
+    }
+    const double corridor = qIsNaN(heading) ? lookahead : kVehicleCorridorMeters;
+
+    qCDebug(TilePrefetchControllerLog) << Q_FUNC_INFO << "lookahead:corridor" << lookahead << corridor;
+
+    (void) QGCTilePrefetcher::instance()->prefetchPath(_mapType, path, _zoomLevels(), corridor);
+    TerrainTileManager::instance()->prefetchPath(path, corridor);
+}
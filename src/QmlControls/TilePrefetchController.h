@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtPositioning/QGeoCoordinate>
+
+Q_DECLARE_LOGGING_CATEGORY(TilePrefetchControllerLog)
+
+class MissionController;
+class Vehicle;
+
+Q_MOC_INCLUDE("MissionController.h")
+Q_MOC_INCLUDE("Vehicle.h")
+
+/// Drives QGCTilePrefetcher from the loaded mission and the live vehicle trajectory so map and
+/// terrain tiles are already cached by the time the vehicle gets there.
+class TilePrefetchController : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(MissionController*   missionController   READ missionController  WRITE setMissionController  NOTIFY missionControllerChanged)
+    Q_PROPERTY(Vehicle*             vehicle             READ vehicle            WRITE setVehicle            NOTIFY vehicleChanged)
+    Q_PROPERTY(QString              mapType             READ mapType            WRITE setMapType            NOTIFY mapTypeChanged)
+    Q_PROPERTY(double               zoomLevel           READ zoomLevel          WRITE setZoomLevel          NOTIFY zoomLevelChanged)
+
+public:
+    explicit TilePrefetchController(QObject *parent = nullptr);
+    ~TilePrefetchController();
+
+    MissionController *missionController() { return _missionController; }
+    Vehicle *vehicle() { return _vehicle; }
+    QString mapType() const { return _mapType; }
+    double zoomLevel() const { return _zoomLevel; }
+
+    void setMissionController(MissionController *missionController);
+    void setVehicle(Vehicle *vehicle);
+    void setMapType(const QString &mapType);
+    void setZoomLevel(double zoomLevel);
+
+signals:
+    void missionControllerChanged();
+    void vehicleChanged();
+    void mapTypeChanged();
+    void zoomLevelChanged();
+
+private slots:
+    void _missionPathChanged();
+    void _vehicleCoordinateChanged(const QGeoCoordinate &coordinate);
+    void _prefetchMission();
+    void _updateSettings();
+
+private:
+    QList<int> _zoomLevels() const;
+    bool _prefetchEnabled() const;
+
+    QPointer<MissionController> _missionController;
+    QPointer<Vehicle> _vehicle;
+    QString _mapType;
+    double _zoomLevel = 0;
+
+    QTimer _missionPrefetchTimer;               ///< Collapses bursts of mission edits into a single prefetch
+    QGeoCoordinate _lastVehiclePrefetchCoord;
+    QElapsedTimer _lastVehiclePrefetchTimer;
+
+    static constexpr int kMissionPrefetchDelayMSecs = 2000;
+    static constexpr double kMissionCorridorMeters = 250.;
+    static constexpr double kVehicleLookaheadSecs = 60.;
+    static constexpr double kVehicleMinLookaheadMeters = 500.;
+    static constexpr double kVehicleCorridorMeters = 300.;
+    static constexpr double kVehicleRefreshMeters = 200.;
+    static constexpr qint64 kVehicleRefreshMSecs = 10000;
+};
@@ -59,5 +59,10 @@ QGCTileSet CopernicusElevationProvider::getTileCount(int zoom, double topleftLon
 
 QByteArray CopernicusElevationProvider::serialize(const QByteArray &image) const
 {
-    return TerrainTileCopernicus::serializeFromJson(image);
+    return TerrainTileCopernicus::serialize(image);
+}
+
+double CopernicusElevationProvider::tileSizeDegrees() const
+{
+    return TerrainTileCopernicus::tileSizeDegrees;
 }
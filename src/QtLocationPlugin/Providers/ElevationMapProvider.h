@@ -28,6 +28,12 @@ protected:
 public:
     bool isElevationProvider() const final { return true; }
     virtual QByteArray serialize(const QByteArray &image) const = 0;
+
+    /// @return Size of a tile side in degrees. Elevation tiles are not web mercator tiles and don't depend on zoom.
+    virtual double tileSizeDegrees() const = 0;
+
+    /// Binary terrain tiles are preferred, JSON is the fallback
+    static constexpr const char *kAcceptHeader = "application/vnd.qgc.terrain-tile, application/json;q=0.9, */*;q=0.8";
 };
 
 class CopernicusElevationProvider : public ElevationProvider
@@ -49,6 +55,7 @@ public:
                             double bottomRightLat) const final;
 
     QByteArray serialize(const QByteArray &image) const final;
+    double tileSizeDegrees() const final;
 
     static constexpr const char *kProviderKey = "Copernicus Elevation";
     static constexpr const char *kProviderNotice = "© Airbus Defence and Space GmbH";
@@ -0,0 +1,302 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTilePrefetcher.h"
+#include "ElevationMapProvider.h"
+#include "MapProvider.h"
+#include "QGCCacheTile.h"
+#include "QGCMapEngine.h"
+#include "QGCMapTasks.h"
+#include "QGCMapUrlEngine.h"
+#include "QGeoFileTileCacheQGC.h"
+#include "QGeoMapReplyQGC.h"
+#include "QGeoTileFetcherQGC.h"
+
+#include <DeviceInfo.h>
+#include <QGCFileDownload.h>
+#include <QGCLoggingCategory.h>
+
+#include <QtCore/qapplicationstatic.h>
+#include <QtCore/QtMath>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+
+QGC_LOGGING_CATEGORY(QGCTilePrefetcherLog, "qgc.qtlocationplugin.qgctileprefetcher")
+
+Q_APPLICATION_STATIC(QGCTilePrefetcher, _tilePrefetcher);
+
+QGCTilePrefetcher *QGCTilePrefetcher::instance()
+{
+    return _tilePrefetcher();
+}
+
+QGCTilePrefetcher::QGCTilePrefetcher(QObject *parent)
+    : QObject(parent)
+    , _networkManager(new QNetworkAccessManager(this))
+{
+    // qCDebug(QGCTilePrefetcherLog) << Q_FUNC_INFO << this;
+
+    _processTimer.setInterval(kProcessIntervalMSecs);
+    _processTimer.setSingleShot(false);
+    (void) connect(&_processTimer, &QTimer::timeout, this, &QGCTilePrefetcher::_processQueue);
+
+    _tokenTimer.start();
+}
+
+QGCTilePrefetcher::~QGCTilePrefetcher()
+{
+    // qCDebug(QGCTilePrefetcherLog) << Q_FUNC_INFO << this;
+}
+
+void QGCTilePrefetcher::setEnabled(bool enabled)
+{
+    if (enabled == _enabled) {
+        return;
+    }
+
+    _enabled = enabled;
+    if (!_enabled) {
+        clear();
+    }
+}
+
+void QGCTilePrefetcher::clear()
+{
+    for (const PendingTile_t &tile : _pendingTiles) {
+        (void) _knownHashes.remove(tile.hash);
+    }
+    _pendingTiles.clear();
+    _processTimer.stop();
+}
+
+int QGCTilePrefetcher::prefetchPath(const QString &mapType, const QList<QGeoCoordinate> &path, const QList<int> &zoomLevels, double corridorMeters)
+{
+    if (!_enabled || path.isEmpty() || zoomLevels.isEmpty()) {
+        return 0;
+    }
+
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(mapType);
+    if (!provider) {
+        qCWarning(QGCTilePrefetcherLog) << Q_FUNC_INFO << "unknown map type" << mapType;
+        return 0;
+    }
+
+    if (_pendingTiles.isEmpty() && (_activeCount == 0) && (_knownHashes.count() > kMaxPendingTiles)) {
+        // Forget about completed tiles once the set gets large, the cache lookup will catch them anyway
+        _knownHashes.clear();
+    }
+
+    int queuedCount = 0;
+    corridorMeters = qMax(corridorMeters, 0.);
+
+    double elevationTileDegrees = 0.;
+    if (provider->isElevationProvider()) {
+        const SharedElevationProvider elevationProvider = std::dynamic_pointer_cast<const ElevationProvider>(provider);
+        elevationTileDegrees = elevationProvider->tileSizeDegrees();
+    }
+
+    for (const int zoom : zoomLevels) {
+        if ((zoom < 1) || (zoom > MAX_MAP_ZOOM)) {
+            continue;
+        }
+
+        for (qsizetype i = 0; i < path.count(); i++) {
+            const QGeoCoordinate &from = path[i];
+            const QGeoCoordinate &to = (i + 1 < path.count()) ? path[i + 1] : path[i];
+            if (!from.isValid() || !to.isValid()) {
+                continue;
+            }
+
+            // Sample the segment at half a tile so no tile along the way is skipped. Elevation tiles have a fixed size
+            // in degrees, their narrower side is the longitude one.
+            const double latitudeScale = qCos(qDegreesToRadians(from.latitude()));
+            const double tileMeters = (elevationTileDegrees > 0.)
+                ? (elevationTileDegrees * (40075016.686 / 360.) * latitudeScale)
+                : ((40075016.686 * latitudeScale) / static_cast<double>(1 << zoom));
+            const double sampleSpacing = qMax(tileMeters / 2., 1.);
+            const double segmentLength = from.distanceTo(to);
+            const double azimuth = from.azimuthTo(to);
+            const int samples = qMax(1, qCeil(segmentLength / sampleSpacing));
+
+            for (int sample = 0; sample <= samples; sample++) {
+                const QGeoCoordinate center = from.atDistanceAndAzimuth((segmentLength * sample) / samples, azimuth);
+                const QGeoCoordinate topLeft = center.atDistanceAndAzimuth(corridorMeters, 0).atDistanceAndAzimuth(corridorMeters, 270);
+                const QGeoCoordinate bottomRight = center.atDistanceAndAzimuth(corridorMeters, 180).atDistanceAndAzimuth(corridorMeters, 90);
+
+                // Web mercator tile Y grows southwards, elevation tile Y grows northwards
+                const int topLeftY = provider->lat2tileY(topLeft.latitude(), zoom);
+                const int bottomRightY = provider->lat2tileY(bottomRight.latitude(), zoom);
+                const int minX = provider->long2tileX(topLeft.longitude(), zoom);
+                const int maxX = provider->long2tileX(bottomRight.longitude(), zoom);
+                const int minY = qMin(topLeftY, bottomRightY);
+                const int maxY = qMax(topLeftY, bottomRightY);
+
+                for (int x = minX; x <= maxX; x++) {
+                    for (int y = minY; y <= maxY; y++) {
+                        _queueTile(provider->getMapName(), x, y, zoom, queuedCount);
+                    }
+                }
+
+                if (_pendingTiles.count() >= kMaxPendingTiles) {
+                    qCDebug(QGCTilePrefetcherLog) << Q_FUNC_INFO << "pending tile limit reached";
+                    break;
+                }
+            }
+        }
+    }
+
+    qCDebug(QGCTilePrefetcherLog) << Q_FUNC_INFO << mapType << "queued:pending" << queuedCount << _pendingTiles.count();
+
+    if (!_pendingTiles.isEmpty() && !_processTimer.isActive()) {
+        _processTimer.start();
+    }
+
+    return queuedCount;
+}
+
+void QGCTilePrefetcher::_queueTile(const QString &mapType, int x, int y, int zoom, int &queuedCount)
+{
+    if (_pendingTiles.count() >= kMaxPendingTiles) {
+        return;
+    }
+
+    const QString hash = UrlFactory::getTileHash(mapType, x, y, zoom);
+    if (_knownHashes.contains(hash)) {
+        return;
+    }
+
+    (void) _knownHashes.insert(hash);
+    _pendingTiles.enqueue({mapType, hash, x, y, zoom});
+    queuedCount++;
+}
+
+void QGCTilePrefetcher::_refillTokens()
+{
+    const qint64 elapsed = _tokenTimer.restart();
+    const qint64 bucketSize = static_cast<qint64>(_bytesPerSecond);
+
+    _tokens = qMin(_tokens + ((bucketSize * elapsed) / 1000), bucketSize);
+}
+
+void QGCTilePrefetcher::_processQueue()
+{
+    _refillTokens();
+
+    if (_pendingTiles.isEmpty()) {
+        if (_activeCount == 0) {
+            _processTimer.stop();
+        }
+        return;
+    }
+
+    // Interactive requests always win. Wait for the map and terrain to finish their work.
+    if (QGeoTiledMapReplyQGC::activeNetworkRequests() > 0) {
+        return;
+    }
+
+    while (!_pendingTiles.isEmpty() && (_activeCount < kMaxActiveRequests) && (_tokens > 0)) {
+        const PendingTile_t tile = _pendingTiles.dequeue();
+        _fetchTile(tile);
+    }
+}
+
+void QGCTilePrefetcher::_fetchTile(const PendingTile_t &tile)
+{
+    _activeCount++;
+
+    QGCFetchTileTask* const task = QGeoFileTileCacheQGC::createFetchTileTask(tile.mapType, tile.x, tile.y, tile.zoom);
+    (void) connect(task, &QGCFetchTileTask::tileFetched, this, [this](QGCCacheTile *cacheTile) {
+        _cacheHit(cacheTile);
+    });
+    (void) connect(task, &QGCMapTask::error, this, [this, tile](QGCMapTask::TaskType, const QString &) {
+        _cacheMiss(tile);
+    });
+
+    // A failed addTask emits the task error, which already ends up in _tileDone through _cacheMiss
+    (void) getQGCMapEngine()->addTask(task);
+}
+
+void QGCTilePrefetcher::_cacheHit(QGCCacheTile *cacheTile)
+{
+    // Already in the cache, nothing to download
+    delete cacheTile;
+    _tileDone();
+}
+
+void QGCTilePrefetcher::_cacheMiss(const PendingTile_t &tile)
+{
+    if (!QGCDeviceInfo::isInternetAvailable()) {
+        _tileDone();
+        return;
+    }
+
+    QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(UrlFactory::getQtMapIdFromProviderType(tile.mapType), tile.x, tile.y, tile.zoom);
+    if (request.url().isEmpty()) {
+        _tileDone();
+        return;
+    }
+    request.setPriority(QNetworkRequest::LowPriority);
+
+    QNetworkReply* const reply = _networkManager->get(request);
+    reply->setParent(this);
+    QGCFileDownload::setIgnoreSSLErrorsIfNeeded(*reply);
+
+    (void) connect(reply, &QNetworkReply::finished, this, [this, tile, reply]() {
+        _networkReplyFinished(tile, reply);
+    });
+}
+
+void QGCTilePrefetcher::_networkReplyFinished(const PendingTile_t &tile, QNetworkReply *reply)
+{
+    reply->deleteLater();
+
+    const QByteArray image = reply->readAll();
+
+    // Charge the bucket for what actually went over the wire, even for failed requests
+    _tokens -= image.size();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qCDebug(QGCTilePrefetcherLog) << Q_FUNC_INFO << tile.hash << reply->errorString();
+        _tileDone();
+        return;
+    }
+
+    if (image.isEmpty()) {
+        _tileDone();
+        return;
+    }
+
+    const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromProviderType(tile.mapType);
+    if (!mapProvider) {
+        _tileDone();
+        return;
+    }
+
+    QByteArray tileData = image;
+    if (mapProvider->isElevationProvider()) {
+        const SharedElevationProvider elevationProvider = std::dynamic_pointer_cast<const ElevationProvider>(mapProvider);
+        tileData = elevationProvider->serialize(image);
+    }
+
+    const QString format = mapProvider->getImageFormat(tileData);
+    if (!tileData.isEmpty() && !format.isEmpty()) {
+        QGeoFileTileCacheQGC::cacheTile(tile.mapType, tile.x, tile.y, tile.zoom, tileData, format);
+        emit tilePrefetched(tile.mapType, tile.x, tile.y, tile.zoom);
+    }
+
+    _tileDone();
+}
+
+void QGCTilePrefetcher::_tileDone()
+{
+    _activeCount--;
+    if (!_processTimer.isActive() && !_pendingTiles.isEmpty()) {
+        _processTimer.start();
+    }
+}
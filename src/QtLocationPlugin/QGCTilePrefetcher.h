@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QQueue>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtPositioning/QGeoCoordinate>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCTilePrefetcherLog)
+
+class QGCCacheTile;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/// Background tile fetcher which warms the tile cache ahead of the vehicle.
+/// Requests are throttled by a token bucket bandwidth budget and always yield to
+/// interactive map/terrain requests which are currently on the wire.
+class QGCTilePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QGCTilePrefetcher(QObject *parent = nullptr);
+    ~QGCTilePrefetcher();
+
+    static QGCTilePrefetcher *instance();
+
+    /// Queues all tiles of mapType covering a corridor around path at each of the zoom levels.
+    ///     @param corridorMeters Half width of the corridor around the path
+    ///     @return Number of new tiles queued
+    int prefetchPath(const QString &mapType, const QList<QGeoCoordinate> &path, const QList<int> &zoomLevels, double corridorMeters);
+
+    /// Drops all pending (not yet requested) tiles
+    void clear();
+
+    /// Maximum number of bytes per second which prefetching is allowed to use
+    void setBandwidthBudget(quint32 bytesPerSecond) { _bytesPerSecond = bytesPerSecond; }
+    quint32 bandwidthBudget() const { return _bytesPerSecond; }
+
+    void setEnabled(bool enabled);
+    bool enabled() const { return _enabled; }
+
+    qsizetype pendingCount() const { return _pendingTiles.count(); }
+
+signals:
+    void tilePrefetched(const QString &mapType, int x, int y, int zoom);
+
+private slots:
+    void _processQueue();
+
+private:
+    struct PendingTile_t {
+        QString mapType;
+        QString hash;
+        int x;
+        int y;
+        int zoom;
+    };
+
+    void _queueTile(const QString &mapType, int x, int y, int zoom, int &queuedCount);
+    void _fetchTile(const PendingTile_t &tile);
+    void _cacheHit(QGCCacheTile *cacheTile);
+    void _cacheMiss(const PendingTile_t &tile);
+    void _networkReplyFinished(const PendingTile_t &tile, QNetworkReply *reply);
+    void _tileDone();
+    void _refillTokens();
+
+    QNetworkAccessManager *_networkManager = nullptr;
+    QTimer _processTimer;
+    QElapsedTimer _tokenTimer;
+    QQueue<PendingTile_t> _pendingTiles;
+    QSet<QString> _knownHashes;                 ///< Queued or in flight tiles, used to prevent duplicate requests
+    bool _enabled = true;
+    int _activeCount = 0;
+    quint32 _bytesPerSecond = kDefaultBytesPerSecond;
+    qint64 _tokens = 0;                         ///< Available bytes in the bandwidth bucket, may go negative after a large tile
+
+    static constexpr int kMaxActiveRequests = 2;
+    static constexpr int kMaxPendingTiles = 4000;
+    static constexpr int kProcessIntervalMSecs = 250;
+    static constexpr quint32 kDefaultBytesPerSecond = 64 * 1024;
+};
@@ -14,6 +14,8 @@
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
 
+#include <atomic>
+
 #include "QGCMapTasks.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGeoTiledMapReplyQGCLog)
@@ -31,6 +33,9 @@ public:
 
     void abort() final;
 
+    /// Number of interactive tile requests currently waiting on the network
+    static int activeNetworkRequests() { return _activeNetworkRequests; }
+
 private slots:
     void _networkReplyFinished();
     void _networkReplyError(QNetworkReply::NetworkError error);
@@ -46,6 +51,7 @@ private:
 
     static QByteArray _bingNoTileImage;
     static QByteArray _badTile;
+    static std::atomic_int _activeNetworkRequests;
 
     enum HTTP_Response {
         SUCCESS_OK = 200,
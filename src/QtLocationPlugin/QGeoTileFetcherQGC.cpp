@@ -12,6 +12,7 @@
 #include "QGeoMapReplyQGC.h"
 #include "QGCMapUrlEngine.h"
 #include "MapProvider.h"
+#include "ElevationMapProvider.h"
 #include <QGCLoggingCategory.h>
 
 #include <QtNetwork/QNetworkRequest>
@@ -98,7 +99,12 @@ QNetworkRequest QGeoTileFetcherQGC::getNetworkRequest(int mapId, int x, int y, i
 
     QNetworkRequest request;
     request.setUrl(mapProvider->getTileURL(x, y, zoom));
-    request.setRawHeader(QByteArrayLiteral("Accept"), QByteArrayLiteral("*/*"));
+    if (mapProvider->isElevationProvider()) {
+        // Servers which support it hand out the binary tile format, which saves the JSON parse
+        request.setRawHeader(QByteArrayLiteral("Accept"), ElevationProvider::kAcceptHeader);
+    } else {
+        request.setRawHeader(QByteArrayLiteral("Accept"), QByteArrayLiteral("*/*"));
+    }
     request.setHeader(QNetworkRequest::UserAgentHeader, s_userAgent);
     const QByteArray referrer = mapProvider->getReferrer().toUtf8();
     if (!referrer.isEmpty()) {
@@ -19,3 +19,5 @@ DECLARE_SETTINGGROUP(ADSBVehicleManager, "ADSBVehicleManager")
 DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbServerConnectEnabled)
 DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbServerHostAddress)
 DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbServerPort)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbProximityAlertDistance)
+DECLARE_SETTINGSFACT(ADSBVehicleManagerSettings, adsbProximityAlertAltitude)
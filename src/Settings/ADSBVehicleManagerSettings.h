@@ -21,4 +21,6 @@ public:
     DEFINE_SETTINGFACT(adsbServerConnectEnabled)
     DEFINE_SETTINGFACT(adsbServerHostAddress)
     DEFINE_SETTINGFACT(adsbServerPort)
+    DEFINE_SETTINGFACT(adsbProximityAlertDistance)
+    DEFINE_SETTINGFACT(adsbProximityAlertAltitude)
 };
@@ -13,6 +13,7 @@
 #include "QGCMAVLink.h"
 #include "QGCToolbox.h"
 #include "LinkManager.h"
+#include "SettingsStore.h"
 
 #ifdef Q_OS_ANDROID
 #include "AndroidInterface.h"
@@ -21,7 +22,6 @@
 #include <QtQml/QQmlEngine>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QDir>
-#include <QtCore/QSettings>
 
 // Release languages are 90%+ complete
 QList<QLocale::Language> AppSettings::_rgReleaseLanguages = {
@@ -68,25 +68,26 @@ DECLARE_SETTINGGROUP(App, "")
     qmlRegisterUncreatableType<AppSettings>("QGroundControl.SettingsManager", 1, 0, "AppSettings", "Reference only");
     QGCPalette::setGlobalTheme(indoorPalette()->rawValue().toBool() ? QGCPalette::Dark : QGCPalette::Light);
 
-    QSettings settings;
+    // Migrations go through the settings store since that is where the settings facts read from.
+    // Note that the App settings group has no group name.
+    SettingsStore* const settings = SettingsStore::instance();
 
     // These two "type" keys were changed to "class" values
     static const char* deprecatedFirmwareTypeKey    = "offlineEditingFirmwareType";
     static const char* deprecatedVehicleTypeKey     = "offlineEditingVehicleType";
-    if (settings.contains(deprecatedFirmwareTypeKey)) {
-        settings.setValue(deprecatedFirmwareTypeKey, QGCMAVLink::firmwareClass(static_cast<MAV_AUTOPILOT>(settings.value(deprecatedFirmwareTypeKey).toInt())));
+    if (settings->contains(deprecatedFirmwareTypeKey)) {
+        settings->setValue(deprecatedFirmwareTypeKey, QGCMAVLink::firmwareClass(static_cast<MAV_AUTOPILOT>(settings->value(deprecatedFirmwareTypeKey).toInt())));
     }
-    if (settings.contains(deprecatedVehicleTypeKey)) {
-        settings.setValue(deprecatedVehicleTypeKey, QGCMAVLink::vehicleClass(static_cast<MAV_TYPE>(settings.value(deprecatedVehicleTypeKey).toInt())));
+    if (settings->contains(deprecatedVehicleTypeKey)) {
+        settings->setValue(deprecatedVehicleTypeKey, QGCMAVLink::vehicleClass(static_cast<MAV_TYPE>(settings->value(deprecatedVehicleTypeKey).toInt())));
     }
 
     QStringList deprecatedKeyNames  = { "virtualJoystickCentralized",           "offlineEditingFirmwareType",   "offlineEditingVehicleType" };
     QStringList newKeyNames         = { "virtualJoystickAutoCenterThrottle",    "offlineEditingFirmwareClass",  "offlineEditingVehicleClass" };
-    settings.beginGroup(_settingsGroup);
     for (int i=0; i<deprecatedKeyNames.count(); i++) {
-        if (settings.contains(deprecatedKeyNames[i])) {
-            settings.setValue(newKeyNames[i], settings.value(deprecatedKeyNames[i]));
-            settings.remove(deprecatedKeyNames[i]);
+        if (settings->contains(deprecatedKeyNames[i])) {
+            settings->setValue(newKeyNames[i], settings->value(deprecatedKeyNames[i]));
+            settings->remove(deprecatedKeyNames[i]);
         }
     }
 
@@ -258,6 +259,7 @@ void AppSettings::_checkSavePathDirectories(void)
         savePathDir.mkdir(photoDirectory);
         savePathDir.mkdir(crashDirectory);
         savePathDir.mkdir(customActionsDirectory);
+        savePathDir.mkdir(terrainDirectory);
     }
 }
 
@@ -351,6 +353,16 @@ QString AppSettings::customActionsSavePath(void)
     return QString();
 }
 
+QString AppSettings::terrainSavePath(void)
+{
+    QString path = savePath()->rawValue().toString();
+    if (!path.isEmpty() && QDir(path).exists()) {
+        QDir dir(path);
+        return dir.filePath(terrainDirectory);
+    }
+    return QString();
+}
+
 QList<int> AppSettings::firstRunPromptsIdsVariantToList(const QVariant& firstRunPromptIds)
 {
     QList<int> rgIds;
@@ -388,10 +400,10 @@ void AppSettings::firstRunPromptIdsMarkIdAsShown(int id)
 /// for language are not currently supported.
 QLocale::Language AppSettings::_qLocaleLanguageEarlyAccess(void)
 {
-    QSettings settings;
-
-    // Note that the AppSettings group has no group name
-    QLocale::Language localeLanguage = static_cast<QLocale::Language>(settings.value(qLocaleLanguageName).toInt());
+    // Read through the store since a language change has not been written to disk yet when setLanguage is called.
+    // Before the store is loaded this falls through to QSettings. Note that the AppSettings group has no group name.
+    SettingsStore* const settings = SettingsStore::instance();
+    QLocale::Language localeLanguage = static_cast<QLocale::Language>(settings->value(qLocaleLanguageName).toInt());
     for (auto& languageInfo: _rgLanguageInfo) {
         if (languageInfo.languageId == localeLanguage) {
             return localeLanguage;
@@ -399,7 +411,7 @@ QLocale::Language AppSettings::_qLocaleLanguageEarlyAccess(void)
     }
 
     localeLanguage = QLocale::AnyLanguage;
-    settings.setValue(qLocaleLanguageName, localeLanguage);
+    settings->setValue(qLocaleLanguageName, localeLanguage);
 
     return localeLanguage;
 }
@@ -9,6 +9,7 @@
 
 #include "AutoConnectSettings.h"
 #include "LinkManager.h"
+#include "SettingsStore.h"
 
 #include <QtQml/QQmlEngine>
 
@@ -18,22 +19,19 @@ DECLARE_SETTINGGROUP(AutoConnect, "AutoConnect")
 
     // Settings group name was changed from "LinkManager" to "AutoConnect" in v5.0.0
     // Copy over an old settings to the new name
-    QSettings settings;
+    SettingsStore* const settings = SettingsStore::instance();
     static const char* deprecatedGroupName = "LinkManager";
-    if (settings.childGroups().contains(deprecatedGroupName)) {
-        settings.beginGroup(deprecatedGroupName);
+    const QStringList deprecatedKeys = settings->childKeys(deprecatedGroupName);
+    if (!deprecatedKeys.isEmpty()) {
         QList<QPair<QString, QVariant>> values;
-        for (const QString& key: settings.childKeys()) {
-            values.append(QPair<QString, QVariant>(key, settings.value(key)));
+        for (const QString& key: deprecatedKeys) {
+            values.append(QPair<QString, QVariant>(key, settings->value(QString(deprecatedGroupName) + QLatin1Char('/') + key)));
         }
-        settings.endGroup();
-        settings.remove(deprecatedGroupName);
+        settings->remove(deprecatedGroupName);
 
-        settings.beginGroup(_name);
         for (const QPair<QString, QVariant>& pair: values) {
-            settings.setValue(pair.first, pair.second);
+            settings->setValue(_name + QLatin1Char('/') + pair.first, pair.second);
         }
-        settings.endGroup();
     }
 }
 
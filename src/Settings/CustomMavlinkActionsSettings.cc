@@ -9,23 +9,22 @@
 
 #include "CustomMavlinkActionsSettings.h"
 #include "QGCApplication.h"
+#include "SettingsStore.h"
 
 #include <QtQml/QQmlEngine>
 #include <QtCore/QFile>
-#include <QtCore/QSettings>
 
 DECLARE_SETTINGGROUP(CustomMavlinkActions, "CustomMavlinkActions")
 {
     qmlRegisterUncreatableType<CustomMavlinkActionsSettings>("QGroundControl.SettingsManager", 1, 0, "CustomMavlinkActionsSettings", "Reference only");
 
     // Notify the user of new Fly View custom actions support
-    QSettings deprecatedSettings;
-    static constexpr const char* deprecatedKey1 = "enableCustomActions";
-    static constexpr const char* deprecatedKey2 = "customActionsDefinitions";
-    deprecatedSettings.beginGroup("FlyView");
-    if (deprecatedSettings.contains(deprecatedKey1) || deprecatedSettings.contains(deprecatedKey2)) {
-        deprecatedSettings.remove(deprecatedKey1);
-        deprecatedSettings.remove(deprecatedKey2);
+    SettingsStore* const settings = SettingsStore::instance();
+    static constexpr const char* deprecatedKey1 = "FlyView/enableCustomActions";
+    static constexpr const char* deprecatedKey2 = "FlyView/customActionsDefinitions";
+    if (settings->contains(deprecatedKey1) || settings->contains(deprecatedKey2)) {
+        settings->remove(deprecatedKey1);
+        settings->remove(deprecatedKey2);
         qgcApp()->showAppMessage(CustomMavlinkActionsSettings::tr("Support for Fly View custom actions has changed. The location of the files has changed. You will need to setup up your settings again from Fly View Settings."));
     }
 
@@ -8,8 +8,8 @@
  ****************************************************************************/
 
 #include "MapsSettings.h"
+#include "SettingsStore.h"
 
-#include <QtCore/QSettings>
 #include <QtQml/QQmlEngine>
 
 DECLARE_SETTINGGROUP(Maps, "Maps")
@@ -21,22 +21,22 @@ DECLARE_SETTINGGROUP(Maps, "Maps")
     static constexpr const char* kMaxDiskCacheKey = "MaxDiskCache";
     static constexpr const char* kMaxMemCacheKey  = "MaxMemoryCache";
 
-    QSettings deprecatedSettings;
-    QSettings newSettings;
+    SettingsStore* const settings = SettingsStore::instance();
 
-    newSettings.beginGroup(_settingsGroup);
-    if (deprecatedSettings.contains(kMaxDiskCacheKey)) {
-        uint32_t maxDiskCache = deprecatedSettings.value(kMaxDiskCacheKey, 1024).toUInt();
-        deprecatedSettings.remove(kMaxDiskCacheKey);
-        newSettings.setValue("maxCacheDiskSize", maxDiskCache);
+    if (settings->contains(kMaxDiskCacheKey)) {
+        uint32_t maxDiskCache = settings->value(kMaxDiskCacheKey, 1024).toUInt();
+        settings->remove(kMaxDiskCacheKey);
+        settings->setValue(_settingsGroup + QStringLiteral("/maxCacheDiskSize"), maxDiskCache);
    }
-    if (deprecatedSettings.contains(kMaxMemCacheKey)) {
-        uint32_t maxMemCache = deprecatedSettings.value(kMaxMemCacheKey, 1024).toUInt();
-        deprecatedSettings.remove(kMaxMemCacheKey);
-        newSettings.setValue("maxCacheMemorySize", maxMemCache);
+    if (settings->contains(kMaxMemCacheKey)) {
+        uint32_t maxMemCache = settings->value(kMaxMemCacheKey, 1024).toUInt();
+        settings->remove(kMaxMemCacheKey);
+        settings->setValue(_settingsGroup + QStringLiteral("/maxCacheMemorySize"), maxMemCache);
     }
  
 }
 
 DECLARE_SETTINGSFACT(MapsSettings, maxCacheDiskSize)
 DECLARE_SETTINGSFACT(MapsSettings, maxCacheMemorySize)
+DECLARE_SETTINGSFACT(MapsSettings, prefetchEnabled)
+DECLARE_SETTINGSFACT(MapsSettings, prefetchBandwidth)
@@ -0,0 +1,282 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SettingsStore.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSettings>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+QGC_LOGGING_CATEGORY(SettingsStoreLog, "qgc.settings.settingsstore")
+
+Q_GLOBAL_STATIC(SettingsStore, _settingsStore)
+
+/// Writes batches of changed keys to QSettings off the gui thread
+class SettingsStoreWriter : public QThread
+{
+public:
+    SettingsStoreWriter(SettingsStore *store)
+        : _store(store)
+    {
+
+    }
+
+    ~SettingsStoreWriter()
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            _stop = true;
+        }
+        _wake.wakeOne();
+        (void) wait();
+    }
+
+    void enqueue(const QString &key, const QVariant &value, bool remove)
+    {
+        QMutexLocker lock(&_mutex);
+        _pending.append({ key, value, remove });
+    }
+
+    void requestWrite()
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            _writeRequested = true;
+        }
+        _wake.wakeOne();
+    }
+
+    /// Writes everything outstanding on the calling thread
+    void flush()
+    {
+        // The batch is taken while holding _writeMutex so a batch the thread picked up earlier is always
+        // written before this one.
+        QMutexLocker writeLock(&_writeMutex);
+        (void) _writePending();
+    }
+
+protected:
+    void run() final
+    {
+        forever {
+            {
+                QMutexLocker lock(&_mutex);
+                while (!_writeRequested && !_stop) {
+                    (void) _wake.wait(&_mutex);
+                }
+                if (_stop) {
+                    break;
+                }
+                _writeRequested = false;
+            }
+
+            bool wrote;
+            {
+                QMutexLocker writeLock(&_writeMutex);
+                wrote = _writePending();
+            }
+            if (wrote) {
+                (void) QMetaObject::invokeMethod(_store, [store = _store]() { emit store->written(); }, Qt::QueuedConnection);
+            }
+        }
+    }
+
+private:
+    struct Change_t {
+        QString     key;
+        QVariant    value;
+        bool        remove;
+    };
+
+    /// Must be called with _writeMutex held
+    /// @return false: nothing to write
+    bool _writePending()
+    {
+        QList<Change_t> pending;
+        {
+            QMutexLocker lock(&_mutex);
+            pending.swap(_pending);
+        }
+        if (pending.isEmpty()) {
+            return false;
+        }
+
+        // Changes are applied in order since a remove also drops the sub keys of a group. QSettings replaces
+        // the ini file through QSaveFile so the file on disk is never half written.
+        QSettings settings;
+        for (const Change_t &change: pending) {
+            if (change.remove) {
+                settings.remove(change.key);
+            } else {
+                settings.setValue(change.key, change.value);
+            }
+        }
+        settings.sync();
+        if (settings.status() != QSettings::NoError) {
+            qCWarning(SettingsStoreLog) << "Writing settings failed" << settings.fileName() << settings.status();
+        } else {
+            qCDebug(SettingsStoreLog) << "Wrote" << pending.count() << "changes";
+        }
+
+        return true;
+    }
+
+    SettingsStore               *_store;        ///< Owns the writer so it always outlives it
+    QMutex                      _mutex;         ///< Protects _pending, _writeRequested and _stop
+    QMutex                      _writeMutex;    ///< Serializes writes from the thread and flush()
+    QWaitCondition              _wake;
+    QList<Change_t>             _pending;
+    bool                        _writeRequested = false;
+    bool                        _stop = false;
+};
+
+SettingsStore::SettingsStore(QObject *parent)
+    : QObject(parent)
+{
+    // qCDebug(SettingsStoreLog) << Q_FUNC_INFO << this;
+
+    _writeTimer.setSingleShot(true);
+    _writeTimer.setInterval(_writeDelayMsecs);
+    (void) connect(&_writeTimer, &QTimer::timeout, this, &SettingsStore::_writeTimeout);
+}
+
+SettingsStore::~SettingsStore()
+{
+    if (_writer) {
+        _writer->flush();
+        delete _writer;
+    }
+
+    // qCDebug(SettingsStoreLog) << Q_FUNC_INFO << this;
+}
+
+SettingsStore *SettingsStore::instance()
+{
+    return _settingsStore();
+}
+
+void SettingsStore::load()
+{
+    if (_writer) {
+        _writer->flush();
+    }
+
+    _values.clear();
+    QSettings settings;
+    const QStringList keys = settings.allKeys();
+    _values.reserve(keys.count());
+    for (const QString &key: keys) {
+        _values[key] = settings.value(key);
+    }
+    _loaded = true;
+
+    if (!_writer) {
+        _writer = new SettingsStoreWriter(this);
+        _writer->start(QThread::LowPriority);
+    }
+
+    qCDebug(SettingsStoreLog) << "Loaded" << _values.count() << "keys from" << settings.fileName();
+}
+
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    if (!_loaded) {
+        return QSettings().value(key, defaultValue);
+    }
+
+    return _values.value(key, defaultValue);
+}
+
+bool SettingsStore::contains(const QString &key) const
+{
+    if (!_loaded) {
+        return QSettings().contains(key);
+    }
+
+    return _values.contains(key);
+}
+
+QStringList SettingsStore::childKeys(const QString &group) const
+{
+    if (!_loaded) {
+        QSettings settings;
+        settings.beginGroup(group);
+        return settings.childKeys();
+    }
+
+    QStringList keys;
+    const QString prefix = group + QLatin1Char('/');
+    for (auto it = _values.constBegin(); it != _values.constEnd(); it++) {
+        if (it.key().startsWith(prefix) && !it.key().mid(prefix.length()).contains(QLatin1Char('/'))) {
+            keys.append(it.key().mid(prefix.length()));
+        }
+    }
+    return keys;
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    if (!_loaded) {
+        QSettings().setValue(key, value);
+        return;
+    }
+
+    _values[key] = value;
+    _writer->enqueue(key, value, false /* remove */);
+    _scheduleWrite();
+}
+
+void SettingsStore::remove(const QString &key)
+{
+    if (!_loaded) {
+        QSettings().remove(key);
+        return;
+    }
+
+    // Match QSettings::remove which also removes all sub keys
+    const QString prefix = key + QLatin1Char('/');
+    for (auto it = _values.begin(); it != _values.end();) {
+        if ((it.key() == key) || it.key().startsWith(prefix)) {
+            it = _values.erase(it);
+        } else {
+            it++;
+        }
+    }
+    _writer->enqueue(key, QVariant(), true /* remove */);
+    _scheduleWrite();
+}
+
+void SettingsStore::flush()
+{
+    _writeTimer.stop();
+    if (_writer) {
+        _writer->flush();
+    }
+}
+
+void SettingsStore::_scheduleWrite()
+{
+    if (!_writeTimer.isActive()) {
+        _firstPendingChange.start();
+    } else if (_firstPendingChange.elapsed() >= _maxWriteDelayMsecs) {
+        // Don't restart the timer, let the outstanding changes go out
+        return;
+    }
+
+    _writeTimer.start();
+}
+
+void SettingsStore::_writeTimeout()
+{
+    _writer->requestWrite();
+}
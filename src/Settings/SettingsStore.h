@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+#include <QtCore/QVariant>
+
+Q_DECLARE_LOGGING_CATEGORY(SettingsStoreLog)
+
+class SettingsStoreWriter;
+
+/// In memory copy of the application settings which SettingsFact reads and writes through.
+///
+/// All keys are read from QSettings once at startup so reads are a hash lookup. Changes are applied to the
+/// hash immediately and written back to disk on a worker thread once no further changes have come in for
+/// a short while. The ini file is replaced atomically on write so a crash leaves either the old or the new
+/// file behind, never a partial one. Must only be used from the gui thread.
+///
+/// Since the file on disk can lag behind by up to _maxWriteDelayMsecs, code which reads SettingsFact keys must do
+/// so through the store, not with QSettings directly.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SettingsStore(QObject *parent = nullptr);
+    ~SettingsStore();
+
+    static SettingsStore *instance();
+
+    /// Reads all keys from QSettings. Must be called after any startup code which clears or upgrades
+    /// settings with QSettings directly. Until then reads fall through to QSettings.
+    void load();
+    bool loaded() const { return _loaded; }
+
+    /// @param key Full key including the group, e.g. "Units/horizontalDistanceUnits"
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    bool contains(const QString &key) const;
+    /// @return Keys directly below group, without the group prefix
+    QStringList childKeys(const QString &group) const;
+    void setValue(const QString &key, const QVariant &value);
+    void remove(const QString &key);
+
+    /// Synchronously writes all outstanding changes to disk
+    void flush();
+
+    /// Quiet time after the last change before outstanding changes are written
+    void setWriteDelay(int msecs) { _writeTimer.setInterval(msecs); }
+
+signals:
+    /// Emitted on the gui thread after the worker has written a batch of changes
+    void written();
+
+private slots:
+    void _writeTimeout();
+
+private:
+    void _scheduleWrite();
+
+    bool                        _loaded = false;
+    QHash<QString, QVariant>    _values;
+    QTimer                      _writeTimer;
+    QElapsedTimer               _firstPendingChange;
+    SettingsStoreWriter         *_writer = nullptr;
+
+    static constexpr int _writeDelayMsecs = 500;
+    static constexpr int _maxWriteDelayMsecs = 2000;   ///< Continuous changes still get written at least this often
+};
@@ -0,0 +1,589 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMDatabase.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QtEndian>
+#include <QtCore/QtMath>
+#include <QtPositioning/QGeoCoordinate>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TerrainDEMDatabaseLog, "qgc.terrain.terraindemdatabase")
+
+Q_GLOBAL_STATIC(TerrainDEMDatabase, _terrainDEMDatabase)
+
+namespace {
+    constexpr int kHgtVoid = -32768;
+
+    // TIFF tags
+    constexpr quint16 kTagImageWidth        = 256;
+    constexpr quint16 kTagImageLength       = 257;
+    constexpr quint16 kTagBitsPerSample     = 258;
+    constexpr quint16 kTagCompression       = 259;
+    constexpr quint16 kTagStripOffsets      = 273;
+    constexpr quint16 kTagSamplesPerPixel   = 277;
+    constexpr quint16 kTagRowsPerStrip      = 278;
+    constexpr quint16 kTagTileWidth         = 322;
+    constexpr quint16 kTagTileLength        = 323;
+    constexpr quint16 kTagTileOffsets       = 324;
+    constexpr quint16 kTagSampleFormat      = 339;
+    constexpr quint16 kTagModelPixelScale   = 33550;
+    constexpr quint16 kTagModelTiepoint     = 33922;
+    constexpr quint16 kTagGeoKeyDirectory   = 34735;
+    constexpr quint16 kTagGdalNoData        = 42113;
+
+    // GeoTIFF keys
+    constexpr quint16 kKeyModelType         = 1024;
+    constexpr quint16 kKeyRasterType        = 1025;
+    constexpr quint16 kModelTypeGeographic  = 2;
+    constexpr quint16 kRasterPixelIsPoint   = 2;
+
+    /// Bounds checked reads from a mapped TIFF file
+    class TiffReader
+    {
+    public:
+        TiffReader(const uchar *data, qint64 size) : _data(data), _size(size) {}
+
+        bool init()
+        {
+            if (_size < 8) {
+                return false;
+            }
+            if (memcmp(_data, "II", 2) == 0) {
+                _bigEndian = false;
+            } else if (memcmp(_data, "MM", 2) == 0) {
+                _bigEndian = true;
+            } else {
+                return false;
+            }
+            // 43 is BigTIFF which is not supported
+            return u16(2) == 42;
+        }
+
+        bool bigEndian() const { return _bigEndian; }
+        bool valid(qint64 offset, qint64 length) const { return (offset >= 0) && (length >= 0) && ((offset + length) <= _size); }
+
+        quint16 u16(qint64 offset) const
+        {
+            if (!valid(offset, 2)) { _error = true; return 0; }
+            return _bigEndian ? qFromBigEndian<quint16>(_data + offset) : qFromLittleEndian<quint16>(_data + offset);
+        }
+
+        quint32 u32(qint64 offset) const
+        {
+            if (!valid(offset, 4)) { _error = true; return 0; }
+            return _bigEndian ? qFromBigEndian<quint32>(_data + offset) : qFromLittleEndian<quint32>(_data + offset);
+        }
+
+        double f64(qint64 offset) const
+        {
+            if (!valid(offset, 8)) { _error = true; return 0; }
+            const quint64 bits = _bigEndian ? qFromBigEndian<quint64>(_data + offset) : qFromLittleEndian<quint64>(_data + offset);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        /// Value at index of a SHORT, LONG or DOUBLE tag
+        double value(quint16 type, qint64 offset, quint32 index) const
+        {
+            switch (type) {
+            case 3: return u16(offset + (index * 2));
+            case 4: return u32(offset + (index * 4));
+            case 12: return f64(offset + (index * 8));
+            default: _error = true; return 0;
+            }
+        }
+
+        static int typeSize(quint16 type)
+        {
+            switch (type) {
+            case 1: case 2: case 6: case 7: return 1;   // BYTE, ASCII, SBYTE, UNDEFINED
+            case 3: case 8: return 2;                   // SHORT, SSHORT
+            case 4: case 9: case 11: return 4;          // LONG, SLONG, FLOAT
+            case 5: case 10: case 12: return 8;         // RATIONAL, SRATIONAL, DOUBLE
+            default: return 0;
+            }
+        }
+
+        const uchar *data() const { return _data; }
+        bool error() const { return _error; }
+
+    private:
+        const uchar *_data;
+        qint64 _size;
+        bool _bigEndian = false;
+        mutable bool _error = false;
+    };
+
+    struct TiffTag_t {
+        quint16 type = 0;
+        quint32 count = 0;
+        qint64 offset = 0;      ///< Offset of the value(s) in the file
+    };
+}
+
+TerrainDEMDatabase::TerrainDEMDatabase(QObject *parent)
+    : QObject(parent)
+{
+    // qCDebug(TerrainDEMDatabaseLog) << Q_FUNC_INFO << this;
+}
+
+TerrainDEMDatabase::~TerrainDEMDatabase()
+{
+    _clear();
+
+    // qCDebug(TerrainDEMDatabaseLog) << Q_FUNC_INFO << this;
+}
+
+TerrainDEMDatabase *TerrainDEMDatabase::instance()
+{
+    return _terrainDEMDatabase();
+}
+
+void TerrainDEMDatabase::_clear()
+{
+    qDeleteAll(_rasters);
+    _rasters.clear();
+    _index.clear();
+}
+
+void TerrainDEMDatabase::setDirectory(const QString &path)
+{
+    QMutexLocker locker(&_mutex);
+
+    _clear();
+    _directory = path;
+
+    if (path.isEmpty()) {
+        return;
+    }
+
+    const QDir dir(path);
+    const QStringList nameFilters = { QStringLiteral("*.hgt"), QStringLiteral("*.tif"), QStringLiteral("*.tiff") };
+    const QFileInfoList files = dir.entryInfoList(nameFilters, QDir::Files | QDir::Readable);
+
+    // Only the headers are read, so lookups are held off for no longer than it takes to list the directory
+    for (const QFileInfo &fileInfo : files) {
+        if (!_addFile(fileInfo.absoluteFilePath())) {
+            qCWarning(TerrainDEMDatabaseLog) << "Unsupported DEM file" << fileInfo.absoluteFilePath();
+        }
+    }
+
+    qCDebug(TerrainDEMDatabaseLog) << "Indexed" << _rasters.count() << "rasters from" << path;
+}
+
+QString TerrainDEMDatabase::directory() const
+{
+    QMutexLocker locker(&_mutex);
+    return _directory;
+}
+
+int TerrainDEMDatabase::rasterCount() const
+{
+    QMutexLocker locker(&_mutex);
+    return _rasters.count();
+}
+
+bool TerrainDEMDatabase::addFile(const QString &path)
+{
+    QMutexLocker locker(&_mutex);
+    return _addFile(path);
+}
+
+bool TerrainDEMDatabase::_addFile(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == QStringLiteral("hgt")) {
+        return _addHgt(path);
+    } else if ((suffix == QStringLiteral("tif")) || (suffix == QStringLiteral("tiff"))) {
+        return _addGeoTiff(path);
+    }
+
+    return false;
+}
+
+/// SRTM: Square big endian int16 grid with 1 or 3 arc second spacing. The file name is the south west corner.
+bool TerrainDEMDatabase::_addHgt(const QString &path)
+{
+    static const QRegularExpression nameRegExp(QStringLiteral("^([NS])(\\d{2})([EW])(\\d{3})$"), QRegularExpression::CaseInsensitiveOption);
+
+    const QFileInfo fileInfo(path);
+    const QRegularExpressionMatch match = nameRegExp.match(fileInfo.completeBaseName());
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    const qint64 sampleCount = fileInfo.size() / 2;
+    const int samplesPerRow = qRound(qSqrt(static_cast<double>(sampleCount)));
+    if ((samplesPerRow < 2) || ((static_cast<qint64>(samplesPerRow) * samplesPerRow) != sampleCount)) {
+        return false;
+    }
+
+    int latitude = match.captured(2).toInt();
+    if (match.captured(1).toUpper() == QStringLiteral("S")) {
+        latitude = -latitude;
+    }
+    int longitude = match.captured(4).toInt();
+    if (match.captured(3).toUpper() == QStringLiteral("W")) {
+        longitude = -longitude;
+    }
+
+    Raster_t *raster = new Raster_t;
+    raster->path = path;
+    raster->west = longitude;
+    raster->north = latitude + 1;
+    raster->xResolution = 1.0 / (samplesPerRow - 1);
+    raster->yResolution = raster->xResolution;
+    raster->width = samplesPerRow;
+    raster->height = samplesPerRow;
+    raster->sampleFormat = SampleInt16;
+    raster->bigEndian = true;
+    raster->hasNoData = true;
+    raster->noData = kHgtVoid;
+    raster->blockWidth = samplesPerRow;
+    raster->blockHeight = samplesPerRow;
+    raster->blockOffsets = { 0 };
+
+    _rasters.append(raster);
+    _addToIndex(_rasters.count() - 1);
+
+    return true;
+}
+
+bool TerrainDEMDatabase::_addGeoTiff(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const uchar *data = file.map(0, file.size());
+    if (!data) {
+        return false;
+    }
+
+    TiffReader reader(data, file.size());
+    if (!reader.init()) {
+        return false;
+    }
+
+    QHash<quint16, TiffTag_t> tags;
+    const qint64 ifdOffset = reader.u32(4);
+    const quint16 tagCount = reader.u16(ifdOffset);
+    for (quint16 i = 0; i < tagCount; i++) {
+        const qint64 entryOffset = ifdOffset + 2 + (i * 12);
+
+        TiffTag_t tag;
+        tag.type = reader.u16(entryOffset + 2);
+        tag.count = reader.u32(entryOffset + 4);
+        const qint64 valueSize = static_cast<qint64>(TiffReader::typeSize(tag.type)) * tag.count;
+        tag.offset = (valueSize <= 4) ? (entryOffset + 8) : reader.u32(entryOffset + 8);
+        if (!reader.valid(tag.offset, valueSize)) {
+            return false;
+        }
+        tags[reader.u16(entryOffset)] = tag;
+    }
+
+    const auto tagValue = [&tags, &reader](quint16 id, double defaultValue, quint32 index = 0) -> double {
+        const auto it = tags.constFind(id);
+        if ((it == tags.constEnd()) || (index >= it->count)) {
+            return defaultValue;
+        }
+        return reader.value(it->type, it->offset, index);
+    };
+
+    const int width = static_cast<int>(tagValue(kTagImageWidth, 0));
+    const int height = static_cast<int>(tagValue(kTagImageLength, 0));
+    const int bitsPerSample = static_cast<int>(tagValue(kTagBitsPerSample, 1));
+    const int sampleFormat = static_cast<int>(tagValue(kTagSampleFormat, 1));
+
+    if ((width < 2) || (height < 2) || (tagValue(kTagCompression, 1) != 1) || (tagValue(kTagSamplesPerPixel, 1) != 1)) {
+        qCDebug(TerrainDEMDatabaseLog) << "Only uncompressed single band GeoTIFFs are supported" << path;
+        return false;
+    }
+
+    if (!tags.contains(kTagModelPixelScale) || !tags.contains(kTagModelTiepoint)) {
+        qCDebug(TerrainDEMDatabaseLog) << "Missing georeferencing" << path;
+        return false;
+    }
+
+    // Model and raster type from the GeoKey directory: header is 4 shorts followed by 4 shorts per key
+    bool geographic = true;
+    bool pixelIsPoint = false;
+    if (tags.contains(kTagGeoKeyDirectory)) {
+        const int keyCount = static_cast<int>(tagValue(kTagGeoKeyDirectory, 0, 3));
+        for (int key = 0; key < keyCount; key++) {
+            const quint32 keyIndex = 4 + (key * 4);
+            const quint16 keyId = static_cast<quint16>(tagValue(kTagGeoKeyDirectory, 0, keyIndex));
+            const quint16 keyLocation = static_cast<quint16>(tagValue(kTagGeoKeyDirectory, 0, keyIndex + 1));
+            const quint16 keyValue = static_cast<quint16>(tagValue(kTagGeoKeyDirectory, 0, keyIndex + 3));
+            if (keyLocation != 0) {
+                continue;
+            }
+            if (keyId == kKeyModelType) {
+                geographic = (keyValue == kModelTypeGeographic);
+            } else if (keyId == kKeyRasterType) {
+                pixelIsPoint = (keyValue == kRasterPixelIsPoint);
+            }
+        }
+    }
+    if (!geographic) {
+        qCDebug(TerrainDEMDatabaseLog) << "Only geographic (lat/lon) GeoTIFFs are supported" << path;
+        return false;
+    }
+
+    Raster_t *raster = new Raster_t;
+    raster->path = path;
+    raster->width = width;
+    raster->height = height;
+    raster->bigEndian = reader.bigEndian();
+
+    if ((bitsPerSample == 16) && (sampleFormat == 2)) {
+        raster->sampleFormat = SampleInt16;
+    } else if ((bitsPerSample == 16) && (sampleFormat == 1)) {
+        raster->sampleFormat = SampleUInt16;
+    } else if ((bitsPerSample == 32) && (sampleFormat == 3)) {
+        raster->sampleFormat = SampleFloat32;
+    } else {
+        qCDebug(TerrainDEMDatabaseLog) << "Unsupported sample format" << bitsPerSample << sampleFormat << path;
+        delete raster;
+        return false;
+    }
+
+    const double scaleX = tagValue(kTagModelPixelScale, 0, 0);
+    const double scaleY = tagValue(kTagModelPixelScale, 0, 1);
+    const double tieI = tagValue(kTagModelTiepoint, 0, 0);
+    const double tieJ = tagValue(kTagModelTiepoint, 0, 1);
+    const double tieX = tagValue(kTagModelTiepoint, 0, 3);
+    const double tieY = tagValue(kTagModelTiepoint, 0, 4);
+    const double pixelCenter = pixelIsPoint ? 0 : 0.5;
+
+    raster->xResolution = scaleX;
+    raster->yResolution = scaleY;
+    raster->west = tieX + ((pixelCenter - tieI) * scaleX);
+    raster->north = tieY - ((pixelCenter - tieJ) * scaleY);
+
+    if (tags.contains(kTagGdalNoData)) {
+        const TiffTag_t &noDataTag = tags[kTagGdalNoData];
+        bool ok = false;
+        raster->noData = QByteArray(reinterpret_cast<const char*>(reader.data() + noDataTag.offset), noDataTag.count).trimmed().replace('\0', "").toDouble(&ok);
+        raster->hasNoData = ok;
+    }
+
+    quint16 offsetsTag;
+    if (tags.contains(kTagTileOffsets)) {
+        raster->blockWidth = static_cast<int>(tagValue(kTagTileWidth, 0));
+        raster->blockHeight = static_cast<int>(tagValue(kTagTileLength, 0));
+        offsetsTag = kTagTileOffsets;
+    } else {
+        raster->blockWidth = width;
+        raster->blockHeight = qMin(static_cast<int>(tagValue(kTagRowsPerStrip, height)), height);
+        offsetsTag = kTagStripOffsets;
+    }
+
+    const TiffTag_t offsets = tags.value(offsetsTag);
+    for (quint32 i = 0; i < offsets.count; i++) {
+        raster->blockOffsets.append(static_cast<quint64>(reader.value(offsets.type, offsets.offset, i)));
+    }
+
+    const int blocksAcross = (raster->blockWidth > 0) ? ((width + raster->blockWidth - 1) / raster->blockWidth) : 0;
+    const int blocksDown = (raster->blockHeight > 0) ? ((height + raster->blockHeight - 1) / raster->blockHeight) : 0;
+    if (reader.error() || (scaleX <= 0) || (scaleY <= 0) || (blocksAcross == 0) || (raster->blockOffsets.count() < (blocksAcross * blocksDown))) {
+        qCDebug(TerrainDEMDatabaseLog) << "Invalid GeoTIFF layout" << path;
+        delete raster;
+        return false;
+    }
+
+    _rasters.append(raster);
+    _addToIndex(_rasters.count() - 1);
+
+    return true;
+}
+
+void TerrainDEMDatabase::_addToIndex(int rasterIndex)
+{
+    Raster_t *raster = _rasters[rasterIndex];
+    raster->blocksAcross = (raster->width + raster->blockWidth - 1) / raster->blockWidth;
+    raster->bytesPerSample = (raster->sampleFormat == SampleFloat32) ? 4 : 2;
+
+    const double south = raster->north - ((raster->height - 1) * raster->yResolution);
+    const double east = raster->west + ((raster->width - 1) * raster->xResolution);
+
+    // Edges which fall exactly on a whole degree must also be found from the neighbouring cell
+    static constexpr double kEpsilon = 1e-9;
+    for (int latitude = qFloor(south - kEpsilon); latitude <= qFloor(raster->north + kEpsilon); latitude++) {
+        for (int longitude = qFloor(raster->west - kEpsilon); longitude <= qFloor(east + kEpsilon); longitude++) {
+            _index[_cellKey(latitude, longitude)].append(rasterIndex);
+        }
+    }
+
+    qCDebug(TerrainDEMDatabaseLog) << "Added" << raster->path << "south:west:north:east" << south << raster->west << raster->north << east;
+}
+
+bool TerrainDEMDatabase::_map(Raster_t &raster)
+{
+    if (raster.data) {
+        return true;
+    }
+
+    if (raster.file) {
+        // Mapping failed before
+        return false;
+    }
+
+    raster.file = std::make_unique<QFile>(raster.path);
+    if (!raster.file->open(QIODevice::ReadOnly)) {
+        qCWarning(TerrainDEMDatabaseLog) << "Unable to open" << raster.path << raster.file->errorString();
+        return false;
+    }
+
+    raster.size = raster.file->size();
+    raster.data = raster.file->map(0, raster.size);
+    if (!raster.data) {
+        qCWarning(TerrainDEMDatabaseLog) << "Unable to map" << raster.path << raster.file->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool TerrainDEMDatabase::_sample(Raster_t &raster, int column, int row, double &value) const
+{
+    const int blockIndex = ((row / raster.blockHeight) * raster.blocksAcross) + (column / raster.blockWidth);
+    const int bytesPerSample = raster.bytesPerSample;
+    const qint64 offset = static_cast<qint64>(raster.blockOffsets.constData()[blockIndex]) +
+            ((static_cast<qint64>(row % raster.blockHeight) * raster.blockWidth) + (column % raster.blockWidth)) * bytesPerSample;
+
+    if ((offset < 0) || ((offset + bytesPerSample) > raster.size)) {
+        return false;
+    }
+
+    const uchar *sample = raster.data + offset;
+    switch (raster.sampleFormat) {
+    case SampleInt16:
+        value = raster.bigEndian ? qFromBigEndian<qint16>(sample) : qFromLittleEndian<qint16>(sample);
+        break;
+    case SampleUInt16:
+        value = raster.bigEndian ? qFromBigEndian<quint16>(sample) : qFromLittleEndian<quint16>(sample);
+        break;
+    case SampleFloat32:
+    {
+        const quint32 bits = raster.bigEndian ? qFromBigEndian<quint32>(sample) : qFromLittleEndian<quint32>(sample);
+        float floatValue;
+        memcpy(&floatValue, &bits, sizeof(floatValue));
+        value = floatValue;
+        break;
+    }
+    }
+
+    return !qIsNaN(value) && !(raster.hasNoData && (value == raster.noData));
+}
+
+bool TerrainDEMDatabase::_interpolate(Raster_t &raster, double latitude, double longitude, double &elevation) const
+{
+    static constexpr double kEpsilon = 1e-9;
+
+    double x = (longitude - raster.west) / raster.xResolution;
+    double y = (raster.north - latitude) / raster.yResolution;
+    if ((x < -kEpsilon) || (y < -kEpsilon) || (x > (raster.width - 1 + kEpsilon)) || (y > (raster.height - 1 + kEpsilon))) {
+        return false;
+    }
+    x = qBound(0.0, x, static_cast<double>(raster.width - 1));
+    y = qBound(0.0, y, static_cast<double>(raster.height - 1));
+
+    const int column0 = qMin(static_cast<int>(x), raster.width - 2);
+    const int row0 = qMin(static_cast<int>(y), raster.height - 2);
+    const double fx = x - column0;
+    const double fy = y - row0;
+
+    const struct {
+        int column;
+        int row;
+        double weight;
+    } corners[4] = {
+        { column0,      row0,       (1 - fx) * (1 - fy) },
+        { column0 + 1,  row0,       fx * (1 - fy) },
+        { column0,      row0 + 1,   (1 - fx) * fy },
+        { column0 + 1,  row0 + 1,   fx * fy },
+    };
+
+    // Void samples are left out and the remaining weights renormalized
+    double sum = 0;
+    double totalWeight = 0;
+    for (const auto &corner : corners) {
+        double value;
+        if ((corner.weight > 0) && _sample(raster, corner.column, corner.row, value)) {
+            sum += value * corner.weight;
+            totalWeight += corner.weight;
+        }
+    }
+
+    if (totalWeight <= 0) {
+        return false;
+    }
+
+    elevation = sum / totalWeight;
+    return true;
+}
+
+/// Caller must hold the mutex
+bool TerrainDEMDatabase::_elevation(double latitude, double longitude, double &elevation)
+{
+    const auto it = _index.constFind(_cellKey(qFloor(latitude), qFloor(longitude)));
+    if (it == _index.constEnd()) {
+        return false;
+    }
+
+    for (const int rasterIndex : it.value()) {
+        Raster_t &raster = *_rasters.at(rasterIndex);
+        if (_map(raster) && _interpolate(raster, latitude, longitude, elevation)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TerrainDEMDatabase::getElevation(const QGeoCoordinate &coordinate, double &elevation)
+{
+    QMutexLocker locker(&_mutex);
+
+    return _elevation(coordinate.latitude(), coordinate.longitude(), elevation);
+}
+
+bool TerrainDEMDatabase::getElevations(const QList<QGeoCoordinate> &coordinates, QList<double> &elevations)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (_rasters.isEmpty()) {
+        return false;
+    }
+
+    QList<double> result;
+    result.reserve(coordinates.count());
+
+    for (const QGeoCoordinate &coordinate : coordinates) {
+        double elevation;
+        if (!_elevation(coordinate.latitude(), coordinate.longitude(), elevation)) {
+            return false;
+        }
+        result.append(elevation);
+    }
+
+    elevations = result;
+    return true;
+}
@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+#include <memory>
+
+class QFile;
+class QGeoCoordinate;
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainDEMDatabaseLog)
+
+/// Local elevation data read straight from DEM files in a directory, without any network access.
+///
+/// Supported are SRTM .hgt files and single band, uncompressed GeoTIFFs in geographic WGS84 coordinates
+/// (int16, uint16 or float32 samples, stripped or tiled). Only the headers are read when the directory is
+/// indexed. The rasters are memory mapped on first use so a lookup is a bounds check and a couple of reads.
+class TerrainDEMDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TerrainDEMDatabase(QObject *parent = nullptr);
+    ~TerrainDEMDatabase();
+
+    static TerrainDEMDatabase *instance();
+
+    /// Rebuilds the tile index from the DEM files found in the specified directory (non-recursive)
+    void setDirectory(const QString &path);
+    QString directory() const;
+
+    /// @return Number of rasters in the index
+    int rasterCount() const;
+
+    /// Bilinear interpolated elevation in meters AMSL. Doesn't allocate once the raster is mapped.
+    ///     @return false: coordinate not covered by local data
+    bool getElevation(const QGeoCoordinate &coordinate, double &elevation);
+
+    /// @return false: at least one coordinate is not covered by local data, elevations is not valid
+    bool getElevations(const QList<QGeoCoordinate> &coordinates, QList<double> &elevations);
+
+    /// Adds a single file to the index
+    ///     @return false: file is not a supported DEM
+    bool addFile(const QString &path);
+
+private:
+    enum SampleFormat {
+        SampleInt16,
+        SampleUInt16,
+        SampleFloat32,
+    };
+
+    struct Raster_t {
+        QString path;
+        double west = 0;                ///< Longitude of the center of the first column
+        double north = 0;               ///< Latitude of the center of the first row
+        double xResolution = 0;         ///< Degrees per column
+        double yResolution = 0;         ///< Degrees per row
+        int width = 0;
+        int height = 0;
+        SampleFormat sampleFormat = SampleInt16;
+        bool bigEndian = false;
+        bool hasNoData = false;
+        double noData = 0;
+        int blockWidth = 0;             ///< Strip or tile layout
+        int blockHeight = 0;
+        int blocksAcross = 0;
+        int bytesPerSample = 2;
+        QList<quint64> blockOffsets;
+
+        std::unique_ptr<QFile> file;    ///< Mapped on first use
+        const uchar *data = nullptr;
+        qint64 size = 0;
+    };
+
+    bool _addFile(const QString &path);
+    bool _addHgt(const QString &path);
+    bool _addGeoTiff(const QString &path);
+    void _addToIndex(int rasterIndex);
+    bool _map(Raster_t &raster);
+    bool _sample(Raster_t &raster, int column, int row, double &value) const;
+    bool _interpolate(Raster_t &raster, double latitude, double longitude, double &elevation) const;
+    bool _elevation(double latitude, double longitude, double &elevation);
+    void _clear();
+
+    static qint64 _cellKey(int latitude, int longitude) { return (static_cast<qint64>(latitude) << 32) | static_cast<quint32>(longitude); }
+
+    QString _directory;
+    QList<Raster_t*> _rasters;
+    QHash<qint64, QList<int>> _index;   ///< 1 degree cells to the rasters covering them
+    mutable QMutex _mutex;              ///< Protects everything above, lookups come from the terrain query threads
+};
@@ -10,9 +10,13 @@
 #include "TerrainTile.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QDataStream>
+#include <QtCore/QtEndian>
 #include <QtCore/QtNumeric>
 #include <QtPositioning/QGeoCoordinate>
 
+#include <cstring>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "qgc.terrain.terraintile");
 
 TerrainTile::TerrainTile()
@@ -21,13 +25,12 @@ TerrainTile::TerrainTile()
 }
 
 TerrainTile::TerrainTile(const QByteArray &byteArray)
-    : _tileInfo(*reinterpret_cast<const TileInfo_t*>(byteArray.constData()))
 {
     // qCDebug(TerrainTileLog) << Q_FUNC_INFO << this;
 
-    if (((_tileInfo.neLon - _tileInfo.swLon) < 0.0) || ((_tileInfo.neLat - _tileInfo.swLat) < 0.0)) {
-        qCWarning(TerrainTileLog) << this << "Tile extent is infeasible";
-        _isValid = false;
+    _isValid = isBinaryTile(byteArray) ? _parseBinary(byteArray) : _parseLegacy(byteArray);
+    if (!_isValid) {
+        _elevationData.clear();
         return;
     }
 
@@ -36,38 +39,9 @@ TerrainTile::TerrainTile(const QByteArray &byteArray)
 
     qCDebug(TerrainTileLog) << this << "TileInfo: south west:" << _tileInfo.swLat << _tileInfo.swLon;
     qCDebug(TerrainTileLog) << this << "TileInfo: north east:" << _tileInfo.neLat << _tileInfo.neLon;
-    qCDebug(TerrainTileLog) << this << "TileInfo: dimensions:" << _tileInfo.gridSizeLat << "by" << _tileInfo.gridSizeLat;
+    qCDebug(TerrainTileLog) << this << "TileInfo: dimensions:" << _tileInfo.gridSizeLat << "by" << _tileInfo.gridSizeLon;
     qCDebug(TerrainTileLog) << this << "TileInfo: min, max, avg:" << _tileInfo.minElevation << _tileInfo.maxElevation << _tileInfo.avgElevation;
     qCDebug(TerrainTileLog) << this << "TileInfo: cell size:" << _cellSizeLat << _cellSizeLon;
-
-    const int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    const int cTileBytesAvailable = byteArray.size();
-
-    if (cTileBytesAvailable < cTileHeaderBytes) {
-        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
-        return;
-    }
-
-    const int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
-    if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
-        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for tile data";
-        return;
-    }
-
-    _elevationData.resize(_tileInfo.gridSizeLat);
-    for (int k = 0; k < _tileInfo.gridSizeLat; k++) {
-        _elevationData[k].resize(_tileInfo.gridSizeLon);
-    }
-
-    int valueIndex = 0;
-    const int16_t* const pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _tileInfo.gridSizeLat; i++) {
-        for (int j = 0; j < _tileInfo.gridSizeLon; j++) {
-            _elevationData[i][j] = pTileData[valueIndex++];
-        }
-    }
-
-    _isValid = true;
 }
 
 TerrainTile::~TerrainTile()
@@ -96,13 +70,14 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
         return qQNaN();
     }
 
-    if ((latIndex >= _elevationData.size()) || (lonIndex >= _elevationData[latIndex].size())) {
+    const qsizetype valueIndex = (static_cast<qsizetype>(latIndex) * _tileInfo.gridSizeLon) + lonIndex;
+    if (valueIndex >= _elevationData.size()) {
         qCWarning(TerrainTileLog).noquote() << this << "Internal error: _elevationData size inconsistent _tileInfo << coordinate" << coordinate
             << "\n\t_tillIndo.gridSizeLat: " << _tileInfo.gridSizeLat << " _tileInfo.gridSizeLon: " << _tileInfo.gridSizeLon
-            << "\n\t_data.size(): " << _elevationData.size() << " _elevationData[latIndex].size(): " << _elevationData[latIndex].size();
+            << "\n\t_data.size(): " << _elevationData.size();
         return qQNaN();
     }
-    const auto elevation = _elevationData[latIndex][lonIndex];
+    const auto elevation = _elevationData[valueIndex];
 
     if (elevation < _tileInfo.minElevation) {
         qCWarning(TerrainTileLog) << this << "Warning: elevation read is below min elevation in tile:" << elevation << "<" << _tileInfo.minElevation;
@@ -114,3 +89,135 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
 
     return static_cast<double>(elevation);
 }
+
+bool TerrainTile::isBinaryTile(QByteArrayView data)
+{
+    return data.startsWith(QByteArrayView(_binaryMagic));
+}
+
+QByteArray TerrainTile::serializeBinary(const TileInfo_t &tileInfo, const QList<int16_t> &elevations)
+{
+    const qsizetype valueCount = static_cast<qsizetype>(tileInfo.gridSizeLat) * tileInfo.gridSizeLon;
+    if ((tileInfo.gridSizeLat <= 0) || (tileInfo.gridSizeLon <= 0) || (elevations.count() != valueCount)) {
+        qCWarning(TerrainTileLog) << Q_FUNC_INFO << "grid size does not match elevation count" << tileInfo.gridSizeLat << tileInfo.gridSizeLon << elevations.count();
+        return QByteArray();
+    }
+
+    // Neighbouring samples are close in value, so the deltas are mostly tiny and compress well
+    QByteArray deltas(valueCount * static_cast<qsizetype>(sizeof(int16_t)), Qt::Uninitialized);
+    uchar* const pDeltas = reinterpret_cast<uchar*>(deltas.data());
+    uint16_t previous = 0;
+    for (qsizetype i = 0; i < valueCount; i++) {
+        const uint16_t value = static_cast<uint16_t>(elevations[i]);
+        qToLittleEndian<uint16_t>(static_cast<uint16_t>(value - previous), pDeltas + (i * 2));
+        previous = value;
+    }
+    // Part of the format: qCompress puts the uncompressed size as a big endian uint32 in front of the zlib stream
+    const QByteArray payload = qCompress(deltas);
+
+    QByteArray result;
+    result.reserve(_binaryHeaderSize + payload.size());
+
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    (void) stream.writeRawData(_binaryMagic, 4);
+    stream << _binaryVersion;
+    stream << tileInfo.swLat << tileInfo.swLon << tileInfo.neLat << tileInfo.neLon;
+    stream << tileInfo.minElevation << tileInfo.maxElevation << tileInfo.avgElevation;
+    stream << tileInfo.gridSizeLat << tileInfo.gridSizeLon;
+    stream << static_cast<quint32>(payload.size());
+    (void) stream.writeRawData(payload.constData(), payload.size());
+
+    return result;
+}
+
+bool TerrainTile::_parseBinary(const QByteArray &byteArray)
+{
+    if (byteArray.size() < _binaryHeaderSize) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for header";
+        return false;
+    }
+
+    QDataStream stream(byteArray);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    (void) stream.skipRawData(4);
+
+    quint8 version;
+    stream >> version;
+    if (version != _binaryVersion) {
+        qCWarning(TerrainTileLog) << "Unsupported terrain tile version" << version;
+        return false;
+    }
+
+    quint32 payloadSize;
+    stream >> _tileInfo.swLat >> _tileInfo.swLon >> _tileInfo.neLat >> _tileInfo.neLon;
+    stream >> _tileInfo.minElevation >> _tileInfo.maxElevation >> _tileInfo.avgElevation;
+    stream >> _tileInfo.gridSizeLat >> _tileInfo.gridSizeLon;
+    stream >> payloadSize;
+
+    if (((_tileInfo.neLon - _tileInfo.swLon) < 0.0) || ((_tileInfo.neLat - _tileInfo.swLat) < 0.0) || (_tileInfo.gridSizeLat <= 0) || (_tileInfo.gridSizeLon <= 0)) {
+        qCWarning(TerrainTileLog) << this << "Tile extent is infeasible";
+        return false;
+    }
+
+    if ((byteArray.size() - _binaryHeaderSize) < static_cast<qsizetype>(payloadSize)) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for tile data";
+        return false;
+    }
+
+    // Check the size prefix before qUncompress allocates what it says
+    const uchar* const pPayload = reinterpret_cast<const uchar*>(byteArray.constData() + _binaryHeaderSize);
+    const qsizetype valueCount = static_cast<qsizetype>(_tileInfo.gridSizeLat) * _tileInfo.gridSizeLon;
+    const qsizetype deltasSize = valueCount * static_cast<qsizetype>(sizeof(int16_t));
+    if ((payloadSize < _binaryPayloadPrefixSize) || (static_cast<qsizetype>(qFromBigEndian<quint32>(pPayload)) != deltasSize)) {
+        qCWarning(TerrainTileLog) << "Terrain tile data size does not match grid size";
+        return false;
+    }
+
+    const QByteArray deltas = qUncompress(pPayload, static_cast<qsizetype>(payloadSize));
+    if (deltas.size() != deltasSize) {
+        qCWarning(TerrainTileLog) << "Terrain tile data does not match grid size";
+        return false;
+    }
+
+    _elevationData.resize(valueCount);
+    const uchar* const pDeltas = reinterpret_cast<const uchar*>(deltas.constData());
+    uint16_t value = 0;
+    for (qsizetype i = 0; i < valueCount; i++) {
+        value += qFromLittleEndian<uint16_t>(pDeltas + (i * 2));
+        _elevationData[i] = static_cast<int16_t>(value);
+    }
+
+    return true;
+}
+
+bool TerrainTile::_parseLegacy(const QByteArray &byteArray)
+{
+    const int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
+    const int cTileBytesAvailable = byteArray.size();
+
+    if (cTileBytesAvailable < cTileHeaderBytes) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
+        return false;
+    }
+
+    (void) memcpy(&_tileInfo, byteArray.constData(), sizeof(TileInfo_t));
+
+    if (((_tileInfo.neLon - _tileInfo.swLon) < 0.0) || ((_tileInfo.neLat - _tileInfo.swLat) < 0.0) || (_tileInfo.gridSizeLat <= 0) || (_tileInfo.gridSizeLon <= 0)) {
+        qCWarning(TerrainTileLog) << this << "Tile extent is infeasible";
+        return false;
+    }
+
+    const int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
+    if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for tile data";
+        return false;
+    }
+
+    _elevationData.resize(static_cast<qsizetype>(_tileInfo.gridSizeLat) * _tileInfo.gridSizeLon);
+    (void) memcpy(_elevationData.data(), byteArray.constData() + cTileHeaderBytes, cTileDataBytes);
+
+    return true;
+}
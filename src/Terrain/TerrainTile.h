@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <QtCore/QByteArrayView>
 #include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
 
@@ -16,16 +17,26 @@ class QGeoCoordinate;
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
 
+/// Elevation grid for a rectangular area.
+///
+/// Tiles are cached in a compact binary format: a little endian header holding the bounds, stats and grid
+/// dimensions, followed by the compressed, row-major int16 grid where each value is stored as the difference to
+/// the previous one. The compressed payload is the qCompress layout: the uncompressed size in bytes as a big
+/// endian uint32, followed by a zlib (RFC 1950) stream. Tiles written by older versions as a raw header/grid
+/// memory dump are still accepted.
 class TerrainTile
 {
 public:
     TerrainTile();
 
     /// Constructor from serialized elevation data (either from file or web)
-    ///    @param document
+    ///    @param byteArray Binary tile or legacy raw tile
     explicit TerrainTile(const QByteArray &byteArray);
     ~TerrainTile();
 
+    /// @return true: data starts with the binary tile format signature
+    static bool isBinaryTile(QByteArrayView data);
+
     /// Check whether valid data is loaded
     ///    @return true if data is valid
     bool isValid() const { return _isValid; }
@@ -55,9 +66,21 @@ protected:
         int16_t gridSizeLat, gridSizeLon;
     };
 
+    /// Builds a binary tile
+    ///     @param elevations Row-major grid, gridSizeLat rows of gridSizeLon values
+    static QByteArray serializeBinary(const TileInfo_t &tileInfo, const QList<int16_t> &elevations);
+
 private:
+    bool _parseBinary(const QByteArray &byteArray);
+    bool _parseLegacy(const QByteArray &byteArray);
+
+    static constexpr const char *_binaryMagic = "QGTB";
+    static constexpr quint8 _binaryVersion = 1;
+    static constexpr qsizetype _binaryHeaderSize = 4 + 1 + (4 * 8) + (2 * 2) + 8 + (2 * 2) + 4;  ///< magic, version, bounds, min/max, avg, grid size, payload size
+    static constexpr qsizetype _binaryPayloadPrefixSize = 4;   ///< Big endian uncompressed size in front of the zlib stream
+
     TileInfo_t _tileInfo{};
-    QList<QList<int16_t>> _elevationData;   /// 2D elevation data array
+    QList<int16_t> _elevationData;          /// Row-major elevation data array
     double _cellSizeLat = 0.0;              /// data grid size in latitude direction
     double _cellSizeLon = 0.0;              /// data grid size in longitude direction
     bool _isValid = false;                  /// data loaded is valid
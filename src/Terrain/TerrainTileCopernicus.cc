@@ -33,6 +33,19 @@ TerrainTileCopernicus::~TerrainTileCopernicus()
     // qCDebug(TerrainTileCopernicusLog) << Q_FUNC_INFO << this;
 }
 
+QByteArray TerrainTileCopernicus::serialize(const QByteArray &input)
+{
+    if (isBinaryTile(input)) {
+        if (!TerrainTile(input).isValid()) {
+            qCWarning(TerrainTileCopernicusLog) << Q_FUNC_INFO << "Invalid binary terrain tile";
+            return QByteArray();
+        }
+        return input;
+    }
+
+    return serializeFromJson(input);
+}
+
 QByteArray TerrainTileCopernicus::serializeFromJson(const QByteArray &input)
 {
     QJsonParseError parseError;
@@ -127,16 +140,8 @@ QByteArray TerrainTileCopernicus::serializeFromJson(const QByteArray &input)
     qCDebug(TerrainTileCopernicusLog) << "Serialize: TileInfo: south west:" << tileInfo.swLat << tileInfo.swLon;
     qCDebug(TerrainTileCopernicusLog) << "Serialize: TileInfo: north east:" << tileInfo.neLat << tileInfo.neLon;
 
-    const int cTileNumHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    const int cTileNumDataBytes = static_cast<int>(sizeof(int16_t)) * tileInfo.gridSizeLat * tileInfo.gridSizeLon;
-
-    QByteArray result(cTileNumHeaderBytes + cTileNumDataBytes, Qt::Uninitialized);
-    TileInfo_t *pTileInfo = reinterpret_cast<TileInfo_t*>(result.data());
-    int16_t* const pTileData = reinterpret_cast<int16_t*>(&reinterpret_cast<uint8_t*>(result.data())[cTileNumHeaderBytes]);
-
-    *pTileInfo = tileInfo;
-
-    int valueIndex = 0;
+    QList<int16_t> elevations;
+    elevations.reserve(static_cast<qsizetype>(tileInfo.gridSizeLat) * tileInfo.gridSizeLon);
     for (qsizetype i = 0; i < static_cast<qsizetype>(tileInfo.gridSizeLat); i++) {
         const QJsonArray &row = carpetArray[i].toArray();
         if (row.count() < tileInfo.gridSizeLon) {
@@ -145,9 +150,9 @@ QByteArray TerrainTileCopernicus::serializeFromJson(const QByteArray &input)
         }
 
         for (qsizetype j = 0; j < static_cast<qsizetype>(tileInfo.gridSizeLon); j++) {
-            pTileData[valueIndex++] = static_cast<int16_t>(row[j].toDouble());
+            elevations.append(static_cast<int16_t>(row[j].toDouble()));
         }
     }
 
-    return result;
+    return serializeBinary(tileInfo, elevations);
 }
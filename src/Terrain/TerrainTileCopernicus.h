@@ -27,6 +27,9 @@ public:
     explicit TerrainTileCopernicus(const QByteArray &byteArray);
     ~TerrainTileCopernicus();
 
+    /// Converts a downloaded tile to the binary cache format.
+    /// Binary tiles are passed through as is, anything else is parsed as a JSON carpet response.
+    static QByteArray serialize(const QByteArray &input);
     static QByteArray serializeFromJson(const QByteArray &input);
 
     static constexpr double tileSizeDegrees = 0.01;                 ///< Each terrain tile represents a square area .01 degrees in lat/lon
@@ -10,8 +10,10 @@
 #include "TerrainTileManager.h"
 #include "TerrainTile.h"
 #include "TerrainTileCopernicus.h"
+#include "TerrainDEMDatabase.h"
 // #include "TerrainQueryAirMap.h"
 #include "QGeoTileFetcherQGC.h"
+#include "QGCTilePrefetcher.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGCMapUrlEngine.h"
 #include "ElevationMapProvider.h"
@@ -148,13 +150,28 @@ void TerrainTileManager::addPathQuery(TerrainQueryInterface *terrainQueryInterfa
     terrainQueryInterface->signalPathHeights((coordinates.count() == altitudes.count()), distanceBetween, finalDistanceBetween, altitudes);
 }
 
+void TerrainTileManager::prefetchPath(const QList<QGeoCoordinate> &path, double corridorMeters)
+{
+    // Copernicus tiles don't depend on zoom, the prefetcher samples them at their own tile size
+    static const QList<int> kTerrainZoomLevels = { 1 };
+    (void) QGCTilePrefetcher::instance()->prefetchPath(CopernicusElevationProvider::kProviderKey, path, kTerrainZoomLevels, corridorMeters);
+}
+
 bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error)
 {
     error = false;
 
     static const QString kMapType = CopernicusElevationProvider::kProviderKey;
     const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
+    TerrainDEMDatabase* const demDatabase = TerrainDEMDatabase::instance();
     for (const QGeoCoordinate &coordinate: coordinates) {
+        // Local DEM files take precedence over downloaded tiles
+        double demElevation;
+        if (demDatabase->getElevation(coordinate, demElevation)) {
+            altitudes.push_back(demElevation);
+            continue;
+        }
+
         const QString tileHash = UrlFactory::getTileHash(
             provider->getMapName(),
             provider->long2tileX(coordinate.longitude(), 1),
@@ -40,6 +40,9 @@ public:
     ///     @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
     bool getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error);
 
+    /// Queues the elevation tiles covering a corridor around the path for low priority background download
+    void prefetchPath(const QList<QGeoCoordinate> &path, double corridorMeters);
+
     /// Returns a list of individual coordinates along the requested path spaced according to the terrain tile value spacing
     static QList<QGeoCoordinate> pathQueryToCoords(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, double &distanceBetween, double &finalDistanceBetween);
 
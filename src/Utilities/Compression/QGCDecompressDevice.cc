@@ -0,0 +1,300 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCDecompressDevice.h"
+#include "QGCLoggingCategory.h"
+#include "QGCLZMA.h"
+#include "QGCZlib.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+
+QGC_LOGGING_CATEGORY(QGCDecompressDeviceLog, "qgc.compression.qgcdecompressdevice")
+
+QGCDecompressDevice::QGCDecompressDevice(QIODevice *source, Format format, qint64 size, QObject *parent)
+    : QIODevice(parent)
+    , _source(source)
+    , _format(format)
+    , _sourceRemaining(size)
+    , _input(_inputChunkSize, Qt::Uninitialized)
+{
+    const auto output = [this](const char *data, qsizetype size) {
+        _decoded.append(data, size);
+        return true;
+    };
+
+    switch (format) {
+    case Xz:
+        _xzDecoder = std::make_unique<QGCLZMA::Decoder>(output);
+        break;
+    case Gzip:
+        _inflater = std::make_unique<QGCZlib::Inflater>(output, QGCZlib::Inflater::Gzip);
+        break;
+    case Zlib:
+        _inflater = std::make_unique<QGCZlib::Inflater>(output, QGCZlib::Inflater::Zlib);
+        break;
+    case Deflate:
+        _inflater = std::make_unique<QGCZlib::Inflater>(output, QGCZlib::Inflater::Deflate);
+        break;
+    case Stored:
+        break;
+    }
+}
+
+QGCDecompressDevice::~QGCDecompressDevice()
+{
+
+}
+
+bool QGCDecompressDevice::open(OpenMode mode)
+{
+    if (mode & WriteOnly) {
+        setErrorString(tr("Decompression device is read only"));
+        return false;
+    }
+    if (!_source || !_source->isReadable()) {
+        setErrorString(tr("Compressed data source is not readable"));
+        return false;
+    }
+
+    return QIODevice::open(mode);
+}
+
+bool QGCDecompressDevice::atEnd() const
+{
+    return !isOpen() || _failed || (_finished && QIODevice::atEnd());
+}
+
+qint64 QGCDecompressDevice::bytesAvailable() const
+{
+    return (_decoded.size() - _decodedOffset) + QIODevice::bytesAvailable();
+}
+
+qint64 QGCDecompressDevice::readData(char *data, qint64 maxSize)
+{
+    if (_failed) {
+        return -1;
+    }
+
+    qint64 bytesRead = 0;
+    while (bytesRead < maxSize) {
+        if (_decodedOffset == _decoded.size()) {
+            if (_finished) {
+                break;
+            }
+            if (!_decodeMore()) {
+                qCWarning(QGCDecompressDeviceLog) << errorString();
+                _failed = true;
+                return (bytesRead > 0) ? bytesRead : -1;
+            }
+            continue;
+        }
+
+        const qint64 count = qMin(maxSize - bytesRead, static_cast<qint64>(_decoded.size() - _decodedOffset));
+        (void) memcpy(data + bytesRead, _decoded.constData() + _decodedOffset, static_cast<size_t>(count));
+        bytesRead += count;
+        _decodedOffset += count;
+    }
+
+    return bytesRead;
+}
+
+qint64 QGCDecompressDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+
+    return -1;
+}
+
+/// Decodes source data until there are new decoded bytes or the end of the stream is reached
+bool QGCDecompressDevice::_decodeMore()
+{
+    _decoded.clear();
+    _decodedOffset = 0;
+
+    while (_decoded.isEmpty() && !_finished) {
+        qint64 bytesToRead = _inputChunkSize;
+        if (_sourceRemaining >= 0) {
+            bytesToRead = qMin(bytesToRead, _sourceRemaining);
+        }
+        const qint64 bytesRead = (bytesToRead > 0) ? _source->read(_input.data(), bytesToRead) : 0;
+        if (bytesRead < 0) {
+            setErrorString(tr("Read of compressed data failed: %1").arg(_source->errorString()));
+            return false;
+        }
+        if (bytesRead == 0) {
+            if (_format == Stored) {
+                _finished = true;
+                break;
+            }
+            setErrorString(tr("Compressed data is truncated"));
+            return false;
+        }
+        if (_sourceRemaining >= 0) {
+            _sourceRemaining -= bytesRead;
+        }
+
+        if (_format == Stored) {
+            _decoded.append(_input.constData(), bytesRead);
+            continue;
+        }
+
+        const bool decoded = _xzDecoder ? _xzDecoder->decode(_input.constData(), bytesRead) : _inflater->inflate(_input.constData(), bytesRead);
+        if (!decoded) {
+            setErrorString(tr("Compressed data is corrupt"));
+            return false;
+        }
+        _finished = _xzDecoder ? _xzDecoder->finished() : _inflater->finished();
+    }
+
+    return true;
+}
+
+QGCDecompressDevice::Format QGCDecompressDevice::detectFormat(const QByteArray &header)
+{
+    static constexpr char xzMagic[] = { '\xFD', '7', 'z', 'X', 'Z', '\x00' };
+
+    if (header.startsWith(QByteArray::fromRawData(xzMagic, sizeof(xzMagic)))) {
+        return Xz;
+    }
+    if (header.length() < 2) {
+        return Stored;
+    }
+
+    const uint8_t byte0 = static_cast<uint8_t>(header[0]);
+    const uint8_t byte1 = static_cast<uint8_t>(header[1]);
+    if ((byte0 == 0x1F) && (byte1 == 0x8B)) {
+        return Gzip;
+    }
+    // Deflate method, a window of at most 32K, no preset dictionary and a header check which is a multiple of 31
+    if (((byte0 & 0x0F) == 8) && ((byte0 >> 4) <= 7) && ((byte1 & 0x20) == 0) && ((((byte0 << 8) | byte1) % 31) == 0)) {
+        return Zlib;
+    }
+
+    return Stored;
+}
+
+QGCDecompressDevice *QGCDecompressDevice::zipEntry(QIODevice *zipSource, const QString &entryName, QString &errorString, QObject *parent)
+{
+    constexpr quint32 cEndRecordSignature = 0x06054b50;
+    constexpr quint32 cDirectoryEntrySignature = 0x02014b50;
+    constexpr quint32 cLocalHeaderSignature = 0x04034b50;
+    constexpr qint64 cEndRecordSize = 22;
+    constexpr qint64 cDirectoryEntrySize = 46;
+    constexpr qint64 cLocalHeaderSize = 30;
+
+    if (!zipSource || !zipSource->isReadable() || zipSource->isSequential()) {
+        errorString = tr("Zip archive must be readable and random access");
+        return nullptr;
+    }
+
+    // The end of central directory record is at the end of the archive, only followed by an optional comment
+    const qint64 archiveSize = zipSource->size();
+    const qint64 tailSize = qMin<qint64>(archiveSize, cEndRecordSize + 0xFFFF);
+    (void) zipSource->seek(archiveSize - tailSize);
+    const QByteArray tail = zipSource->read(tailSize);
+    qsizetype endRecord = -1;
+    for (qsizetype i = tail.size() - cEndRecordSize; i >= 0; i--) {
+        if (qFromLittleEndian<quint32>(tail.constData() + i) == cEndRecordSignature) {
+            endRecord = i;
+            break;
+        }
+    }
+    if (endRecord < 0) {
+        errorString = tr("Not a zip archive");
+        return nullptr;
+    }
+
+    const quint32 directorySize = qFromLittleEndian<quint32>(tail.constData() + endRecord + 12);
+    const quint32 directoryOffset = qFromLittleEndian<quint32>(tail.constData() + endRecord + 16);
+    if (!zipSource->seek(directoryOffset)) {
+        errorString = tr("Zip archive is corrupt");
+        return nullptr;
+    }
+    const QByteArray directory = zipSource->read(directorySize);
+
+    const QByteArray name = entryName.toUtf8();
+    qsizetype pos = 0;
+    while ((pos + cDirectoryEntrySize) <= directory.size()) {
+        const char *entry = directory.constData() + pos;
+        if (qFromLittleEndian<quint32>(entry) != cDirectoryEntrySignature) {
+            break;
+        }
+        const quint16 method = qFromLittleEndian<quint16>(entry + 10);
+        const quint32 compressedSize = qFromLittleEndian<quint32>(entry + 20);
+        const quint16 nameLength = qFromLittleEndian<quint16>(entry + 28);
+        const quint16 extraLength = qFromLittleEndian<quint16>(entry + 30);
+        const quint16 commentLength = qFromLittleEndian<quint16>(entry + 32);
+        const quint32 localHeaderOffset = qFromLittleEndian<quint32>(entry + 42);
+
+        if (((pos + cDirectoryEntrySize + nameLength) <= directory.size()) && (QByteArray::fromRawData(entry + cDirectoryEntrySize, nameLength) == name)) {
+            if ((method != 0) && (method != 8)) {
+                errorString = tr("Zip entry %1 uses unsupported compression method %2").arg(entryName).arg(method);
+                return nullptr;
+            }
+            if ((compressedSize == 0xFFFFFFFF) || (localHeaderOffset == 0xFFFFFFFF)) {
+                errorString = tr("Zip64 entry %1 is not supported").arg(entryName);
+                return nullptr;
+            }
+
+            // The local header can have a different extra field than the central directory
+            QByteArray localHeader;
+            if (zipSource->seek(localHeaderOffset)) {
+                localHeader = zipSource->read(cLocalHeaderSize);
+            }
+            if ((localHeader.size() != cLocalHeaderSize) || (qFromLittleEndian<quint32>(localHeader.constData()) != cLocalHeaderSignature)) {
+                errorString = tr("Zip archive is corrupt");
+                return nullptr;
+            }
+            const qint64 dataOffset = localHeaderOffset + cLocalHeaderSize + qFromLittleEndian<quint16>(localHeader.constData() + 26) + qFromLittleEndian<quint16>(localHeader.constData() + 28);
+            if (!zipSource->seek(dataOffset)) {
+                errorString = tr("Zip archive is corrupt");
+                return nullptr;
+            }
+
+            return new QGCDecompressDevice(zipSource, (method == 8) ? Deflate : Stored, compressedSize, parent);
+        }
+
+        pos += cDirectoryEntrySize + nameLength + extraLength + commentLength;
+    }
+
+    errorString = tr("Zip archive has no entry %1").arg(entryName);
+    return nullptr;
+}
+
+bool QGCDecompressDevice::readFile(const QString &fileName, QByteArray &bytes, QString &errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = tr("File open failed: file:error %1 %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    const Format format = detectFormat(file.peek(6));
+    if (format == Stored) {
+        bytes = file.readAll();
+        return true;
+    }
+
+    QGCDecompressDevice device(&file, format);
+    if (!device.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        errorString = device.errorString();
+        return false;
+    }
+    bytes = device.readAll();
+    if (device._failed) {
+        errorString = tr("Decompress failed: file:error %1 %2").arg(fileName, device.errorString());
+        bytes.clear();
+        return false;
+    }
+
+    qCDebug(QGCDecompressDeviceLog) << "Decompressed" << fileName << file.size() << "->" << bytes.size();
+    return true;
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QIODevice>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+
+#include <memory>
+
+Q_DECLARE_LOGGING_CATEGORY(QGCDecompressDeviceLog)
+
+namespace QGCLZMA {
+    class Decoder;
+}
+
+namespace QGCZlib {
+    class Inflater;
+}
+
+/// Read only sequential device which decompresses the data of a source device as it is read. This lets callers
+/// parse compressed files straight from memory instead of decompressing them to a temporary file first.
+class QGCDecompressDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    enum Format {
+        Stored,     ///< Not compressed, the data is passed through
+        Xz,         ///< .xz/.lzma
+        Gzip,       ///< .gz
+        Zlib,       ///< zlib (RFC 1950) stream
+        Deflate,    ///< Raw deflate stream, as stored in zip archives
+    };
+
+    /// @param source Device to read the compressed data from, starting at its current position. Must be open and
+    ///               have all data available. Not owned.
+    /// @param size Number of compressed bytes to read from source, -1 reads up to the end of source
+    QGCDecompressDevice(QIODevice *source, Format format, qint64 size = -1, QObject *parent = nullptr);
+    ~QGCDecompressDevice();
+
+    bool open(OpenMode mode) final;
+    bool isSequential() const final { return true; }
+    bool atEnd() const final;
+    qint64 bytesAvailable() const final;
+
+    Format format() const { return _format; }
+
+    /// @return Format from the magic bytes at the start of a file, Stored if it is not compressed
+    static Format detectFormat(const QByteArray &header);
+
+    /// Creates a device for reading an entry of a zip archive. Only stored and deflated entries are supported.
+    ///     @param zipSource Open device of the archive, must be random access
+    ///     @param errorString Set on failure
+    /// @return nullptr if the entry can't be read, otherwise an unopened device
+    static QGCDecompressDevice *zipEntry(QIODevice *zipSource, const QString &entryName, QString &errorString, QObject *parent = nullptr);
+
+    /// Reads a whole file into memory, decompressing it if it is an xz, gzip or zlib file
+    ///     @param errorString Set on failure
+    static bool readFile(const QString &fileName, QByteArray &bytes, QString &errorString);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) final;
+    qint64 writeData(const char *data, qint64 maxSize) final;
+
+private:
+    bool _decodeMore();
+
+    QIODevice                           *_source;
+    const Format                        _format;
+    qint64                              _sourceRemaining;       ///< -1 reads up to the end of source
+    std::unique_ptr<QGCLZMA::Decoder>   _xzDecoder;
+    std::unique_ptr<QGCZlib::Inflater>  _inflater;
+    QByteArray                          _input;
+    QByteArray                          _decoded;
+    qsizetype                           _decodedOffset = 0;     ///< Start of the _decoded bytes not read yet
+    bool                                _finished = false;
+    bool                                _failed = false;
+
+    static constexpr qsizetype _inputChunkSize = 16 * 1024;
+};
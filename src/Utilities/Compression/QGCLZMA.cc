@@ -36,95 +36,110 @@ bool inflateLZMAFile(const QString &lzmaFilename, const QString &decompressedFil
         return false;
     }
 
+    Decoder decoder([&outputFile](const char *data, qsizetype size) {
+        if (outputFile.write(data, size) != size) {
+            qCWarning(QGCLZMALog) << "output file write failed:" << outputFile.fileName() << outputFile.errorString();
+            return false;
+        }
+        return true;
+    });
+
+    constexpr int buf_size = 4 * 1024;
+    char in[buf_size];
+    while (!decoder.finished()) {
+        const qint64 bytesRead = inputFile.read(in, sizeof(in));
+        if (bytesRead <= 0) {
+            qCWarning(QGCLZMALog) << "File is truncated" << lzmaFilename;
+            return false;
+        }
+        if (!decoder.decode(in, bytesRead)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Decoder::Decoder(const OutputFunction &output)
+    : _output(output)
+{
     std::call_once(crc_init, []() {
         xz_crc32_init();
         xz_crc64_init();
     });
 
-    xz_dec* const s = xz_dec_init(XZ_DYNALLOC, static_cast<uint32_t>(-1));
-    if (s == nullptr) {
+    _decoder = xz_dec_init(XZ_DYNALLOC, static_cast<uint32_t>(-1));
+    if (_decoder == nullptr) {
         qCWarning(QGCLZMALog) << "Memory allocation failed";
+    }
+}
+
+Decoder::~Decoder()
+{
+    if (_decoder) {
+        xz_dec_end(_decoder);
+    }
+}
+
+bool Decoder::decode(const char *data, qsizetype size)
+{
+    if (_decoder == nullptr) {
         return false;
     }
+    if (_finished) {
+        return true;
+    }
 
-    constexpr int buf_size = 4 * 1024;
-    uint8_t in[buf_size];
+    constexpr int buf_size = 16 * 1024;
     uint8_t out[buf_size];
 
     xz_buf b;
-    b.in = in;
+    b.in = reinterpret_cast<const uint8_t*>(data);
     b.in_pos = 0;
-    b.in_size = 0;
+    b.in_size = static_cast<size_t>(size);
     b.out = out;
-    b.out_pos = 0;
     b.out_size = buf_size;
 
-    while (true) {
-        if (b.in_pos == b.in_size) {
-            b.in_size = static_cast<size_t>(inputFile.read((char*)in, sizeof(in)));
-            b.in_pos = 0;
-        }
-
-        xz_ret ret = xz_dec_run(s, &b);
-
-        if (b.out_pos == sizeof(out)) {
-            const size_t cBytesWritten = static_cast<size_t>(outputFile.write((char*)out, static_cast<int>(b.out_pos)));
-            if (cBytesWritten != b.out_pos) {
-                qCWarning(QGCLZMALog) << "output file write failed:" << outputFile.fileName() << outputFile.errorString();
-                goto error;
-            }
+    do {
+        b.out_pos = 0;
+        const xz_ret ret = xz_dec_run(_decoder, &b);
 
-            b.out_pos = 0;
-        }
-
-        if (ret == XZ_OK) {
-            continue;
-        }
-
-        if (ret == XZ_UNSUPPORTED_CHECK) {
-            qCWarning(QGCLZMALog) << "Unsupported check; not verifying file integrity";
-            continue;
-        }
-
-        const size_t cBytesWritten = static_cast<size_t>(outputFile.write((char*)out, static_cast<int>(b.out_pos)));
-        if (cBytesWritten != b.out_pos) {
-            qCWarning(QGCLZMALog) << "output file write failed:" << outputFile.fileName() << outputFile.errorString();
-            goto error;
+        if ((b.out_pos > 0) && !_output(reinterpret_cast<const char*>(out), static_cast<qsizetype>(b.out_pos))) {
+            return false;
         }
 
         switch (ret) {
+        case XZ_OK:
+            break;
+        case XZ_UNSUPPORTED_CHECK:
+            qCWarning(QGCLZMALog) << "Unsupported check; not verifying file integrity";
+            break;
         case XZ_STREAM_END:
-            xz_dec_end(s);
+            _finished = true;
             return true;
         case XZ_MEM_ERROR:
             qCWarning(QGCLZMALog) << "Memory allocation failed";
-            goto error;
+            return false;
         case XZ_MEMLIMIT_ERROR:
             qCWarning(QGCLZMALog) << "Memory usage limit reached";
-            goto error;
+            return false;
         case XZ_FORMAT_ERROR:
             qCWarning(QGCLZMALog) << "Not a .xz file";
-            goto error;
+            return false;
         case XZ_OPTIONS_ERROR:
             qCWarning(QGCLZMALog) << "Unsupported options in the .xz headers";
-            goto error;
+            return false;
         case XZ_DATA_ERROR:
         case XZ_BUF_ERROR:
             qCWarning(QGCLZMALog) << "File is corrupt";
-            goto error;
+            return false;
         default:
             qCWarning(QGCLZMALog) << "Bug!";
-            goto error;
+            return false;
         }
-    }
+    } while ((b.in_pos < b.in_size) || (b.out_pos == b.out_size));
 
-    xz_dec_end(s);
     return true;
-
-error:
-    xz_dec_end(s);
-    return false;
-
 }
 
 } // namespace QGCLZMA
@@ -12,11 +12,40 @@
 #include <QtCore/QString>
 #include <QtCore/QLoggingCategory>
 
+#include <functional>
+
 Q_DECLARE_LOGGING_CATEGORY(QGCLZMALog)
 
+struct xz_dec;
+
 namespace QGCLZMA {
     /// Decompresses the specified file to the specified directory
     ///     @param lzmaFilename         Fully qualified path to lzma file
     ///     @param decompressedFilename Fully qualified path to for file to decompress to
     bool inflateLZMAFile(const QString &lzmaFilename, const QString &decompressedFilename);
+
+    /// Decompresses an .xz stream which is fed in pieces
+    class Decoder
+    {
+    public:
+        /// Receives the decompressed data as it is produced, return false to abort
+        using OutputFunction = std::function<bool(const char *data, qsizetype size)>;
+
+        explicit Decoder(const OutputFunction &output);
+        ~Decoder();
+
+        /// Feeds the next piece of compressed data. Data after the end of the stream is ignored.
+        /// @return false: data is corrupt or the output function aborted
+        bool decode(const char *data, qsizetype size);
+
+        /// @return true: the end of the compressed stream has been reached
+        bool finished() const { return _finished; }
+
+    private:
+        xz_dec          *_decoder = nullptr;
+        OutputFunction  _output;
+        bool            _finished = false;
+
+        Q_DISABLE_COPY(Decoder)
+    };
 } // namespace QGCLZMA
@@ -96,4 +96,78 @@ bool inflateGzipFile(const QString &gzippedFileName, const QString &decompressed
     return true;
 }
 
+Inflater::Inflater(const OutputFunction &output, Format format)
+    : _stream(std::make_unique<z_stream>())
+    , _output(output)
+{
+    _stream->zalloc = nullptr;
+    _stream->zfree = nullptr;
+    _stream->opaque = nullptr;
+    _stream->avail_in = 0;
+    _stream->next_in = nullptr;
+
+    int windowBits = MAX_WBITS;
+    if (format == Gzip) {
+        windowBits += 16;
+    } else if (format == Deflate) {
+        windowBits = -windowBits;
+    }
+
+    const int ret = inflateInit2(_stream.get(), windowBits);
+    if (ret != Z_OK) {
+        qCWarning(QGCZlibLog) << "inflateInit2 failed:" << ret;
+        return;
+    }
+    _initialized = true;
+}
+
+Inflater::~Inflater()
+{
+    if (_initialized) {
+        (void) inflateEnd(_stream.get());
+    }
+}
+
+bool Inflater::inflate(const char *data, qsizetype size)
+{
+    if (!_initialized) {
+        return false;
+    }
+    if (_finished) {
+        return true;
+    }
+
+    _stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    _stream->avail_in = static_cast<uInt>(size);
+
+    constexpr int cBuffer = 1024 * 16;
+    unsigned char outputBuffer[cBuffer];
+    do {
+        _stream->avail_out = cBuffer;
+        _stream->next_out = outputBuffer;
+
+        const int ret = ::inflate(_stream.get(), Z_NO_FLUSH);
+        if (ret == Z_STREAM_ERROR || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_NEED_DICT) {
+            qCWarning(QGCZlibLog) << "inflate failed:" << ret;
+            return false;
+        }
+
+        const qsizetype cBytesInflated = cBuffer - _stream->avail_out;
+        if ((cBytesInflated > 0) && !_output(reinterpret_cast<const char*>(outputBuffer), cBytesInflated)) {
+            return false;
+        }
+
+        if (ret == Z_STREAM_END) {
+            _finished = true;
+            break;
+        }
+        if ((ret == Z_BUF_ERROR) && (_stream->avail_in == 0)) {
+            // Needs more input
+            break;
+        }
+    } while ((_stream->avail_in > 0) || (_stream->avail_out == 0));
+
+    return true;
+}
+
 } // namespace QGCZlib
@@ -12,8 +12,13 @@
 #include <QtCore/QString>
 #include <QtCore/QLoggingCategory>
 
+#include <functional>
+#include <memory>
+
 Q_DECLARE_LOGGING_CATEGORY(QGCZlibLog)
 
+struct z_stream_s;
+
 namespace QGCZlib
 {
     /// Decompresses the specified file to the specified directory
@@ -21,4 +26,37 @@ namespace QGCZlib
     ///     @param decompressedFilename Fully qualified path to for file to decompress to
     /// @return bool Success
     bool inflateGzipFile(const QString &gzippedFileName, const QString &decompressedFilename);
+
+    /// Inflates a stream which is fed in pieces, so neither the compressed nor the decompressed data needs to be
+    /// held in memory as a whole
+    class Inflater
+    {
+    public:
+        enum Format {
+            Zlib,       ///< RFC 1950
+            Gzip,       ///< RFC 1952
+            Deflate,    ///< Raw RFC 1951 stream, as stored in zip archives
+        };
+
+        /// Receives the decompressed data as it is produced, return false to abort
+        using OutputFunction = std::function<bool(const char *data, qsizetype size)>;
+
+        explicit Inflater(const OutputFunction &output, Format format = Zlib);
+        ~Inflater();
+
+        /// Feeds the next piece of compressed data. Data after the end of the stream is ignored.
+        /// @return false: data is corrupt or the output function aborted
+        bool inflate(const char *data, qsizetype size);
+
+        /// @return true: the end of the compressed stream has been reached
+        bool finished() const { return _finished; }
+
+    private:
+        std::unique_ptr<z_stream_s> _stream;
+        OutputFunction              _output;
+        bool                        _initialized = false;
+        bool                        _finished = false;
+
+        Q_DISABLE_COPY(Inflater)
+    };
 }
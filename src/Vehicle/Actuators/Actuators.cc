@@ -10,10 +10,10 @@
 #include "Actuators.h"
 #include "GeometryImage.h"
 #include "ParameterManager.h"
+#include "QGCDecompressDevice.h"
 #include "Vehicle.h"
 
 #include <QtCore/QString>
-#include <QtCore/QFile>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
 
@@ -117,14 +117,14 @@ bool Actuators::isMultirotor() const
 
 void Actuators::load(const QString &json_file)
 {
-    QFile file;
-    file.setFileName(json_file);
-    file.open(QIODevice::ReadOnly | QIODevice::Text);
-    QString json_data = file.readAll();
-    file.close();
+    QByteArray json_data;
+    QString errorString;
+    if (!QGCDecompressDevice::readFile(json_file, json_data, errorString)) {
+        qCWarning(ActuatorsConfigLog) << "Failed to read actuator metadata:" << errorString;
+    }
 
     // store the metadata to be loaded later after all params are available
-    _jsonMetadata = QJsonDocument::fromJson(json_data.toUtf8());
+    _jsonMetadata = QJsonDocument::fromJson(json_data);
 }
 
 void Actuators::init()
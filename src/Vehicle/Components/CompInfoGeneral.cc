@@ -9,6 +9,7 @@
 
 #include "CompInfoGeneral.h"
 #include "JsonHelper.h"
+#include "QGCDecompressDevice.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QJsonDocument>
@@ -40,8 +41,9 @@ void CompInfoGeneral::setJson(const QString& metadataJsonFileName)
 
     QString         errorString;
     QJsonDocument   jsonDoc;
+    QByteArray      bytes;
 
-    if (!JsonHelper::isJsonFile(metadataJsonFileName, jsonDoc, errorString)) {
+    if (!QGCDecompressDevice::readFile(metadataJsonFileName, bytes, errorString) || !JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
         qCWarning(CompInfoGeneralLog) << "Metadata json file open failed: compid:" << compId << errorString;
         return;
     }
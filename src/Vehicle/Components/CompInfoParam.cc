@@ -9,6 +9,7 @@
 
 #include "CompInfoParam.h"
 #include "JsonHelper.h"
+#include "QGCDecompressDevice.h"
 #include "FactMetaData.h"
 #include "FirmwarePlugin.h"
 #include "FirmwarePluginManager.h"
@@ -42,10 +43,11 @@ void CompInfoParam::setJson(const QString& metadataJsonFileName)
 
     QString         errorString;
     QJsonDocument   jsonDoc;
+    QByteArray      bytes;
 
     _noJsonMetadata = false;
 
-    if (!JsonHelper::isJsonFile(metadataJsonFileName, jsonDoc, errorString)) {
+    if (!QGCDecompressDevice::readFile(metadataJsonFileName, bytes, errorString) || !JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
         qCWarning(CompInfoParamLog) << "Metadata json file open failed: compid:" << compId << errorString;
         return;
     }
@@ -12,7 +12,6 @@
 #include "ComponentInformationCache.h"
 #include "Vehicle.h"
 #include "FTPManager.h"
-#include "QGCLZMA.h"
 #include "CompInfoGeneral.h"
 #include "CompInfoParam.h"
 #include "CompInfoEvents.h"
@@ -315,20 +314,9 @@ void RequestMetaDataTypeStateMachine::_stateRequestCompInfoDeprecated(StateMachi
 
 QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QString& fileName)
 {
+    // Compressed files are kept as downloaded, the metadata is decompressed in memory when it is parsed
     QString outputFileName = fileName;
 
-    if (fileName.endsWith(".lzma", Qt::CaseInsensitive) || fileName.endsWith(".xz", Qt::CaseInsensitive)) {
-        outputFileName = (QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(_currentCacheFileTag));
-        if (QGCLZMA::inflateLZMAFile(fileName, outputFileName)) {
-            QFile(fileName).remove();
-        } else {
-            qCWarning(ComponentInformationManagerLog) << "Inflate of compressed json failed" << _currentCacheFileTag;
-            outputFileName.clear();
-        }
-    } else {
-        outputFileName = fileName;
-    }
-
     if (_currentFileValidCrc) {
         // cache the file (this will move/remove the temp file as well)
         outputFileName = _compMgr->fileCache().insert(_currentCacheFileTag, outputFileName);
@@ -11,7 +11,7 @@
 #include "ComponentInformationTranslation.h"
 #include "QGCCachedFileDownload.h"
 #include "JsonHelper.h"
-#include "QGCLZMA.h"
+#include "QGCDecompressDevice.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QStandardPaths>
@@ -54,7 +54,9 @@ QString ComponentInformationTranslation::getUrlFromSummaryJson(const QString &su
     QString         errorString;
     QJsonDocument   jsonDoc;
 
-    if (!JsonHelper::isJsonFile(summaryJsonFile, jsonDoc, errorString)) {
+    QByteArray      bytes;
+
+    if (!QGCDecompressDevice::readFile(summaryJsonFile, bytes, errorString) || !JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
         qCWarning(ComponentInformationTranslationLog) << "Metadata translation summary json file open failed:" << errorString;
         return "";
     }
@@ -77,34 +79,15 @@ void ComponentInformationTranslation::onDownloadCompleted(QString remoteFile, QS
 {
     disconnect(_cachedFileDownload, &QGCCachedFileDownload::downloadComplete, this, &ComponentInformationTranslation::onDownloadCompleted);
 
-    QString tsFileName = localFile;
-    bool deleteFile = false;
-    if (errorMsg.isEmpty()) {
-
-        // Decompress if needed
-        if (localFile.endsWith(".lzma", Qt::CaseInsensitive) || localFile.endsWith(".xz", Qt::CaseInsensitive)) {
-            tsFileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("qgc_translation_file_decompressed.ts");
-            if (QGCLZMA::inflateLZMAFile(localFile, tsFileName)) {
-                deleteFile = true;
-            } else {
-                errorMsg = "Inflate of compressed json failed, " + remoteFile;
-            }
-        }
-    }
-
-    // Translate json file to new temp file
+    // Translate json file to new temp file, a compressed TS file is decompressed in memory
     QString translatedJsonFilename;
     if (errorMsg.isEmpty()) {
-        translatedJsonFilename = translateJsonUsingTS(_toTranslateJsonFile, tsFileName);
+        translatedJsonFilename = translateJsonUsingTS(_toTranslateJsonFile, localFile);
         if (translatedJsonFilename.isEmpty()) {
-            errorMsg = "Failed to translate json file";
+            errorMsg = "Failed to translate json file, " + remoteFile;
         }
     }
 
-    if (deleteFile) {
-        QFile(localFile).remove();
-    }
-
     emit downloadComplete(translatedJsonFilename, errorMsg);
 }
 
@@ -115,8 +98,9 @@ QString ComponentInformationTranslation::translateJsonUsingTS(const QString &toT
     // Open JSON and get the 'translation' object
     QString         errorString;
     QJsonDocument   jsonDoc;
+    QByteArray      bytes;
 
-    if (!JsonHelper::isJsonFile(toTranslateJsonFile, jsonDoc, errorString)) {
+    if (!QGCDecompressDevice::readFile(toTranslateJsonFile, bytes, errorString) || !JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
         qCWarning(ComponentInformationTranslationLog) << "Metadata json file to translate open failed:" << errorString;
         return "";
     }
@@ -131,14 +115,12 @@ QString ComponentInformationTranslation::translateJsonUsingTS(const QString &toT
 
     // Open and parse TS file into a hash table
     QHash<QString, QString> translations;
-    QFile xmlFile(tsFile);
-    if (!xmlFile.open(QIODevice::ReadOnly)) {
-        qCWarning(ComponentInformationTranslationLog) << "Failed opening TS file";
+    if (!QGCDecompressDevice::readFile(tsFile, bytes, errorString)) {
+        qCWarning(ComponentInformationTranslationLog) << "Failed opening TS file" << errorString;
         return "";
     }
 
-    QXmlStreamReader xml(xmlFile.readAll());
-    xmlFile.close();
+    QXmlStreamReader xml(bytes);
     if (xml.hasError()) {
         qCWarning(ComponentInformationTranslationLog) << "Badly formed TS (XML)" << xml.errorString();
         return "";
@@ -22,67 +22,139 @@
 
 QGC_LOGGING_CATEGORY(InitialConnectStateMachineLog, "InitialConnectStateMachineLog")
 
+const InitialConnectStateMachine::StepInfo_t InitialConnectStateMachine::_rgSteps[StepCount] = {
+    // stepFn                           weight  dependencies
+    { _stateRequestAutopilotVersion,    1,      0 },
+    { _stateRequestProtocolVersion,     1,      _stepBit(StepAutopilotVersion) },
+    { _stateRequestStandardModes,       1,      _stepBit(StepProtocolVersion) },
+    { _stateRequestCompInfo,            5,      _stepBit(StepStandardModes) },      // Both use REQUEST_MESSAGE
+    { _stateRequestParameters,          5,      _stepBit(StepCompInfo) },           // Parameter metadata comes from component information
+    { _stateRequestMission,             2,      _stepBit(StepProtocolVersion) },    // Needs the capabilities and protocol version
+    { _stateRequestGeoFence,            1,      _stepBit(StepMission) },            // Plan downloads share the mission protocol
+    { _stateRequestRallyPoints,         1,      _stepBit(StepGeoFence) },
+};
+
 InitialConnectStateMachine::InitialConnectStateMachine(Vehicle* vehicle)
     : _vehicle(vehicle)
 {
-    static_assert(sizeof(_rgStates)/sizeof(_rgStates[0]) == sizeof(_rgProgressWeights)/sizeof(_rgProgressWeights[0]),
-            "array size mismatch");
-
-    _progressWeightTotal = 0;
-    for (int i = 0; i < _cStates; ++i) {
-        _progressWeightTotal += _rgProgressWeights[i];
+    for (int i = 0; i < StepCount; ++i) {
+        _progressWeightTotal += _rgSteps[i].progressWeight;
+        _stepStartMSecs[i] = -1;
+        _stepEndMSecs[i] = -1;
     }
 }
 
-int InitialConnectStateMachine::stateCount(void) const
+void InitialConnectStateMachine::start(void)
 {
-    return _cStates;
+    _active = true;
+    _clock.start();
+    _startReadySteps();
 }
 
-const InitialConnectStateMachine::StateFn* InitialConnectStateMachine::rgStates(void) const
+void InitialConnectStateMachine::_startReadySteps(void)
 {
-    return &_rgStates[0];
+    uint32_t doneSteps = 0;
+    for (int i = 0; i < StepCount; ++i) {
+        if (_stepStates[i] == StepDone) {
+            doneSteps |= _stepBit(static_cast<Step>(i));
+        }
+    }
+
+    for (int i = 0; i < StepCount && _active; ++i) {
+        if ((_stepStates[i] == StepWaiting) && ((_rgSteps[i].dependencies & doneSteps) == _rgSteps[i].dependencies)) {
+            const Step step = static_cast<Step>(i);
+            _stepStates[step] = StepRunning;
+            _stepStartMSecs[step] = _clock.elapsed();
+            qCDebug(InitialConnectStateMachineLog) << "Starting" << step << "at" << _stepStartMSecs[step] << "msecs";
+            if (_completedEarlySteps & _stepBit(step)) {
+                stepComplete(step);
+            } else {
+                // Steps which have nothing to do complete right away, which starts their dependents from in here
+                (*_rgSteps[step].stepFn)(this);
+            }
+        }
+    }
 }
 
-void InitialConnectStateMachine::statesCompleted(void) const
+void InitialConnectStateMachine::stepComplete(Step step)
 {
+    if (_active && (_stepStates[step] == StepWaiting)) {
+        // For example parameters which became ready before the step was reached. The step is skipped when it comes up.
+        qCDebug(InitialConnectStateMachineLog) << "Step completed before it was started" << step;
+        _completedEarlySteps |= _stepBit(step);
+        return;
+    }
+    if (!_active || (_stepStates[step] != StepRunning)) {
+        qCDebug(InitialConnectStateMachineLog) << "Ignoring completion of step which is not running" << step;
+        return;
+    }
+
+    _stepStates[step] = StepDone;
+    _stepEndMSecs[step] = _clock.elapsed();
+    _stepProgress[step] = 1.f;
+    QObject::disconnect(_progressConnections[step]);
+    qCDebug(InitialConnectStateMachineLog) << "Completed" << step << "in" << stepDurationMSecs(step) << "msecs";
+
+    for (int i = 0; i < StepCount; ++i) {
+        if (_stepStates[i] != StepDone) {
+            emit progressUpdate(_progress());
+            _startReadySteps();
+            return;
+        }
+    }
 
+    _allStepsComplete();
 }
 
-void InitialConnectStateMachine::advance()
+void InitialConnectStateMachine::_allStepsComplete(void)
 {
-    StateMachine::advance();
+    _active = false;
+    _totalMSecs = _clock.elapsed();
+
+    for (int i = 0; i < StepCount; ++i) {
+        qCDebug(InitialConnectStateMachineLog) << "Timing" << static_cast<Step>(i) << "start" << _stepStartMSecs[i] << "duration" << stepDurationMSecs(static_cast<Step>(i));
+    }
+    qCDebug(InitialConnectStateMachineLog) << "Signalling initialConnectComplete after" << _totalMSecs << "msecs";
+
+    // Progress updates while not active reset the vehicle load progress
     emit progressUpdate(_progress());
+    emit _vehicle->initialConnectComplete();
 }
 
-void InitialConnectStateMachine::gotProgressUpdate(float progressValue)
+qint64 InitialConnectStateMachine::stepDurationMSecs(Step step) const
 {
-    emit progressUpdate(_progress(progressValue));
+    return (_stepEndMSecs[step] < 0) ? -1 : (_stepEndMSecs[step] - _stepStartMSecs[step]);
 }
 
-float InitialConnectStateMachine::_progress(float subProgress)
+void InitialConnectStateMachine::_setStepProgress(Step step, float progress)
 {
-    int progressWeight = 0;
-    for (int i = 0; i < _stateIndex && i < _cStates; ++i) {
-        progressWeight += _rgProgressWeights[i];
+    if (_stepStates[step] == StepRunning) {
+        _stepProgress[step] = progress;
+        emit progressUpdate(_progress());
     }
-    int currentWeight = _stateIndex < _cStates ? _rgProgressWeights[_stateIndex] : 1;
-    return (progressWeight + currentWeight * subProgress) / (float)_progressWeightTotal;
 }
 
-void InitialConnectStateMachine::_stateRequestAutopilotVersion(StateMachine* stateMachine)
+float InitialConnectStateMachine::_progress(void) const
+{
+    float progressWeight = 0;
+    for (int i = 0; i < StepCount; ++i) {
+        progressWeight += _rgSteps[i].progressWeight * _stepProgress[i];
+    }
+    return progressWeight / _progressWeightTotal;
+}
+
+void InitialConnectStateMachine::_stateRequestAutopilotVersion(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     SharedLinkInterfacePtr      sharedLink      = vehicle->vehicleLinkManager()->primaryLink().lock();
 
     if (!sharedLink) {
         qCDebug(InitialConnectStateMachineLog) << "Skipping REQUEST_MESSAGE:AUTOPILOT_VERSION request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stepComplete(StepAutopilotVersion);
     } else {
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "Skipping REQUEST_MESSAGE:AUTOPILOT_VERSION request due to link type";
-            connectMachine->advance();
+            connectMachine->stepComplete(StepAutopilotVersion);
         } else {
             qCDebug(InitialConnectStateMachineLog) << "Sending REQUEST_MESSAGE:AUTOPILOT_VERSION";
             vehicle->requestMessage(_autopilotVersionRequestMessageHandler,
@@ -179,25 +251,24 @@ void InitialConnectStateMachine::_autopilotVersionRequestMessageHandler(void* re
         vehicle->_setCapabilities(assumedCapabilities);
     }
 
-    connectMachine->advance();
+    connectMachine->stepComplete(StepAutopilotVersion);
 }
 
-void InitialConnectStateMachine::_stateRequestProtocolVersion(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestProtocolVersion(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     SharedLinkInterfacePtr      sharedLink      = vehicle->vehicleLinkManager()->primaryLink().lock();
 
     if (!sharedLink) {
         qCDebug(InitialConnectStateMachineLog) << "Skipping REQUEST_MESSAGE:PROTOCOL_VERSION request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stepComplete(StepProtocolVersion);
     } else {
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "Skipping REQUEST_MESSAGE:PROTOCOL_VERSION request due to link type";
-            connectMachine->advance();
+            connectMachine->stepComplete(StepProtocolVersion);
         } else if (vehicle->apmFirmware()) {
             qCDebug(InitialConnectStateMachineLog) << "Skipping REQUEST_MESSAGE:PROTOCOL_VERSION request due to Ardupilot firmware";
-            connectMachine->advance();
+            connectMachine->stepComplete(StepProtocolVersion);
         } else {
             qCDebug(InitialConnectStateMachineLog) << "Sending REQUEST_MESSAGE:PROTOCOL_VERSION";
             vehicle->requestMessage(_protocolVersionRequestMessageHandler,
@@ -248,23 +319,20 @@ void InitialConnectStateMachine::_protocolVersionRequestMessageHandler(void* res
         vehicle->_setMaxProtoVersionFromBothSources();
     }
 
-    connectMachine->advance();
+    connectMachine->stepComplete(StepProtocolVersion);
 }
-void InitialConnectStateMachine::_stateRequestCompInfo(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestCompInfo(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
+    Vehicle* vehicle = connectMachine->_vehicle;
 
     qCDebug(InitialConnectStateMachineLog) << "_stateRequestCompInfo";
-    connect(vehicle->_componentInformationManager, &ComponentInformationManager::progressUpdate, connectMachine,
-            &InitialConnectStateMachine::gotProgressUpdate);
+    connectMachine->_trackProgress(StepCompInfo, vehicle->_componentInformationManager, &ComponentInformationManager::progressUpdate);
     vehicle->_componentInformationManager->requestAllComponentInformation(_stateRequestCompInfoComplete, connectMachine);
 }
 
-void InitialConnectStateMachine::_stateRequestStandardModes(StateMachine *stateMachine)
+void InitialConnectStateMachine::_stateRequestStandardModes(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
+    Vehicle* vehicle = connectMachine->_vehicle;
 
     qCDebug(InitialConnectStateMachineLog) << "_stateRequestStandardModes";
     connect(vehicle->_standardModes, &StandardModes::requestCompleted, connectMachine,
@@ -276,66 +344,53 @@ void InitialConnectStateMachine::standardModesRequestCompleted()
 {
     disconnect(_vehicle->_standardModes, &StandardModes::requestCompleted, this,
                &InitialConnectStateMachine::standardModesRequestCompleted);
-    advance();
+    stepComplete(StepStandardModes);
 }
 
 void InitialConnectStateMachine::_stateRequestCompInfoComplete(void* requestAllCompleteFnData)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(requestAllCompleteFnData);
-    disconnect(connectMachine->_vehicle->_componentInformationManager, &ComponentInformationManager::progressUpdate,
-            connectMachine, &InitialConnectStateMachine::gotProgressUpdate);
+    InitialConnectStateMachine* connectMachine = static_cast<InitialConnectStateMachine*>(requestAllCompleteFnData);
 
-    connectMachine->advance();
+    connectMachine->stepComplete(StepCompInfo);
 }
 
-void InitialConnectStateMachine::_stateRequestParameters(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestParameters(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
+    Vehicle* vehicle = connectMachine->_vehicle;
 
     qCDebug(InitialConnectStateMachineLog) << "_stateRequestParameters";
-    connect(vehicle->_parameterManager, &ParameterManager::loadProgressChanged, connectMachine,
-            &InitialConnectStateMachine::gotProgressUpdate);
+    connectMachine->_trackProgress(StepParameters, vehicle->_parameterManager, &ParameterManager::loadProgressChanged);
     vehicle->_parameterManager->refreshAllParameters();
 }
 
-void InitialConnectStateMachine::_stateRequestMission(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestMission(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     SharedLinkInterfacePtr      sharedLink      = vehicle->vehicleLinkManager()->primaryLink().lock();
 
-    disconnect(vehicle->_parameterManager, &ParameterManager::loadProgressChanged, connectMachine,
-            &InitialConnectStateMachine::gotProgressUpdate);
-
     if (!sharedLink) {
         qCDebug(InitialConnectStateMachineLog) << "_stateRequestMission: Skipping first mission load request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stepComplete(StepMission);
     } else {
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "_stateRequestMission: Skipping first mission load request due to link type";
             vehicle->_firstMissionLoadComplete();
         } else {
             qCDebug(InitialConnectStateMachineLog) << "_stateRequestMission";
+            connectMachine->_trackProgress(StepMission, vehicle->_missionManager, &MissionManager::progressPctChanged);
             vehicle->_missionManager->loadFromVehicle();
-            connect(vehicle->_missionManager, &MissionManager::progressPctChanged, connectMachine,
-                    &InitialConnectStateMachine::gotProgressUpdate);
         }
     }
 }
 
-void InitialConnectStateMachine::_stateRequestGeoFence(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestGeoFence(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     SharedLinkInterfacePtr      sharedLink      = vehicle->vehicleLinkManager()->primaryLink().lock();
 
-    disconnect(vehicle->_missionManager, &MissionManager::progressPctChanged, connectMachine,
-               &InitialConnectStateMachine::gotProgressUpdate);
-
     if (!sharedLink) {
         qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence: Skipping first geofence load request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stepComplete(StepGeoFence);
     } else {
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence: Skipping first geofence load request due to link type";
@@ -343,9 +398,8 @@ void InitialConnectStateMachine::_stateRequestGeoFence(StateMachine* stateMachin
         } else {
             if (vehicle->_geoFenceManager->supported()) {
                 qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence";
+                connectMachine->_trackProgress(StepGeoFence, vehicle->_geoFenceManager, &GeoFenceManager::progressPctChanged);
                 vehicle->_geoFenceManager->loadFromVehicle();
-                connect(vehicle->_geoFenceManager, &GeoFenceManager::progressPctChanged, connectMachine,
-                        &InitialConnectStateMachine::gotProgressUpdate);
             } else {
                 qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence: skipped due to no support";
                 vehicle->_firstGeoFenceLoadComplete();
@@ -354,27 +408,22 @@ void InitialConnectStateMachine::_stateRequestGeoFence(StateMachine* stateMachin
     }
 }
 
-void InitialConnectStateMachine::_stateRequestRallyPoints(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestRallyPoints(InitialConnectStateMachine* connectMachine)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     SharedLinkInterfacePtr      sharedLink      = vehicle->vehicleLinkManager()->primaryLink().lock();
 
-    disconnect(vehicle->_geoFenceManager, &GeoFenceManager::progressPctChanged, connectMachine,
-               &InitialConnectStateMachine::gotProgressUpdate);
-
     if (!sharedLink) {
         qCDebug(InitialConnectStateMachineLog) << "_stateRequestRallyPoints: Skipping first rally point load request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stepComplete(StepRallyPoints);
     } else {
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "_stateRequestRallyPoints: Skipping first rally point load request due to link type";
             vehicle->_firstRallyPointLoadComplete();
         } else {
             if (vehicle->_rallyPointManager->supported()) {
+                connectMachine->_trackProgress(StepRallyPoints, vehicle->_rallyPointManager, &RallyPointManager::progressPctChanged);
                 vehicle->_rallyPointManager->loadFromVehicle();
-                connect(vehicle->_rallyPointManager, &RallyPointManager::progressPctChanged, connectMachine,
-                        &InitialConnectStateMachine::gotProgressUpdate);
             } else {
                 qCDebug(InitialConnectStateMachineLog) << "_stateRequestRallyPoints: skipping due to no support";
                 vehicle->_firstRallyPointLoadComplete();
@@ -382,17 +431,3 @@ void InitialConnectStateMachine::_stateRequestRallyPoints(StateMachine* stateMac
         }
     }
 }
-
-void InitialConnectStateMachine::_stateSignalInitialConnectComplete(StateMachine* stateMachine)
-{
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
-
-    disconnect(vehicle->_rallyPointManager, &RallyPointManager::progressPctChanged, connectMachine,
-               &InitialConnectStateMachine::gotProgressUpdate);
-
-    connectMachine->advance();
-    qCDebug(InitialConnectStateMachineLog) << "Signalling initialConnectComplete";
-    emit vehicle->initialConnectComplete();
-}
-
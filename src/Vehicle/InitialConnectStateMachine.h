@@ -9,81 +9,118 @@
 
 #pragma once
 
-#include "StateMachine.h"
 #include "QGCMAVLink.h"
 #include "Vehicle.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QObject>
 
 Q_DECLARE_LOGGING_CATEGORY(InitialConnectStateMachineLog)
 
 class Vehicle;
 
-class InitialConnectStateMachine : public StateMachine
+/// Runs the requests which bring a newly connected vehicle up to date.
+///
+/// Each step starts as soon as the steps it depends on have completed, so independent requests run concurrently. The
+/// command based steps (version, standard modes, component information) stay in order since REQUEST_MESSAGE commands
+/// to the same component can't be outstanding at the same time, and parameters need the parameter metadata from
+/// component information. Mission, geofence and rally point downloads only need the capabilities, so they run
+/// alongside that chain, one after the other since they share the mission protocol.
+class InitialConnectStateMachine : public QObject
 {
     Q_OBJECT
 
 public:
+    enum Step {
+        StepAutopilotVersion,
+        StepProtocolVersion,
+        StepStandardModes,
+        StepCompInfo,
+        StepParameters,
+        StepMission,
+        StepGeoFence,
+        StepRallyPoints,
+        StepCount
+    };
+    Q_ENUM(Step)
+
     InitialConnectStateMachine(Vehicle* vehicle);
 
-    // Overrides from StateMachine
-    int             stateCount      (void) const final;
-    const StateFn*  rgStates        (void) const final;
-    void            statesCompleted (void) const final;
+    void start  (void);
+    bool active (void) const { return _active; }
+
+    /// Called when the work a step started is done. Starts all steps which were waiting on it.
+    void stepComplete(Step step);
+
+    /// @return Time from start() to when the step was started, -1 if it has not started
+    qint64 stepStartMSecs(Step step) const { return _stepStartMSecs[step]; }
+
+    /// @return Time the step took, -1 if it has not completed
+    qint64 stepDurationMSecs(Step step) const;
 
-    void advance() override;
+    /// @return Time from start() until all steps completed, -1 if not complete
+    qint64 totalDurationMSecs(void) const { return _totalMSecs; }
 
 signals:
     void progressUpdate(float progress);
 
 private slots:
-    void gotProgressUpdate(float progressValue);
     void standardModesRequestCompleted();
 
 private:
-    static void _stateRequestAutopilotVersion           (StateMachine* stateMachine);
-    static void _stateRequestProtocolVersion            (StateMachine* stateMachine);
-    static void _stateRequestCompInfo                   (StateMachine* stateMachine);
-    static void _stateRequestStandardModes              (StateMachine* stateMachine);
-    static void _stateRequestCompInfoComplete           (void* requestAllCompleteFnData);
-    static void _stateRequestParameters                 (StateMachine* stateMachine);
-    static void _stateRequestMission                    (StateMachine* stateMachine);
-    static void _stateRequestGeoFence                   (StateMachine* stateMachine);
-    static void _stateRequestRallyPoints                (StateMachine* stateMachine);
-    static void _stateSignalInitialConnectComplete      (StateMachine* stateMachine);
-
-    static void _autopilotVersionRequestMessageHandler  (void* resultHandlerData, MAV_RESULT commandResult, Vehicle::RequestMessageResultHandlerFailureCode_t failureCode, const mavlink_message_t& message);
-    static void _protocolVersionRequestMessageHandler   (void* resultHandlerData, MAV_RESULT commandResult, Vehicle::RequestMessageResultHandlerFailureCode_t failureCode, const mavlink_message_t& message);
+    typedef void (*StepFn)(InitialConnectStateMachine* connectMachine);
 
-    float _progress(float subProgress = 0.f);
-
-    Vehicle* _vehicle;
-
-    int _progressWeightTotal;
-
-    static constexpr const StateMachine::StateFn _rgStates[] = {
-        _stateRequestAutopilotVersion,
-        _stateRequestProtocolVersion,
-        _stateRequestStandardModes,
-        _stateRequestCompInfo,
-        _stateRequestParameters,
-        _stateRequestMission,
-        _stateRequestGeoFence,
-        _stateRequestRallyPoints,
-        _stateSignalInitialConnectComplete
+    enum StepState {
+        StepWaiting,
+        StepRunning,
+        StepDone
     };
 
-    static constexpr const int _rgProgressWeights[] = {
-        1, //_stateRequestCapabilities
-        1, //_stateRequestProtocolVersion
-        1, //_stateRequestStandardModes
-        5, //_stateRequestCompInfo
-        5, //_stateRequestParameters
-        2, //_stateRequestMission
-        1, //_stateRequestGeoFence
-        1, //_stateRequestRallyPoints
-        1, //_stateSignalInitialConnectComplete
+    struct StepInfo_t {
+        StepFn      stepFn;
+        int         progressWeight;
+        uint32_t    dependencies;   ///< Bit mask of the steps which must complete first
     };
 
-    static constexpr int _cStates = sizeof(_rgStates) / sizeof(_rgStates[0]);
+    static void _stateRequestAutopilotVersion           (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestProtocolVersion            (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestCompInfo                   (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestStandardModes              (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestCompInfoComplete           (void* requestAllCompleteFnData);
+    static void _stateRequestParameters                 (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestMission                    (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestGeoFence                   (InitialConnectStateMachine* connectMachine);
+    static void _stateRequestRallyPoints                (InitialConnectStateMachine* connectMachine);
+
+    static void _autopilotVersionRequestMessageHandler  (void* resultHandlerData, MAV_RESULT commandResult, Vehicle::RequestMessageResultHandlerFailureCode_t failureCode, const mavlink_message_t& message);
+    static void _protocolVersionRequestMessageHandler   (void* resultHandlerData, MAV_RESULT commandResult, Vehicle::RequestMessageResultHandlerFailureCode_t failureCode, const mavlink_message_t& message);
+
+    static constexpr uint32_t _stepBit(Step step) { return 1u << step; }
+
+    void    _startReadySteps    (void);
+    void    _allStepsComplete   (void);
+    void    _setStepProgress    (Step step, float progress);
+    float   _progress           (void) const;
+
+    /// Routes the progress signal of the object doing the work for a step into the overall progress
+    template<typename Sender, typename Signal>
+    void _trackProgress(Step step, Sender* sender, Signal signal)
+    {
+        _progressConnections[step] = connect(sender, signal, this, [this, step](double progress) { _setStepProgress(step, static_cast<float>(progress)); });
+    }
+
+    Vehicle*                _vehicle;
+    bool                    _active                             = false;
+    int                     _progressWeightTotal                = 0;
+    StepState               _stepStates[StepCount]              = {};
+    float                   _stepProgress[StepCount]            = {};
+    qint64                  _stepStartMSecs[StepCount];
+    qint64                  _stepEndMSecs[StepCount];
+    QMetaObject::Connection _progressConnections[StepCount];
+    qint64                  _totalMSecs                         = -1;
+    uint32_t                _completedEarlySteps                = 0;    ///< Steps whose work completed before they were started
+    QElapsedTimer           _clock;
+
+    static const StepInfo_t _rgSteps[StepCount];
 };
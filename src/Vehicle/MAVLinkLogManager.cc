@@ -22,6 +22,12 @@
 #include <QtCore/QDirIterator>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
 
 QGC_LOGGING_CATEGORY(MAVLinkLogManagerLog, "MAVLinkLogManagerLog")
 
@@ -97,15 +103,99 @@ MAVLinkLogFiles::setUploaded(bool uploaded)
     emit uploadedChanged();
 }
 
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+/// Writes the log file on its own thread. Chunks reference the LOGGING_DATA payloads they came from, so queueing
+/// one does not copy any data.
+class MAVLinkLogWriter : public QThread
+{
+public:
+    MAVLinkLogWriter(const QString& fileName)
+        : _file(fileName)
+    {
+
+    }
+
+    /// Writes out everything queued so far before returning
+    ~MAVLinkLogWriter()
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            _stop = true;
+        }
+        _wake.wakeOne();
+        (void) wait();
+        _file.close();
+    }
+
+    bool open() { return _file.open(QIODevice::WriteOnly | QIODevice::Truncate); }
+
+    void enqueue(const QByteArray& data, qsizetype offset, qsizetype len)
+    {
+        {
+            QMutexLocker lock(&_mutex);
+            _queue.append({ data, offset, len });
+        }
+        _wake.wakeOne();
+    }
+
+    /// Set once a write has failed, everything after that is dropped
+    bool error() const { return _error.load(std::memory_order_relaxed); }
+
+protected:
+    void run() final
+    {
+        forever {
+            QList<Chunk_t> chunks;
+            bool stop;
+            {
+                QMutexLocker lock(&_mutex);
+                while (_queue.isEmpty() && !_stop) {
+                    (void) _wake.wait(&_mutex);
+                }
+                chunks.swap(_queue);
+                stop = _stop;
+            }
+
+            if (!error()) {
+                for (const Chunk_t& chunk: chunks) {
+                    if (_file.write(chunk.data.constData() + chunk.offset, chunk.len) != chunk.len) {
+                        qCWarning(MAVLinkLogManagerLog) << "File IO error:" << chunk.len << "bytes into" << _file.fileName() << _file.errorString();
+                        _error.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+
+            if (stop) {
+                break;
+            }
+        }
+    }
+
+private:
+    struct Chunk_t {
+        QByteArray  data;
+        qsizetype   offset;
+        qsizetype   len;
+    };
+
+    QFile               _file;
+    QMutex              _mutex;
+    QWaitCondition      _wake;
+    QList<Chunk_t>      _queue;
+    bool                _stop = false;
+    std::atomic<bool>   _error{false};
+};
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 MAVLinkLogProcessor::MAVLinkLogProcessor()
-    : _fd(nullptr)
+    : _writer(nullptr)
     , _written(0)
     , _sequence(-1)
     , _numDrops(0)
     , _gotHeader(false)
-    , _error(false)
     , _record(nullptr)
 {
 }
@@ -120,9 +210,9 @@ MAVLinkLogProcessor::~MAVLinkLogProcessor()
 void
 MAVLinkLogProcessor::close()
 {
-    if(_fd) {
-        fclose(_fd);
-        _fd = nullptr;
+    if(_writer) {
+        delete _writer;
+        _writer = nullptr;
     }
 }
 
@@ -130,7 +220,7 @@ MAVLinkLogProcessor::close()
 bool
 MAVLinkLogProcessor::valid()
 {
-    return (_fd != nullptr) && (_record != nullptr);
+    return (_writer != nullptr) && (_record != nullptr);
 }
 
 //-----------------------------------------------------------------------------
@@ -142,13 +232,16 @@ MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint
                       id,
                       QDateTime::currentDateTime().toString("yyyy-MM-dd-hh-mm-ss-zzz").toLocal8Bit().data(),
                       manager->logExtension().toLocal8Bit().data());
-    _fd = fopen(_fileName.toLocal8Bit().data(), "wb");
-    if(_fd) {
+    _writer = new MAVLinkLogWriter(_fileName);
+    if(_writer->open()) {
+        _writer->start();
         _record = new MAVLinkLogFiles(manager, _fileName, true);
         _record->setWriting(true);
         _sequence = -1;
         return true;
     }
+    delete _writer;
+    _writer = nullptr;
     return false;
 }
 
@@ -188,44 +281,44 @@ MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogProcessor::_writeData(void* data, int len)
+MAVLinkLogProcessor::_writeData(const QByteArray& data, qsizetype offset, qsizetype len)
 {
-    if(!_error) {
-        _error = fwrite(data, 1, len, _fd) != (size_t)len;
-        if(!_error) {
-            _written += len;
-            if(_record) {
-                _record->setSize(_written);
-            }
-        } else {
-            qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
-        }
+    if(len > 0) {
+        _writer->enqueue(data, offset, len);
+        _written += len;
     }
 }
 
 //-----------------------------------------------------------------------------
 QByteArray
-MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
+MAVLinkLogProcessor::_writeUlogMessage(const QByteArray& data, qsizetype offset)
 {
     //-- Write ulog data w/o integrity checking, assuming data starts with a
-    //   valid ulog message. returns the remaining data at the end.
-    while(data.length() > 2) {
-        uint8_t* ptr = (uint8_t*)data.data();
-        int message_length = ptr[0] + (ptr[1] * 256) + 3; // 3 = ULog msg header
-        if(message_length > data.length())
+    //   valid ulog message at offset. returns the remaining data at the end.
+    const uint8_t* ptr = (const uint8_t*)data.constData();
+    qsizetype end = offset;
+    while(data.length() - end > 2) {
+        int message_length = ptr[end] + (ptr[end + 1] * 256) + 3; // 3 = ULog msg header
+        if(message_length > data.length() - end)
             break;
-        _writeData(data.data(), message_length);
-        data.remove(0, message_length);
+        end += message_length;
     }
-    return data;
+    //-- All complete messages go out as a single chunk
+    _writeData(data, offset, end - offset);
+    return data.mid(end);
 }
 
 //-----------------------------------------------------------------------------
 bool
 MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
 {
+    if(_writer->error()) {
+        return false;
+    }
     int num_drops = 0;
-    _error = false;
+    //-- Offset of the first byte not consumed yet, data itself is never modified
+    qsizetype offset = 0;
+    const quint32 written = _written;
     while(_checkSequence(sequence, num_drops)) {
         //-- The first 16 bytes need special treatment (this sounds awfully brittle)
         if(!_gotHeader) {
@@ -235,10 +328,10 @@ MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message,
                 return false;
             }
             //-- Write header
-            _writeData(data.data(), 16);
-            data.remove(0, 16);
+            _writeData(data, 0, 16);
+            offset = 16;
             _gotHeader = true;
-            // What about data start offset now that we removed 16 bytes off the start?
+            // What about data start offset now that we skipped 16 bytes off the start?
         }
         if(_gotHeader && num_drops > 0) {
             if(num_drops > 25) num_drops = 25;
@@ -247,38 +340,41 @@ MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message,
             //   so just use the number of drops * 10 ms
             uint8_t bogus[] = {2, 0, 79, 0, 0};
             bogus[3] = num_drops * 10;
-            _writeData(bogus, sizeof(bogus));
+            _writeData(QByteArray(reinterpret_cast<const char*>(bogus), sizeof(bogus)), 0, sizeof(bogus));
         }
         if(num_drops > 0) {
-            _writeUlogMessage(_ulogMessage);
+            (void) _writeUlogMessage(_ulogMessage, 0);
             _ulogMessage.clear();
             //-- If no useful information in this message. Drop it.
             if(first_message == 255) {
                 break;
             }
             if(first_message > 0) {
-                data.remove(0, first_message);
+                offset = qMin(offset + first_message, data.length());
                 first_message = 0;
             }
         }
         if(first_message == 255 && _ulogMessage.length() > 0) {
-            _ulogMessage.append(data);
+            _ulogMessage.append(data.constData() + offset, data.length() - offset);
             break;
         }
         if(_ulogMessage.length()) {
-            _writeData(_ulogMessage.data(), _ulogMessage.length());
+            _writeData(_ulogMessage, 0, _ulogMessage.length());
             if(first_message) {
-                _writeData(data.left(first_message).data(), first_message);
+                _writeData(data, offset, qMin<qsizetype>(first_message, data.length() - offset));
             }
             _ulogMessage.clear();
         }
         if(first_message) {
-            data.remove(0, first_message);
+            offset = qMin(offset + first_message, data.length());
         }
-        _ulogMessage = _writeUlogMessage(data);
+        _ulogMessage = _writeUlogMessage(data, offset);
         break;
     }
-    return !_error;
+    if(_record && (_written != written)) {
+        _record->setSize(_written);
+    }
+    return true;
 }
 
 //-----------------------------------------------------------------------------
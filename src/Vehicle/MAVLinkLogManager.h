@@ -20,6 +20,7 @@ Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogManagerLog)
 
 class QNetworkAccessManager;
 class MAVLinkLogManager;
+class MAVLinkLogWriter;
 class Vehicle;
 
 //-----------------------------------------------------------------------------
@@ -72,6 +73,8 @@ private:
 };
 
 //-----------------------------------------------------------------------------
+/// Reassembles the ULog stream from LOGGING_DATA messages. Only the message framing is done here, the file
+/// itself is written by a MAVLinkLogWriter thread.
 class MAVLinkLogProcessor
 {
 public:
@@ -85,16 +88,15 @@ public:
     bool                processStreamData(uint16_t _sequence, uint8_t first_message, QByteArray data);
 private:
     bool                _checkSequence(uint16_t seq, int &num_drops);
-    QByteArray          _writeUlogMessage(QByteArray &data);
-    void                _writeData(void* data, int len);
+    QByteArray          _writeUlogMessage(const QByteArray &data, qsizetype offset);
+    void                _writeData(const QByteArray &data, qsizetype offset, qsizetype len);
 private:
-    FILE*               _fd;
+    MAVLinkLogWriter*   _writer;
     quint32             _written;
     int                 _sequence;
     int                 _numDrops;
     bool                _gotHeader;
-    bool                _error;
-    QByteArray          _ulogMessage;
+    QByteArray          _ulogMessage;   ///< Incomplete ULog message carried over to the next LOGGING_DATA
     QString             _fileName;
     MAVLinkLogFiles*    _record;
 };
@@ -10,44 +10,226 @@
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
 
+#include <QtCore/QtMath>
+
+namespace {
+    // Tolerance and size cap for each level of detail, from full resolution to coarsest
+    constexpr double    kLevelTolerances[] = { 1.0, 8.0, 32.0, 128.0, 512.0 };
+    constexpr int       kLevelMaxPoints[]  = { 20000, 10000, 5000, 5000, 5000 };
+
+    constexpr double    kEarthRadiusMeters      = 6371000.0;
+    constexpr double    kMetersPerPixelZoom0    = 156543.03392;
+    constexpr double    kMaxPixelError          = 2.0;
+}
+
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
     , _vehicle      (vehicle)
-    , _lastAzimuth  (qQNaN())
 {
+    for (int i = 0; i < _lodCount; i++) {
+        _levels[i].tolerance = kLevelTolerances[i];
+        _levels[i].maxPoints = kLevelMaxPoints[i];
+    }
+}
+
+TrajectoryPoints::PackedPoint_t TrajectoryPoints::_pack(const QGeoCoordinate& coordinate)
+{
+    return { static_cast<qint32>(qRound64(coordinate.latitude() * 1e7)), static_cast<qint32>(qRound64(coordinate.longitude() * 1e7)) };
+}
+
+QGeoCoordinate TrajectoryPoints::_unpack(const PackedPoint_t& point)
+{
+    return QGeoCoordinate(point.lat / 1e7, point.lon / 1e7);
+}
+
+/// Distance in meters from point to the segment from-to. Uses a local flat earth approximation which is plenty
+/// accurate at the scale of trail simplification.
+double TrajectoryPoints::_crossTrackDistance(const PackedPoint_t& from, const PackedPoint_t& to, const PackedPoint_t& point)
+{
+    const double metersPerUnit = qDegreesToRadians(1e-7) * kEarthRadiusMeters;
+    const double lonScale = qCos(qDegreesToRadians(from.lat / 1e7));
+
+    const double dx = static_cast<double>(to.lon - from.lon) * lonScale * metersPerUnit;
+    const double dy = static_cast<double>(to.lat - from.lat) * metersPerUnit;
+    const double px = static_cast<double>(point.lon - from.lon) * lonScale * metersPerUnit;
+    const double py = static_cast<double>(point.lat - from.lat) * metersPerUnit;
+
+    const double lengthSquared = (dx * dx) + (dy * dy);
+    double t = 0;
+    if (lengthSquared > 0) {
+        t = qBound(0.0, ((px * dx) + (py * dy)) / lengthSquared, 1.0);
+    }
+
+    return qSqrt(qPow(px - (t * dx), 2) + qPow(py - (t * dy), 2));
 }
 
 void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
 {
-    // The goal of this algorithm is to limit the number of trajectory points whic represent the vehicle path.
+    if (_lastCoordinate.isValid()) {
+        const double distance = _lastCoordinate.distanceTo(coordinate);
+        if (distance <= _distanceTolerance) {
+            return;
+        }
+
+        //-- Update flight distance
+        _vehicle->updateFlightDistance(distance);
+    }
+
+    addCoordinate(coordinate);
+}
+
+void TrajectoryPoints::addCoordinate(const QGeoCoordinate& coordinate)
+{
+    // The goal of this algorithm is to limit the number of trajectory points which represent the vehicle path.
     // Fewer points means higher performance of map display.
 
-    if (_lastPoint.isValid()) {
-        double distance = _lastPoint.distanceTo(coordinate);
-        if (distance > _distanceTolerance) {
-            //-- Update flight distance
-            _vehicle->updateFlightDistance(distance);
-            // Vehicle has moved far enough from previous point for an update
-            double newAzimuth = _lastPoint.azimuthTo(coordinate);
-            if (qIsNaN(_lastAzimuth) || qAbs(newAzimuth - _lastAzimuth) > _azimuthTolerance) {
-                // The new position IS NOT colinear with the last segment. Append the new position to the list.
-                _lastAzimuth = _lastPoint.azimuthTo(coordinate);
-                _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
-            } else {
-                // The new position IS colinear with the last segment. Don't add a new point, just update
-                // the last point to be the new position.
-                _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
-                emit updateLastPoint(coordinate);
+    _lastCoordinate = coordinate;
+
+    const PackedPoint_t point = _pack(coordinate);
+    bool tolerancesChanged = false;
+    for (int i = 0; i < _lodCount; i++) {
+        LevelUpdate_t update = _addToLevel(_levels[i], point);
+        if (_enforceCap(_levels[i])) {
+            update = LevelUpdateReset;
+            tolerancesChanged = true;
+        }
+        if (i == _lodLevel) {
+            _emitUpdate(update, point);
+        }
+    }
+
+    if (tolerancesChanged) {
+        _bumpLevelRevision();
+    }
+}
+
+/// Lets bindings on lodLevelForZoom re-evaluate after a level tolerance changed
+void TrajectoryPoints::_bumpLevelRevision(void)
+{
+    _levelRevision++;
+    emit levelRevisionChanged(_levelRevision);
+}
+
+/// Streaming simplification (opening window): the last point of a level floats with the vehicle for as long as
+/// every position since the previous fixed point stays within tolerance of the segment from that fixed point to
+/// the new position. Otherwise the last point is fixed and a new window starts from it.
+TrajectoryPoints::LevelUpdate_t TrajectoryPoints::_addToLevel(Level_t& level, const PackedPoint_t& point)
+{
+    const qsizetype count = level.points.count();
+
+    if (count < 2) {
+        level.points.append(point);
+        level.window = { point };
+        return LevelUpdateAdded;
+    }
+
+    if (level.window.count() < _maxWindowPoints) {
+        const PackedPoint_t& anchor = level.points[count - 2];
+        bool withinTolerance = true;
+        for (const PackedPoint_t& windowPoint : level.window) {
+            if (_crossTrackDistance(anchor, point, windowPoint) > level.tolerance) {
+                withinTolerance = false;
+                break;
             }
         }
-    } else {
-        // Add the very first trajectory point to the list
-        _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
-        emit pointAdded(coordinate);
+        if (withinTolerance) {
+            level.points[count - 1] = point;
+            level.window.append(point);
+            return LevelUpdateReplaced;
+        }
+    }
+
+    level.points.append(point);
+    level.window = { point };
+    return LevelUpdateAdded;
+}
+
+/// Once a level hits its cap every other interior point is dropped and the tolerance for future points is
+/// doubled. The whole flight stays visible, just at a lower resolution.
+///     @return true: level was decimated
+bool TrajectoryPoints::_enforceCap(Level_t& level)
+{
+    const qsizetype count = level.points.count();
+    if (count <= level.maxPoints) {
+        return false;
+    }
+
+    qsizetype writeIndex = 1;
+    for (qsizetype readIndex = 2; readIndex < count - 1; readIndex += 2) {
+        level.points[writeIndex++] = level.points[readIndex];
+    }
+    level.points[writeIndex++] = level.points[count - 1];
+    level.points.resize(writeIndex);
+    level.window = { level.points.last() };
+    level.tolerance *= 2;
+
+    return true;
+}
+
+void TrajectoryPoints::_emitUpdate(LevelUpdate_t update, const PackedPoint_t& point)
+{
+    switch (update) {
+    case LevelUpdateAdded:
+        emit pointAdded(_unpack(point));
+        break;
+    case LevelUpdateReplaced:
+        emit updateLastPoint(_unpack(point));
+        break;
+    case LevelUpdateReset:
+        emit pointsChanged();
+        break;
+    }
+}
+
+QVariantList TrajectoryPoints::list(int lodLevel) const
+{
+    QVariantList points;
+
+    if (lodLevel < 0 || lodLevel >= _lodCount) {
+        return points;
+    }
+
+    const Level_t& level = _levels[lodLevel];
+    points.reserve(level.points.count());
+    for (const PackedPoint_t& point : level.points) {
+        points.append(QVariant::fromValue(_unpack(point)));
+    }
+
+    return points;
+}
+
+int TrajectoryPoints::count(int lodLevel) const
+{
+    if (lodLevel < 0 || lodLevel >= _lodCount) {
+        return 0;
+    }
+
+    return _levels[lodLevel].points.count();
+}
+
+int TrajectoryPoints::lodLevelForZoom(double zoomLevel) const
+{
+    const double metersPerPixel = kMetersPerPixelZoom0 / qPow(2.0, zoomLevel);
+    const double maxError = metersPerPixel * kMaxPixelError;
+
+    int lodLevel = 0;
+    for (int i = 1; i < _lodCount; i++) {
+        if (_levels[i].tolerance > maxError) {
+            break;
+        }
+        lodLevel = i;
+    }
+
+    return lodLevel;
+}
+
+void TrajectoryPoints::setLodLevel(int lodLevel)
+{
+    lodLevel = qBound(0, lodLevel, _lodCount - 1);
+    if (lodLevel != _lodLevel) {
+        _lodLevel = lodLevel;
+        emit lodLevelChanged(_lodLevel);
+        emit pointsChanged();
     }
 }
 
@@ -64,8 +246,19 @@ void TrajectoryPoints::stop(void)
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
-    _lastPoint = QGeoCoordinate();
-    _lastAzimuth = qQNaN();
+    bool tolerancesChanged = false;
+    for (int i = 0; i < _lodCount; i++) {
+        _levels[i].points.clear();
+        _levels[i].window.clear();
+        if (_levels[i].tolerance != kLevelTolerances[i]) {
+            _levels[i].tolerance = kLevelTolerances[i];
+            tolerancesChanged = true;
+        }
+    }
+    _lastCoordinate = QGeoCoordinate();
     emit pointsCleared();
+
+    if (tolerancesChanged) {
+        _bumpLevelRevision();
+    }
 }
@@ -11,39 +11,100 @@
 
 #include <QtPositioning/QGeoCoordinate>
 #include <QtCore/QObject>
+#include <QtCore/QList>
 #include <QtCore/QVariantList>
 
 class Vehicle;
 
+/// Flight trail of the vehicle.
+///
+/// Points are stored packed as int32 1e-7 degree lat/lon pairs at several levels of detail. Each level is
+/// simplified in a streaming fashion with a larger tolerance than the previous one and is capped in size so
+/// the map never has to render an unbounded number of vertices no matter how long the flight is.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(int lodLevel     READ lodLevel   WRITE setLodLevel   NOTIFY lodLevelChanged)
+    Q_PROPERTY(int lodCount     READ lodCount                       CONSTANT)
+    Q_PROPERTY(int levelRevision READ levelRevision                NOTIFY levelRevisionChanged)
 
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    /// @return Points for the current level of detail
+    Q_INVOKABLE QVariantList list(void) const { return list(_lodLevel); }
+
+    /// @return Points for the specified level of detail
+    Q_INVOKABLE QVariantList list(int lodLevel) const;
+
+    /// @return Level of detail which is sufficient to draw the trail at the specified map zoom level. The result also
+    ///         depends on the level tolerances, which grow as levels hit their cap. levelRevision changes with them.
+    Q_INVOKABLE int lodLevelForZoom(double zoomLevel) const;
+
+    int     lodLevel    (void) const { return _lodLevel; }
+    int     lodCount    (void) const { return _lodCount; }
+    int     levelRevision(void) const { return _levelRevision; }
+    void    setLodLevel (int lodLevel);
+
+    /// @return Number of stored points for the specified level of detail
+    int     count       (int lodLevel) const;
 
     void start  (void);
     void stop   (void);
 
+    /// Adds a new vehicle position to the trail
+    void addCoordinate(const QGeoCoordinate& coordinate);
+
 public slots:
     void clear  (void);
 
 signals:
-    void pointAdded     (QGeoCoordinate coordinate);
-    void updateLastPoint(QGeoCoordinate coordinate);
+    void pointAdded     (QGeoCoordinate coordinate);    ///< New point at the current level of detail
+    void updateLastPoint(QGeoCoordinate coordinate);    ///< Last point at the current level of detail moved
     void pointsCleared  (void);
+    void pointsChanged  (void);                         ///< Points at the current level of detail changed in bulk, re-read list()
+    void lodLevelChanged(int lodLevel);
+    void levelRevisionChanged(int levelRevision);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
+    struct PackedPoint_t {
+        qint32 lat;     ///< Latitude * 1e7
+        qint32 lon;     ///< Longitude * 1e7
+    };
+
+    struct Level_t {
+        QList<PackedPoint_t>    points;
+        QList<PackedPoint_t>    window;         ///< Points after the last fixed point which the floating last point stands in for
+        double                  tolerance;      ///< Max perpendicular deviation in meters of a dropped point
+        int                     maxPoints;
+    };
+
+    enum LevelUpdate_t {
+        LevelUpdateAdded,
+        LevelUpdateReplaced,
+        LevelUpdateReset,
+    };
+
+    LevelUpdate_t   _addToLevel     (Level_t& level, const PackedPoint_t& point);
+    bool            _enforceCap     (Level_t& level);
+    void            _emitUpdate     (LevelUpdate_t update, const PackedPoint_t& point);
+    void            _bumpLevelRevision(void);
+
+    static PackedPoint_t    _pack           (const QGeoCoordinate& coordinate);
+    static QGeoCoordinate   _unpack         (const PackedPoint_t& point);
+    static double           _crossTrackDistance(const PackedPoint_t& from, const PackedPoint_t& to, const PackedPoint_t& point);
+
+    static constexpr int _lodCount = 5;
+    static constexpr int _maxWindowPoints = 512;    ///< Bounds the deviation check, a longer window fixes the last point
+
     Vehicle*        _vehicle;
-    QVariantList    _points;
-    QGeoCoordinate  _lastPoint;
-    double          _lastAzimuth;
+    Level_t         _levels[_lodCount];
+    int             _lodLevel = 0;
+    int             _levelRevision = 0;
+    QGeoCoordinate  _lastCoordinate;
 
     static constexpr double _distanceTolerance = 2.0;
-    static constexpr double _azimuthTolerance = 1.5;
 };
@@ -533,12 +533,17 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     // Battery fact groups are created dynamically as new batteries are discovered
     VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message);
 
-    // Let the fact groups take a whack at the mavlink traffic
+    // Let the fact groups take a whack at the mavlink traffic. Their change signals are batched so a fact which
+    // changes with every message only signals once per frame.
     for (FactGroup* factGroup : factGroups()) {
+        factGroup->beginUpdate();
         factGroup->handleMessage(this, message);
+        factGroup->commitUpdate();
     }
 
+    beginUpdate();
     this->handleMessage(this, message);
+    commitUpdate();
 
     switch (message.msgid) {
     case MAVLINK_MSG_ID_HOME_POSITION:
@@ -762,8 +767,11 @@ void Vehicle::_handleGlobalPositionInt(mavlink_message_t& message)
     mavlink_msg_global_position_int_decode(&message, &globalPositionInt);
 
     if (!_altitudeMessageAvailable) {
+        // Batched like the facts set from handleMessage, so rawValueChanged for these reaches listeners up to a frame late
+        beginUpdate();
         _altitudeRelativeFact.setRawValue(globalPositionInt.relative_alt / 1000.0);
         _altitudeAMSLFact.setRawValue(globalPositionInt.alt / 1000.0);
+        commitUpdate();
     }
 
     // ArduPilot sends bogus GLOBAL_POSITION_INT messages with lat/lat 0/0 even when it has no gps signal
@@ -1476,9 +1484,16 @@ bool Vehicle::sendMessageOnLinkThreadSafe(LinkInterface* link, mavlink_message_t
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
     int len = mavlink_msg_to_send_buffer(buffer, &message);
 
-    link->writeBytesThreadSafe((const char*)buffer, len);
+    link->writeBytesThreadSafe((const char*)buffer, len, LinkTransmitQueue::priorityForMessage(message.msgid), true /* resequence */);
     _messagesSent++;
-    emit messagesSentChanged();
+
+    // At most one notification in flight, bursts of messages don't each need a UI update
+    if (!_messagesSentChangedPending.exchange(true)) {
+        (void) QMetaObject::invokeMethod(this, [this]() {
+            _messagesSentChangedPending = false;
+            emit messagesSentChanged();
+        }, Qt::QueuedConnection);
+    }
 
     return true;
 }
@@ -1812,13 +1827,13 @@ void Vehicle::_gotProgressUpdate(float progressValue)
 void Vehicle::_firstMissionLoadComplete()
 {
     disconnect(_missionManager, &MissionManager::newMissionItemsAvailable, this, &Vehicle::_firstMissionLoadComplete);
-    _initialConnectStateMachine->advance();
+    _initialConnectStateMachine->stepComplete(InitialConnectStateMachine::StepMission);
 }
 
 void Vehicle::_firstGeoFenceLoadComplete()
 {
     disconnect(_geoFenceManager, &GeoFenceManager::loadComplete, this, &Vehicle::_firstGeoFenceLoadComplete);
-    _initialConnectStateMachine->advance();
+    _initialConnectStateMachine->stepComplete(InitialConnectStateMachine::StepGeoFence);
 }
 
 void Vehicle::_firstRallyPointLoadComplete()
@@ -1826,7 +1841,7 @@ void Vehicle::_firstRallyPointLoadComplete()
     disconnect(_rallyPointManager, &RallyPointManager::loadComplete, this, &Vehicle::_firstRallyPointLoadComplete);
     _initialPlanRequestComplete = true;
     emit initialPlanRequestCompleteChanged(true);
-    _initialConnectStateMachine->advance();
+    _initialConnectStateMachine->stepComplete(InitialConnectStateMachine::StepRallyPoints);
 }
 
 void Vehicle::_parametersReady(bool parametersReady)
@@ -1840,7 +1855,7 @@ void Vehicle::_parametersReady(bool parametersReady)
     if (parametersReady) {
         disconnect(_parameterManager, &ParameterManager::parametersReadyChanged, this, &Vehicle::_parametersReady);
         _setupAutoDisarmSignalling();
-        _initialConnectStateMachine->advance();
+        _initialConnectStateMachine->stepComplete(InitialConnectStateMachine::StepParameters);
     }
 
     _multirotor_speed_limits_available = _firmwarePlugin->mulirotorSpeedLimitsAvailable(this);
@@ -2702,6 +2717,16 @@ void Vehicle::_handleCommandAck(mavlink_message_t& message)
 
     int entryIndex = _findMavCommandListEntryIndex(message.compid, static_cast<MAV_CMD>(ack.command));
     if (entryIndex != -1) {
+        // Only the first ack to a command which was sent once gives an unambiguous round trip time
+        MavCommandListEntry_t& ackedEntryRef = _mavCommandList[entryIndex];
+        if (!ackedEntryRef.ackReceived && (ackedEntryRef.tryCount == 1)) {
+            SharedLinkInterfacePtr sharedLink = vehicleLinkManager()->primaryLink().lock();
+            if (sharedLink) {
+                sharedLink->statistics()->countRoundTrip(LinkStatistics::RoundTripCommandAck, ackedEntryRef.elapsedTimer.nsecsElapsed() / 1000);
+            }
+        }
+        ackedEntryRef.ackReceived = true;
+
         if (ack.result == MAV_RESULT_IN_PROGRESS) {
             MavCommandListEntry_t commandEntry;
             if (px4Firmware() && ack.command == MAV_CMD_DO_AUTOTUNE_ENABLE) {
@@ -18,6 +18,8 @@
 #include <QtPositioning/QGeoCoordinate>
 #include <QtCore/QFile>
 
+#include <atomic>
+
 #include "HealthAndArmingCheckReport.h"
 #include "MAVLinkStreamConfig.h"
 #include "QGCMapCircle.h"
@@ -617,6 +619,7 @@ public:
     VehicleLinkManager*             vehicleLinkManager  () { return _vehicleLinkManager; }
     FTPManager*                     ftpManager          () { return _ftpManager; }
     ComponentInformationManager*    compInfoManager     () { return _componentInformationManager; }
+    InitialConnectStateMachine*     initialConnectStateMachine() { return _initialConnectStateMachine; }
     VehicleObjectAvoidance*         objectAvoidance     () { return _objectAvoidance; }
     Autotune*                       autotune            () const { return _autotune; }
     RemoteIDManager*                remoteIDManager     () { return _remoteIDManager; }
@@ -1098,7 +1101,8 @@ private:
     bool _allLinksRemovedSent = false; ///< true: allLinkRemoved signal already sent one time
 
     uint                _messagesReceived = 0;
-    uint                _messagesSent = 0;
+    std::atomic_uint    _messagesSent = 0;
+    std::atomic_bool    _messagesSentChangedPending = false;    ///< true: messagesSentChanged already posted, coalesces notifications
     uint                _messagesLost = 0;
     uint8_t             _messageSeq = 0;
     uint8_t             _compID = 0;
@@ -1193,6 +1197,7 @@ private:
         int                     tryCount            = 0;
         QElapsedTimer           elapsedTimer;
         int                     ackTimeoutMSecs     = _mavCommandAckTimeoutMSecs;
+        bool                    ackReceived         = false;
     } MavCommandListEntry_t;
 
     QList<MavCommandListEntry_t>    _mavCommandList;
@@ -14,6 +14,8 @@
 #include <QtCore/QFile>
 #include <QtCore/QElapsedTimer>
 
+#include <cstring>
+
 /// This class manages interactions with the bootloader
 Bootloader::Bootloader(bool sikRadio, QObject *parent)
     : QObject   (parent)
@@ -184,11 +186,49 @@ bool Bootloader::erase(void)
 
 bool Bootloader::program(const FirmwareImage* image)
 {
-    if (image->imageIsBinFormat()) {
-        return _binProgram(image);
-    } else {
+    if (!image->imageIsBinFormat()) {
         return _ihxProgram(image);
     }
+
+    const int window = _binProgramWindow();
+    if (_binProgram(image, window)) {
+        return true;
+    }
+
+    // A .px4 image is decompressed while it is being programmed, and the last chunk is only released once the zlib
+    // checksum has passed. A corrupt image leaves a partial program behind, which is erased again so the board
+    // stays in the bootloader instead of booting it.
+    QString imageErrorString;
+    if (!image->waitForImage(imageErrorString)) {
+        qCWarning(FirmwareUpgradeLog) << "Image failed during program, erasing board:" << imageErrorString;
+        while (_port.waitForReadyRead(100)) {
+            (void) _port.readAll();
+        }
+        if (_sync() && erase()) {
+            _errorString = tr("Firmware image is corrupt, the board was erased and stays in the bootloader: %1").arg(imageErrorString);
+        } else {
+            _errorString = tr("Firmware image is corrupt: %1 (erase after failure: %2)").arg(imageErrorString, _errorString);
+        }
+        return false;
+    }
+
+    if (window == 1) {
+        return false;
+    }
+
+    // The bootloader may have overrun its receive buffer. Drop whatever is still coming back for the packets in
+    // flight, then start over from a fresh erase one packet at a time.
+    qCWarning(FirmwareUpgradeLog) << "Windowed program failed, retrying one packet at a time:" << _errorString;
+    const QString windowedErrorString = _errorString;
+    while (_port.waitForReadyRead(100)) {
+        (void) _port.readAll();
+    }
+    if (!_sync() || !erase() || !_binProgram(image, 1)) {
+        _errorString = tr("%1 (retry after: %2)").arg(_errorString, windowedErrorString);
+        return false;
+    }
+
+    return true;
 }
 
 bool Bootloader::reboot(void)
@@ -340,29 +380,51 @@ Error:
     return false;
 }
 
-bool Bootloader::_binProgram(const FirmwareImage* image)
+/// @return Number of PROG_MULTI packets to send ahead of their responses
+int Bootloader::_binProgramWindow(void) const
+{
+    if (_programWindow > 0) {
+        return _programWindow;
+    }
+
+    // SiK radios are flashed over a plain uart without flow control and must be sent one packet at a time. Older
+    // PX4 bootloaders have a small receive buffer which a window of packets can overflow.
+    if (_sikRadio || (_bootloaderVersion < _bootloaderVersionProgramWindow)) {
+        return 1;
+    }
+
+    return _usbProgramWindow;
+}
+
+bool Bootloader::_binProgram(const FirmwareImage* image, int window)
 {
+    // The image may still be decompressing, reads wait for the bytes to become available and must not be buffered
     QFile firmwareFile(image->binFilename());
-    if (!firmwareFile.open(QIODevice::ReadOnly)) {
+    if (!firmwareFile.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
         _errorString = tr("Unable to open firmware file %1: %2").arg(image->binFilename(), firmwareFile.errorString());
         return false;
     }
-    uint32_t imageSize = (uint32_t)firmwareFile.size();
+    uint32_t imageSize = image->imageSize();
     
-    uint8_t imageBuf[PROG_MULTI_MAX];
+    uint8_t packet[PROG_MULTI_MAX + 3];     // PROTO_PROG_MULTI, byte count, image bytes, PROTO_EOC
+    uint8_t* imageBuf = &packet[2];
     uint32_t bytesSent = 0;
+    QQueue<uint32_t> inFlight;              // Start addresses of the packets still waiting for a response
     _imageCRC = 0;
     
     Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
     
     while (bytesSent < imageSize) {
         int bytesToSend = imageSize - bytesSent;
-        if (bytesToSend > (int)sizeof(imageBuf)) {
-            bytesToSend = (int)sizeof(imageBuf);
+        if (bytesToSend > PROG_MULTI_MAX) {
+            bytesToSend = PROG_MULTI_MAX;
         }
         
         Q_ASSERT((bytesToSend % 4) == 0);
         
+        if (!image->waitForBinBytes(bytesSent + bytesToSend, _errorString)) {
+            return false;
+        }
         int bytesRead = firmwareFile.read((char *)imageBuf, bytesToSend);
         if (bytesRead == -1 || bytesRead != bytesToSend) {
             _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
@@ -371,36 +433,61 @@ bool Bootloader::_binProgram(const FirmwareImage* image)
         
         Q_ASSERT(bytesToSend <= 0x8F);
         
-        bool failed = true;
-        if (_write(PROTO_PROG_MULTI) &&
-                _write((uint8_t)bytesToSend) &&
-                _write(imageBuf, bytesToSend) &&
-                _write(PROTO_EOC)) {
-            if (_getCommandResponse()) {
-                failed = false;
-            }
-        }
-        if (failed) {
+        // Each packet goes out in a single write. Responses are only collected once the window is full so the
+        // link keeps busy while the bootloader programs the previous packets.
+        packet[0] = PROTO_PROG_MULTI;
+        packet[1] = (uint8_t)bytesToSend;
+        packet[bytesToSend + 2] = PROTO_EOC;
+        if (!_write(packet, bytesToSend + 3)) {
             _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
             return false;
         }
+        _port.flush();
+        inFlight.enqueue(bytesSent);
 
         bytesSent += bytesToSend;
 
         // Calculate the CRC now so we can test it after the board is flashed.
-        _imageCRC = QGC::crc32((uint8_t *)imageBuf, bytesToSend, _imageCRC);
+        _imageCRC = QGC::crc32(imageBuf, bytesToSend, _imageCRC);
 
-        emit updateProgress(bytesSent, imageSize);
+        if (inFlight.count() >= window) {
+            if (!_binProgramResponse(inFlight, bytesSent, imageSize)) {
+                return false;
+            }
+        }
     }
     firmwareFile.close();
 
+    while (!inFlight.isEmpty()) {
+        if (!_binProgramResponse(inFlight, bytesSent, imageSize)) {
+            return false;
+        }
+    }
+
     // We calculate the CRC using the entire flash size, filling the remainder with 0xFF.
+    uint8_t fill[256];
+    memset(fill, 0xFF, sizeof(fill));
     while (bytesSent < _boardFlashSize) {
-        const uint8_t fill = 0xFF;
-        _imageCRC = QGC::crc32(&fill, 1, _imageCRC);
-        bytesSent++;
+        const uint32_t fillBytes = qMin<uint32_t>(sizeof(fill), _boardFlashSize - bytesSent);
+        _imageCRC = QGC::crc32(fill, fillBytes, _imageCRC);
+        bytesSent += fillBytes;
+    }
+
+    return true;
+}
+
+/// Reads the response to the oldest PROG_MULTI packet in flight
+///     @param bytesSent Image bytes sent so far, including the packets in flight
+bool Bootloader::_binProgramResponse(QQueue<uint32_t>& inFlight, uint32_t bytesSent, uint32_t imageSize)
+{
+    const uint32_t address = inFlight.dequeue();
+    if (!_getCommandResponse()) {
+        _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(address, 8, 16, QLatin1Char('0'));
+        return false;
     }
 
+    emit updateProgress(inFlight.isEmpty() ? bytesSent : inFlight.head(), imageSize);
+
     return true;
 }
 
@@ -508,12 +595,13 @@ bool Bootloader::_binVerifyBytes(const FirmwareImage* image)
 {
     Q_ASSERT(image->imageIsBinFormat());
     
+    // Programming already waited for the whole image
     QFile firmwareFile(image->binFilename());
     if (!firmwareFile.open(QIODevice::ReadOnly)) {
         _errorString = tr("Unable to open firmware file %1: %2").arg(image->binFilename(), firmwareFile.errorString());
         return false;
     }
-    uint32_t imageSize = (uint32_t)firmwareFile.size();
+    uint32_t imageSize = image->imageSize();
     
     if (!_sendCommand(PROTO_CHIP_VERIFY)) {
         return false;
@@ -15,6 +15,8 @@
 #include <QtSerialPort/QSerialPort>
 #endif
 
+#include <QtCore/QQueue>
+
 class FirmwareImage;
 
 /// Bootloader Utility routines. Works with PX4 and 3DR Radio bootloaders.
@@ -36,6 +38,10 @@ public:
     bool verify             (const FirmwareImage* image);
     bool reboot             (void);
 
+    /// Overrides the number of PROG_MULTI packets which are sent ahead of their responses, 1 waits for each response.
+    /// By default a window is only used for bootloader revisions known to keep up with it.
+    void setProgramWindow   (int window) { _programWindow = qMax(1, window); }
+
     static const int boardIDSiKRadio1000    = 78;       ///< Original radio based on SI1000 chip
     static const int boardIDSiKRadio1060    = 80;       ///< Newer radio based on SI1060 chip
 
@@ -51,7 +57,9 @@ signals:
 private:
     bool    _sync               (void);
     bool    _syncWorker         (void);
-    bool    _binProgram         (const FirmwareImage* image);
+    int     _binProgramWindow   (void) const;
+    bool    _binProgram         (const FirmwareImage* image, int window);
+    bool    _binProgramResponse (QQueue<uint32_t>& inFlight, uint32_t bytesSent, uint32_t imageSize);
     bool    _ihxProgram         (const FirmwareImage* image);
     bool    _write              (const uint8_t* data, qint64 maxSize);
     bool    _write              (const uint8_t byte);
@@ -109,6 +117,7 @@ private:
     uint32_t    _boardFlashSize     = 0;        ///< flash size for currently connected board
     uint32_t    _bootloaderVersion  = 0;        ///< Bootloader version
     uint32_t    _imageCRC           = 0;        ///< CRC for image in currently selected firmware file
+    int         _programWindow      = 0;        ///< Max PROG_MULTI packets awaiting a response, 0 picks it from the bootloader revision
     QString     _firmwareFilename;              ///< Currently selected firmware file to flash
     QString     _errorString;                   ///< Last error
     
@@ -119,4 +128,6 @@ private:
     static const int _responseTimeout                   = 2000;     ///< Msecs to wait for command response bytes
     static const int _flashSizeSmall                    = 1032192;  ///< Flash size for boards with silicon error
     static const int _bootloaderVersionV2CorrectFlash   = 5;        ///< Anything below this bootloader version on V2 boards cannot trust flash size
+    static const int _bootloaderVersionProgramWindow    = 5;        ///< Anything below this bootloader version gets one PROG_MULTI packet at a time
+    static const int _usbProgramWindow                  = 8;        ///< PROG_MULTI packets in flight on USB
 };
@@ -8,18 +8,19 @@
  ****************************************************************************/
 
 #include "FirmwareImage.h"
-#include "JsonHelper.h"
 #include "QGCApplication.h"
 #include "CompInfoParam.h"
 #include "Bootloader.h"
 #include "QGCLoggingCategory.h"
+#include "QGCZlib.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QFile>
 #include <QtCore/QTextStream>
-#include <QtCore/QJsonDocument>
-#include <QtCore/QJsonObject>
+#include <QtCore/QHash>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
+#include <QtCore/QMutexLocker>
 
 FirmwareImage::FirmwareImage(QObject* parent) :
     QObject(parent),
@@ -28,8 +29,20 @@ FirmwareImage::FirmwareImage(QObject* parent) :
     
 }
 
+FirmwareImage::~FirmwareImage()
+{
+    _decompressCancel = true;
+    _decompressFuture.waitForFinished();
+    _px4File.close();
+}
+
 bool FirmwareImage::load(const QString& imageFilename, uint32_t boardId)
 {
+    // Stop decompression of a previously loaded image
+    _decompressCancel = true;
+    _decompressFuture.waitForFinished();
+    _px4File.close();
+
     _imageSize = 0;
     _boardId = boardId;
     
@@ -200,201 +213,322 @@ bool FirmwareImage::_px4Load(const QString& imageFilename)
     
     // We need to collect information from the .px4 file as well as pull the binary image out to a separate file.
     
-    QFile px4File(imageFilename);
-    if (!px4File.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit statusMessage(tr("Unable to open firmware file %1, error: %2").arg(imageFilename, px4File.errorString()));
+    _px4File.setFileName(imageFilename);
+    if (!_px4File.open(QIODevice::ReadOnly)) {
+        emit statusMessage(tr("Unable to open firmware file %1, error: %2").arg(imageFilename, _px4File.errorString()));
         return false;
     }
-    
-    QByteArray bytes = px4File.readAll();
-    px4File.close();
-    QJsonDocument doc = QJsonDocument::fromJson(bytes);
-    
-    if (doc.isNull()) {
-        emit statusMessage(tr("Supplied file is not a valid JSON document"));
-        return false;
+
+    // The file is mapped rather than read so that decompression pages it in as it goes. It stays mapped until the
+    // background image decompression is done with it.
+    QByteArray bytes;
+    if (uchar* mapped = _px4File.map(0, _px4File.size())) {
+        bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), _px4File.size());
+    } else {
+        bytes = _px4File.readAll();
     }
-    
-    QJsonObject px4Json = doc.object();
-    
-    // Make sure the keys we need are available
-    QString errorString;
-    QStringList requiredKeys;
-    requiredKeys << _jsonBoardIdKey << _jsonImageKey << _jsonImageSizeKey;
-    if (!JsonHelper::validateRequiredKeys(px4Json, requiredKeys, errorString)) {
-        emit statusMessage(tr("Firmware file missing required key: %1").arg(errorString));
+
+    // A .px4 file is a flat json object which is almost entirely made up of the compressed values. Only the few
+    // numbers needed up front are picked out of it, rather than building a QJsonDocument of the whole file.
+    qsizetype first = 0;
+    qsizetype last = bytes.size() - 1;
+    while ((first <= last) && QChar::isSpace(static_cast<uchar>(bytes[first]))) {
+        first++;
+    }
+    while ((last > first) && QChar::isSpace(static_cast<uchar>(bytes[last]))) {
+        last--;
+    }
+    if ((first >= last) || (bytes[first] != '{') || (bytes[last] != '}')) {
+        emit statusMessage(tr("Supplied file is not a valid JSON document"));
         return false;
     }
 
-    // Make sure the keys are the correct type
-    QStringList keys;
-    QList<QJsonValue::Type> types;
-    keys << _jsonBoardIdKey << _jsonParamXmlSizeKey << _jsonParamXmlKey << _jsonAirframeXmlSizeKey << _jsonAirframeXmlKey << _jsonImageSizeKey << _jsonImageKey << _jsonMavAutopilotKey;
-    types << QJsonValue::Double << QJsonValue::Double << QJsonValue::String << QJsonValue::Double << QJsonValue::String << QJsonValue::Double << QJsonValue::String << QJsonValue::Double;
-    if (!JsonHelper::validateKeyTypes(px4Json, keys, types, errorString)) {
-        emit statusMessage(tr("Firmware file has invalid key: %1").arg(errorString));
-        return false;
+    // Make sure the keys we need are available and are the correct type
+    QHash<QByteArray, qint64> px4Json;
+    for (const char* key: { _jsonBoardIdKey, _jsonParamXmlSizeKey, _jsonAirframeXmlSizeKey, _jsonImageSizeKey, _jsonMavAutopilotKey }) {
+        qint64 value = 0;
+        switch (_jsonNumberValue(bytes, key, value)) {
+        case JsonValueFound:
+            px4Json[key] = value;
+            break;
+        case JsonValueMissing:
+            break;
+        case JsonValueInvalid:
+            emit statusMessage(tr("Firmware file has invalid key: %1").arg(key));
+            return false;
+        }
+    }
+    for (const char* key: { _jsonBoardIdKey, _jsonImageSizeKey }) {
+        if (!px4Json.contains(key)) {
+            emit statusMessage(tr("Firmware file missing required key: %1").arg(key));
+            return false;
+        }
     }
 
-    uint32_t firmwareBoardId = (uint32_t)px4Json.value(_jsonBoardIdKey).toInt();
+    uint32_t firmwareBoardId = (uint32_t)px4Json.value(_jsonBoardIdKey);
     if (!isCompatible(_boardId, firmwareBoardId)) {
         emit statusMessage(tr("Downloaded firmware board id does not match hardware board id: %1 != %2").arg(firmwareBoardId).arg(_boardId));
         return false;
     }
 
     // What firmware type is this?
-    MAV_AUTOPILOT firmwareType = (MAV_AUTOPILOT)px4Json[_jsonMavAutopilotKey].toInt(MAV_AUTOPILOT_PX4);
+    MAV_AUTOPILOT firmwareType = (MAV_AUTOPILOT)px4Json.value(_jsonMavAutopilotKey, MAV_AUTOPILOT_PX4);
     emit statusMessage(QString("MAV_AUTOPILOT = %1").arg(firmwareType));
     
-    // Decompress the parameter xml and save to file
-    QByteArray decompressedBytes;
-    bool success = _decompressJsonValue(px4Json,               // JSON object
-                                        bytes,                 // Raw bytes of JSON document
-                                        _jsonParamXmlSizeKey,  // key which holds byte size
-                                        _jsonParamXmlKey,      // key which holds compressed bytes
-                                        decompressedBytes);    // Returned decompressed bytes
-    if (success) {
-        QString parameterFilename = QGCApplication::cachedParameterMetaDataFile();
-        QFile parameterFile(QGCApplication::cachedParameterMetaDataFile());
-
-        if (parameterFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            qint64 bytesWritten = parameterFile.write(decompressedBytes);
-            if (bytesWritten != decompressedBytes.length()) {
-                emit statusMessage(tr("Write failed for parameter meta data file, error: %1").arg(parameterFile.errorString()));
-                parameterFile.close();
-                QFile::remove(parameterFilename);
-            } else {
-                parameterFile.close();
-            }
-        } else {
-            emit statusMessage(tr("Unable to open parameter meta data file %1 for writing, error: %2").arg(parameterFilename, parameterFile.errorString()));
+    // The parameter and airframe xml are optional and decompressed straight to their cache files while the
+    // image is being decompressed
+    auto decompressMetaData = [this, &px4Json, &bytes](const char* sizeKey, const char* bytesKey, const QString& filename) -> QFuture<QString> {
+        if (!px4Json.contains(sizeKey)) {
+            emit statusMessage(tr("Firmware file missing %1 key").arg(sizeKey));
+            return QFuture<QString>();
         }
+        const qint64 decompressedSize = px4Json.value(sizeKey);
+        if (decompressedSize <= 0) {
+            emit statusMessage(tr("Firmware file has invalid decompressed size for %1").arg(sizeKey));
+            return QFuture<QString>();
+        }
+
+        return QtConcurrent::run([bytes, bytesKey, decompressedSize, filename]() -> QString {
+            QFile file(filename);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                return tr("Unable to open meta data file %1 for writing, error: %2").arg(filename, file.errorString());
+            }
+            QString errorString;
+            if (!_decompressJsonValue(bytes, bytesKey, decompressedSize, file, errorString)) {
+                file.close();
+                (void) QFile::remove(filename);
+                return errorString;
+            }
+            return QString();
+        });
+    };
+    const QString parameterFilename = QGCApplication::cachedParameterMetaDataFile();
+    QFuture<QString> parameterFuture = decompressMetaData(_jsonParamXmlSizeKey, _jsonParamXmlKey, parameterFilename);
+    QFuture<QString> airframeFuture = decompressMetaData(_jsonAirframeXmlSizeKey, _jsonAirframeXmlKey, QGCApplication::cachedAirframeMetaDataFile());
 
-        // Cache this file with the system
-        CompInfoParam::_cachePX4MetaDataFile(parameterFilename);
+    // Decompress the image to a file in the same location as the original download. This continues in the
+    // background after load returns so programming can start as soon as the first bytes are available.
+    bool success = true;
+    const qint64 imageSize = px4Json.value(_jsonImageSizeKey);
+    if (imageSize <= 0) {
+        emit statusMessage(tr("Firmware file has invalid decompressed size for %1").arg(_jsonImageSizeKey));
+        success = false;
     }
 
-    // Decompress the airframe xml and save to file
-    success = _decompressJsonValue(px4Json,                         // JSON object
-                                        bytes,                      // Raw bytes of JSON document
-                                        _jsonAirframeXmlSizeKey,    // key which holds byte size
-                                        _jsonAirframeXmlKey,        // key which holds compressed bytes
-                                        decompressedBytes);         // Returned decompressed bytes
+    QDir imageDir = QFileInfo(imageFilename).dir();
+    QString decompressFilename = imageDir.filePath("PX4FlashUpgrade.bin");
     if (success) {
-        QString airframeFilename = QGCApplication::cachedAirframeMetaDataFile();
-        //qDebug() << airframeFilename;
-        QFile airframeFile(QGCApplication::cachedAirframeMetaDataFile());
-
-        if (airframeFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-            qint64 bytesWritten = airframeFile.write(decompressedBytes);
-            if (bytesWritten != decompressedBytes.length()) {
-                // FIXME: What about these warnings?
-                emit statusMessage(tr("Write failed for airframe meta data file, error: %1").arg(airframeFile.errorString()));
-                airframeFile.close();
-                QFile::remove(airframeFilename);
-            } else {
-                airframeFile.close();
-            }
+        _decompressFile.setFileName(decompressFilename);
+        if (!_decompressFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)) {
+            emit statusMessage(tr("Unable to open decompressed file %1 for writing, error: %2").arg(decompressFilename, _decompressFile.errorString()));
+            success = false;
+        }
+    }
+
+    if (success) {
+        // Image is padded to 4-byte boundary
+        _imageSize = static_cast<uint32_t>((imageSize + 3) & ~3);
+        _binFilename = decompressFilename;
+        _setBinBytesAvailable(0);
+        {
+            QMutexLocker lock(&_binMutex);
+            _binDecompressDone = false;
+            _binDecompressError.clear();
+        }
+        _decompressCancel = false;
+        _decompressFuture = QtConcurrent::run([this, bytes, imageSize]() { _decompressImage(bytes, imageSize); });
+    }
+
+    if (parameterFuture.isValid()) {
+        const QString errorString = parameterFuture.result();
+        if (errorString.isEmpty()) {
+            emit statusMessage(tr("Successfully decompressed %1").arg(_jsonParamXmlKey));
+            // Cache this file with the system
+            CompInfoParam::_cachePX4MetaDataFile(parameterFilename);
         } else {
-            emit statusMessage(tr("Unable to open airframe meta data file %1 for writing, error: %2").arg(airframeFilename, airframeFile.errorString()));
+            emit statusMessage(errorString);
         }
     }
-    
-    // Decompress the image and save to file
-    _imageSize = px4Json.value(QString("image_size")).toInt();
-    success = _decompressJsonValue(px4Json,               // JSON object
-                                   bytes,                 // Raw bytes of JSON document
-                                   _jsonImageSizeKey,     // key which holds byte size
-                                   _jsonImageKey,         // key which holds compressed bytes
-                                   decompressedBytes);    // Returned decompressed bytes
-    if (!success) {
-        return false;
+    if (airframeFuture.isValid()) {
+        const QString errorString = airframeFuture.result();
+        emit statusMessage(errorString.isEmpty() ? tr("Successfully decompressed %1").arg(_jsonAirframeXmlKey) : errorString);
     }
-    
-    // Pad image to 4-byte boundary
-    while ((decompressedBytes.length() % 4) != 0) {
-        decompressedBytes.append(static_cast<char>(static_cast<unsigned char>(0xFF)));
+
+    return success;
+}
+
+void FirmwareImage::_decompressImage(const QByteArray& jsonDocBytes, qint64 decompressedSize)
+{
+    // The zlib checksum is only known at the very end. The last bytes are held back until it has passed, so a
+    // corrupt image can never be programmed completely.
+    QString errorString;
+    bool success = _decompressJsonValue(jsonDocBytes, _jsonImageKey, decompressedSize, _decompressFile, errorString, [this, decompressedSize](qint64 bytesWritten) {
+        _setBinBytesAvailable(qMin(bytesWritten, decompressedSize - 1));
+        return !_decompressCancel;
+    });
+
+    if (success) {
+        const QByteArray padding(_imageSize - decompressedSize, static_cast<char>(static_cast<unsigned char>(0xFF)));
+        if (_decompressFile.write(padding) != padding.length()) {
+            errorString = tr("Write failed for decompressed image file, error: %1").arg(_decompressFile.errorString());
+            success = false;
+        }
     }
-    
-    // Store decompressed image file in same location as original download file
-    QDir imageDir = QFileInfo(imageFilename).dir();
-    QString decompressFilename = imageDir.filePath("PX4FlashUpgrade.bin");
-    
-    QFile decompressFile(decompressFilename);
-    if (!decompressFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        emit statusMessage(tr("Unable to open decompressed file %1 for writing, error: %2").arg(decompressFilename, decompressFile.errorString()));
-        return false;
+    _decompressFile.close();
+
+    if (success) {
+        qCDebug(FirmwareUpgradeLog) << "Decompressed image" << _binFilename << _imageSize;
+        _setBinBytesAvailable(_imageSize);
+    } else {
+        qCWarning(FirmwareUpgradeLog) << "Image decompression failed:" << errorString;
     }
-    
-    qint64 bytesWritten = decompressFile.write(decompressedBytes);
-    if (bytesWritten != decompressedBytes.length()) {
-        emit statusMessage(tr("Write failed for decompressed image file, error: %1").arg(decompressFile.errorString()));
-        return false;
+
+    {
+        QMutexLocker lock(&_binMutex);
+        _binDecompressDone = true;
+        _binDecompressError = errorString;
     }
-    decompressFile.close();
-    
-    _binFilename = decompressFilename;
-    
-    return true;
+    _binBytesWake.wakeAll();
 }
 
-/// Decompress a set of bytes stored in a Json document.
-bool FirmwareImage::_decompressJsonValue(const QJsonObject&	jsonObject,			///< JSON object
-                                         const QByteArray&	jsonDocBytes,		///< Raw bytes of JSON document
-                                         const QString&		sizeKey,			///< key which holds byte size
-                                         const QString&		bytesKey,			///< key which holds compress bytes
-                                         QByteArray&		decompressedBytes)	///< Returned decompressed bytes
+void FirmwareImage::_setBinBytesAvailable(qint64 count)
 {
-    // Validate decompressed size key
-    if (!jsonObject.contains(sizeKey)) {
-        emit statusMessage(QString("Firmware file missing %1 key").arg(sizeKey));
-        return false;
+    {
+        QMutexLocker lock(&_binMutex);
+        _binBytesAvailable = count;
     }
-    int decompressedSize = jsonObject.value(QString(sizeKey)).toInt();
-    if (decompressedSize == 0) {
-        emit statusMessage(tr("Firmware file has invalid decompressed size for %1").arg(sizeKey));
-        return false;
+    _binBytesWake.wakeAll();
+}
+
+bool FirmwareImage::waitForBinBytes(qint64 count, QString& errorString) const
+{
+    QMutexLocker lock(&_binMutex);
+
+    while ((_binBytesAvailable < count) && !_binDecompressDone) {
+        (void) _binBytesWake.wait(&_binMutex);
     }
-    
+    if (_binBytesAvailable >= count) {
+        return true;
+    }
+
+    errorString = _binDecompressError.isEmpty() ? tr("Firmware image is shorter than expected") : _binDecompressError;
+    return false;
+}
+
+bool FirmwareImage::waitForImage(QString& errorString) const
+{
+    return !_binFormat || waitForBinBytes(_imageSize, errorString);
+}
+
+/// Finds a top level number value in the raw bytes of a flat Json document. Safe to call from any thread.
+FirmwareImage::JsonValueResult FirmwareImage::_jsonNumberValue(const QByteArray& jsonDocBytes, const char* key, qint64& value)
+{
+    const QByteArray quotedKey = QByteArray("\"") + key + "\"";
+    for (qsizetype index = jsonDocBytes.indexOf(quotedKey); index != -1; index = jsonDocBytes.indexOf(quotedKey, index + 1)) {
+        // Skip over the key showing up inside of a string value
+        if ((index > 0) && (jsonDocBytes[index - 1] == '\\')) {
+            continue;
+        }
+        qsizetype valueIndex = index + quotedKey.length();
+        while ((valueIndex < jsonDocBytes.size()) && QChar::isSpace(static_cast<uchar>(jsonDocBytes[valueIndex]))) {
+            valueIndex++;
+        }
+        if ((valueIndex >= jsonDocBytes.size()) || (jsonDocBytes[valueIndex] != ':')) {
+            continue;
+        }
+        valueIndex++;
+        while ((valueIndex < jsonDocBytes.size()) && QChar::isSpace(static_cast<uchar>(jsonDocBytes[valueIndex]))) {
+            valueIndex++;
+        }
+
+        qsizetype endIndex = valueIndex;
+        while (endIndex < jsonDocBytes.size()) {
+            const char c = jsonDocBytes[endIndex];
+            if (!(((c >= '0') && (c <= '9')) || (c == '-') || (c == '+') || (c == '.') || (c == 'e') || (c == 'E'))) {
+                break;
+            }
+            endIndex++;
+        }
+        bool ok = false;
+        const double number = QByteArray::fromRawData(jsonDocBytes.constData() + valueIndex, endIndex - valueIndex).toDouble(&ok);
+        if (!ok) {
+            return JsonValueInvalid;
+        }
+        value = static_cast<qint64>(number);
+        return JsonValueFound;
+    }
+
+    return JsonValueMissing;
+}
+
+/// Decompress a set of bytes stored in a Json document, writing the decompressed bytes to outputDevice as they are
+/// produced. Safe to call from any thread.
+bool FirmwareImage::_decompressJsonValue(const QByteArray&                  jsonDocBytes,       ///< Raw bytes of JSON document
+                                         const char*                        bytesKey,           ///< key which holds compress bytes
+                                         qint64                             decompressedSize,   ///< Expected decompressed byte count
+                                         QIODevice&                         outputDevice,       ///< Receives decompressed bytes
+                                         QString&                           errorString,        ///< Set on failure
+                                         const std::function<bool(qint64)>& progress)           ///< Called with the byte count written so far, return false to cancel
+{
     // XXX Qt's JSON string handling is terribly broken, strings
     // with some length (18K / 25K) are just weirdly cut.
     // The code below works around this by manually 'parsing'
     // for the image string. Since its compressed / checksummed
     // this should be fine.
     
-    QStringList parts = QString(jsonDocBytes).split(QString("\"%1\": \"").arg(bytesKey));
-    if (parts.length() == 1) {
-        emit statusMessage(tr("Could not find compressed bytes for %1 in Firmware file").arg(bytesKey));
+    const QByteArray valueStart = QByteArray("\"") + bytesKey + "\": \"";
+    const qsizetype startIndex = jsonDocBytes.lastIndexOf(valueStart);
+    if (startIndex == -1) {
+        errorString = tr("Could not find compressed bytes for %1 in Firmware file").arg(bytesKey);
         return false;
     }
-    parts = parts.last().split("\"");
-    if (parts.length() == 1) {
-        emit statusMessage(tr("Incorrectly formed compressed bytes section for %1 in Firmware file").arg(bytesKey));
+    const qsizetype valueIndex = startIndex + valueStart.length();
+    const qsizetype endIndex = jsonDocBytes.indexOf('"', valueIndex);
+    if (endIndex == -1) {
+        errorString = tr("Incorrectly formed compressed bytes section for %1 in Firmware file").arg(bytesKey);
         return false;
     }
+
+    qint64 bytesWritten = 0;
+    QGCZlib::Inflater inflater([&](const char* data, qsizetype size) {
+        if (bytesWritten + size > decompressedSize) {
+            errorString = tr("Decompressed %1 is larger than stored size: Expected(%2)").arg(bytesKey).arg(decompressedSize);
+            return false;
+        }
+        if (outputDevice.write(data, size) != size) {
+            errorString = tr("Write failed for decompressed %1, error: %2").arg(bytesKey, outputDevice.errorString());
+            return false;
+        }
+        bytesWritten += size;
+        if (progress && !progress(bytesWritten)) {
+            errorString = tr("Decompression of %1 cancelled").arg(bytesKey);
+            return false;
+        }
+        return true;
+    });
+
+    // Base64 decode in pieces which are a multiple of 4 characters so that each piece decodes on its own
+    constexpr qsizetype cBase64Chunk = 4 * 4096;
+    for (qsizetype index = valueIndex; (index < endIndex) && !inflater.finished(); index += cBase64Chunk) {
+        const QByteArray raw64 = QByteArray::fromRawData(jsonDocBytes.constData() + index, qMin(cBase64Chunk, endIndex - index));
+        const QByteArray raw = QByteArray::fromBase64(raw64);
+        if (!inflater.inflate(raw.constData(), raw.length())) {
+            if (errorString.isEmpty()) {
+                errorString = tr("Firmware file has corrupt compressed bytes for %1").arg(bytesKey);
+            }
+            return false;
+        }
+    }
     
-    // Store decompressed size as first four bytes. This is required by qUncompress routine.
-    QByteArray raw;
-    raw.append((unsigned char)((decompressedSize >> 24) & 0xFF));
-    raw.append((unsigned char)((decompressedSize >> 16) & 0xFF));
-    raw.append((unsigned char)((decompressedSize >> 8) & 0xFF));
-    raw.append((unsigned char)((decompressedSize >> 0) & 0xFF));
-    
-    QByteArray raw64 = parts.first().toUtf8();
-    raw.append(QByteArray::fromBase64(raw64));
-    decompressedBytes = qUncompress(raw);
-    
-    if (decompressedBytes.length() == 0) {
-        emit statusMessage(tr("Firmware file has 0 length %1").arg(bytesKey));
+    if (bytesWritten == 0) {
+        errorString = tr("Firmware file has 0 length %1").arg(bytesKey);
         return false;
     }
-    if (decompressedBytes.length() != decompressedSize) {
-        emit statusMessage(tr("Size for decompressed %1 does not match stored size: Expected(%1) Actual(%2)").arg(decompressedSize).arg(decompressedBytes.length()));
+    if (!inflater.finished() || (bytesWritten != decompressedSize)) {
+        errorString = tr("Size for decompressed %1 does not match stored size: Expected(%2) Actual(%3)").arg(bytesKey).arg(decompressedSize).arg(bytesWritten);
         return false;
     }
     
-    emit statusMessage(tr("Successfully decompressed %1").arg(bytesKey));
-    
     return true;
 }
 
@@ -430,6 +564,7 @@ bool FirmwareImage::_binLoad(const QString& imageFilename)
     binFile.close();
     
     _binFilename = imageFilename;
+    _setBinBytesAvailable(_imageSize);
     
     return true;
 }
@@ -19,6 +19,13 @@
 #include <QtCore/QByteArray>
 #include <QtCore/QList>
 #include <QtCore/QTextStream>
+#include <QtCore/QFile>
+#include <QtCore/QFuture>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <functional>
 
 /// Support for Intel Hex firmware file
 class FirmwareImage : public QObject
@@ -27,9 +34,13 @@ class FirmwareImage : public QObject
     
 public:
     FirmwareImage(QObject *parent = 0);
+    ~FirmwareImage();
     
     /// Loads the specified image file. Supported formats: .px4, .bin, .ihx.
     /// Emits errorMesssage and statusMessage signals while loading.
+    /// For .px4/.apj files the image is still being decompressed to binFilename() in the background when this
+    /// returns, readers of the .bin file must call waitForBinBytes before reading. A corrupt compressed image is only
+    /// reported from there. The last bytes of the image only become available once the whole image has checked out.
     ///     @param imageFilename Image file to load
     ///     @param boardId Board id that we are going to load this image onto
     /// @return true: success, false: failure
@@ -43,6 +54,17 @@ public:
     
     /// @return Filename for .bin file
     QString binFilename(void) const { return _binFilename; }
+
+    /// Blocks until the first count bytes of the .bin file are available. Thread safe.
+    ///     @param errorString Set on failure
+    /// @return false: decompression of the image failed before count bytes were available
+    bool waitForBinBytes(qint64 count, QString& errorString) const;
+
+    /// Blocks until the whole image is available. For .px4/.apj files this is once the image has been decompressed
+    /// and has passed the zlib checksum and size checks. Thread safe.
+    ///     @param errorString Set on failure
+    /// @return false: image is corrupt
+    bool waitForImage(QString& errorString) const;
     
     /// @return Block count from .ihx image
     uint16_t ihxBlockCount(void) const;
@@ -70,11 +92,21 @@ private:
     bool _readWordFromStream(QTextStream& stream, uint16_t& word);
     bool _readBytesFromStream(QTextStream& stream, uint8_t byteCount, QByteArray& bytes);
     
-    bool _decompressJsonValue(const QJsonObject&	jsonObject,
-                              const QByteArray&     jsonDocBytes,
-                              const QString&		sizeKey,
-                              const QString&		bytesKey,
-                              QByteArray&			decompressedBytes);
+    typedef enum {
+        JsonValueFound,
+        JsonValueMissing,
+        JsonValueInvalid,
+    } JsonValueResult;
+
+    static JsonValueResult _jsonNumberValue(const QByteArray& jsonDocBytes, const char* key, qint64& value);
+    static bool _decompressJsonValue(const QByteArray&                      jsonDocBytes,
+                                     const char*                            bytesKey,
+                                     qint64                                 decompressedSize,
+                                     QIODevice&                             outputDevice,
+                                     QString&                               errorString,
+                                     const std::function<bool(qint64)>&     progress = nullptr);
+    void _decompressImage(const QByteArray& jsonDocBytes, qint64 decompressedSize);
+    void _setBinBytesAvailable(qint64 count);
     
     typedef struct {
         uint16_t    address;
@@ -87,6 +119,16 @@ private:
     QList<IntelHexBlock_t>  _ihxBlocks;
     uint32_t                _imageSize;
 
+    QFile                   _px4File;                   ///< Mapped while the image is decompressed from it
+    QFile                   _decompressFile;            ///< Only used by the image decompression thread once started
+    QFuture<void>           _decompressFuture;
+    std::atomic<bool>       _decompressCancel{false};
+    mutable QMutex          _binMutex;                  ///< Protects the three members below
+    mutable QWaitCondition  _binBytesWake;
+    qint64                  _binBytesAvailable = 0;
+    bool                    _binDecompressDone = true;
+    QString                 _binDecompressError;
+
     static constexpr const char* _jsonBoardIdKey =            "board_id";
     static constexpr const char* _jsonParamXmlSizeKey =       "parameter_xml_size";
     static constexpr const char* _jsonParamXmlKey =           "parameter_xml";
@@ -16,7 +16,7 @@
 #include "QGCCorePlugin.h"
 #include "FirmwareUpgradeSettings.h"
 #include "SettingsManager.h"
-#include "QGCZlib.h"
+#include "QGCDecompressDevice.h"
 #include "JsonHelper.h"
 #include "LinkManager.h"
 #include "MultiVehicleManager.h"
@@ -24,8 +24,6 @@
 #include "Fact.h"
 #include "QGCLoggingCategory.h"
 
-#include <QtCore/QDir>
-#include <QtCore/QStandardPaths>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonArray>
@@ -657,15 +655,16 @@ void FirmwareUpgradeController::_ardupilotManifestDownloadComplete(QString remot
 
         qCDebug(FirmwareUpgradeLog) << "_ardupilotManifestDownloadFinished" << remoteFile << localFile;
 
-        QString jsonFileName(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("ArduPilot.Manifest.json"));
-        if (!QGCZlib::inflateGzipFile(localFile, jsonFileName)) {
-            qCWarning(FirmwareUpgradeLog) << "Inflate of compressed manifest failed" << localFile;
+        // The manifest is decompressed in memory
+        QString         errorString;
+        QByteArray      bytes;
+        if (!QGCDecompressDevice::readFile(localFile, bytes, errorString)) {
+            qCWarning(FirmwareUpgradeLog) << "Inflate of compressed manifest failed" << errorString;
             return;
         }
 
-        QString         errorString;
         QJsonDocument   doc;
-        if (!JsonHelper::isJsonFile(jsonFileName, doc, errorString)) {
+        if (!JsonHelper::isJsonFile(bytes, doc, errorString)) {
             qCWarning(FirmwareUpgradeLog) << "Json file read failed" << errorString;
             return;
         }
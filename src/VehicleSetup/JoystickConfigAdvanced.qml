@@ -140,6 +140,34 @@ Item {
             visible:            advancedSettings.checked
         }
         //-----------------------------------------------------------------
+        //-- Event driven input
+        QGCLabel {
+            text:               qsTr("Send input immediately")
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked
+        }
+        QGCCheckBox {
+            enabled:            advancedSettings.checked
+            checked:            _activeJoystick.eventDriven
+            onClicked:          _activeJoystick.eventDriven = checked
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked
+        }
+        //-----------------------------------------------------------------
+        //-- Input latency
+        QGCLabel {
+            text:               qsTr("Input latency (ms):")
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked
+        }
+        QGCLabel {
+            text:               _activeJoystick.latencySampleCount ?
+                                    qsTr("mean %1 max %2").arg(_activeJoystick.latencyMeanMs.toFixed(1)).arg(_activeJoystick.latencyMaxMs.toFixed(1)) :
+                                    qsTr("n/a")
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked
+        }
+        //-----------------------------------------------------------------
         //-- Enable circle correction
         QGCLabel {
             text:               qsTr("Enable circle correction")
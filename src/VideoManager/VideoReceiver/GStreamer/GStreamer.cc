@@ -10,13 +10,13 @@
 #include "GStreamer.h"
 #include "GstVideoReceiver.h"
 #include "AppSettings.h"
+#include "SettingsStore.h"
 #include "QGCLoggingCategory.h"
 #ifdef Q_OS_IOS
 #include "gst_ios_init.h"
 #endif
 
 #include <QtCore/QCoreApplication>
-#include <QtCore/QSettings>
 #include <QtQuick/QQuickItem>
 
 QGC_LOGGING_CATEGORY(GStreamerLog, "qgc.videomanager.videoreceiver.gstreamer")
@@ -168,9 +168,10 @@ void initialize()
 
     if (qEnvironmentVariableIsEmpty("GST_DEBUG")) {
         int gstDebugLevel = 0;
-        QSettings settings;
-        if (settings.contains(AppSettings::gstDebugLevelName)) {
-            gstDebugLevel = settings.value(AppSettings::gstDebugLevelName).toInt();
+        // Through the store since a change may not have been written to disk yet
+        const SettingsStore* const settings = SettingsStore::instance();
+        if (settings->contains(AppSettings::gstDebugLevelName)) {
+            gstDebugLevel = settings->value(AppSettings::gstDebugLevelName).toInt();
         }
         gst_debug_set_default_threshold(static_cast<GstDebugLevel>(gstDebugLevel));
         gst_debug_remove_log_function(gst_debug_log_default);
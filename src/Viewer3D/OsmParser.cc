@@ -9,10 +9,19 @@
 
 #include "OsmParser.h"
 #include "QGCApplication.h"
+#include "QGCLoggingCategory.h"
 #include "SettingsManager.h"
 #include "OsmParserThread.h"
 #include "earcut.hpp"
 
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+QGC_LOGGING_CATEGORY(OsmParserLog, "qgc.viewer3d.osmparser")
+
 typedef union {
     uint array[3];
 
@@ -83,7 +92,6 @@ void OsmParser::osmParserFinished(bool isValid)
 
 void OsmParser::parseOsmFile(QString filePath)
 {
-    _osmParserWorker->mapNodes.clear();
     _osmParserWorker->mapBuildings.clear();
     _gpsRefSet = false;
     _mapLoadedFlag = false;
@@ -94,82 +102,120 @@ void OsmParser::parseOsmFile(QString filePath)
 
 QByteArray OsmParser::buildingToMesh()
 {
-    QByteArray vertexData;
-    QMapIterator<uint64_t, OsmParserThread::BuildingType_t> ii(_osmParserWorker->mapBuildings);
-
-    for (auto ii = _osmParserWorker->mapBuildings.begin(), end = _osmParserWorker->mapBuildings.end(); ii != end; ++ii) {
-        float bld_height = 0;
-        // std::vector<std::array<float, 2> > bld_points;
-        // std::vector<std::vector<std::array<float, 2> > > polygon;
-
-        std::vector<std::array<float, 2> > all_bld_points;
-        std::vector<std::array<float, 2> > bld_points;
-        std::vector<std::vector<std::array<float, 2> > > polygon;
-        std::vector<QVector3D> triangulated_mesh;
-
-        //        bld_height = (ii.value().height >= ii.value().levels * _buildingLevelHeight)?(ii.value().height):(ii.value().levels * _buildingLevelHeight);
-
-        if(ii.value().height > 0){
-            bld_height = ii.value().height;
-        }else if(ii.value().levels > 0){
-            bld_height = (float)(ii.value().levels) * _buildingLevelHeight;
-        }else{
-            continue;
+    // The mesh depends on the level height setting as well as on the file
+    QString cacheFile;
+    if(!_osmParserWorker->fileHash.isEmpty()) {
+        cacheFile = QDir(OsmParserThread::cacheDirectory()).absoluteFilePath(QStringLiteral("%1-%2.mesh").arg(_osmParserWorker->fileHash).arg(_buildingLevelHeight));
+
+        QFile file(cacheFile);
+        if(file.open(QIODevice::ReadOnly)) {
+            qCDebug(OsmParserLog) << "Loaded building mesh from cache" << cacheFile;
+            // Keep recently used files from being evicted
+            (void) file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            return file.readAll();
         }
+    }
 
-        for(unsigned int jj=0; jj<ii.value().points_local.size(); jj++) {
-            bld_points.push_back({ii.value().points_local[jj].x(), ii.value().points_local[jj].y()});
-            all_bld_points.push_back({ii.value().points_local[jj].x(), ii.value().points_local[jj].y()});
-        }
-        polygon.push_back(bld_points);
+    QList<const OsmParserThread::BuildingType_t*> buildings;
+    buildings.reserve(_osmParserWorker->mapBuildings.size());
+    for (auto ii = _osmParserWorker->mapBuildings.cbegin(), end = _osmParserWorker->mapBuildings.cend(); ii != end; ++ii) {
+        buildings.append(&ii.value());
+    }
 
-        bld_points.clear();
-        for(unsigned int jj=0; jj<ii.value().points_local_inner.size(); jj++) {
-            bld_points.push_back({ii.value().points_local_inner[jj].x(), ii.value().points_local_inner[jj].y()});
-            all_bld_points.push_back({ii.value().points_local_inner[jj].x(), ii.value().points_local_inner[jj].y()});
-        }
-        if(bld_points.size() > 0){
-            polygon.push_back(bld_points);
-        }
+    // Buildings are independent of each other, the results come back in map order so the mesh is stable
+    const float levelHeight = _buildingLevelHeight;
+    const QList<QByteArray> buildingMeshes = QtConcurrent::blockingMapped(buildings, [levelHeight](const OsmParserThread::BuildingType_t* building) {
+        return _buildingToMesh(*building, levelHeight);
+    });
+
+    qsizetype totalSize = 0;
+    for (const QByteArray& buildingMesh : buildingMeshes) {
+        totalSize += buildingMesh.size();
+    }
+    QByteArray vertexData;
+    vertexData.reserve(totalSize);
+    for (const QByteArray& buildingMesh : buildingMeshes) {
+        vertexData.append(buildingMesh);
+    }
 
-        std::vector<uint32_t> indices = mapbox::earcut<uint32_t>(polygon);
-
-        for(uint i_i=0; i_i<indices.size(); i_i+=3) {
-            // mesh for roof
-            uint n_idx = indices[i_i];
-            triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], bld_height));
-            n_idx = indices[i_i+1];
-            triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], bld_height));
-            n_idx = indices[i_i+2];
-            triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], bld_height));
-
-            // mesh for floor
-            n_idx = indices[i_i+2];
-            triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], 0));
-            n_idx = indices[i_i+1];
-            triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], 0));
-            n_idx = indices[i_i];
-            triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], 0));
+    if(!cacheFile.isEmpty() && QDir().mkpath(OsmParserThread::cacheDirectory())) {
+        QSaveFile file(cacheFile);
+        if(!file.open(QIODevice::WriteOnly) || (file.write(vertexData) != vertexData.size()) || !file.commit()) {
+            qCWarning(OsmParserLog) << "Unable to write building mesh cache" << cacheFile << file.errorString();
         }
+        OsmParserThread::pruneCache(OsmParserThread::cacheDirectory(), OsmParserThread::maxCacheBytes);
+    }
 
-        if(bld_height > 0) {
-            trianglateWallsExtrudedPolygon(triangulated_mesh, ii.value().points_local, bld_height, 0, 0); // mesh for wall outside
-            trianglateWallsExtrudedPolygon(triangulated_mesh, ii.value().points_local, bld_height, 1, 0);// mesh for wall inside
+    return vertexData;
+}
 
-            trianglateWallsExtrudedPolygon(triangulated_mesh, ii.value().points_local_inner, bld_height, 0, 0); // mesh for wall outside
-            trianglateWallsExtrudedPolygon(triangulated_mesh, ii.value().points_local_inner, bld_height, 1, 0);// mesh for wall inside
-        }
+QByteArray OsmParser::_buildingToMesh(const OsmParserThread::BuildingType_t& building, float buildingLevelHeight)
+{
+    float bld_height = 0;
+
+    std::vector<std::array<float, 2> > all_bld_points;
+    std::vector<std::array<float, 2> > bld_points;
+    std::vector<std::vector<std::array<float, 2> > > polygon;
+    std::vector<QVector3D> triangulated_mesh;
+
+    if(building.height > 0){
+        bld_height = building.height;
+    }else if(building.levels > 0){
+        bld_height = (float)(building.levels) * buildingLevelHeight;
+    }else{
+        return QByteArray();
+    }
 
-        QByteArray vertexData_tmp(triangulated_mesh.size() * 3 * sizeof(float), Qt::Initialization::Uninitialized);
-        float *p = reinterpret_cast<float *>(vertexData_tmp.data());
+    for(unsigned int jj=0; jj<building.points_local.size(); jj++) {
+        bld_points.push_back({building.points_local[jj].x(), building.points_local[jj].y()});
+        all_bld_points.push_back({building.points_local[jj].x(), building.points_local[jj].y()});
+    }
+    polygon.push_back(bld_points);
 
-        for(uint i_m=0; i_m<triangulated_mesh.size(); i_m++) {
-            *p++ =  (float)triangulated_mesh[i_m].x(); *p++ =  (float)triangulated_mesh[i_m].y(); *p++ =  (float)triangulated_mesh[i_m].z();
-        }
+    bld_points.clear();
+    for(unsigned int jj=0; jj<building.points_local_inner.size(); jj++) {
+        bld_points.push_back({building.points_local_inner[jj].x(), building.points_local_inner[jj].y()});
+        all_bld_points.push_back({building.points_local_inner[jj].x(), building.points_local_inner[jj].y()});
+    }
+    if(bld_points.size() > 0){
+        polygon.push_back(bld_points);
+    }
 
-        ii.value().triangulated_mesh.insert(ii.value().triangulated_mesh.begin(), triangulated_mesh.begin(), triangulated_mesh.end());
-        vertexData.append(vertexData_tmp);
+    std::vector<uint32_t> indices = mapbox::earcut<uint32_t>(polygon);
+
+    for(uint i_i=0; i_i<indices.size(); i_i+=3) {
+        // mesh for roof
+        uint n_idx = indices[i_i];
+        triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], bld_height));
+        n_idx = indices[i_i+1];
+        triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], bld_height));
+        n_idx = indices[i_i+2];
+        triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], bld_height));
+
+        // mesh for floor
+        n_idx = indices[i_i+2];
+        triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], 0));
+        n_idx = indices[i_i+1];
+        triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], 0));
+        n_idx = indices[i_i];
+        triangulated_mesh.push_back(QVector3D(all_bld_points[n_idx][0], all_bld_points[n_idx][1], 0));
     }
+
+    if(bld_height > 0) {
+        trianglateWallsExtrudedPolygon(triangulated_mesh, building.points_local, bld_height, 0, 0); // mesh for wall outside
+        trianglateWallsExtrudedPolygon(triangulated_mesh, building.points_local, bld_height, 1, 0);// mesh for wall inside
+
+        trianglateWallsExtrudedPolygon(triangulated_mesh, building.points_local_inner, bld_height, 0, 0); // mesh for wall outside
+        trianglateWallsExtrudedPolygon(triangulated_mesh, building.points_local_inner, bld_height, 1, 0);// mesh for wall inside
+    }
+
+    QByteArray vertexData(triangulated_mesh.size() * 3 * sizeof(float), Qt::Initialization::Uninitialized);
+    float *p = reinterpret_cast<float *>(vertexData.data());
+
+    for(uint i_m=0; i_m<triangulated_mesh.size(); i_m++) {
+        *p++ =  (float)triangulated_mesh[i_m].x(); *p++ =  (float)triangulated_mesh[i_m].y(); *p++ =  (float)triangulated_mesh[i_m].z();
+    }
+
     return vertexData;
 }
 
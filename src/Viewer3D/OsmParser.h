@@ -14,11 +14,15 @@
 #include <QtGui/QVector2D>
 #include <QtPositioning/QGeoCoordinate>
 #include <QtCore/QVariant>
+#include <QtCore/QLoggingCategory>
+
+#include "OsmParserThread.h"
+
+Q_DECLARE_LOGGING_CATEGORY(OsmParserLog)
 
 ///     @author Omid Esrafilian <esrafilian.omid@gmail.com>
 
 class Viewer3DSettings;
-class OsmParserThread;
 
 class OsmParser : public QObject
 {
@@ -37,13 +41,16 @@ public:
     float buildingLevelHeight(void){return _buildingLevelHeight;}
     void parseOsmFile(QString filePath);
 
+    /// Triangulates all buildings in parallel, the result is cached per file and building level height
     QByteArray buildingToMesh();
 
-    void trianglateWallsExtrudedPolygon(std::vector<QVector3D>& triangulatedMesh, std::vector<QVector2D> verticesCcw, float h, bool inverseOrder=0, bool duplicateStartEndPoint=0);
-    void trianglateRectangle(std::vector<QVector3D>& triangulatedMesh, std::vector<QVector3D> verticesCcw, bool invertNormal);
+    static void trianglateWallsExtrudedPolygon(std::vector<QVector3D>& triangulatedMesh, std::vector<QVector2D> verticesCcw, float h, bool inverseOrder=0, bool duplicateStartEndPoint=0);
+    static void trianglateRectangle(std::vector<QVector3D>& triangulatedMesh, std::vector<QVector3D> verticesCcw, bool invertNormal);
     std::pair<QGeoCoordinate, QGeoCoordinate> getMapBoundingBoxCoordinate(){ return std::pair(_coordinateMin, _coordinateMax);}
 
 private:
+    static QByteArray _buildingToMesh(const OsmParserThread::BuildingType_t& building, float buildingLevelHeight);
+
     OsmParserThread* _osmParserWorker;
     QGeoCoordinate _gpsRefPoint;
     QGeoCoordinate _coordinateMin, _coordinateMax; //Osm map bounding boxes in global coordinate
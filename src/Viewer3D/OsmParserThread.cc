@@ -9,8 +9,120 @@
 
 #include "OsmParserThread.h"
 #include "Viewer3DUtils.h"
+#include "QGCLoggingCategory.h"
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QtEndian>
+#include <QtCore/QXmlStreamReader>
+
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(OsmParserThreadLog, "qgc.viewer3d.osmparserthread")
+
+namespace {
+    /// Minimal protocol buffers wire format reader, just enough for the OSM PBF format
+    class PbfReader
+    {
+    public:
+        explicit PbfReader(QByteArrayView data) : _p(data.data()), _end(data.data() + data.size()) {}
+
+        /// Advances to the next field
+        ///     @return false: no more fields or the data is malformed
+        bool next()
+        {
+            if (_p >= _end) {
+                return false;
+            }
+            const quint64 key = varint();
+            _field = static_cast<int>(key >> 3);
+            _wireType = static_cast<int>(key & 0x7);
+            return !_error;
+        }
+
+        int field() const { return _field; }
+        bool error() const { return _error; }
+        bool atEnd() const { return _error || (_p >= _end); }
+
+        quint64 varint()
+        {
+            quint64 value = 0;
+            for (int shift = 0; (_p < _end) && (shift < 64); shift += 7) {
+                const quint8 byte = static_cast<quint8>(*_p++);
+                value |= static_cast<quint64>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+            _error = true;
+            return 0;
+        }
+
+        int64_t svarint()
+        {
+            const quint64 value = varint();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        QByteArrayView bytes()
+        {
+            const quint64 length = varint();
+            if (_error || (length > static_cast<quint64>(_end - _p))) {
+                _error = true;
+                return QByteArrayView();
+            }
+            const QByteArrayView value(_p, static_cast<qsizetype>(length));
+            _p += length;
+            return value;
+        }
+
+        void skip()
+        {
+            switch (_wireType) {
+            case 0:
+                (void) varint();
+                break;
+            case 1:
+                _advance(8);
+                break;
+            case 2:
+                (void) bytes();
+                break;
+            case 5:
+                _advance(4);
+                break;
+            default:
+                _error = true;
+                break;
+            }
+        }
+
+    private:
+        void _advance(qsizetype count)
+        {
+            if (count > (_end - _p)) {
+                _error = true;
+            } else {
+                _p += count;
+            }
+        }
+
+        const char* _p;
+        const char* _end;
+        int _field = 0;
+        int _wireType = 0;
+        bool _error = false;
+    };
+
+    constexpr qint64 kPbfMaxBlobHeaderSize = 64 * 1024;
+    constexpr qint64 kPbfMaxBlobSize = 32 * 1024 * 1024;
+}
 
 OsmParserThread::OsmParserThread(QObject *parent)
     : QThread{parent}
@@ -31,15 +143,45 @@ OsmParserThread::OsmParserThread(QObject *parent)
     _mainThread->start();
 }
 
+OsmParserThread::~OsmParserThread()
+{
+    _mainThread->quit();
+    (void) _mainThread->wait();
+    delete _mainThread;
+}
+
 void OsmParserThread::start(QString filePath)
 {
     emit startThread(filePath);
 }
 
+QString OsmParserThread::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1String("/QGCOsmCache");
+}
+
+void OsmParserThread::pruneCache(const QString &directory, qint64 maxBytes)
+{
+    // Most recently used first
+    const QFileInfoList files = QDir(directory).entryInfoList(QDir::Files, QDir::Time);
+
+    qint64 totalBytes = 0;
+    for (const QFileInfo &file : files) {
+        totalBytes += file.size();
+        if (totalBytes > maxBytes) {
+            qCDebug(OsmParserThreadLog) << "Evicting from OSM cache" << file.fileName();
+            if (!QFile::remove(file.absoluteFilePath())) {
+                qCWarning(OsmParserThreadLog) << "Unable to remove OSM cache file" << file.absoluteFilePath();
+            }
+            totalBytes -= file.size();
+        }
+    }
+}
+
 void OsmParserThread::parseOsmFile(QString filePath)
 {
-    mapNodes.clear();
     mapBuildings.clear();
+    fileHash.clear();
     _mapLoadedFlag = false;
 
 
@@ -52,9 +194,6 @@ void OsmParserThread::parseOsmFile(QString filePath)
         return;
     }
 
-    //The QDomDocument class represents an XML document.
-    QDomDocument xml_content;
-// Load xml file as raw data
 #ifdef __unix__
     filePath = QString("/") + filePath;
 #endif
@@ -64,12 +203,29 @@ void OsmParserThread::parseOsmFile(QString filePath)
         qDebug() << "Error while loading OSM file" << filePath;
         return;
     }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    (void) hash.addData(&f);
+    const QString hexHash = QString::fromLatin1(hash.result().toHex());
+    (void) f.seek(0);
+
+    const QString cacheFile = QDir(cacheDirectory()).absoluteFilePath(hexHash + QStringLiteral(".osmcache"));
+    if (loadCache(cacheFile)) {
+        qCDebug(OsmParserThreadLog) << "Loaded OSM file from cache" << filePath;
+        fileHash = hexHash;
+        _mapLoadedFlag = true;
+        emit fileParsed(true);
+        return;
+    }
+
     qDebug("Loading the OSM file!!!");
-    // Set data into the QDomDocument before processing
-    xml_content.setContent(&f);
+    const bool isPbf = filePath.endsWith(QStringLiteral(".pbf"), Qt::CaseInsensitive);
+    const bool success = parseOsmDevice(f, isPbf);
     f.close();
 
-    if(decodeFile(xml_content, mapBuildings, mapNodes, coordinateMin, coordinateMax, gpsRefPoint)){
+    if(success){
+        fileHash = hexHash;
+        saveCache(cacheFile);
         _mapLoadedFlag = true;
         emit fileParsed(true);
         return;
@@ -78,79 +234,442 @@ void OsmParserThread::parseOsmFile(QString filePath)
     emit fileParsed(false);
 }
 
-bool OsmParserThread::decodeFile(QDomDocument &xml_content, QMap<uint64_t, OsmParserThread::BuildingType_t> &buildingMap, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate &coordinateMin, QGeoCoordinate &coordinateMax, QGeoCoordinate &gpsRef)
+/// Parses the buildings from device into mapBuildings, which is left empty on failure
+bool OsmParserThread::parseOsmDevice(QIODevice &device, bool isPbf)
 {
-    QDomElement root = xml_content.documentElement();
-    QDomElement xmlComponent = root.firstChild().toElement();
-    QGeoCoordinate tmpGpsRef;
-    bool gpsRefIsSet = false;
-    while(!xmlComponent.isNull()) {
-        if(decodeNodeTags(xmlComponent, nodeMap, coordinateMin, coordinateMax, tmpGpsRef)){
-            gpsRefIsSet = true;
-            gpsRef = tmpGpsRef;
-        }
-        decodeBuildings(xmlComponent, buildingMap, nodeMap, coordinateMin, coordinateMax, gpsRef);
-        decodeRelations(xmlComponent, buildingMap, nodeMap, gpsRef);
+    mapBuildings.clear();
+    _nodes.clear();
+    _nodesSorted = true;
+    _gpsRefIsSet = false;
+    _nodesMin = QGeoCoordinate(90, 180, 0);
+    _nodesMax = QGeoCoordinate(-90, -180, 0);
 
-        xmlComponent = xmlComponent.nextSibling().toElement();
+    bool success = isPbf ? parseOsmPbf(device) : parseOsmXml(device);
+
+    // Node positions are only needed while resolving ways
+    _nodes.clear();
+    _nodes.shrink_to_fit();
+
+    success = success && _gpsRefIsSet;
+    if (!success) {
+        mapBuildings.clear();
     }
-    return gpsRefIsSet;
+
+    return success;
 }
 
-bool OsmParserThread::decodeNodeTags(QDomElement &xmlComponent, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate &coordMin, QGeoCoordinate &coordMax, QGeoCoordinate &gpsRef)
+bool OsmParserThread::parseOsmXml(QIODevice &device)
 {
-    int64_t id_tmp=0;
-    QGeoCoordinate gps_tmp;
-    QString attribute;
-    bool gpsRefIsSet = false;
+    enum { ElementNone, ElementWay, ElementRelation } currentElement = ElementNone;
+    int64_t currentId = 0;
+    std::vector<int64_t> refs;
+    QList<OsmMember_t> members;
+    OsmTags_t tags;
+
+    QXmlStreamReader xml(&device);
+    while (!xml.atEnd()) {
+        const QXmlStreamReader::TokenType token = xml.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            const QStringView name = xml.name();
+            const QXmlStreamAttributes attributes = xml.attributes();
+
+            if (name == u"node") {
+                decodeNode(attributes.value(u"id").toLongLong(), attributes.value(u"lat").toDouble(), attributes.value(u"lon").toDouble());
+            } else if (name == u"nd") {
+                if (currentElement == ElementWay) {
+                    refs.push_back(attributes.value(u"ref").toLongLong());
+                }
+            } else if (name == u"tag") {
+                if (currentElement != ElementNone) {
+                    tags.append(qMakePair(attributes.value(u"k").toString(), attributes.value(u"v").toString()));
+                }
+            } else if (name == u"member") {
+                if (currentElement == ElementRelation) {
+                    members.append({ attributes.value(u"ref").toLongLong(), attributes.value(u"role").toString(), attributes.value(u"type") == u"way" });
+                }
+            } else if (name == u"way") {
+                currentElement = ElementWay;
+                currentId = attributes.value(u"id").toLongLong();
+                refs.clear();
+                tags.clear();
+            } else if (name == u"relation") {
+                currentElement = ElementRelation;
+                currentId = attributes.value(u"id").toLongLong();
+                members.clear();
+                tags.clear();
+            } else if (name == u"bounds") {
+                decodeBounds(QGeoCoordinate(attributes.value(u"minlat").toDouble(), attributes.value(u"minlon").toDouble(), 0),
+                             QGeoCoordinate(attributes.value(u"maxlat").toDouble(), attributes.value(u"maxlon").toDouble(), 0));
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if ((currentElement == ElementWay) && (xml.name() == u"way")) {
+                decodeBuildings(currentId, refs, tags);
+                currentElement = ElementNone;
+            } else if ((currentElement == ElementRelation) && (xml.name() == u"relation")) {
+                decodeRelations(currentId, members, tags);
+                currentElement = ElementNone;
+            }
+        }
+    }
 
-    if (xmlComponent.tagName()=="node") {
+    if (xml.hasError()) {
+        qWarning() << "Error parsing OSM file" << xml.errorString() << "line" << xml.lineNumber();
+        return false;
+    }
 
-        attribute = xmlComponent.attribute("id","-1");
-        id_tmp = attribute.toLongLong();
+    return true;
+}
 
-        attribute = xmlComponent.attribute("lat","0");
-        gps_tmp.setLatitude(attribute.toDouble());
+bool OsmParserThread::parseOsmPbf(QIODevice &device)
+{
+    while (!device.atEnd()) {
+        const QByteArray headerSizeBytes = device.read(sizeof(quint32));
+        if (headerSizeBytes.size() != sizeof(quint32)) {
+            qWarning() << "OSM PBF file is truncated";
+            return false;
+        }
+        const qint64 headerSize = qFromBigEndian<quint32>(headerSizeBytes.constData());
+        if (headerSize > kPbfMaxBlobHeaderSize) {
+            qWarning() << "OSM PBF blob header too large" << headerSize;
+            return false;
+        }
 
-        attribute = xmlComponent.attribute("lon","0");
-        gps_tmp.setLongitude(attribute.toDouble());
+        // BlobHeader
+        const QByteArray header = device.read(headerSize);
+        QByteArrayView blobType;
+        qint64 blobSize = -1;
+        PbfReader headerReader(header);
+        while (headerReader.next()) {
+            switch (headerReader.field()) {
+            case 1:
+                blobType = headerReader.bytes();
+                break;
+            case 3:
+                blobSize = static_cast<qint64>(headerReader.varint());
+                break;
+            default:
+                headerReader.skip();
+                break;
+            }
+        }
+        if (headerReader.error() || (header.size() != headerSize) || (blobSize < 0) || (blobSize > kPbfMaxBlobSize)) {
+            qWarning() << "OSM PBF blob header is invalid";
+            return false;
+        }
 
-        gps_tmp.setAltitude(0);
+        // Blob
+        const QByteArray blob = device.read(blobSize);
+        if (blob.size() != blobSize) {
+            qWarning() << "OSM PBF file is truncated";
+            return false;
+        }
+        QByteArray data;
+        quint32 rawSize = 0;
+        bool compressed = false;
+        PbfReader blobReader(blob);
+        while (blobReader.next()) {
+            switch (blobReader.field()) {
+            case 1:
+                data = blobReader.bytes().toByteArray();
+                break;
+            case 2:
+                rawSize = static_cast<quint32>(blobReader.varint());
+                break;
+            case 3:
+                data = blobReader.bytes().toByteArray();
+                compressed = true;
+                break;
+            case 4:
+            case 5:
+            case 6:
+            case 7:
+                qWarning() << "OSM PBF compression type not supported, only zlib is";
+                return false;
+            default:
+                blobReader.skip();
+                break;
+            }
+        }
+        if (blobReader.error()) {
+            qWarning() << "OSM PBF blob is invalid";
+            return false;
+        }
+        if (compressed) {
+            // qUncompress wants the uncompressed size as a big endian prefix in front of the zlib stream
+            QByteArray sizePrefix(sizeof(quint32), Qt::Uninitialized);
+            qToBigEndian<quint32>(rawSize, sizePrefix.data());
+            data = qUncompress(sizePrefix + data);
+            if (data.size() != static_cast<qsizetype>(rawSize)) {
+                qWarning() << "OSM PBF blob decompression failed";
+                return false;
+            }
+        }
+
+        if (blobType == QByteArrayView("OSMHeader")) {
+            // HeaderBlock, only the bounding box is of interest
+            PbfReader blockReader(data);
+            while (blockReader.next()) {
+                if (blockReader.field() != 1) {
+                    blockReader.skip();
+                    continue;
+                }
+                int64_t left = 0, right = 0, top = 0, bottom = 0;
+                PbfReader bboxReader(blockReader.bytes());
+                while (bboxReader.next()) {
+                    switch (bboxReader.field()) {
+                    case 1: left = bboxReader.svarint(); break;
+                    case 2: right = bboxReader.svarint(); break;
+                    case 3: top = bboxReader.svarint(); break;
+                    case 4: bottom = bboxReader.svarint(); break;
+                    default: bboxReader.skip(); break;
+                    }
+                }
+                decodeBounds(QGeoCoordinate(bottom * 1e-9, left * 1e-9, 0), QGeoCoordinate(top * 1e-9, right * 1e-9, 0));
+            }
+        } else if (blobType == QByteArrayView("OSMData")) {
+            if (!parsePbfPrimitiveBlock(data)) {
+                qWarning() << "OSM PBF data block is invalid";
+                return false;
+            }
+        }
+    }
 
-        if(id_tmp > 0) {
-            nodeMap.insert((uint64_t)id_tmp, gps_tmp);
+    return true;
+}
+
+bool OsmParserThread::parsePbfPrimitiveBlock(const QByteArray &block)
+{
+    QList<QString> strings;
+    QList<QByteArrayView> groups;
+    int64_t granularity = 100;
+    int64_t latOffset = 0;
+    int64_t lonOffset = 0;
+
+    // Groups may come before the settings they depend on, so collect everything first
+    PbfReader blockReader(block);
+    while (blockReader.next()) {
+        switch (blockReader.field()) {
+        case 1: {
+            PbfReader stringTableReader(blockReader.bytes());
+            while (stringTableReader.next()) {
+                if (stringTableReader.field() == 1) {
+                    strings.append(QString::fromUtf8(stringTableReader.bytes()));
+                } else {
+                    stringTableReader.skip();
+                }
+            }
+            if (stringTableReader.error()) {
+                return false;
+            }
+            break;
+        }
+        case 2:
+            groups.append(blockReader.bytes());
+            break;
+        case 17:
+            granularity = static_cast<int64_t>(blockReader.varint());
+            break;
+        case 19:
+            latOffset = static_cast<int64_t>(blockReader.varint());
+            break;
+        case 20:
+            lonOffset = static_cast<int64_t>(blockReader.varint());
+            break;
+        default:
+            blockReader.skip();
+            break;
         }
-    }else if(xmlComponent.tagName() == "bounds") {
-        coordMin.setLatitude(xmlComponent.attribute("minlat","0").toFloat());
-        coordMin.setLongitude(xmlComponent.attribute("minlon","0").toFloat());
-        coordMin.setAltitude(0);
-        coordMax.setLatitude(xmlComponent.attribute("maxlat","0").toFloat());
-        coordMax.setLongitude(xmlComponent.attribute("maxlon","0").toFloat());
-        coordMax.setAltitude(0);
+    }
+    if (blockReader.error()) {
+        return false;
+    }
 
-        gpsRefIsSet = true;
-        gps_tmp.setLatitude(0.5 * (coordMin.latitude() + coordMax.latitude()));
-        gps_tmp.setLongitude(0.5 * (coordMin.longitude() + coordMax.longitude()));
-        gps_tmp.setAltitude(0);
-        gpsRef = gps_tmp;
+    auto string = [&strings](quint64 index) {
+        return (index < static_cast<quint64>(strings.count())) ? strings[index] : QString();
+    };
+    auto latitude = [granularity, latOffset](int64_t value) {
+        return 1e-9 * (latOffset + (granularity * value));
+    };
+    auto longitude = [granularity, lonOffset](int64_t value) {
+        return 1e-9 * (lonOffset + (granularity * value));
+    };
+    auto readTags = [&string](QByteArrayView keys, QByteArrayView values, OsmTags_t &tags) {
+        tags.clear();
+        PbfReader keyReader(keys);
+        PbfReader valueReader(values);
+        while (!keyReader.atEnd() && !valueReader.atEnd()) {
+            tags.append(qMakePair(string(keyReader.varint()), string(valueReader.varint())));
+        }
+    };
+
+    std::vector<int64_t> refs;
+    QList<OsmMember_t> members;
+    OsmTags_t tags;
+
+    for (const QByteArrayView group : groups) {
+        PbfReader groupReader(group);
+        while (groupReader.next()) {
+            switch (groupReader.field()) {
+            case 1: {
+                // Node
+                int64_t id = 0, lat = 0, lon = 0;
+                PbfReader nodeReader(groupReader.bytes());
+                while (nodeReader.next()) {
+                    switch (nodeReader.field()) {
+                    case 1: id = nodeReader.svarint(); break;
+                    case 8: lat = nodeReader.svarint(); break;
+                    case 9: lon = nodeReader.svarint(); break;
+                    default: nodeReader.skip(); break;
+                    }
+                }
+                decodeNode(id, latitude(lat), longitude(lon));
+                break;
+            }
+            case 2: {
+                // DenseNodes, all values are delta coded
+                QByteArrayView ids, lats, lons;
+                PbfReader denseReader(groupReader.bytes());
+                while (denseReader.next()) {
+                    switch (denseReader.field()) {
+                    case 1: ids = denseReader.bytes(); break;
+                    case 8: lats = denseReader.bytes(); break;
+                    case 9: lons = denseReader.bytes(); break;
+                    default: denseReader.skip(); break;
+                    }
+                }
+                PbfReader idReader(ids), latReader(lats), lonReader(lons);
+                int64_t id = 0, lat = 0, lon = 0;
+                while (!idReader.atEnd() && !latReader.atEnd() && !lonReader.atEnd()) {
+                    id += idReader.svarint();
+                    lat += latReader.svarint();
+                    lon += lonReader.svarint();
+                    decodeNode(id, latitude(lat), longitude(lon));
+                }
+                break;
+            }
+            case 3: {
+                // Way
+                int64_t id = 0;
+                QByteArrayView keys, values, packedRefs;
+                PbfReader wayReader(groupReader.bytes());
+                while (wayReader.next()) {
+                    switch (wayReader.field()) {
+                    case 1: id = static_cast<int64_t>(wayReader.varint()); break;
+                    case 2: keys = wayReader.bytes(); break;
+                    case 3: values = wayReader.bytes(); break;
+                    case 8: packedRefs = wayReader.bytes(); break;
+                    default: wayReader.skip(); break;
+                    }
+                }
+                readTags(keys, values, tags);
+                refs.clear();
+                PbfReader refReader(packedRefs);
+                int64_t ref = 0;
+                while (!refReader.atEnd()) {
+                    ref += refReader.svarint();
+                    refs.push_back(ref);
+                }
+                decodeBuildings(id, refs, tags);
+                break;
+            }
+            case 4: {
+                // Relation
+                int64_t id = 0;
+                QByteArrayView keys, values, roles, memberIds, memberTypes;
+                PbfReader relationReader(groupReader.bytes());
+                while (relationReader.next()) {
+                    switch (relationReader.field()) {
+                    case 1: id = static_cast<int64_t>(relationReader.varint()); break;
+                    case 2: keys = relationReader.bytes(); break;
+                    case 3: values = relationReader.bytes(); break;
+                    case 8: roles = relationReader.bytes(); break;
+                    case 9: memberIds = relationReader.bytes(); break;
+                    case 10: memberTypes = relationReader.bytes(); break;
+                    default: relationReader.skip(); break;
+                    }
+                }
+                readTags(keys, values, tags);
+                members.clear();
+                PbfReader roleReader(roles), memberIdReader(memberIds), memberTypeReader(memberTypes);
+                int64_t memberId = 0;
+                while (!roleReader.atEnd() && !memberIdReader.atEnd() && !memberTypeReader.atEnd()) {
+                    const QString role = string(roleReader.varint());
+                    memberId += memberIdReader.svarint();
+                    members.append({ memberId, role, memberTypeReader.varint() == 1 /* WAY */ });
+                }
+                decodeRelations(id, members, tags);
+                break;
+            }
+            default:
+                groupReader.skip();
+                break;
+            }
+        }
+        if (groupReader.error()) {
+            return false;
+        }
     }
-    return gpsRefIsSet;
+
+    return true;
+}
+
+void OsmParserThread::decodeBounds(const QGeoCoordinate &coordMin, const QGeoCoordinate &coordMax)
+{
+    coordinateMin = coordMin;
+    coordinateMax = coordMax;
+
+    gpsRefPoint = QGeoCoordinate(0.5 * (coordMin.latitude() + coordMax.latitude()), 0.5 * (coordMin.longitude() + coordMax.longitude()), 0);
+    _gpsRefIsSet = true;
 }
 
-void OsmParserThread::decodeBuildings(QDomElement &xmlComponent, QMap<uint64_t, OsmParserThread::BuildingType_t> &bldMap, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate &coordMin, QGeoCoordinate &coordMax, QGeoCoordinate gpsRef)
+void OsmParserThread::decodeNode(int64_t id, double latitude, double longitude)
 {
-    if (xmlComponent.tagName()!="way"){
+    if (id <= 0) {
         return;
     }
 
-    int64_t id_tmp = xmlComponent.attribute("id","0").toLongLong();
-    if(id_tmp == 0) {
+    if (!_nodes.empty() && (id < _nodes.back().id)) {
+        _nodesSorted = false;
+    }
+    _nodes.push_back({ id, static_cast<qint32>(qRound64(latitude * 1e7)), static_cast<qint32>(qRound64(longitude * 1e7)) });
+
+    _nodesMin.setLatitude(fmin(_nodesMin.latitude(), latitude));
+    _nodesMin.setLongitude(fmin(_nodesMin.longitude(), longitude));
+    _nodesMax.setLatitude(fmax(_nodesMax.latitude(), latitude));
+    _nodesMax.setLongitude(fmax(_nodesMax.longitude(), longitude));
+}
+
+bool OsmParserThread::findNode(int64_t id, QGeoCoordinate &coordinate)
+{
+    // Files are normally sorted by id already, so this only happens for hand edited files
+    if (!_nodesSorted) {
+        std::sort(_nodes.begin(), _nodes.end(), [](const OsmNode_t &a, const OsmNode_t &b) { return a.id < b.id; });
+        _nodesSorted = true;
+    }
+
+    const auto it = std::lower_bound(_nodes.cbegin(), _nodes.cend(), id, [](const OsmNode_t &node, int64_t nodeId) { return node.id < nodeId; });
+    if ((it == _nodes.cend()) || (it->id != id)) {
+        return false;
+    }
+
+    coordinate = QGeoCoordinate(it->lat / 1e7, it->lon / 1e7, 0);
+    return true;
+}
+
+void OsmParserThread::decodeBuildings(int64_t id, const std::vector<int64_t> &refs, const OsmTags_t &tags)
+{
+    if(id == 0) {
         return;
     }
+
+    // Files without bounds are centered on their nodes. Nodes always come before ways.
+    if (!_gpsRefIsSet && !_nodes.empty()) {
+        decodeBounds(_nodesMin, _nodesMax);
+    }
+
     OsmParserThread::BuildingType_t bld_tmp;
     QGeoCoordinate gps_pt_tmp;
     QVector3D local_pt_tmp;
-    std::vector<QGeoCoordinate> bld_points;
     std::vector<QVector2D> bld_points_local;
     double bld_lon_max, bld_lon_min, bld_lat_max, bld_lat_min;
     double bld_x_max, bld_x_min, bld_y_max, bld_y_min;
@@ -159,90 +678,67 @@ void OsmParserThread::decodeBuildings(QDomElement &xmlComponent, QMap<uint64_t,
     bld_lon_max = bld_lat_max = -1e10;
     bld_lon_min = bld_lat_min = 1e10;
 
-    int64_t ref_id;
-    QDomElement Child = xmlComponent.firstChild().toElement();
-    QString attribute;
-
     bld_tmp.height = 0;
     bld_tmp.levels = 0;
 
-    while (!Child.isNull()) {
-        if (Child.tagName()=="nd") {
-            ref_id = Child.attribute("ref","0").toLongLong();
-
-            if(ref_id > 0) {
-                gps_pt_tmp = nodeMap[ref_id];
-                bld_points.push_back(gps_pt_tmp);
-                local_pt_tmp = mapGpsToLocalPoint(gps_pt_tmp, gpsRef);
-                bld_points_local.push_back(QVector2D(local_pt_tmp.x(), local_pt_tmp.y()));
-
-                bld_x_max = (bld_x_max < local_pt_tmp.x())?(local_pt_tmp.x()):(bld_x_max);
-                bld_y_max = (bld_y_max < local_pt_tmp.y())?(local_pt_tmp.y()):(bld_y_max);
-                bld_x_min = (bld_x_min > local_pt_tmp.x())?(local_pt_tmp.x()):(bld_x_min);
-                bld_y_min = (bld_y_min > local_pt_tmp.y())?(local_pt_tmp.y()):(bld_y_min);
-
-                bld_lon_max = fmax(bld_lon_max, gps_pt_tmp.longitude());
-                bld_lat_max = fmax(bld_lat_max, gps_pt_tmp.latitude());
-                bld_lon_min = fmin(bld_lon_min, gps_pt_tmp.longitude());
-                bld_lat_min = fmin(bld_lat_min, gps_pt_tmp.latitude());
+    bld_points_local.reserve(refs.size());
+    for (const int64_t ref_id : refs) {
+        if(ref_id > 0 && findNode(ref_id, gps_pt_tmp)) {
+            local_pt_tmp = mapGpsToLocalPoint(gps_pt_tmp, gpsRefPoint);
+            bld_points_local.push_back(QVector2D(local_pt_tmp.x(), local_pt_tmp.y()));
+
+            bld_x_max = (bld_x_max < local_pt_tmp.x())?(local_pt_tmp.x()):(bld_x_max);
+            bld_y_max = (bld_y_max < local_pt_tmp.y())?(local_pt_tmp.y()):(bld_y_max);
+            bld_x_min = (bld_x_min > local_pt_tmp.x())?(local_pt_tmp.x()):(bld_x_min);
+            bld_y_min = (bld_y_min > local_pt_tmp.y())?(local_pt_tmp.y()):(bld_y_min);
+
+            bld_lon_max = fmax(bld_lon_max, gps_pt_tmp.longitude());
+            bld_lat_max = fmax(bld_lat_max, gps_pt_tmp.latitude());
+            bld_lon_min = fmin(bld_lon_min, gps_pt_tmp.longitude());
+            bld_lat_min = fmin(bld_lat_min, gps_pt_tmp.latitude());
+        }
+    }
+
+    for (const QPair<QString, QString> &tag : tags) {
+        const QString &attribute = tag.first;
+        if(attribute == "building:levels") {
+            bld_tmp.levels = tag.second.toFloat();
+        }else if(attribute == "height") {
+            bld_tmp.height = tag.second.toFloat();
+        }else if(attribute == "building" && bld_tmp.levels == 0 && bld_tmp.height == 0){
+            if(_singleStoreyBuildings.contains(tag.second)){
+                bld_tmp.levels = 1;
+            }else{
+                bld_tmp.levels = 2;
             }
-        }else if (Child.tagName()=="tag") {
-            attribute = Child.attribute("k","0");
-            if(attribute == "building:levels") {
-                bld_tmp.levels = Child.attribute("v","0").toFloat();
-            }else if(attribute == "height") {
-                bld_tmp.height = Child.attribute("v","0").toFloat();
-            }else if(attribute == "building" && bld_tmp.levels == 0 && bld_tmp.height == 0){
-                QString attribute_2 = Child.attribute("v","0");
-                if(_singleStoreyBuildings.contains(attribute_2)){
-                    bld_tmp.levels = 1;
-                }else{
-                    bld_tmp.levels = 2;
-                }
-            }else if(attribute == "leisure" && bld_tmp.levels == 0 && bld_tmp.height == 0){
-                QString attribute_2 = Child.attribute("v","0");
-                if(_doubleStoreyLeisure.contains(attribute_2)){
-                    bld_tmp.levels = 2;
-                }
+        }else if(attribute == "leisure" && bld_tmp.levels == 0 && bld_tmp.height == 0){
+            if(_doubleStoreyLeisure.contains(tag.second)){
+                bld_tmp.levels = 2;
             }
         }
-
-        Child = Child.nextSibling().toElement();
     }
 
-    if(bld_points.size() > 2) {
-        //        float bld_height = (bld_tmp.height >= bld_tmp.levels * _buildingLevelHeight)?(bld_tmp.height):(bld_tmp.levels * _buildingLevelHeight);
-        //        bld_tmp.height = bld_height;
+    if(bld_points_local.size() > 2) {
         if(bld_tmp.levels > 0 || bld_tmp.height > 0){
-            coordMin.setLatitude(fmin(coordMin.latitude(), bld_lat_min));
-            coordMin.setLongitude(fmin(coordMin.longitude(), bld_lon_min));
-            coordMax.setLatitude(fmax(coordMax.latitude(), bld_lat_max));
-            coordMax.setLongitude(fmax(coordMax.longitude(), bld_lon_max));
+            coordinateMin.setLatitude(fmin(coordinateMin.latitude(), bld_lat_min));
+            coordinateMin.setLongitude(fmin(coordinateMin.longitude(), bld_lon_min));
+            coordinateMax.setLatitude(fmax(coordinateMax.latitude(), bld_lat_max));
+            coordinateMax.setLongitude(fmax(coordinateMax.longitude(), bld_lon_max));
         }
-        bld_tmp.points_gps = bld_points;
-        bld_tmp.points_local = bld_points_local;
+        bld_tmp.points_local = std::move(bld_points_local);
         bld_tmp.bb_max = QVector2D(bld_x_max, bld_y_max);
         bld_tmp.bb_min = QVector2D(bld_x_min, bld_y_min);
-        bldMap.insert(id_tmp, bld_tmp);
+        mapBuildings.insert(id, bld_tmp);
     }
 }
 
-void OsmParserThread::decodeRelations(QDomElement &xmlComponent, QMap<uint64_t, OsmParserThread::BuildingType_t> &bldMap, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate gpsRef)
+void OsmParserThread::decodeRelations(int64_t id, const QList<OsmMember_t> &members, const OsmTags_t &tags)
 {
-    if (xmlComponent.tagName()!="relation"){
-        return;
-    }
-
-    int64_t id_tmp = xmlComponent.attribute("id","0").toLongLong();
-    if(id_tmp == 0) {
+    if(id == 0) {
         return;
     }
 
     OsmParserThread::BuildingType_t bld_tmp;
-    int64_t ref_id;
-    QDomElement Child = xmlComponent.firstChild().toElement();
-    QString attribute;
-    QString role;
 
     bld_tmp.height = 0;
     bld_tmp.levels = 0;
@@ -250,34 +746,32 @@ void OsmParserThread::decodeRelations(QDomElement &xmlComponent, QMap<uint64_t,
     bool isBuilding = false;
     bool isMultipolygon = false;
 
-    while (!Child.isNull()) {
-        if (Child.tagName()=="member") {
-            ref_id = Child.attribute("ref","0").toLongLong();
-            role = Child.attribute("role","0");
-            auto bldItem = bldMap.find(ref_id);
-            if(bldItem != bldMap.end()) {
-                bld_tmp.append(bldItem.value().points_local, role == "inner");
-                bld_tmp.append(bldItem.value().points_gps, role == "inner");
-                bld_tmp.levels = fmax(bld_tmp.levels, bldItem.value().levels);
-                bld_tmp.height = fmax(bld_tmp.height, bldItem.value().height);
-
-                bld_tmp.bb_max[0] = fmax(bld_tmp.bb_max[0], bldItem.value().bb_max[0]);
-                bld_tmp.bb_max[1] = fmax(bld_tmp.bb_max[1], bldItem.value().bb_max[1]);
-                bld_tmp.bb_min[0] = fmin(bld_tmp.bb_min[0], bldItem.value().bb_min[0]);
-                bld_tmp.bb_min[1] = fmin(bld_tmp.bb_min[1], bldItem.value().bb_min[1]);
-                bldToBeRemoved.push_back(ref_id);
-            }
-        }else if (Child.tagName()=="tag") {
-            attribute = Child.attribute("k","0");
-            if(attribute == "type") {
-                if(Child.attribute("v","0") == "multipolygon"){
-                    isMultipolygon = true;
-                }
-            }else if(attribute == "building"){
-                isBuilding = true;
+    for (const OsmMember_t &member : members) {
+        if (!member.isWay) {
+            continue;
+        }
+        auto bldItem = mapBuildings.find(member.ref);
+        if(bldItem != mapBuildings.end()) {
+            bld_tmp.append(bldItem.value().points_local, member.role == "inner");
+            bld_tmp.levels = fmax(bld_tmp.levels, bldItem.value().levels);
+            bld_tmp.height = fmax(bld_tmp.height, bldItem.value().height);
+
+            bld_tmp.bb_max[0] = fmax(bld_tmp.bb_max[0], bldItem.value().bb_max[0]);
+            bld_tmp.bb_max[1] = fmax(bld_tmp.bb_max[1], bldItem.value().bb_max[1]);
+            bld_tmp.bb_min[0] = fmin(bld_tmp.bb_min[0], bldItem.value().bb_min[0]);
+            bld_tmp.bb_min[1] = fmin(bld_tmp.bb_min[1], bldItem.value().bb_min[1]);
+            bldToBeRemoved.push_back(member.ref);
+        }
+    }
+
+    for (const QPair<QString, QString> &tag : tags) {
+        if(tag.first == "type") {
+            if(tag.second == "multipolygon"){
+                isMultipolygon = true;
             }
+        }else if(tag.first == "building"){
+            isBuilding = true;
         }
-        Child = Child.nextSibling().toElement();
     }
 
     if(isBuilding){
@@ -285,14 +779,121 @@ void OsmParserThread::decodeRelations(QDomElement &xmlComponent, QMap<uint64_t,
             bld_tmp.levels = (bld_tmp.levels == 0)?(2):(bld_tmp.levels);
         }
     }
-    if(isMultipolygon){
+    if(isMultipolygon && !bldToBeRemoved.empty()){
         for(uint i_id=0; i_id<bldToBeRemoved.size(); i_id++){
-            bldMap.remove(bldToBeRemoved[i_id]);
+            mapBuildings.remove(bldToBeRemoved[i_id]);
         }
-        bldMap.insert(bldToBeRemoved[0], bld_tmp);
+        mapBuildings.insert(bldToBeRemoved[0], bld_tmp);
     }
 }
 
+bool OsmParserThread::loadCache(const QString &cacheFile)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // Keep recently used files from being evicted
+    (void) file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+    if ((magic != _cacheMagic) || (version != _cacheVersion)) {
+        qCDebug(OsmParserThreadLog) << "Ignoring cache with unknown format" << cacheFile;
+        return false;
+    }
+
+    double refLat, refLon, minLat, minLon, maxLat, maxLon;
+    quint32 buildingCount;
+    stream >> refLat >> refLon >> minLat >> minLon >> maxLat >> maxLon >> buildingCount;
+
+    auto readPoints = [&stream](std::vector<QVector2D> &points) {
+        quint32 count;
+        stream >> count;
+        if ((stream.status() != QDataStream::Ok) || (count > (1u << 24))) {
+            return false;
+        }
+        points.resize(count);
+        for (QVector2D &point : points) {
+            float x, y;
+            stream >> x >> y;
+            point = QVector2D(x, y);
+        }
+        return true;
+    };
+
+    QMap<uint64_t, BuildingType_t> buildings;
+    for (quint32 i = 0; i < buildingCount; i++) {
+        quint64 id;
+        float bbMinX, bbMinY, bbMaxX, bbMaxY;
+        BuildingType_t building;
+        stream >> id >> building.height >> building.levels >> bbMinX >> bbMinY >> bbMaxX >> bbMaxY;
+        building.bb_min = QVector2D(bbMinX, bbMinY);
+        building.bb_max = QVector2D(bbMaxX, bbMaxY);
+        if (!readPoints(building.points_local) || !readPoints(building.points_local_inner)) {
+            qCWarning(OsmParserThreadLog) << "Corrupt OSM cache" << cacheFile;
+            return false;
+        }
+        buildings.insert(id, building);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(OsmParserThreadLog) << "Corrupt OSM cache" << cacheFile;
+        return false;
+    }
+
+    gpsRefPoint = QGeoCoordinate(refLat, refLon, 0);
+    coordinateMin = QGeoCoordinate(minLat, minLon, 0);
+    coordinateMax = QGeoCoordinate(maxLat, maxLon, 0);
+    mapBuildings = buildings;
+
+    return true;
+}
+
+void OsmParserThread::saveCache(const QString &cacheFile)
+{
+    if (!QDir().mkpath(QFileInfo(cacheFile).absolutePath())) {
+        return;
+    }
+
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(OsmParserThreadLog) << "Unable to write OSM cache" << cacheFile << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    auto writePoints = [&stream](const std::vector<QVector2D> &points) {
+        stream << static_cast<quint32>(points.size());
+        for (const QVector2D &point : points) {
+            stream << point.x() << point.y();
+        }
+    };
+
+    stream << _cacheMagic << _cacheVersion;
+    stream << gpsRefPoint.latitude() << gpsRefPoint.longitude();
+    stream << coordinateMin.latitude() << coordinateMin.longitude() << coordinateMax.latitude() << coordinateMax.longitude();
+    stream << static_cast<quint32>(mapBuildings.size());
+    for (auto it = mapBuildings.cbegin(); it != mapBuildings.cend(); ++it) {
+        const BuildingType_t &building = it.value();
+        stream << static_cast<quint64>(it.key()) << building.height << building.levels;
+        stream << building.bb_min.x() << building.bb_min.y() << building.bb_max.x() << building.bb_max.y();
+        writePoints(building.points_local);
+        writePoints(building.points_local_inner);
+    }
+
+    if (!file.commit()) {
+        qCWarning(OsmParserThreadLog) << "Unable to write OSM cache" << cacheFile << file.errorString();
+    }
+
+    pruneCache(cacheDirectory(), maxCacheBytes);
+}
+
 void OsmParserThread::startThreadEvent(QString filePath)
 {
     parseOsmFile(filePath);
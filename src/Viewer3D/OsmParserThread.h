@@ -11,41 +11,38 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QThread>
-#include <QtXml/QDomDocument>
 #include <QtCore/QMap>
+#include <QtCore/QLoggingCategory>
 #include <QtGui/QVector3D>
 #include <QtGui/QVector2D>
 #include <QtPositioning/QGeoCoordinate>
 
-///     @author Omid Esrafilian <esrafilian.omid@gmail.com>
+Q_DECLARE_LOGGING_CATEGORY(OsmParserThreadLog)
+
+class QIODevice;
 
+///     @author Omid Esrafilian <esrafilian.omid@gmail.com>
 
+/// Reads buildings from .osm (XML) and .osm.pbf files.
+///
+/// Both formats are read in a streaming fashion. Node positions are kept in a flat id sorted index which is dropped
+/// once the file is parsed. The resulting building footprints are cached on disk keyed by the file hash, so loading
+/// the same file again skips parsing completely. The cache directory is kept below maxCacheBytes by evicting the
+/// least recently used files.
 class OsmParserThread : public QThread
 {
+    friend class OsmParserThreadTest;
 
 public:
     typedef struct BuildingType_s
     {
-        std::vector<QGeoCoordinate> points_gps;
-        std::vector<QGeoCoordinate> points_gps_inner;
         std::vector<QVector2D> points_local;
         std::vector<QVector2D> points_local_inner;
-        std::vector<QVector3D> triangulated_mesh;
         QVector2D bb_max = QVector2D(-1e6, -1e6); //bounding boxes
         QVector2D bb_min = QVector2D(1e6, 1e6); //bounding boxes
         float height;
         float levels;
 
-        void append(std::vector<QGeoCoordinate> newPoints, bool isInner){
-            for(uint i=0; i<newPoints.size(); i++){
-                if(isInner){
-                    points_gps_inner.push_back(newPoints[i]);
-                }else{
-                    points_gps.push_back(newPoints[i]);
-                }
-            }
-        }
-
         void append(std::vector<QVector2D> newPoints, bool isInner){
             for(uint i=0; i<newPoints.size(); i++){
                 if(isInner){
@@ -60,26 +57,64 @@ public:
     Q_OBJECT
 public:
     explicit OsmParserThread(QObject *parent = nullptr);
+    ~OsmParserThread();
 
     QGeoCoordinate gpsRefPoint;
-    QMap<uint64_t, QGeoCoordinate> mapNodes;
     QMap<uint64_t, BuildingType_t> mapBuildings;
     QGeoCoordinate coordinateMin, coordinateMax;
+    QString fileHash;   ///< Hex SHA-1 of the loaded file, empty if nothing is loaded
 
     void start(QString filePath);
 
+    /// Directory for the parsed building and mesh caches
+    static QString cacheDirectory();
+
+    /// Removes the least recently used files from directory until the files in it take up at most maxBytes.
+    /// Cache hits refresh the modification time of a file, which is what recently used is based on.
+    static void pruneCache(const QString& directory, qint64 maxBytes);
+
+    static constexpr qint64 maxCacheBytes = 256 * 1024 * 1024;
+
 private:
+    typedef QList<QPair<QString, QString>> OsmTags_t;
+
+    struct OsmNode_t {
+        int64_t id;
+        qint32  lat;    ///< Latitude * 1e7
+        qint32  lon;    ///< Longitude * 1e7
+    };
+
+    struct OsmMember_t {
+        int64_t ref;
+        QString role;
+        bool    isWay;
+    };
+
     QThread* _mainThread;
     bool _mapLoadedFlag;
     QList<QString> _singleStoreyBuildings;
     QList<QString> _doubleStoreyLeisure;
 
-    void parseOsmFile(QString filePath);
-    bool decodeFile(QDomDocument& xml_content, QMap<uint64_t, BuildingType_t > &buildingMap, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate& coordinateMin, QGeoCoordinate& coordinateMax, QGeoCoordinate& gpsRef);
-    bool decodeNodeTags(QDomElement& xmlComponent, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate& coordMin, QGeoCoordinate& coordMax, QGeoCoordinate& gpsRef);
-    void decodeBuildings(QDomElement& xmlComponent, QMap<uint64_t, BuildingType_t > &bldMap, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate& coordMin, QGeoCoordinate& coordMax, QGeoCoordinate gpsRef);
-    void decodeRelations(QDomElement& xmlComponent, QMap<uint64_t, BuildingType_t > &bldMap, QMap<uint64_t, QGeoCoordinate> &nodeMap, QGeoCoordinate gpsRef);
+    std::vector<OsmNode_t> _nodes;
+    bool _nodesSorted;
+    bool _gpsRefIsSet;
+    QGeoCoordinate _nodesMin, _nodesMax;    ///< Extent of all nodes, used as bounds if the file has none
 
+    void parseOsmFile(QString filePath);
+    bool parseOsmDevice(QIODevice& device, bool isPbf);
+    bool parseOsmXml(QIODevice& device);
+    bool parseOsmPbf(QIODevice& device);
+    bool parsePbfPrimitiveBlock(const QByteArray& block);
+    void decodeBounds(const QGeoCoordinate& coordMin, const QGeoCoordinate& coordMax);
+    void decodeNode(int64_t id, double latitude, double longitude);
+    bool findNode(int64_t id, QGeoCoordinate& coordinate);
+    void decodeBuildings(int64_t id, const std::vector<int64_t>& refs, const OsmTags_t& tags);
+    void decodeRelations(int64_t id, const QList<OsmMember_t>& members, const OsmTags_t& tags);
+    bool loadCache(const QString& cacheFile);
+    void saveCache(const QString& cacheFile);
+
+    static constexpr quint32 _cacheMagic = 0x51474F53;     ///< "QGOS"
+    static constexpr quint32 _cacheVersion = 1;
 
 signals:
     void fileParsed(bool isValid);
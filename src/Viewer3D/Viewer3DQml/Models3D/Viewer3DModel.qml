@@ -160,6 +160,7 @@ View3D {
                 geometry: Viewer3DTerrainGeometry {
                     id: terrainGeometryManager
                     refCoordinate: _gpsRef
+                    lodCenter: QGroundControl.multiVehicleManager.activeVehicle ? QGroundControl.multiVehicleManager.activeVehicle.coordinate : _gpsRef
                 }
 
                 materials: CustomMaterial {
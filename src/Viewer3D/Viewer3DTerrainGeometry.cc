@@ -12,6 +12,10 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "Viewer3DSettings.h"
+#include "TerrainQuery.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtConcurrent/QtConcurrentRun>
 
 #include "math.h"
 
@@ -19,6 +23,8 @@
 #define MaxLatitude         85.05112878
 #define EarthRadius         6378137
 
+QGC_LOGGING_CATEGORY(Viewer3DTerrainGeometryLog, "qgc.viewer3d.viewer3dterraingeometry")
+
 Viewer3DTerrainGeometry::Viewer3DTerrainGeometry()
 {
     _viewer3DSettings = qgcApp()->toolbox()->settingsManager()->viewer3DSettings();
@@ -27,38 +33,49 @@ Viewer3DTerrainGeometry::Viewer3DTerrainGeometry()
     setRadius(EarthRadius);
     connect(_viewer3DSettings->osmFilePath(), &Fact::rawValueChanged, this, &Viewer3DTerrainGeometry::clearScene);
     connect(this, &Viewer3DTerrainGeometry::refCoordinateChanged, this, &Viewer3DTerrainGeometry::updateEarthData);
+    connect(&_buildWatcher, &QFutureWatcher<BuildResult_t>::finished, this, &Viewer3DTerrainGeometry::_buildFinished);
 }
 
 void Viewer3DTerrainGeometry::updateEarthData()
 {
-    clear();
-    int stride = 3 * sizeof(float);
-    stride += 3 * sizeof(float); // for normals
-    stride += 2 * sizeof(float); // for UV
+    _setupChunks();
+}
+
+/// Lays out one chunk per texture tile and reserves a fixed size slot for each of them in the vertex buffer
+void Viewer3DTerrainGeometry::_setupChunks()
+{
+    _generation++;
+    _chunks.clear();
 
-    if(buildTerrain_2(roiMin(), roiMax(), refCoordinate(), 1) == 0){
+    clear();
+    if (_sectorCount <= 0 || _stackCount <= 0 || !_roiMin.isValid() || !_roiMax.isValid() || !_refCoordinate.isValid()) {
+        update();
         return;
     }
 
-    QByteArray vertexData;
-    vertexData.resize(_vertices.size() * stride);
-    float *p = reinterpret_cast<float *>(vertexData.data());
-
-    for (uint i = 0; i < _vertices.size(); ++i) {
-        *p++ = _vertices[i].x();
-        *p++ = _vertices[i].y();
-        *p++ = _vertices[i].z();
-
-        *p++ = _normals[i].x();
-        *p++ = _normals[i].y();
-        *p++ = _normals[i].z();
-
-        *p++ = _texCoords[i].x();
-        *p++ = _texCoords[i].y();
+    const double sectorStep = (_roiMax.longitude() - _roiMin.longitude()) / _sectorCount;
+    const double stackStep = (_roiMax.latitude() - _roiMin.latitude()) / _stackCount;
+    for (int i = 0; i < _stackCount; i++) {
+        for (int j = 0; j < _sectorCount; j++) {
+            Chunk_t chunk;
+            chunk.topLeft = QGeoCoordinate(_roiMax.latitude() - (i * stackStep), _roiMin.longitude() + (j * sectorStep));
+            chunk.bottomRight = QGeoCoordinate(_roiMax.latitude() - ((i + 1) * stackStep), _roiMin.longitude() + ((j + 1) * sectorStep));
+            _chunks.append(chunk);
+        }
+    }
+    _chunkSizeMeters = qMax(1.0, _chunks[0].topLeft.distanceTo(_chunks[0].bottomRight));
+
+    // Texture covers the whole ROI
+    _minS = (_roiMin.longitude() + 180.0) / 360.0;
+    _scaleS = (_roiMax.longitude() - _roiMin.longitude()) / 360.0;
+    _minT = _mercatorT(_roiMax.latitude());
+    _scaleT = _mercatorT(_roiMin.latitude()) - _minT;
+    if (qFuzzyIsNull(_scaleS) || qFuzzyIsNull(_scaleT)) {
+        _scaleS = _scaleT = 1;
     }
 
-    setVertexData(vertexData);
-    setStride(stride);
+    setVertexData(QByteArray(_chunks.count() * _chunkVertexCapacity * _stride, 0));
+    setStride(_stride);
 
     setPrimitiveType(QQuick3DGeometry::PrimitiveType::Triangles);
     addAttribute(QQuick3DGeometry::Attribute::PositionSemantic,
@@ -72,6 +89,277 @@ void Viewer3DTerrainGeometry::updateEarthData()
                  QQuick3DGeometry::Attribute::F32Type);
 
     update();
+
+    qCDebug(Viewer3DTerrainGeometryLog) << "chunks" << _sectorCount << "x" << _stackCount << "chunk size" << _chunkSizeMeters;
+
+    _refHeight = qQNaN();
+    _requestRefHeight();
+    _updateLod();
+}
+
+/// Picks the level of detail for each chunk and requests elevations for chunks which need finer data than they have
+void Viewer3DTerrainGeometry::_updateLod()
+{
+    const QGeoCoordinate center = _lodCenter.isValid() ? _lodCenter : _refCoordinate;
+
+    for (int i = 0; i < _chunks.count(); i++) {
+        Chunk_t &chunk = _chunks[i];
+
+        const QGeoCoordinate chunkCenter((chunk.topLeft.latitude() + chunk.bottomRight.latitude()) / 2.0, (chunk.topLeft.longitude() + chunk.bottomRight.longitude()) / 2.0);
+        const double distance = center.distanceTo(chunkCenter) / _chunkSizeMeters;
+
+        int lod = 0;
+        double lodLimit = _lodDistanceFactor;
+        while ((lod < _lodCount - 1) && (distance > lodLimit)) {
+            lod++;
+            lodLimit *= 2;
+        }
+
+        chunk.wantedLod = lod;
+        if (chunk.lod != chunk.wantedLod) {
+            chunk.dirty = true;
+        }
+
+        const bool haveHeights = (chunk.heightsLod >= 0) && (chunk.heightsLod <= lod);
+        const bool heightsRequested = (chunk.requestedHeightsLod >= 0) && (chunk.requestedHeightsLod <= lod);
+        if (!haveHeights && !heightsRequested) {
+            _requestHeights(i, lod);
+        }
+    }
+
+    _scheduleBuild();
+}
+
+void Viewer3DTerrainGeometry::_requestHeights(int chunkIndex, int lod)
+{
+    Chunk_t &chunk = _chunks[chunkIndex];
+    chunk.requestedHeightsLod = lod;
+
+    const int quads = _quadsForLod(lod);
+    const double latStep = (chunk.topLeft.latitude() - chunk.bottomRight.latitude()) / quads;
+    const double lonStep = (chunk.bottomRight.longitude() - chunk.topLeft.longitude()) / quads;
+
+    QList<QGeoCoordinate> coordinates;
+    coordinates.reserve((quads + 1) * (quads + 1));
+    for (int i = 0; i <= quads; i++) {
+        for (int j = 0; j <= quads; j++) {
+            coordinates.append(QGeoCoordinate(chunk.topLeft.latitude() - (i * latStep), chunk.topLeft.longitude() + (j * lonStep)));
+        }
+    }
+
+    const int generation = _generation;
+    TerrainAtCoordinateQuery *const query = new TerrainAtCoordinateQuery(true /* autoDelete */);
+    (void) connect(query, &TerrainAtCoordinateQuery::terrainDataReceived, this, [this, generation, chunkIndex, lod](bool success, const QList<double> &heights) {
+        if (generation != _generation) {
+            return;
+        }
+
+        Chunk_t &chunk = _chunks[chunkIndex];
+        if (chunk.requestedHeightsLod == lod) {
+            chunk.requestedHeightsLod = -1;
+        }
+        if (!success) {
+            qCDebug(Viewer3DTerrainGeometryLog) << "terrain query failed for chunk" << chunkIndex;
+            return;
+        }
+        if ((chunk.heightsLod < 0) || (lod < chunk.heightsLod)) {
+            chunk.heights = heights;
+            chunk.heightsLod = lod;
+            chunk.dirty = true;
+            _scheduleBuild();
+        }
+    });
+    query->requestData(coordinates);
+}
+
+/// The mesh is built relative to the terrain height at the reference coordinate, which keeps it consistent with the
+/// home relative altitudes used for vehicles and mission items.
+void Viewer3DTerrainGeometry::_requestRefHeight()
+{
+    const int generation = _generation;
+    TerrainAtCoordinateQuery *const query = new TerrainAtCoordinateQuery(true /* autoDelete */);
+    (void) connect(query, &TerrainAtCoordinateQuery::terrainDataReceived, this, [this, generation](bool success, const QList<double> &heights) {
+        if ((generation != _generation) || !success || heights.isEmpty()) {
+            return;
+        }
+
+        _refHeight = heights[0];
+        for (Chunk_t &chunk : _chunks) {
+            if (chunk.heightsLod >= 0) {
+                chunk.dirty = true;
+            }
+        }
+        _scheduleBuild();
+    });
+    query->requestData(QList<QGeoCoordinate>({ _refCoordinate }));
+}
+
+void Viewer3DTerrainGeometry::_scheduleBuild()
+{
+    // Chunks dirtied while a build is running are picked up once it finishes
+    if (_buildInProgress) {
+        return;
+    }
+
+    QList<ChunkBuildInput_t> inputs;
+    for (int i = 0; i < _chunks.count(); i++) {
+        Chunk_t &chunk = _chunks[i];
+        if (!chunk.dirty) {
+            continue;
+        }
+        chunk.dirty = false;
+        chunk.lod = chunk.wantedLod;
+        inputs.append({ i, chunk.lod, chunk.topLeft, chunk.bottomRight, _refCoordinate, chunk.heights, chunk.heightsLod, _refHeight, _minS, _scaleS, _minT, _scaleT });
+    }
+
+    if (inputs.isEmpty()) {
+        return;
+    }
+
+    _buildInProgress = true;
+    const int generation = _generation;
+    _buildWatcher.setFuture(QtConcurrent::run([generation, inputs]() {
+        BuildResult_t result;
+        result.generation = generation;
+        result.chunks.reserve(inputs.count());
+        for (const ChunkBuildInput_t &input : inputs) {
+            result.chunks.append({ input.index, _buildChunk(input) });
+        }
+        return result;
+    }));
+}
+
+void Viewer3DTerrainGeometry::_buildFinished()
+{
+    _buildInProgress = false;
+
+    const BuildResult_t result = _buildWatcher.result();
+    if (result.generation == _generation) {
+        // Only the slots of the rebuilt chunks are uploaded
+        for (const ChunkBuildResult_t &chunkResult : result.chunks) {
+            setVertexData(chunkResult.index * _chunkVertexCapacity * _stride, chunkResult.vertexData);
+        }
+        update();
+        qCDebug(Viewer3DTerrainGeometryLog) << "uploaded chunks" << result.chunks.count();
+    }
+
+    _scheduleBuild();
+}
+
+float Viewer3DTerrainGeometry::_mercatorT(double latitude)
+{
+    const double sinLatitude = sin(qBound(-MaxLatitude, latitude, MaxLatitude) * DEG_TO_RAD);
+    return 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * PI);
+}
+
+/// Meshes a single chunk. Runs on a worker thread. The result always fills the complete chunk slot, unused
+/// vertices are degenerate triangles.
+QByteArray Viewer3DTerrainGeometry::_buildChunk(const ChunkBuildInput_t &input)
+{
+    const int quads = _quadsForLod(input.lod);
+    const int samples = quads + 1;
+    const int heightsQuads = (input.heightsLod >= 0) ? _quadsForLod(input.heightsLod) : 0;
+    const bool haveHeights = (heightsQuads > 0) && !qIsNaN(input.refHeight);
+    const double latStep = (input.topLeft.latitude() - input.bottomRight.latitude()) / quads;
+    const double lonStep = (input.bottomRight.longitude() - input.topLeft.longitude()) / quads;
+
+    QList<QVector3D> positions(samples * samples);
+    QList<QVector2D> texCoords(samples * samples);
+    for (int i = 0; i < samples; i++) {
+        const double latitude = input.topLeft.latitude() - (i * latStep);
+        const float t = (_mercatorT(latitude) - input.minT) / input.scaleT;
+        for (int j = 0; j < samples; j++) {
+            const double longitude = input.topLeft.longitude() + (j * lonStep);
+            const QVector3D localPoint = mapGpsToLocalPoint(QGeoCoordinate(latitude, longitude, 0), input.refCoordinate);
+
+            float z = 0;
+            if (haveHeights) {
+                // Heights may come from a different level of detail than the mesh, use the closest sample
+                const int heightRow = (i * heightsQuads) / quads;
+                const int heightCol = (j * heightsQuads) / quads;
+                z = input.heights[(heightRow * (heightsQuads + 1)) + heightCol] - input.refHeight;
+            }
+
+            positions[(i * samples) + j] = QVector3D(localPoint.x(), localPoint.y(), z);
+            texCoords[(i * samples) + j] = QVector2D((((longitude + 180.0) / 360.0) - input.minS) / input.scaleS, t);
+        }
+    }
+
+    QByteArray vertexData(_chunkVertexCapacity * _stride, 0);
+    float *p = reinterpret_cast<float *>(vertexData.data());
+    int vertexCount = 0;
+
+    auto addTriangle = [&p, &vertexCount](const QVector3D &v1, const QVector3D &v2, const QVector3D &v3, const QVector2D &t1, const QVector2D &t2, const QVector2D &t3) {
+        const QVector3D normal = computeFaceNormal(v1, v2, v3);
+        const QVector3D vertices[3] = { v1, v2, v3 };
+        const QVector2D uvs[3] = { t1, t2, t3 };
+        for (int k = 0; k < 3; ++k) {
+            *p++ = vertices[k].x();
+            *p++ = vertices[k].y();
+            *p++ = vertices[k].z();
+
+            *p++ = normal.x();
+            *p++ = normal.y();
+            *p++ = normal.z();
+
+            *p++ = uvs[k].x();
+            *p++ = uvs[k].y();
+        }
+        vertexCount += 3;
+    };
+
+    for (int i = 0; i < quads; i++) {
+        for (int j = 0; j < quads; j++) {
+            //  v1--v3
+            //  |    |
+            //  v2--v4
+            const int vi1 = (i * samples) + j;
+            const int vi2 = ((i + 1) * samples) + j;
+            const int vi3 = vi1 + 1;
+            const int vi4 = vi2 + 1;
+
+            addTriangle(positions[vi1], positions[vi2], positions[vi3], texCoords[vi1], texCoords[vi2], texCoords[vi3]);
+            addTriangle(positions[vi3], positions[vi2], positions[vi4], texCoords[vi3], texCoords[vi2], texCoords[vi4]);
+        }
+    }
+
+    // Skirts hang down from the chunk border to hide the cracks between neighbouring chunks at different levels of
+    // detail. They are double sided since which side faces the camera depends on the neighbour.
+    const float skirtDepth = qMax(20.0f, (positions[quads] - positions[0]).length() * 0.1f);
+    const QVector3D skirtOffset(0, 0, skirtDepth);
+    auto addSkirt = [&](int index1, int index2) {
+        const QVector3D top1 = positions[index1];
+        const QVector3D top2 = positions[index2];
+        const QVector3D bottom1 = top1 - skirtOffset;
+        const QVector3D bottom2 = top2 - skirtOffset;
+        const QVector2D &uv1 = texCoords[index1];
+        const QVector2D &uv2 = texCoords[index2];
+
+        addTriangle(top1, bottom1, top2, uv1, uv1, uv2);
+        addTriangle(top2, bottom1, bottom2, uv2, uv1, uv2);
+        addTriangle(top1, top2, bottom1, uv1, uv2, uv1);
+        addTriangle(top2, bottom2, bottom1, uv2, uv2, uv1);
+    };
+    for (int k = 0; k < quads; k++) {
+        addSkirt(k, k + 1);                                                 // North
+        addSkirt((quads * samples) + k, (quads * samples) + k + 1);         // South
+        addSkirt(k * samples, (k + 1) * samples);                           // West
+        addSkirt((k * samples) + quads, ((k + 1) * samples) + quads);       // East
+    }
+
+    // Collapse the remainder of the slot onto the last vertex so it renders nothing
+    if (vertexCount > 0) {
+        const float *lastVertex = p - 8;
+        while (vertexCount < _chunkVertexCapacity) {
+            *p++ = lastVertex[0];
+            *p++ = lastVertex[1];
+            *p++ = lastVertex[2];
+            p += 5;
+            vertexCount++;
+        }
+    }
+
+    return vertexData;
 }
 
 QVector3D Viewer3DTerrainGeometry::computeFaceNormal(QVector3D x1, QVector3D x2, QVector3D x3)
@@ -108,82 +396,13 @@ QVector3D Viewer3DTerrainGeometry::computeFaceNormal(QVector3D x1, QVector3D x2,
     return normal;
 }
 
-void Viewer3DTerrainGeometry::changeUpAxis(int from, int to)
-{
-    // initial transform matrix cols
-    float tx[] = {1.0f, 0.0f, 0.0f};    // x-axis (left)
-    float ty[] = {0.0f, 1.0f, 0.0f};    // y-axis (up)
-    float tz[] = {0.0f, 0.0f, 1.0f};    // z-axis (forward)
-
-    float sign_to = (to >= 0)?(1):(-1);
-
-    // X -> Y
-    if(from == 1 && to == 2)
-    {
-        tx[0] =  0.0f * sign_to; tx[1] =  1.0f * sign_to;
-        ty[0] = -1.0f * sign_to; ty[1] =  0.0f * sign_to;
-    }
-    // X -> Z
-    else if(from == 1 && to == 3)
-    {
-        tx[0] =  0.0f * sign_to; tx[2] =  1.0f * sign_to;
-        tz[0] = -1.0f * sign_to; tz[2] =  0.0f * sign_to;
-    }
-    // Y -> X
-    else if(from == 2 && to == 1)
-    {
-        tx[0] =  0.0f * sign_to; tx[1] = -1.0f * sign_to;
-        ty[0] =  1.0f * sign_to; ty[1] =  0.0f * sign_to;
-    }
-    // Y -> Z
-    else if(from == 2 && to == 3)
-    {
-        ty[1] =  0.0f * sign_to; ty[2] =  1.0f * sign_to;
-        tz[1] = -1.0f * sign_to; tz[2] =  0.0f * sign_to;
-    }
-    //  Z -> X
-    else if(from == 3 && to == 1)
-    {
-        tx[0] =  0.0f * sign_to; tx[2] = -1.0f * sign_to;
-        tz[0] =  1.0f * sign_to; tz[2] =  0.0f * sign_to;
-    }
-    // Z -> Y
-    else
-    {
-        ty[1] =  0.0f * sign_to; ty[2] = -1.0f * sign_to;
-        tz[1] =  1.0f * sign_to; tz[2] =  0.0f * sign_to;
-    }
-
-    float vx, vy, vz;
-    float nx, ny, nz;
-    for(std::size_t i = 0; i < _vertices.size(); i++)
-    {
-        // transform vertices
-        vx = _vertices[i].x();
-        vy = _vertices[i].y();
-        vz = _vertices[i].z();
-        _vertices[i] = QVector3D(tx[0] * vx + ty[0] * vy + tz[0] * vz,
-                                 tx[1] * vx + ty[1] * vy + tz[1] * vz,
-                                 tx[2] * vx + ty[2] * vy + tz[2] * vz);
-
-        // transform normals
-        nx = _normals[i].x();
-        ny = _normals[i].y();
-        nz = _normals[i].z();
-        _normals[i]   = QVector3D(tx[0] * nx + ty[0] * ny + tz[0] * nz,
-                                tx[1] * nx + ty[1] * ny + tz[1] * nz,
-                                tx[2] * nx + ty[2] * ny + tz[2] * nz);
-    }
-}
-
 void Viewer3DTerrainGeometry::clearScene()
 {
+    _generation++;
+    _chunks.clear();
     clear();
     setSectorCount(0);
     setStackCount(0);
-    _vertices.clear();
-    _normals.clear();
-    _texCoords.clear();
     update();
 }
 
@@ -213,292 +432,6 @@ void Viewer3DTerrainGeometry::setStackCount(int newStackCount)
     emit stackCountChanged();
 }
 
-void Viewer3DTerrainGeometry::buildTerrain(QGeoCoordinate roiMinCoordinate, QGeoCoordinate roiMaxCoordinate, QGeoCoordinate refCoordinate, bool scale)
-{
-    float sectorLength = abs(roiMaxCoordinate.longitude() - roiMinCoordinate.longitude());
-    float stackLength = abs(roiMaxCoordinate.latitude() - roiMinCoordinate.latitude());
-    float stackRef = roiMaxCoordinate.latitude();
-    float sectorRef = roiMinCoordinate.longitude();
-
-
-    // tmp vertex definition (x,y,z,s,t)
-    struct Vertex{
-        float x, y, z, s, t;
-    };
-    std::vector<Vertex> tmpVertices;
-
-    float minT = 10;
-    float maxT = -10;
-    float minS = 10;
-    float maxS = -10;
-
-    // There si a bug now that the resolution of each polygon changes
-    // by thge portion. It hsould be fixed I think
-    float sectorStep =   sectorLength / _sectorCount;
-    float stackStep = stackLength / _stackCount;
-    float sectorAngle, stackAngle;
-
-    QVector3D refLocalPosition;
-    float refXY = _radius * cosf(refCoordinate.latitude() * DEG_TO_RAD);
-    refLocalPosition.setX(refXY * cosf(refCoordinate.longitude() * DEG_TO_RAD));
-    refLocalPosition.setY(refXY * sinf(refCoordinate.longitude() * DEG_TO_RAD));
-    refLocalPosition.setZ(_radius * sinf(refCoordinate.latitude() * DEG_TO_RAD));
-
-    // compute all vertices first, each vertex contains (x,y,z,s,t) except normal
-    for(int i = 0; i <= _stackCount; ++i){
-        stackAngle = stackRef - i * stackStep;        // starting from 90 to -90
-        float xy = _radius * cosf(stackAngle * DEG_TO_RAD);       // r * cos(u)
-        // float z = _radius * sinf(stackAngle * DEG_TO_RAD);        // r * sin(u)
-
-        // add (sectorCount+1) vertices per stack
-        // the first and last vertices have same position and normal, but different tex coords
-        for(int j = 0; j <= _sectorCount; ++j){
-            sectorAngle = sectorRef + j * sectorStep;           // starting from -180 to 180
-
-            Vertex vertex;
-            vertex.x = xy * cosf(sectorAngle * DEG_TO_RAD) - refLocalPosition.x();      // x = r * cos(u) * cos(v)
-            vertex.y = xy * sinf(sectorAngle * DEG_TO_RAD) - refLocalPosition.y();      // y = r * cos(u) * sin(v)
-            // vertex.z = z - refLocalPosition.z();                           // z = r * sin(u)
-            vertex.z = 0;                           // z = r * sin(u)
-
-            qDebug() << vertex.x << vertex.y << vertex.z;
-            vertex.s = (sectorAngle + 180.0f) / 360.0f;
-            minS = fmin(minS, vertex.s);
-            maxS = fmax(maxS, vertex.s);
-            if(abs(stackAngle) < MaxLatitude){
-                double sinLatitude = sin(stackAngle * DEG_TO_RAD);
-                vertex.t = 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * PI);
-
-            }else{
-                vertex.t = (stackRef - stackAngle) / 180;
-            }
-            minT = fmin(minT, vertex.t);
-            maxT = fmax(maxT, vertex.t);
-
-            tmpVertices.push_back(vertex);
-        }
-    }
-
-    float scaleT = maxT - minT;
-    float scaleS = maxS - minS;
-    _vertices.clear();
-    _texCoords.clear();
-    _normals.clear();
-    Vertex v1, v2, v3, v4;                          // 4 vertex positions and tex coords
-    int i, j, vi1, vi2;
-    QVector3D _n;
-    for(i = 0; i < _stackCount; ++i){
-        vi1 = i * (_sectorCount + 1);                // index of tmpVertices
-        vi2 = (i + 1) * (_sectorCount + 1);
-        stackAngle = stackRef - i * stackStep;
-        for(j = 0; j < _sectorCount; ++j, ++vi1, ++vi2){
-            // get 4 vertices per sector
-            //  v1--v3
-            //  |    |
-            //  v2--v4
-
-            v1 = tmpVertices[vi1];
-            v2 = tmpVertices[vi2];
-            v3 = tmpVertices[vi1 + 1];
-            v4 = tmpVertices[vi2 + 1];
-
-            if(scale){
-                v1.s = (v1.s - minS) / scaleS;
-                v1.t = (v1.t - minT) / scaleT;
-                v2.s = (v2.s - minS) / scaleS;
-                v2.t = (v2.t - minT) / scaleT;
-                v3.s = (v3.s - minS) / scaleS;
-                v3.t = (v3.t - minT) / scaleT;
-                v4.s = (v4.s - minS) / scaleS;
-                v4.t = (v4.t - minT) / scaleT;
-            }
-
-            // 2 triangles per sector excluding 1st and last stacks
-            if(stackAngle < 90){
-                _vertices.push_back(QVector3D(v1.x, v1.y, v1.z));
-                _vertices.push_back(QVector3D(v2.x, v2.y, v2.z));
-                _vertices.push_back(QVector3D(v3.x, v3.y, v3.z));
-
-                _texCoords.push_back(QVector2D(v1.s, v1.t));
-                _texCoords.push_back(QVector2D(v2.s, v2.t));
-                _texCoords.push_back(QVector2D(v3.s, v3.t));
-
-                _n = computeFaceNormal(QVector3D(v1.x,v1.y,v1.z),
-                                       QVector3D(v2.x,v2.y,v2.z),
-                                       QVector3D(v3.x,v3.y,v3.z));
-
-                for(int k = 0; k < 3; ++k)  // same normals for 3 vertices
-                {
-                    _normals.push_back(_n);
-                }
-            }
-
-            if(stackAngle > -90){
-                _vertices.push_back(QVector3D(v3.x, v3.y, v3.z));
-                _vertices.push_back(QVector3D(v2.x, v2.y, v2.z));
-                _vertices.push_back(QVector3D(v4.x, v4.y, v4.z));
-
-                _texCoords.push_back(QVector2D(v3.s, v3.t));
-                _texCoords.push_back(QVector2D(v2.s, v2.t));
-                _texCoords.push_back(QVector2D(v4.s, v4.t));
-
-                _n = computeFaceNormal(QVector3D(v3.x,v3.y,v3.z),
-                                       QVector3D(v2.x,v2.y,v2.z),
-                                       QVector3D(v4.x,v4.y,v4.z));
-
-                for(int k = 0; k < 3; ++k)  // same normals for 3 vertices
-                {
-                    _normals.push_back(_n);
-                }
-            }
-        }
-    }
-
-    changeUpAxis(3, 2);
-}
-
-bool Viewer3DTerrainGeometry::buildTerrain_2(QGeoCoordinate roiMinCoordinate, QGeoCoordinate roiMaxCoordinate, QGeoCoordinate refCoordinate, bool scale)
-{
-    if(_sectorCount == 0 || _stackCount == 0){
-        return false;
-    }
-
-    float sectorLength = abs(roiMaxCoordinate.longitude() - roiMinCoordinate.longitude());
-    float stackLength = abs(roiMaxCoordinate.latitude() - roiMinCoordinate.latitude());
-    float stackRef = roiMaxCoordinate.latitude();
-    float sectorRef = roiMinCoordinate.longitude();
-
-
-    // tmp vertex definition (x,y,z,s,t)
-    struct Vertex{
-        float x, y, z, s, t;
-    };
-    std::vector<Vertex> tmpVertices;
-
-    float minT = 10;
-    float maxT = -10;
-    float minS = 10;
-    float maxS = -10;
-
-    // There si a bug now that the resolution of each polygon changes
-    // by thge portion. It hsould be fixed I think
-    float sectorStep =   sectorLength / _sectorCount;
-    float stackStep = stackLength / _stackCount;
-    float sectorAngle, stackAngle;
-
-    QVector3D refLocalPosition;
-    QVector3D localPoint;
-    float refXY = _radius * cosf(refCoordinate.latitude() * DEG_TO_RAD);
-    refLocalPosition.setX(refXY * cosf(refCoordinate.longitude() * DEG_TO_RAD));
-    refLocalPosition.setY(refXY * sinf(refCoordinate.longitude() * DEG_TO_RAD));
-    refLocalPosition.setZ(_radius * sinf(refCoordinate.latitude() * DEG_TO_RAD));
-
-    for(int i = 0; i <= _stackCount; ++i){
-        stackAngle = stackRef - i * stackStep;        // starting from 90 to -90
-
-        for(int j = 0; j <= _sectorCount; ++j){
-            sectorAngle = sectorRef + j * sectorStep;           // starting from -180 to 180
-
-            Vertex vertex;
-            localPoint = mapGpsToLocalPoint(QGeoCoordinate(stackAngle, sectorAngle, 0), refCoordinate);
-            vertex.x = localPoint.x();
-            vertex.y = localPoint.y();
-            vertex.z = 0;
-
-            vertex.s = (sectorAngle + 180.0f) / 360.0f;
-            minS = fmin(minS, vertex.s);
-            maxS = fmax(maxS, vertex.s);
-            if(abs(stackAngle) < MaxLatitude){
-                double sinLatitude = sin(stackAngle * DEG_TO_RAD);
-                vertex.t = 0.5 - log((1 + sinLatitude) / (1 - sinLatitude)) / (4 * PI);
-
-            }else{
-                vertex.t = (stackRef - stackAngle) / 180;
-            }
-            minT = fmin(minT, vertex.t);
-            maxT = fmax(maxT, vertex.t);
-
-            tmpVertices.push_back(vertex);
-        }
-    }
-
-    float scaleT = maxT - minT;
-    float scaleS = maxS - minS;
-    _vertices.clear();
-    _texCoords.clear();
-    _normals.clear();
-    Vertex v1, v2, v3, v4;                          // 4 vertex positions and texture coords
-    int i, j, vi1, vi2;
-    QVector3D _n;
-    for(i = 0; i < _stackCount; ++i){
-        vi1 = i * (_sectorCount + 1);                // index of tmpVertices
-        vi2 = (i + 1) * (_sectorCount + 1);
-        stackAngle = stackRef - i * stackStep;
-        for(j = 0; j < _sectorCount; ++j, ++vi1, ++vi2){
-            // get 4 vertices per sector
-            //  v1--v3
-            //  |    |
-            //  v2--v4
-
-            v1 = tmpVertices[vi1];
-            v2 = tmpVertices[vi2];
-            v3 = tmpVertices[vi1 + 1];
-            v4 = tmpVertices[vi2 + 1];
-
-            if(scale){
-                v1.s = (v1.s - minS) / scaleS;
-                v1.t = (v1.t - minT) / scaleT;
-                v2.s = (v2.s - minS) / scaleS;
-                v2.t = (v2.t - minT) / scaleT;
-                v3.s = (v3.s - minS) / scaleS;
-                v3.t = (v3.t - minT) / scaleT;
-                v4.s = (v4.s - minS) / scaleS;
-                v4.t = (v4.t - minT) / scaleT;
-            }
-
-            // 2 triangles per sector excluding 1st and last stacks
-            if(stackAngle < 90){
-                _vertices.push_back(QVector3D(v1.x, v1.y, v1.z));
-                _vertices.push_back(QVector3D(v2.x, v2.y, v2.z));
-                _vertices.push_back(QVector3D(v3.x, v3.y, v3.z));
-
-                _texCoords.push_back(QVector2D(v1.s, v1.t));
-                _texCoords.push_back(QVector2D(v2.s, v2.t));
-                _texCoords.push_back(QVector2D(v3.s, v3.t));
-
-                _n = computeFaceNormal(QVector3D(v1.x,v1.y,v1.z),
-                                       QVector3D(v2.x,v2.y,v2.z),
-                                       QVector3D(v3.x,v3.y,v3.z));
-
-                for(int k = 0; k < 3; ++k)  // same normals for 3 vertices
-                {
-                    _normals.push_back(_n);
-                }
-            }
-
-            if(stackAngle > -90){
-                _vertices.push_back(QVector3D(v3.x, v3.y, v3.z));
-                _vertices.push_back(QVector3D(v2.x, v2.y, v2.z));
-                _vertices.push_back(QVector3D(v4.x, v4.y, v4.z));
-
-                _texCoords.push_back(QVector2D(v3.s, v3.t));
-                _texCoords.push_back(QVector2D(v2.s, v2.t));
-                _texCoords.push_back(QVector2D(v4.s, v4.t));
-
-                _n = computeFaceNormal(QVector3D(v3.x,v3.y,v3.z),
-                                       QVector3D(v2.x,v2.y,v2.z),
-                                       QVector3D(v4.x,v4.y,v4.z));
-
-                for(int k = 0; k < 3; ++k)  // same normals for 3 vertices
-                {
-                    _normals.push_back(_n);
-                }
-            }
-        }
-    }
-    return true;
-}
-
 int Viewer3DTerrainGeometry::radius() const
 {
     return _radius;
@@ -554,3 +487,18 @@ void Viewer3DTerrainGeometry::setRefCoordinate(const QGeoCoordinate &newRefCoord
     _refCoordinate = newRefCoordinate;
     emit refCoordinateChanged();
 }
+
+QGeoCoordinate Viewer3DTerrainGeometry::lodCenter() const
+{
+    return _lodCenter;
+}
+
+void Viewer3DTerrainGeometry::setLodCenter(const QGeoCoordinate &newLodCenter)
+{
+    if (_lodCenter == newLodCenter){
+        return;
+    }
+    _lodCenter = newLodCenter;
+    emit lodCenterChanged();
+    _updateLod();
+}
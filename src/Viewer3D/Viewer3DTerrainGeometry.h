@@ -11,13 +11,23 @@
 
 #include <QtQuick3D/QQuick3DGeometry>
 #include <QtPositioning/QGeoCoordinate>
-#include <QtGui/QVector3D>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QtNumeric>
 #include <QtGui/QVector2D>
+#include <QtGui/QVector3D>
+
+Q_DECLARE_LOGGING_CATEGORY(Viewer3DTerrainGeometryLog)
 
 class Viewer3DSettings;
 
 ///     @author Omid Esrafilian <esrafilian.omid@gmail.com>
 
+/// Terrain heightfield for the 3D viewer.
+///
+/// The ROI is split into one chunk per map texture tile. Each chunk is meshed at a level of detail which depends
+/// on its distance from lodCenter, with elevations coming from the terrain tile system. Meshes are built on a worker
+/// thread and every chunk owns a fixed slot in the vertex buffer, so only chunks which changed are uploaded.
 class Viewer3DTerrainGeometry : public QQuick3DGeometry
 {
     Q_OBJECT
@@ -28,6 +38,7 @@ class Viewer3DTerrainGeometry : public QQuick3DGeometry
     Q_PROPERTY(QGeoCoordinate roiMin READ roiMin WRITE setRoiMin NOTIFY roiMinChanged)
     Q_PROPERTY(QGeoCoordinate roiMax READ roiMax WRITE setRoiMax NOTIFY roiMaxChanged)
     Q_PROPERTY(QGeoCoordinate refCoordinate READ refCoordinate WRITE setRefCoordinate NOTIFY refCoordinateChanged)
+    Q_PROPERTY(QGeoCoordinate lodCenter READ lodCenter WRITE setLodCenter NOTIFY lodCenterChanged)    ///< Chunks near this point get the most detail, refCoordinate if not set
 
 public:
     explicit Viewer3DTerrainGeometry();
@@ -53,27 +64,79 @@ public:
     QGeoCoordinate refCoordinate() const;
     void setRefCoordinate(const QGeoCoordinate &newRefCoordinate);
 
-private:
+    QGeoCoordinate lodCenter() const;
+    void setLodCenter(const QGeoCoordinate &newLodCenter);
 
-    int _sectorCount;
-    int _stackCount;
-    std::vector<QVector3D> _vertices;
-    std::vector<QVector2D> _texCoords;
-    std::vector<QVector3D> _normals;
-
-    void buildTerrain(QGeoCoordinate roiMinCoordinate, QGeoCoordinate roiMaxCoordinate, QGeoCoordinate refCoordinate, bool scale);
-    bool buildTerrain_2(QGeoCoordinate roiMinCoordinate, QGeoCoordinate roiMaxCoordinate, QGeoCoordinate refCoordinate, bool scale);
+private:
+    struct Chunk_t {
+        QGeoCoordinate  topLeft;
+        QGeoCoordinate  bottomRight;
+        int             lod = -1;               ///< Level of detail of the mesh built or being built, -1 for none
+        int             wantedLod = 0;
+        QList<double>   heights;                ///< Row major samples at heightsLod
+        int             heightsLod = -1;        ///< -1 for no elevation data yet
+        int             requestedHeightsLod = -1;
+        bool            dirty = true;
+    };
+
+    /// Everything the worker thread needs to mesh a chunk
+    struct ChunkBuildInput_t {
+        int             index;
+        int             lod;
+        QGeoCoordinate  topLeft;
+        QGeoCoordinate  bottomRight;
+        QGeoCoordinate  refCoordinate;
+        QList<double>   heights;
+        int             heightsLod;
+        double          refHeight;
+        float           minS, scaleS, minT, scaleT;
+    };
+
+    struct ChunkBuildResult_t {
+        int             index;
+        QByteArray      vertexData;
+    };
+
+    struct BuildResult_t {
+        int                         generation;
+        QList<ChunkBuildResult_t>   chunks;
+    };
 
-    QVector3D computeFaceNormal(QVector3D x1, QVector3D x2, QVector3D x3);
-    void changeUpAxis(int from, int to);
     void clearScene();
+    void _setupChunks();
+    void _updateLod();
+    void _requestHeights(int chunkIndex, int lod);
+    void _requestRefHeight();
+    void _scheduleBuild();
+    void _buildFinished();
+
+    static int          _quadsForLod        (int lod) { return _maxQuadsPerChunk >> lod; }
+    static float        _mercatorT          (double latitude);
+    static QByteArray   _buildChunk         (const ChunkBuildInput_t &input);
+    static QVector3D    computeFaceNormal   (QVector3D x1, QVector3D x2, QVector3D x3);
 
+    int _sectorCount;
+    int _stackCount;
     int _radius;
     QGeoCoordinate _roiMin;
     QGeoCoordinate _roiMax;
     QGeoCoordinate _refCoordinate;
+    QGeoCoordinate _lodCenter;
     Viewer3DSettings* _viewer3DSettings = nullptr;
 
+    QList<Chunk_t> _chunks;
+    double _chunkSizeMeters = 0;
+    double _refHeight = qQNaN();                ///< Terrain height at refCoordinate, the mesh is relative to it
+    float _minS = 0, _scaleS = 1, _minT = 0, _scaleT = 1;
+    int _generation = 0;                        ///< Bumped on every chunk layout change to drop stale results
+    bool _buildInProgress = false;
+    QFutureWatcher<BuildResult_t> _buildWatcher;
+
+    static constexpr int _maxQuadsPerChunk = 16;
+    static constexpr int _lodCount = 4;
+    static constexpr int _stride = 8 * sizeof(float);           ///< position, normal, uv
+    static constexpr int _chunkVertexCapacity = (_maxQuadsPerChunk * _maxQuadsPerChunk * 6) + (4 * _maxQuadsPerChunk * 12);   ///< surface plus double sided skirts
+    static constexpr double _lodDistanceFactor = 1.5;           ///< LOD drops one level each time the distance doubles past this many chunk sizes
 
 signals:
 
@@ -83,4 +146,5 @@ signals:
     void roiMinChanged();
     void roiMaxChanged();
     void refCoordinateChanged();
+    void lodCenterChanged();
 };
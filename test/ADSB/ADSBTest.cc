@@ -2,12 +2,15 @@
 #include "ADSBVehicleManager.h"
 #include "ADSBVehicle.h"
 #include "ADSBTCPLink.h"
+#include "ADSBSpatialIndex.h"
 #include "QmlObjectListModel.h"
 
 #include <QtNetwork/QTcpServer>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 
+#include <algorithm>
+
 void ADSBTest::_adsbVehicleTest()
 {
     ADSB::VehicleInfo_t vehicleInfo;
@@ -51,7 +54,7 @@ void ADSBTest::_adsbTcpLinkTest()
 
     ADSBTCPLink* const adsbLink = new ADSBTCPLink(QHostAddress::LocalHost, 30003, this);
     QVERIFY(adsbLink);
-    QSignalSpy spy(adsbLink, &ADSBTCPLink::adsbVehicleUpdate);
+    QSignalSpy spy(adsbLink, &ADSBTCPLink::adsbVehicleUpdates);
 
     bool timeout = false;
     QVERIFY(server->waitForNewConnection(1000, &timeout));
@@ -69,6 +72,45 @@ void ADSBTest::_adsbTcpLinkTest()
     server->close();
 }
 
+void ADSBTest::_adsbParseLineTest()
+{
+    ADSB::VehicleInfo_t vehicleInfo;
+
+    QVERIFY(!ADSBTCPLink::parseLine("", vehicleInfo));
+    QVERIFY(!ADSBTCPLink::parseLine("MSG,8D4840D6202CC371C32CE0576098", vehicleInfo));
+    QVERIFY(!ADSBTCPLink::parseLine("STA,,5,179,400AE7,10103,2008/11/28,14:58:51.153,2008/11/28,14:58:51.153,RM", vehicleInfo));
+
+    QVERIFY(ADSBTCPLink::parseLine("MSG,1,1,1,4CA2D6,1,2016/04/26,14:03:57.150,2016/04/26,14:03:57.150,RYR1234 ,,,,,,,,,,,\r\n", vehicleInfo));
+    QCOMPARE(vehicleInfo.icaoAddress, 0x4CA2D6u);
+    QCOMPARE(vehicleInfo.availableFlags, ADSB::AvailableInfoTypes(ADSB::CallsignAvailable));
+    QCOMPARE(vehicleInfo.callsign, QStringLiteral("RYR1234"));
+
+    ADSB::VehicleInfo_t merged = vehicleInfo;
+
+    QVERIFY(ADSBTCPLink::parseLine("MSG,3,1,1,4CA2D6,1,2016/04/26,14:03:57.150,2016/04/26,14:03:57.150,,11000,,,51.45735,-1.02826,,,0,0,0,0", vehicleInfo));
+    QCOMPARE(vehicleInfo.availableFlags, ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable);
+    QCOMPARE(vehicleInfo.location, QGeoCoordinate(51.45735, -1.02826));
+    QVERIFY(qFuzzyCompare(vehicleInfo.altitude, 11000 * 0.3048));
+    QVERIFY(!vehicleInfo.alert);
+    ADSB::mergeVehicleInfo(merged, vehicleInfo);
+
+    QVERIFY(ADSBTCPLink::parseLine("MSG,3,1,1,4CA2D6,1,2016/04/26,14:03:57.150,2016/04/26,14:03:57.150,,11000H,,,51.45735,-1.02826,,,0,0,0,0", vehicleInfo));
+    QVERIFY(qFuzzyCompare(vehicleInfo.altitude, 11000 * 0.3048));
+
+    QVERIFY(ADSBTCPLink::parseLine("MSG,4,1,1,4CA2D6,1,2016/04/26,14:03:57.150,2016/04/26,14:03:57.150,,,420,270,,,64,,,,,0", vehicleInfo));
+    QCOMPARE(vehicleInfo.availableFlags, ADSB::AvailableInfoTypes(ADSB::HeadingAvailable));
+    QVERIFY(qFuzzyCompare(vehicleInfo.heading, 270.));
+    ADSB::mergeVehicleInfo(merged, vehicleInfo);
+
+    QCOMPARE(merged.callsign, QStringLiteral("RYR1234"));
+    QCOMPARE(merged.location, QGeoCoordinate(51.45735, -1.02826));
+    QVERIFY(qFuzzyCompare(merged.heading, 270.));
+    QCOMPARE(merged.availableFlags, ADSB::CallsignAvailable | ADSB::LocationAvailable | ADSB::AltitudeAvailable | ADSB::AlertAvailable | ADSB::HeadingAvailable);
+
+    // Position message with zero lat/lon is not a valid fix
+    QVERIFY(!ADSBTCPLink::parseLine("MSG,3,1,1,4CA2D6,1,2016/04/26,14:03:57.150,2016/04/26,14:03:57.150,,11000,,,0,0,,,0,0,0,0", vehicleInfo));
+}
+
 void ADSBTest::_adsbVehicleManagerTest()
 {
     ADSBVehicleManager* const manager = ADSBVehicleManager::instance();
@@ -88,3 +130,68 @@ void ADSBTest::_adsbVehicleManagerTest()
     manager->adsbVehicleUpdate(vehicleInfo);
     QCOMPARE(manager->adsbVehicles()->count(), 1);
 }
+
+void ADSBTest::_adsbVehicleManagerBatchTest()
+{
+    ADSBVehicleManager* const manager = ADSBVehicleManager::instance();
+    QVERIFY(manager);
+    const qsizetype startCount = manager->adsbVehicles()->count();
+
+    QList<ADSB::VehicleInfo_t> vehicleInfos;
+    for (uint32_t i = 0; i < 10; i++) {
+        ADSB::VehicleInfo_t vehicleInfo;
+        vehicleInfo.icaoAddress = 0x1000 + i;
+        vehicleInfo.location = QGeoCoordinate(1., 1. + (i / 100.));
+        vehicleInfo.availableFlags = ADSB::LocationAvailable;
+        vehicleInfos.append(vehicleInfo);
+    }
+
+    // Callsign only updates for unknown aircraft do not create vehicles
+    ADSB::VehicleInfo_t callsignOnly;
+    callsignOnly.icaoAddress = 0x2000;
+    callsignOnly.callsign = QStringLiteral("2000");
+    callsignOnly.availableFlags = ADSB::CallsignAvailable;
+    vehicleInfos.append(callsignOnly);
+
+    QSignalSpy spy(manager->adsbVehicles(), &QmlObjectListModel::countChanged);
+    manager->adsbVehicleUpdates(vehicleInfos);
+    QCOMPARE(manager->adsbVehicles()->count(), startCount + 10);
+    QCOMPARE(spy.count(), 1);
+}
+
+void ADSBTest::_adsbSpatialIndexTest()
+{
+    ADSBSpatialIndex index;
+    const QGeoCoordinate center(47.3977, 8.5456);
+
+    index.update(1, center.atDistanceAndAzimuth(500, 0));
+    index.update(2, center.atDistanceAndAzimuth(5000, 90));
+    index.update(3, center.atDistanceAndAzimuth(50000, 180));
+    index.update(4, QGeoCoordinate());
+    QCOMPARE(index.count(), 3);
+
+    QList<uint32_t> result = index.query(center, 1000);
+    QCOMPARE(result, QList<uint32_t>({ 1 }));
+
+    result = index.query(center, 10000);
+    std::sort(result.begin(), result.end());
+    QCOMPARE(result, QList<uint32_t>({ 1, 2 }));
+
+    // Moving an entry across cells
+    index.update(3, center.atDistanceAndAzimuth(200, 270));
+    result = index.query(center, 1000);
+    std::sort(result.begin(), result.end());
+    QCOMPARE(result, QList<uint32_t>({ 1, 3 }));
+
+    index.remove(1);
+    QCOMPARE(index.query(center, 1000), QList<uint32_t>({ 3 }));
+    QCOMPARE(index.count(), 2);
+
+    // Queries across the anti-meridian
+    index.update(5, QGeoCoordinate(0., 179.999));
+    QCOMPARE(index.query(QGeoCoordinate(0., -179.999), 1000), QList<uint32_t>({ 5 }));
+
+    index.clear();
+    QCOMPARE(index.count(), 0);
+    QVERIFY(index.query(center, 100000).isEmpty());
+}
@@ -9,5 +9,8 @@ class ADSBTest : public UnitTest
 private slots:
     void _adsbVehicleTest();
     void _adsbTcpLinkTest();
+    void _adsbParseLineTest();
     void _adsbVehicleManagerTest();
+    void _adsbVehicleManagerBatchTest();
+    void _adsbSpatialIndexTest();
 };
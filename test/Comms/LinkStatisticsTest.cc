@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkStatisticsTest.h"
+#include "LinkStatistics.h"
+
+#include <QtCore/QJsonArray>
+#include <QtTest/QTest>
+
+namespace {
+    QByteArray packetForMessage(const mavlink_message_t &message)
+    {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const int length = mavlink_msg_to_send_buffer(buffer, &message);
+        return QByteArray(reinterpret_cast<const char*>(buffer), length);
+    }
+}
+
+void LinkStatisticsTest::_testMessageCounters()
+{
+    LinkStatistics statistics;
+    statistics.update();
+
+    mavlink_message_t heartbeat;
+    (void) mavlink_msg_heartbeat_pack(255, MAV_COMP_ID_MISSIONPLANNER, &heartbeat, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+    const QByteArray heartbeatPacket = packetForMessage(heartbeat);
+
+    for (int i = 0; i < 10; i++) {
+        statistics.countSentPacket(heartbeatPacket.constData(), heartbeatPacket.size());
+        statistics.countReceivedBytes(heartbeatPacket.size());
+        statistics.countReceivedMessage(heartbeat);
+    }
+    statistics.countParseError();
+
+    // Not a MAVLink packet, only counted as bytes
+    statistics.countSentPacket("garbage", 7);
+
+    QTest::qWait(20);
+    statistics.update();
+
+    QCOMPARE(statistics.bytesSent(), quint64((10 * heartbeatPacket.size()) + 7));
+    QCOMPARE(statistics.bytesReceived(), quint64(10 * heartbeatPacket.size()));
+    QCOMPARE(statistics.parseErrors(), quint64(1));
+    QVERIFY(statistics.bytesSentRate() > 0);
+    QVERIFY(statistics.messagesReceivedRate() > 0);
+
+    const QVariantList messageStats = statistics.messageStats();
+    QCOMPARE(messageStats.count(), 1);
+    const QVariantMap heartbeatStats = messageStats[0].toMap();
+    QCOMPARE(heartbeatStats[QStringLiteral("msgid")].toUInt(), uint(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(heartbeatStats[QStringLiteral("name")].toString(), QStringLiteral("HEARTBEAT"));
+    QCOMPARE(heartbeatStats[QStringLiteral("received")].toULongLong(), quint64(10));
+    QCOMPARE(heartbeatStats[QStringLiteral("sent")].toULongLong(), quint64(10));
+    QVERIFY(heartbeatStats[QStringLiteral("bytesReceivedRate")].toDouble() > 0);
+
+    const QJsonObject json = statistics.toJson();
+    QCOMPARE(json[QStringLiteral("parseErrors")].toInteger(), 1);
+    QCOMPARE(json[QStringLiteral("messages")].toArray().count(), 1);
+}
+
+void LinkStatisticsTest::_testRoundTrip()
+{
+    LinkStatistics statistics;
+    QVERIFY(qIsNaN(statistics.timesyncRttMSecs()));
+
+    mavlink_timesync_t timesync = {};
+    timesync.tc1 = 0;
+    timesync.ts1 = 123456789;
+    mavlink_message_t request;
+    (void) mavlink_msg_timesync_encode(255, MAV_COMP_ID_MISSIONPLANNER, &request, &timesync);
+    const QByteArray requestPacket = packetForMessage(request);
+    statistics.countSentPacket(requestPacket.constData(), requestPacket.size());
+
+    QTest::qWait(10);
+
+    timesync.tc1 = 987654321;
+    mavlink_message_t reply;
+    (void) mavlink_msg_timesync_encode(1, MAV_COMP_ID_AUTOPILOT1, &reply, &timesync);
+    statistics.countReceivedMessage(reply);
+    // Duplicated replies only count once
+    statistics.countReceivedMessage(reply);
+
+    QVERIFY(statistics.timesyncRttMSecs() >= 10);
+    QCOMPARE(statistics.toJson()[QStringLiteral("roundTrips")].toObject()[QStringLiteral("timesync")].toObject()[QStringLiteral("count")].toInteger(), 1);
+
+    // A reply to a request which was never sent is ignored
+    timesync.ts1 = 42;
+    (void) mavlink_msg_timesync_encode(1, MAV_COMP_ID_AUTOPILOT1, &reply, &timesync);
+    statistics.countReceivedMessage(reply);
+    QCOMPARE(statistics.toJson()[QStringLiteral("roundTrips")].toObject()[QStringLiteral("timesync")].toObject()[QStringLiteral("count")].toInteger(), 1);
+
+    statistics.countRoundTrip(LinkStatistics::RoundTripCommandAck, 2000);
+    statistics.countRoundTrip(LinkStatistics::RoundTripCommandAck, 4000);
+    QVERIFY(qAbs(statistics.commandAckRttMSecs() - 3.) < 1e-9);
+    QVERIFY(qIsNaN(statistics.pingRttMSecs()));
+}
@@ -0,0 +1,255 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkTransmitQueueTest.h"
+#include "LinkTransmitQueue.h"
+#include "MAVLinkLib.h"
+#include "MAVLinkSigning.h"
+
+#include <QtCore/QThread>
+#include <QtCore/QtEndian>
+#include <QtTest/QTest>
+
+#include <memory>
+
+void LinkTransmitQueueTest::_testPriorityOrder()
+{
+    LinkTransmitQueue queue;
+
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, "b1", 2));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityCommand, "c1", 2));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, "b2", 2));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityControl, "m1", 2));
+    QCOMPARE(queue.stats(LinkTransmitQueue::PriorityBulk).depth, 2);
+
+    QByteArray buffer;
+    QStringList packets;
+    QCOMPARE(queue.dequeue(buffer, 1000, [&packets](const char *bytes, int length, bool) {
+        packets.append(QString::fromLatin1(bytes, length));
+    }), 4);
+    QCOMPARE(buffer, QByteArray("m1c1b1b2"));
+    QCOMPARE(packets, QStringList({ "m1", "c1", "b1", "b2" }));
+
+    QCOMPARE(queue.stats(LinkTransmitQueue::PriorityBulk).depth, 0);
+    QCOMPARE(queue.stats(LinkTransmitQueue::PriorityBulk).sent, quint64(2));
+    QCOMPARE(queue.stats(LinkTransmitQueue::PriorityBulk).maxDepth, 2);
+
+    QCOMPARE(LinkTransmitQueue::priorityForMessage(MAVLINK_MSG_ID_MANUAL_CONTROL), LinkTransmitQueue::PriorityControl);
+    QCOMPARE(LinkTransmitQueue::priorityForMessage(MAVLINK_MSG_ID_COMMAND_LONG), LinkTransmitQueue::PriorityCommand);
+    QCOMPARE(LinkTransmitQueue::priorityForMessage(MAVLINK_MSG_ID_PARAM_SET), LinkTransmitQueue::PriorityBulk);
+}
+
+void LinkTransmitQueueTest::_testCoalescing()
+{
+    LinkTransmitQueue queue;
+
+    const QByteArray packet(100, 'x');
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, packet.constData(), packet.size()));
+    }
+
+    QByteArray buffer;
+    QCOMPARE(queue.dequeue(buffer, 450, nullptr), 4);
+    QCOMPARE(buffer.size(), 400);
+
+    buffer.clear();
+    QCOMPARE(queue.dequeue(buffer, 10000, nullptr), 6);
+    QCOMPARE(buffer.size(), 600);
+
+    buffer.clear();
+    QCOMPARE(queue.dequeue(buffer, 10000, nullptr), 0);
+
+    QVERIFY(!queue.enqueue(LinkTransmitQueue::PriorityBulk, "", 0));
+}
+
+void LinkTransmitQueueTest::_testOversize()
+{
+    LinkTransmitQueue queue;
+
+    // Too large for a slot, still has to go out between the packets around it
+    const QByteArray oversize(LinkTransmitQueue::kMaxPacketLength + 1, 'x');
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, "a", 1));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, oversize.constData(), oversize.size()));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, "b", 1));
+
+    QByteArray buffer;
+    QList<int> lengths;
+    QCOMPARE(queue.dequeue(buffer, 10000, [&lengths](const char *, int length, bool) {
+        lengths.append(length);
+    }), 3);
+    QCOMPARE(buffer, QByteArray("a") + oversize + QByteArray("b"));
+    QCOMPARE(lengths, QList<int>({ 1, static_cast<int>(oversize.size()), 1 }));
+
+    // The slot is reused for a regular packet once drained
+    for (int i = 0; i < 1024; i++) {
+        QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, "c", 1));
+        buffer.clear();
+        QCOMPARE(queue.dequeue(buffer, 10000, nullptr), 1);
+        QCOMPARE(buffer, QByteArray("c"));
+    }
+}
+
+void LinkTransmitQueueTest::_testOverflow()
+{
+    LinkTransmitQueue queue;
+
+    int enqueued = 0;
+    while (queue.enqueue(LinkTransmitQueue::PriorityControl, "x", 1)) {
+        enqueued++;
+        QVERIFY(enqueued <= 10000);
+    }
+    QVERIFY(enqueued > 0);
+    QCOMPARE(queue.stats(LinkTransmitQueue::PriorityControl).dropped, quint64(1));
+
+    // Other lanes are unaffected by a full lane
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityCommand, "y", 1));
+
+    QByteArray buffer;
+    QCOMPARE(queue.dequeue(buffer, 100000, nullptr), enqueued + 1);
+
+    // Slots are reusable once drained
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityControl, "x", 1));
+}
+
+void LinkTransmitQueueTest::_testMultipleProducers()
+{
+    LinkTransmitQueue queue;
+
+    static constexpr int kProducerCount = 4;
+    static constexpr int kPacketsPerProducer = 200;
+
+    std::unique_ptr<QThread> producers[kProducerCount];
+    for (int producer = 0; producer < kProducerCount; producer++) {
+        producers[producer].reset(QThread::create([&queue, producer]() {
+            for (int i = 0; i < kPacketsPerProducer; i++) {
+                const char packet[2] = { static_cast<char>(producer), static_cast<char>(i) };
+                while (!queue.enqueue(LinkTransmitQueue::PriorityBulk, packet, sizeof(packet))) {
+                    QThread::yieldCurrentThread();
+                }
+            }
+        }));
+        producers[producer]->start();
+    }
+
+    // Packets from the same producer must stay in order
+    int nextPacket[kProducerCount] = {};
+    int received = 0;
+    while (received < (kProducerCount * kPacketsPerProducer)) {
+        QByteArray buffer;
+        received += queue.dequeue(buffer, 1400, [&nextPacket](const char *bytes, int length, bool) {
+            QCOMPARE(length, 2);
+            const int producer = bytes[0];
+            QCOMPARE(static_cast<uint8_t>(bytes[1]), static_cast<uint8_t>(nextPacket[producer]));
+            nextPacket[producer]++;
+        });
+    }
+
+    for (std::unique_ptr<QThread> &producer : producers) {
+        QVERIFY(producer->wait(5000));
+    }
+    QCOMPARE(queue.stats(LinkTransmitQueue::PriorityBulk).sent, quint64(kProducerCount * kPacketsPerProducer));
+}
+
+namespace {
+    /// @return Message parsed from packet on channel, msgid is 0xFFFFFFFF if it doesn't parse
+    mavlink_message_t _parsePacket(const QByteArray &packet, uint8_t channel)
+    {
+        mavlink_message_t message{};
+        message.msgid = 0xFFFFFFFF;
+        mavlink_status_t status{};
+        for (const char byte : packet) {
+            if (mavlink_parse_char(channel, static_cast<uint8_t>(byte), &message, &status) == MAVLINK_FRAMING_OK) {
+                return message;
+            }
+        }
+        message.msgid = 0xFFFFFFFF;
+        return message;
+    }
+
+    QByteArray _heartbeatPacket(uint8_t channel)
+    {
+        mavlink_message_t message;
+        (void) mavlink_msg_heartbeat_pack_chan(255, MAV_COMP_ID_MISSIONPLANNER, channel, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const int length = mavlink_msg_to_send_buffer(buffer, &message);
+        return QByteArray(reinterpret_cast<const char*>(buffer), length);
+    }
+}
+
+void LinkTransmitQueueTest::_testResequence()
+{
+    const uint8_t txChannel = MAVLINK_COMM_NUM_BUFFERS - 1;
+    const uint8_t rxChannel = MAVLINK_COMM_NUM_BUFFERS - 2;
+
+    // Packed in one order, written in another
+    LinkTransmitQueue queue;
+    const QByteArray bulk = _heartbeatPacket(txChannel);
+    const QByteArray control = _heartbeatPacket(txChannel);
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, bulk.constData(), bulk.size(), true));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityControl, control.constData(), control.size(), true));
+    QVERIFY(queue.enqueue(LinkTransmitQueue::PriorityBulk, "x", 1));
+
+    QByteArray buffer;
+    uint8_t sequence = 10;
+    QList<bool> resequenced;
+    QCOMPARE(queue.dequeue(buffer, 1000, [&](char *bytes, int length, bool resequence) {
+        if (resequence) {
+            resequenced.append(LinkTransmitQueue::resequencePacket(bytes, length, sequence++, txChannel));
+        }
+    }), 3);
+    QCOMPARE(resequenced, QList<bool>({ true, true }));
+
+    mavlink_message_t message = _parsePacket(buffer.left(control.size()), rxChannel);
+    QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(message.seq, static_cast<uint8_t>(10));
+    message = _parsePacket(buffer.mid(control.size(), bulk.size()), rxChannel);
+    QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(message.seq, static_cast<uint8_t>(11));
+
+    // MAVLink 1
+    mavlink_status_t *const txStatus = mavlink_get_channel_status(txChannel);
+    txStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    QByteArray packet = _heartbeatPacket(txChannel);
+    txStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    QCOMPARE(static_cast<uint8_t>(packet[0]), static_cast<uint8_t>(MAVLINK_STX_MAVLINK1));
+    QVERIFY(LinkTransmitQueue::resequencePacket(packet.data(), packet.size(), 20, txChannel));
+    message = _parsePacket(packet, rxChannel);
+    QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(message.seq, static_cast<uint8_t>(20));
+
+    // Signed packets are signed again, with a newer timestamp
+    const QByteArray key("LinkTransmitQueueTest");
+    QVERIFY(MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(txChannel), key, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    QVERIFY(MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(rxChannel), key, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    const QByteArray older = _heartbeatPacket(txChannel);
+    packet = _heartbeatPacket(txChannel);
+    QCOMPARE(packet.size(), older.size());
+    QVERIFY(packet.size() > (MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_SIGNATURE_BLOCK_LEN));
+    QVERIFY(LinkTransmitQueue::resequencePacket(packet.data(), packet.size(), 30, txChannel));
+    // Signature block is the link id followed by a 48 bit little endian timestamp and the signature itself
+    const auto timestamp = [](const QByteArray &signedPacket) {
+        const QByteArray bytes = signedPacket.right(MAVLINK_SIGNATURE_BLOCK_LEN).mid(1, 6) + QByteArray(2, '\0');
+        return qFromLittleEndian<quint64>(bytes.constData());
+    };
+    QVERIFY(timestamp(packet) > timestamp(older));
+    message = _parsePacket(packet, rxChannel);
+    QCOMPARE(message.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(message.seq, static_cast<uint8_t>(30));
+    QVERIFY(MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(txChannel), QByteArrayView(), nullptr));
+    QVERIFY(MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(rxChannel), QByteArrayView(), nullptr));
+
+    // Anything else is left alone
+    QByteArray truncated = _heartbeatPacket(txChannel);
+    truncated.chop(1);
+    const QByteArray original = truncated;
+    QVERIFY(!LinkTransmitQueue::resequencePacket(truncated.data(), truncated.size(), 40, txChannel));
+    QCOMPARE(truncated, original);
+    QByteArray notMavlink("xyz");
+    QVERIFY(!LinkTransmitQueue::resequencePacket(notMavlink.data(), notMavlink.size(), 40, txChannel));
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupTest.h"
+#include "FactGroup.h"
+
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+    class TestFactGroup : public FactGroup
+    {
+    public:
+        TestFactGroup()
+            : FactGroup(0 /* updateRateMsecs */)
+            , altitude(0, QStringLiteral("altitude"), FactMetaData::valueTypeDouble)
+            , heading(0, QStringLiteral("heading"), FactMetaData::valueTypeDouble)
+        {
+            _addFact(&altitude, altitude.name());
+            _addFact(&heading, heading.name());
+        }
+
+        Fact altitude;
+        Fact heading;
+    };
+
+    constexpr int kFlushWaitMSecs = 100;
+}
+
+void FactGroupTest::_testSignalsWithoutUpdate()
+{
+    TestFactGroup factGroup;
+    QSignalSpy rawValueSpy(&factGroup.altitude, &Fact::rawValueChanged);
+    QSignalSpy valueSpy(&factGroup.altitude, &Fact::valueChanged);
+
+    factGroup.altitude.setRawValue(10.0);
+    factGroup.altitude.setRawValue(20.0);
+
+    QCOMPARE(rawValueSpy.count(), 2);
+    QCOMPARE(valueSpy.count(), 2);
+}
+
+void FactGroupTest::_testUpdateCoalescesSignals()
+{
+    TestFactGroup factGroup;
+    QSignalSpy altitudeSpy(&factGroup.altitude, &Fact::rawValueChanged);
+    QSignalSpy headingSpy(&factGroup.heading, &Fact::valueChanged);
+
+    factGroup.beginUpdate();
+    factGroup.altitude.setRawValue(10.0);
+    factGroup.altitude.setRawValue(20.0);
+    factGroup.heading.setRawValue(90.0);
+    factGroup.commitUpdate();
+
+    // Values are visible right away, the signals follow on the next frame
+    QCOMPARE(factGroup.altitude.rawValue().toDouble(), 20.0);
+    QCOMPARE(altitudeSpy.count(), 0);
+    QCOMPARE(headingSpy.count(), 0);
+
+    QTRY_COMPARE(altitudeSpy.count(), 1);
+    QTRY_COMPARE(headingSpy.count(), 1);
+    QCOMPARE(altitudeSpy[0][0].toDouble(), 20.0);
+
+    // A change made while the signals are still held back joins them
+    factGroup.beginUpdate();
+    factGroup.altitude.setRawValue(30.0);
+    factGroup.commitUpdate();
+    factGroup.altitude.setRawValue(40.0);
+    QTRY_COMPARE(altitudeSpy.count(), 2);
+    QTest::qWait(kFlushWaitMSecs);
+    QCOMPARE(altitudeSpy.count(), 2);
+    QCOMPARE(altitudeSpy[1][0].toDouble(), 40.0);
+}
+
+void FactGroupTest::_testUpdateSkipsUnchanged()
+{
+    TestFactGroup factGroup;
+    factGroup.altitude.setRawValue(10.0);
+
+    QSignalSpy rawValueSpy(&factGroup.altitude, &Fact::rawValueChanged);
+    QSignalSpy valueSpy(&factGroup.altitude, &Fact::valueChanged);
+
+    factGroup.beginUpdate();
+    factGroup.altitude.setRawValue(20.0);
+    factGroup.altitude.setRawValue(10.0);
+    factGroup.commitUpdate();
+
+    QTest::qWait(kFlushWaitMSecs);
+    QCOMPARE(rawValueSpy.count(), 0);
+    QCOMPARE(valueSpy.count(), 0);
+}
+
+void FactGroupTest::_testNestedUpdates()
+{
+    TestFactGroup factGroup;
+    QSignalSpy rawValueSpy(&factGroup.altitude, &Fact::rawValueChanged);
+
+    factGroup.beginUpdate();
+    factGroup.beginUpdate();
+    factGroup.altitude.setRawValue(10.0);
+    factGroup.commitUpdate();
+
+    // Still inside the outer update
+    QTest::qWait(kFlushWaitMSecs);
+    QCOMPARE(rawValueSpy.count(), 0);
+
+    factGroup.commitUpdate();
+    QTRY_COMPARE(rawValueSpy.count(), 1);
+}
@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SettingsStoreTest.h"
+#include "SettingsStore.h"
+
+#include <QtCore/QSettings>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+    constexpr const char* kGroup = "SettingsStoreTest";
+
+    QString testKey(const char* name)
+    {
+        return QString(kGroup) + QLatin1Char('/') + QLatin1String(name);
+    }
+}
+
+void SettingsStoreTest::_testReadAfterWrite()
+{
+    SettingsStore store;
+    store.load();
+    store.setWriteDelay(60 * 1000);
+
+    QVERIFY(!store.contains(testKey("readAfterWrite")));
+    QCOMPARE(store.value(testKey("readAfterWrite"), 5).toInt(), 5);
+
+    store.setValue(testKey("readAfterWrite"), 10);
+    QVERIFY(store.contains(testKey("readAfterWrite")));
+    QCOMPARE(store.value(testKey("readAfterWrite")).toInt(), 10);
+    QVERIFY(store.childKeys(kGroup).contains(QStringLiteral("readAfterWrite")));
+
+    store.remove(kGroup);
+    store.flush();
+}
+
+void SettingsStoreTest::_testDelayedWrite()
+{
+    SettingsStore store;
+    store.load();
+    store.setWriteDelay(10);
+    QSignalSpy writtenSpy(&store, &SettingsStore::written);
+
+    // A burst of changes goes out as a single write with the last value
+    for (int i = 1; i <= 10; i++) {
+        store.setValue(testKey("delayedWrite"), i);
+    }
+    QVERIFY(writtenSpy.wait(1000));
+    QTest::qWait(50);
+    QCOMPARE(writtenSpy.count(), 1);
+
+    QSettings settings;
+    QCOMPARE(settings.value(testKey("delayedWrite")).toInt(), 10);
+
+    store.remove(kGroup);
+    store.flush();
+}
+
+void SettingsStoreTest::_testRemove()
+{
+    SettingsStore store;
+    store.load();
+    store.setWriteDelay(60 * 1000);
+
+    store.setValue(testKey("remove1"), 1);
+    store.setValue(testKey("remove2"), 2);
+    store.remove(kGroup);
+    QVERIFY(!store.contains(testKey("remove1")));
+    QVERIFY(store.childKeys(kGroup).isEmpty());
+
+    // Changes after a remove must survive the write
+    store.setValue(testKey("remove2"), 3);
+    store.flush();
+
+    QSettings settings;
+    QVERIFY(!settings.contains(testKey("remove1")));
+    QCOMPARE(settings.value(testKey("remove2")).toInt(), 3);
+
+    store.remove(kGroup);
+    store.flush();
+}
+
+void SettingsStoreTest::_testFlush()
+{
+    {
+        SettingsStore store;
+        store.load();
+        store.setWriteDelay(60 * 1000);
+        store.setValue(testKey("flush"), QStringLiteral("value"));
+        store.flush();
+
+        QSettings settings;
+        QCOMPARE(settings.value(testKey("flush")).toString(), QStringLiteral("value"));
+
+        // Outstanding changes are also written when the store goes away
+        store.setValue(testKey("flush"), QStringLiteral("destroyed"));
+    }
+
+    SettingsStore store;
+    store.load();
+    QCOMPARE(store.value(testKey("flush")).toString(), QStringLiteral("destroyed"));
+
+    store.remove(kGroup);
+    store.flush();
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "JoystickTest.h"
+#include "Joystick.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+    /// Joystick without a device which records latencies handed to it
+    class TestJoystick : public Joystick
+    {
+    public:
+        TestJoystick()
+            : Joystick(QStringLiteral("JoystickTest"), 0, 0, 0, qgcApp()->toolbox()->multiVehicleManager())
+        {
+        }
+
+        ~TestJoystick() override
+        {
+            stop();
+        }
+
+        void recordLatency(qint64 latencyUs)
+        {
+            if (!_latencyTimer.isValid()) {
+                _latencyTimer.start();
+            }
+            _pendingInputNs = _latencyTimer.nsecsElapsed() - (latencyUs * 1000);
+            _recordInputLatency();
+        }
+
+        void recordWithoutInput()
+        {
+            _pendingInputNs = -1;
+            _recordInputLatency();
+        }
+
+        int index() override { return 0; }
+        void setIndex(int) override {}
+
+    private:
+        bool _open() override { return true; }
+        void _close() override {}
+        bool _update() override { return true; }
+        bool _getButton(int) override { return false; }
+        int _getAxis(int) override { return 0; }
+        bool _getHat(int, int) override { return false; }
+    };
+}
+
+void JoystickTest::_testLatencyHistogram()
+{
+    TestJoystick joystick;
+    QSignalSpy spyStats(&joystick, &Joystick::latencyStatsChanged);
+
+    const QStringList labels = joystick.latencyHistogramLabels();
+    QCOMPARE(joystick.latencyHistogram().count(), labels.count());
+    QCOMPARE(labels.first(), QStringLiteral("< 0.25 ms"));
+    QCOMPARE(labels.last(), QStringLiteral(">= 64 ms"));
+
+    QCOMPARE(joystick.latencySampleCount(), 0);
+    QCOMPARE(joystick.latencyMeanMs(), 0.0);
+    QVERIFY(joystick.latencyHistogram().count(0) == labels.count());
+
+    // One sample well inside each of the first, a middle and the overflow bucket
+    joystick.recordLatency(100);
+    joystick.recordLatency(3000);
+    joystick.recordLatency(100000);
+
+    const QList<int> histogram = joystick.latencyHistogram();
+    QCOMPARE(histogram[0], 1);
+    QCOMPARE(histogram[4], 1);
+    QCOMPARE(histogram.last(), 1);
+    QCOMPARE(joystick.latencySampleCount(), 3);
+    QVERIFY(joystick.latencyMaxMs() >= 100.0);
+    QVERIFY(joystick.latencyMeanMs() >= (100.0 + 3.0 + 0.1) / 3);
+    QVERIFY(joystick.latencyMeanMs() < joystick.latencyMaxMs());
+
+    // Notifications are throttled, the first sample always notifies
+    QCOMPARE(spyStats.count(), 1);
+
+    // Keep alive resends without new input aren't samples
+    joystick.recordWithoutInput();
+    QCOMPARE(joystick.latencySampleCount(), 3);
+
+    joystick.resetLatencyStats();
+    QCOMPARE(spyStats.count(), 2);
+    QCOMPARE(joystick.latencySampleCount(), 0);
+    QCOMPARE(joystick.latencyMaxMs(), 0.0);
+    QVERIFY(joystick.latencyHistogram().count(0) == labels.count());
+}
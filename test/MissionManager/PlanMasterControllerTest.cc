@@ -11,8 +11,14 @@
 #include "MultiSignalSpyV2.h"
 #include "MissionManager.h"
 #include "PlanMasterController.h"
+#include "SurveyComplexItem.h"
+#include "QGCMapPolygon.h"
 #include "Vehicle.h"
 
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QSignalSpy>
 #include <QtTest/QTest>
 
 PlanMasterControllerTest::PlanMasterControllerTest(void)
@@ -79,3 +85,69 @@ void PlanMasterControllerTest::_testActiveVehicleChanged(void) {
     // we make sure it does.
     QVERIFY(spyMissionManager.checkOnlySignalByMask(missionManagerErrorSignalMask));
 }
+
+void PlanMasterControllerTest::_testMultiSurveyPlanLoadBenchmark(void)
+{
+    static constexpr int kSurveyCount = 20;
+
+    MissionController* missionController = _masterController->missionController();
+    for (int i = 0; i < kSurveyCount; i++) {
+        const QGeoCoordinate center(47.6 + (i * 0.01), 8.5);
+        SurveyComplexItem* survey = qobject_cast<SurveyComplexItem*>(missionController->insertComplexMissionItem(missionController->surveyComplexItemName(), center, missionController->visualItems()->count()));
+        QVERIFY(survey);
+        survey->surveyAreaPolygon()->clear();
+        survey->surveyAreaPolygon()->appendVertices(QList<QGeoCoordinate>{
+            center.atDistanceAndAzimuth(200, 0),
+            center.atDistanceAndAzimuth(200, 90),
+            center.atDistanceAndAzimuth(200, 180),
+            center.atDistanceAndAzimuth(200, 270),
+        });
+    }
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString planFile = tempDir.filePath(QStringLiteral("MultiSurvey.plan"));
+    _masterController->saveToFile(planFile);
+
+    QBENCHMARK {
+        PlanMasterController loadController;
+        loadController.setFlyView(false);
+        loadController.start();
+        loadController.loadFromFile(planFile);
+        QCOMPARE(loadController.missionController()->visualItems()->count(), kSurveyCount + 1);
+    }
+}
+
+void PlanMasterControllerTest::_testStreamedSaveAsyncLoad(void)
+{
+    static constexpr int kWaypointCount = 50;
+
+    MissionController* missionController = _masterController->missionController();
+    for (int i = 0; i < kWaypointCount; i++) {
+        QVERIFY(missionController->insertSimpleMissionItem(QGeoCoordinate(47.6 + (i * 0.001), 8.5), missionController->visualItems()->count()));
+    }
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString planFile = tempDir.filePath(QStringLiteral("Streamed.plan"));
+    _masterController->saveToFile(planFile);
+
+    // Streamed file must be identical in content to the in memory json
+    QFile file(planFile);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError parseError;
+    const QJsonDocument savedDoc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    QCOMPARE(parseError.error, QJsonParseError::NoError);
+    QCOMPARE(savedDoc, _masterController->saveToJson());
+
+    PlanMasterController loadController;
+    loadController.setFlyView(false);
+    loadController.start();
+    QSignalSpy completeSpy(&loadController, &PlanMasterController::loadFromFileAsyncComplete);
+    loadController.loadFromFileAsync(planFile);
+    QVERIFY(loadController.loadInProgress());
+    QVERIFY(completeSpy.wait(10000));
+    QVERIFY(!loadController.loadInProgress());
+    QCOMPARE(loadController.missionController()->visualItems()->count(), kWaypointCount + 1);
+    QCOMPARE(loadController.currentPlanFile(), planFile);
+}
@@ -27,6 +27,8 @@ private slots:
     void _testMissionFileLoad(void);
     void _testMissionPlannerFileLoad(void);
     void _testActiveVehicleChanged(void);
+    void _testMultiSurveyPlanLoadBenchmark(void);
+    void _testStreamedSaveAsyncLoad(void);
 
 private:
     PlanMasterController*   _masterController;
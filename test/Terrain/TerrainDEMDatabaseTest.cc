@@ -0,0 +1,225 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainDEMDatabaseTest.h"
+#include "TerrainDEMDatabase.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+#include <QtCore/QtMath>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtTest/QTest>
+
+#include <atomic>
+#include <cstring>
+
+namespace {
+    constexpr int kHgtSize = 1201;
+    constexpr double kHgtSpacing = 1.0 / (kHgtSize - 1);
+}
+
+void TerrainDEMDatabaseTest::_hgtTest()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // 3 arc second tile where the elevation is the column index, with a single void sample
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    for (int row = 0; row < kHgtSize; row++) {
+        for (int column = 0; column < kHgtSize; column++) {
+            stream << static_cast<qint16>(((row == 10) && (column == 10)) ? -32768 : column);
+        }
+    }
+
+    QFile file(tempDir.filePath(QStringLiteral("N47E008.hgt")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+
+    TerrainDEMDatabase database;
+    database.setDirectory(tempDir.path());
+    QCOMPARE(database.rasterCount(), 1);
+
+    double elevation;
+    QVERIFY(database.getElevation(QGeoCoordinate(47.5, 8 + (600.5 * kHgtSpacing)), elevation));
+    QVERIFY(qAbs(elevation - 600.5) <= 0.01);
+
+    // Exact tile corners are covered
+    QVERIFY(database.getElevation(QGeoCoordinate(48, 8), elevation));
+    QVERIFY(qAbs(elevation - 0.) <= 0.01);
+    QVERIFY(database.getElevation(QGeoCoordinate(47, 9), elevation));
+    QVERIFY(qAbs(elevation - 1200.) <= 0.01);
+
+    // Void samples are left out of the interpolation
+    const double voidLatitude = 48 - (10 * kHgtSpacing);
+    QVERIFY(!database.getElevation(QGeoCoordinate(voidLatitude, 8 + (10 * kHgtSpacing)), elevation));
+    QVERIFY(database.getElevation(QGeoCoordinate(voidLatitude, 8 + (10.5 * kHgtSpacing)), elevation));
+    QVERIFY(qAbs(elevation - 11.) <= 0.01);
+
+    QVERIFY(!database.getElevation(QGeoCoordinate(46.5, 8.5), elevation));
+
+    // All or nothing
+    QList<double> elevations;
+    QVERIFY(database.getElevations({ QGeoCoordinate(47.5, 8.5), QGeoCoordinate(47.25, 8.25) }, elevations));
+    QCOMPARE(elevations.count(), 2);
+    QVERIFY(!database.getElevations({ QGeoCoordinate(47.5, 8.5), QGeoCoordinate(10, 10) }, elevations));
+}
+
+void TerrainDEMDatabaseTest::_geoTiffTest()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // 4x4 float32 little endian GeoTIFF, pixel is area, top left corner at 50N 10E with 0.25 degree pixels
+    constexpr int kSize = 4;
+    constexpr quint32 kIfdOffset = 8;
+    constexpr quint16 kTagCount = 11;
+    constexpr quint32 kScaleOffset = kIfdOffset + 2 + (kTagCount * 12) + 4;
+    constexpr quint32 kTiepointOffset = kScaleOffset + (3 * 8);
+    constexpr quint32 kGeoKeysOffset = kTiepointOffset + (6 * 8);
+    constexpr quint32 kDataOffset = kGeoKeysOffset + (8 * 2);
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    const auto writeTag = [&stream](quint16 tag, quint16 type, quint32 count, quint32 value) {
+        stream << tag << type << count;
+        if (type == 3) {
+            stream << static_cast<quint16>(value) << static_cast<quint16>(0);
+        } else {
+            stream << value;
+        }
+    };
+
+    (void) stream.writeRawData("II", 2);
+    stream << static_cast<quint16>(42) << kIfdOffset;
+    stream << kTagCount;
+    writeTag(256, 3, 1, kSize);
+    writeTag(257, 3, 1, kSize);
+    writeTag(258, 3, 1, 32);
+    writeTag(259, 3, 1, 1);
+    writeTag(273, 4, 1, kDataOffset);
+    writeTag(277, 3, 1, 1);
+    writeTag(278, 3, 1, kSize);
+    writeTag(339, 3, 1, 3);
+    writeTag(33550, 12, 3, kScaleOffset);
+    writeTag(33922, 12, 6, kTiepointOffset);
+    writeTag(34735, 3, 8, kGeoKeysOffset);
+    stream << static_cast<quint32>(0);
+    stream << 0.25 << 0.25 << 0.;
+    stream << 0. << 0. << 0. << 10. << 50. << 0.;
+    stream << static_cast<quint16>(1) << static_cast<quint16>(1) << static_cast<quint16>(0) << static_cast<quint16>(1);
+    stream << static_cast<quint16>(1024) << static_cast<quint16>(0) << static_cast<quint16>(1) << static_cast<quint16>(2);
+    QCOMPARE(static_cast<quint32>(data.size()), kDataOffset);
+    for (int row = 0; row < kSize; row++) {
+        for (int column = 0; column < kSize; column++) {
+            const float value = (row * 10) + column;
+            quint32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            stream << bits;
+        }
+    }
+
+    QFile file(tempDir.filePath(QStringLiteral("dem.tif")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+
+    TerrainDEMDatabase database;
+    QVERIFY(database.addFile(file.fileName()));
+
+    // Row 1.5, column 0.5
+    double elevation;
+    QVERIFY(database.getElevation(QGeoCoordinate(49.5, 10.25), elevation));
+    QVERIFY(qAbs(elevation - 15.5) <= 0.001);
+
+    // Outside of the pixel centers
+    QVERIFY(!database.getElevation(QGeoCoordinate(49.95, 10.5), elevation));
+}
+
+void TerrainDEMDatabaseTest::_unsupportedFileTest()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Wrong size for an hgt file
+    QFile file(tempDir.filePath(QStringLiteral("N47E008.hgt")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(QByteArray(1000, 0)), 1000);
+    file.close();
+
+    TerrainDEMDatabase database;
+    QVERIFY(!database.addFile(file.fileName()));
+    QVERIFY(!database.addFile(tempDir.filePath(QStringLiteral("missing.tif"))));
+    QCOMPARE(database.rasterCount(), 0);
+
+    double elevation;
+    QVERIFY(!database.getElevation(QGeoCoordinate(47.5, 8.5), elevation));
+}
+
+void TerrainDEMDatabaseTest::_concurrentTest()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Flat tile at 100m
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    for (int sample = 0; sample < (kHgtSize * kHgtSize); sample++) {
+        stream << static_cast<qint16>(100);
+    }
+
+    QFile file(tempDir.filePath(QStringLiteral("N47E008.hgt")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+
+    TerrainDEMDatabase database;
+
+    // Lookups race the index being rebuilt, they either miss or find the right elevation
+    std::atomic<bool> stop{false};
+    std::atomic<int> badLookups{0};
+    std::atomic<int> lookups{0};
+    QThread *const lookupThread = QThread::create([&database, &stop, &badLookups, &lookups]() {
+        while (!stop) {
+            double elevation = 0;
+            if (database.getElevation(QGeoCoordinate(47.5, 8.5), elevation) && (qAbs(elevation - 100.) > 0.01)) {
+                badLookups++;
+            }
+            QList<double> elevations;
+            if (database.getElevations({ QGeoCoordinate(47.25, 8.25) }, elevations) && (qAbs(elevations.first() - 100.) > 0.01)) {
+                badLookups++;
+            }
+            (void) database.rasterCount();
+            lookups++;
+        }
+    });
+    lookupThread->start();
+
+    for (int i = 0; i < 200; i++) {
+        database.setDirectory((i % 2) ? QString() : tempDir.path());
+    }
+    database.setDirectory(tempDir.path());
+
+    stop = true;
+    QVERIFY(lookupThread->wait(5000));
+    delete lookupThread;
+
+    QCOMPARE(badLookups.load(), 0);
+    QVERIFY(lookups.load() > 0);
+    QCOMPARE(database.rasterCount(), 1);
+    QCOMPARE(database.directory(), tempDir.path());
+}
@@ -0,0 +1,166 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTileCopernicus.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QtEndian>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtTest/QTest>
+
+#include <cstring>
+
+namespace {
+    constexpr double kSwLat = 47.39;
+    constexpr double kSwLon = 8.54;
+    constexpr int kGridSize = 37;       ///< 0.01 degree tile at 1 arc-second spacing
+    constexpr double kCellSize = TerrainTileCopernicus::tileSizeDegrees / kGridSize;
+
+    int16_t _testElevation(int latIndex, int lonIndex)
+    {
+        return static_cast<int16_t>(400 + (latIndex * 3) + lonIndex);
+    }
+
+    QGeoCoordinate _cellCenter(int latIndex, int lonIndex)
+    {
+        return QGeoCoordinate(kSwLat + ((latIndex + 0.5) * kCellSize), kSwLon + ((lonIndex + 0.5) * kCellSize));
+    }
+
+    /// Carpet response as served by the Copernicus terrain server
+    QByteArray _testJsonTile()
+    {
+        QJsonArray carpet;
+        double sum = 0;
+        for (int i = 0; i < kGridSize; i++) {
+            QJsonArray row;
+            for (int j = 0; j < kGridSize; j++) {
+                row.append(_testElevation(i, j));
+                sum += _testElevation(i, j);
+            }
+            carpet.append(row);
+        }
+
+        const QJsonObject bounds = {
+            { "sw", QJsonArray{ kSwLat, kSwLon } },
+            { "ne", QJsonArray{ kSwLat + TerrainTileCopernicus::tileSizeDegrees, kSwLon + TerrainTileCopernicus::tileSizeDegrees } },
+        };
+        const QJsonObject stats = {
+            { "min", _testElevation(0, 0) },
+            { "max", _testElevation(kGridSize - 1, kGridSize - 1) },
+            { "avg", sum / (kGridSize * kGridSize) },
+        };
+        const QJsonObject data = {
+            { "bounds", bounds },
+            { "stats", stats },
+            { "carpet", carpet },
+        };
+        const QJsonObject root = {
+            { "status", "success" },
+            { "data", data },
+        };
+
+        return QJsonDocument(root).toJson(QJsonDocument::Compact);
+    }
+}
+
+void TerrainTileTest::_jsonToBinaryTest()
+{
+    const QByteArray binary = TerrainTileCopernicus::serialize(_testJsonTile());
+    QVERIFY(TerrainTile::isBinaryTile(binary));
+
+    const TerrainTile tile(binary);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.minElevation(), static_cast<double>(_testElevation(0, 0)));
+    QCOMPARE(tile.maxElevation(), static_cast<double>(_testElevation(kGridSize - 1, kGridSize - 1)));
+
+    for (int i = 0; i < kGridSize; i += 6) {
+        for (int j = 0; j < kGridSize; j += 5) {
+            QCOMPARE(tile.elevation(_cellCenter(i, j)), static_cast<double>(_testElevation(i, j)));
+        }
+    }
+
+    // Truncated data must be rejected
+    QVERIFY(!TerrainTile(binary.left(binary.size() - 1)).isValid());
+    QVERIFY(!TerrainTile(binary.left(10)).isValid());
+
+    // The payload starts with the uncompressed size as a big endian uint32, one which does not match the grid is rejected
+    constexpr qsizetype kHeaderSize = 57;
+    QCOMPARE(qFromBigEndian<quint32>(binary.constData() + kHeaderSize), static_cast<quint32>(kGridSize * kGridSize * sizeof(int16_t)));
+    QByteArray wrongSize = binary;
+    qToBigEndian<quint32>(0x7FFFFFFF, wrongSize.data() + kHeaderSize);
+    QVERIFY(!TerrainTile(wrongSize).isValid());
+}
+
+void TerrainTileTest::_binaryPassThroughTest()
+{
+    const QByteArray binary = TerrainTileCopernicus::serialize(_testJsonTile());
+    QCOMPARE(TerrainTileCopernicus::serialize(binary), binary);
+
+    QByteArray corrupt = binary;
+    corrupt[corrupt.size() - 4] = static_cast<char>(corrupt[corrupt.size() - 4] ^ 0xFF);
+    QVERIFY(TerrainTileCopernicus::serialize(corrupt).isEmpty());
+
+    QVERIFY(TerrainTileCopernicus::serialize(QByteArrayLiteral("{\"status\":\"error\"}")).isEmpty());
+}
+
+void TerrainTileTest::_legacyTileTest()
+{
+    // Raw header/grid memory dump as written to the tile cache by earlier versions
+    struct LegacyTileInfo_t {
+        double  swLat, swLon, neLat, neLon;
+        int16_t minElevation, maxElevation;
+        double  avgElevation;
+        int16_t gridSizeLat, gridSizeLon;
+    };
+
+    const LegacyTileInfo_t tileInfo = {
+        kSwLat, kSwLon, kSwLat + TerrainTileCopernicus::tileSizeDegrees, kSwLon + TerrainTileCopernicus::tileSizeDegrees,
+        _testElevation(0, 0), _testElevation(kGridSize - 1, kGridSize - 1), 500,
+        kGridSize, kGridSize
+    };
+
+    QByteArray legacy(sizeof(tileInfo), Qt::Uninitialized);
+    (void) memcpy(legacy.data(), &tileInfo, sizeof(tileInfo));
+    for (int i = 0; i < kGridSize; i++) {
+        for (int j = 0; j < kGridSize; j++) {
+            const int16_t elevation = _testElevation(i, j);
+            legacy.append(reinterpret_cast<const char*>(&elevation), sizeof(elevation));
+        }
+    }
+
+    QVERIFY(!TerrainTile::isBinaryTile(legacy));
+    const TerrainTile tile(legacy);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.elevation(_cellCenter(12, 30)), static_cast<double>(_testElevation(12, 30)));
+}
+
+void TerrainTileTest::_parseJsonBenchmark()
+{
+    const QByteArray json = _testJsonTile();
+    qDebug() << "JSON tile bytes" << json.size();
+
+    QBENCHMARK {
+        const TerrainTile tile(TerrainTileCopernicus::serializeFromJson(json));
+        QVERIFY(tile.isValid());
+    }
+}
+
+void TerrainTileTest::_parseBinaryBenchmark()
+{
+    const QByteArray binary = TerrainTileCopernicus::serialize(_testJsonTile());
+    qDebug() << "Binary tile bytes" << binary.size();
+
+    QBENCHMARK {
+        const TerrainTile tile(binary);
+        QVERIFY(tile.isValid());
+    }
+}
@@ -29,12 +29,16 @@
 // #include "RadioConfigTest.h"
 
 // Comms
+#include "LinkStatisticsTest.h"
+#include "LinkTransmitQueueTest.h"
 #include "QGCSerialPortInfoTest.h"
 
 // FactSystem
+#include "FactGroupTest.h"
 #include "FactSystemTestGeneric.h"
 #include "FactSystemTestPX4.h"
 #include "ParameterManagerTest.h"
+#include "SettingsStoreTest.h"
 
 // FollowMe
 #include "FollowMeTest.h"
@@ -45,6 +49,9 @@
 // GPS
 #include "GpsTest.h"
 
+// Joystick
+#include "JoystickTest.h"
+
 // MAVLink
 #include "StatusTextHandlerTest.h"
 #include "SigningTest.h"
@@ -83,12 +90,15 @@
 // QmlControls
 
 // Terrain
+#include "TerrainDEMDatabaseTest.h"
 #include "TerrainQueryTest.h"
+#include "TerrainTileTest.h"
 
 // UI
 
 // Utilities
 // Compression
+#include "DecompressionBenchmark.h"
 #include "DecompressionTest.h"
 #include "QGCFileDownloadTest.h"
 
@@ -97,10 +107,21 @@
 #include "ComponentInformationCacheTest.h"
 #include "ComponentInformationTranslationTest.h"
 #include "FTPManagerTest.h"
-// #include "InitialConnectTest.h"
+#include "InitialConnectTest.h"
 // #include "RequestMessageTest.h"
 // #include "SendMavCommandWithHandlerTest.h"
 // #include "SendMavCommandWithSignalingTest.h"
+#include "MAVLinkLogBenchmark.h"
+#include "SwarmBenchmark.h"
+#include "TrajectoryPointsTest.h"
+
+// VehicleSetup
+#include "BootloaderTest.h"
+
+// Viewer3D
+#ifdef QGC_VIEWER3D
+#include "OsmParserThreadTest.h"
+#endif
 
 // Missing
 // #include "FlightGearUnitTest.h"
@@ -130,12 +151,16 @@ int runTests(bool stress, QStringView unitTestOptions)
     // UT_REGISTER_TEST(RadioConfigTest)
 
     // Comms
+    UT_REGISTER_TEST(LinkStatisticsTest)
+    UT_REGISTER_TEST(LinkTransmitQueueTest)
     UT_REGISTER_TEST(QGCSerialPortInfoTest)
 
     // FactSystem
+    UT_REGISTER_TEST(FactGroupTest)
     UT_REGISTER_TEST(FactSystemTestGeneric)
     UT_REGISTER_TEST(FactSystemTestPX4)
     UT_REGISTER_TEST(ParameterManagerTest)
+    UT_REGISTER_TEST(SettingsStoreTest)
 
     // FollowMe
     UT_REGISTER_TEST(FollowMeTest)
@@ -146,6 +171,9 @@ int runTests(bool stress, QStringView unitTestOptions)
     // GPS
     // UT_REGISTER_TEST(GpsTest)
 
+    // Joystick
+    UT_REGISTER_TEST(JoystickTest)
+
     // MAVLink
     UT_REGISTER_TEST(StatusTextHandlerTest)
     UT_REGISTER_TEST(SigningTest)
@@ -182,13 +210,16 @@ int runTests(bool stress, QStringView unitTestOptions)
     // QmlControls
 
     // Terrain
+    UT_REGISTER_TEST(TerrainDEMDatabaseTest)
     UT_REGISTER_TEST(TerrainQueryTest)
+    UT_REGISTER_TEST(TerrainTileTest)
 
     // UI
 
     // Utilities
     // Compression
     UT_REGISTER_TEST(DecompressionTest)
+    UT_REGISTER_TEST_STANDALONE(DecompressionBenchmark)
     // UT_REGISTER_TEST(QGCFileDownloadTest)
 
     // Vehicle
@@ -196,10 +227,21 @@ int runTests(bool stress, QStringView unitTestOptions)
     UT_REGISTER_TEST(ComponentInformationCacheTest)
     UT_REGISTER_TEST(ComponentInformationTranslationTest)
     UT_REGISTER_TEST(FTPManagerTest)
-    // UT_REGISTER_TEST(InitialConnectTest)
+    UT_REGISTER_TEST(InitialConnectTest)
     // UT_REGISTER_TEST(RequestMessageTest)
     // UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
     // UT_REGISTER_TEST(SendMavCommandWithSignalingTest)
+    UT_REGISTER_TEST_STANDALONE(MAVLinkLogBenchmark)
+    UT_REGISTER_TEST_STANDALONE(SwarmBenchmark)
+    UT_REGISTER_TEST(TrajectoryPointsTest)
+
+    // VehicleSetup
+    UT_REGISTER_TEST(BootloaderTest)
+
+    // Viewer3D
+#ifdef QGC_VIEWER3D
+    UT_REGISTER_TEST(OsmParserThreadTest)
+#endif
 
     // Missing
     // UT_REGISTER_TEST(FlightGearUnitTest)
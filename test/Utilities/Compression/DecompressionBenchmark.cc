@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "DecompressionBenchmark.h"
+#include "JsonHelper.h"
+#include "QGCDecompressDevice.h"
+#include "QGCLZMA.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <limits>
+
+DecompressionBenchmark::DecompressionBenchmark(void)
+{
+    const QString files = qEnvironmentVariable("QGC_DECOMPRESSION_FILES");
+    _files = files.isEmpty() ? QStringList(QStringLiteral(":/manifest.json.xz")) : files.split(QLatin1Char(','), Qt::SkipEmptyParts);
+
+    bool ok = false;
+    const int iterations = qEnvironmentVariableIntValue("QGC_DECOMPRESSION_ITERATIONS", &ok);
+    if (ok && (iterations > 0)) {
+        _iterations = iterations;
+    }
+}
+
+void DecompressionBenchmark::_decompress_data(void)
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<bool>("inMemory");
+
+    for (const QString& fileName: _files) {
+        const QByteArray name = QFileInfo(fileName).fileName().toUtf8();
+        QTest::newRow(name + " file")   << fileName << false;
+        QTest::newRow(name + " memory") << fileName << true;
+    }
+}
+
+void DecompressionBenchmark::_decompress(void)
+{
+    QFETCH(QString, fileName);
+    QFETCH(bool, inMemory);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString decompressedFileName = tempDir.filePath(QStringLiteral("metadata.json"));
+
+    qint64 bestDecompressNSecs = std::numeric_limits<qint64>::max();
+    qint64 bestTotalNSecs = std::numeric_limits<qint64>::max();
+    qsizetype decompressedBytes = 0;
+
+    for (int i = 0; i < _iterations; i++) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QString errorString;
+        QByteArray bytes;
+        if (inMemory) {
+            QVERIFY2(QGCDecompressDevice::readFile(fileName, bytes, errorString), qPrintable(errorString));
+        } else {
+            QVERIFY(QGCLZMA::inflateLZMAFile(fileName, decompressedFileName));
+            QFile file(decompressedFileName);
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            bytes = file.readAll();
+        }
+        const qint64 decompressNSecs = timer.nsecsElapsed();
+
+        QJsonDocument jsonDoc;
+        QVERIFY2(JsonHelper::isJsonFile(bytes, jsonDoc, errorString), qPrintable(errorString));
+        const qint64 totalNSecs = timer.nsecsElapsed();
+
+        decompressedBytes = bytes.size();
+        bestDecompressNSecs = std::min(bestDecompressNSecs, decompressNSecs);
+        bestTotalNSecs = std::min(bestTotalNSecs, totalNSecs);
+    }
+
+    const double mbytes = static_cast<double>(decompressedBytes) / (1024.0 * 1024.0);
+
+    QJsonObject result;
+    result[QStringLiteral("row")]                       = QString::fromLatin1(QTest::currentDataTag());
+    result[QStringLiteral("compressedBytes")]           = static_cast<double>(QFileInfo(fileName).size());
+    result[QStringLiteral("decompressedBytes")]         = static_cast<double>(decompressedBytes);
+    result[QStringLiteral("iterations")]                = _iterations;
+    result[QStringLiteral("decompressMBytesPerSec")]    = (bestDecompressNSecs > 0) ? (mbytes * 1e9 / bestDecompressNSecs) : 0.0;
+    result[QStringLiteral("decompressMSecs")]           = static_cast<double>(bestDecompressNSecs / 1000000);
+    result[QStringLiteral("parsedMSecs")]               = static_cast<double>(bestTotalNSecs / 1000000);
+    _results.append(result);
+}
+
+void DecompressionBenchmark::cleanupTestCase(void)
+{
+    QJsonObject root;
+    root[QStringLiteral("benchmark")]   = QStringLiteral("DecompressionBenchmark");
+    root[QStringLiteral("version")]     = QCoreApplication::applicationVersion();
+    root[QStringLiteral("timestamp")]   = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root[QStringLiteral("results")]     = _results;
+
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    const QString outputFile = qEnvironmentVariable("QGC_DECOMPRESSION_OUTPUT");
+    if (outputFile.isEmpty()) {
+        qDebug().noquote() << json;
+        return;
+    }
+
+    QFile file(outputFile);
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    QCOMPARE(file.write(json), json.size());
+}
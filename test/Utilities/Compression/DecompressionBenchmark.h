@@ -0,0 +1,41 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QStringList>
+
+/// Measures how fast compressed json metadata gets to a parsed document. The "file" rows decompress to a temporary
+/// file and read it back the way metadata used to be loaded, the "memory" rows decompress in memory through
+/// QGCDecompressDevice.
+///
+/// This is a standalone test, run it with --unittest:DecompressionBenchmark. It is configured through the environment:
+///     QGC_DECOMPRESSION_FILES         Comma separated .json.xz files to measure (default the bundled manifest.json.xz)
+///     QGC_DECOMPRESSION_ITERATIONS    Runs per row, the fastest is reported (default 3)
+///     QGC_DECOMPRESSION_OUTPUT        File to write the json results to, they are logged if not set
+class DecompressionBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    DecompressionBenchmark(void);
+
+private slots:
+    void _decompress_data   (void);
+    void _decompress        (void);
+    void cleanupTestCase    (void);
+
+private:
+    QStringList _files;
+    int         _iterations = 3;
+    QJsonArray  _results;
+};
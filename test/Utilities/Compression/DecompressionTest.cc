@@ -1,8 +1,13 @@
 #include "DecompressionTest.h"
+#include "QGCDecompressDevice.h"
 #include "QGCLZMA.h"
 #include "QGCZlib.h"
 #include "QGCZip.h"
 
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QTemporaryFile>
 #include <QtTest/QTest>
 
 void DecompressionTest::_testDecompressGzip()
@@ -28,3 +33,85 @@ void DecompressionTest::_testUnzip()
     const bool result = QGCZip::unzipFile(zipFilename, decompressedPath);
     QVERIFY(result);
 }
+
+void DecompressionTest::_testDecompressDevice()
+{
+    QString errorString;
+    QByteArray xzBytes;
+    QVERIFY2(QGCDecompressDevice::readFile(QStringLiteral(":/manifest.json.xz"), xzBytes, errorString), qPrintable(errorString));
+    QByteArray gzipBytes;
+    QVERIFY2(QGCDecompressDevice::readFile(QStringLiteral(":/manifest.json.gz"), gzipBytes, errorString), qPrintable(errorString));
+    QCOMPARE(xzBytes, gzipBytes);
+
+    QJsonParseError parseError;
+    (void) QJsonDocument::fromJson(xzBytes, &parseError);
+    QCOMPARE(parseError.error, QJsonParseError::NoError);
+
+    // Uncompressed data is passed through
+    QTemporaryFile jsonFile;
+    QVERIFY(jsonFile.open());
+    QCOMPARE(jsonFile.write(xzBytes), xzBytes.size());
+    jsonFile.close();
+    QByteArray storedBytes;
+    QVERIFY2(QGCDecompressDevice::readFile(jsonFile.fileName(), storedBytes, errorString), qPrintable(errorString));
+    QCOMPARE(storedBytes, xzBytes);
+}
+
+void DecompressionTest::_testDecompressDeviceZipEntry()
+{
+    QFile zipFile(QStringLiteral(":/manifest.json.zip"));
+    QVERIFY(zipFile.open(QIODevice::ReadOnly));
+
+    QString errorString;
+    QVERIFY(!QGCDecompressDevice::zipEntry(&zipFile, QStringLiteral("missing.json"), errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    QGCDecompressDevice* const device = QGCDecompressDevice::zipEntry(&zipFile, QStringLiteral("manifest.json"), errorString, this);
+    QVERIFY2(device, qPrintable(errorString));
+    QVERIFY(device->open(QIODevice::ReadOnly));
+
+    // Read in small pieces to exercise reads which end in the middle of a decoded block
+    QByteArray zipBytes;
+    char buffer[1000];
+    while (!device->atEnd()) {
+        const qint64 bytesRead = device->read(buffer, sizeof(buffer));
+        QVERIFY2(bytesRead >= 0, qPrintable(device->errorString()));
+        zipBytes.append(buffer, bytesRead);
+    }
+    delete device;
+
+    QByteArray xzBytes;
+    QVERIFY2(QGCDecompressDevice::readFile(QStringLiteral(":/manifest.json.xz"), xzBytes, errorString), qPrintable(errorString));
+    QCOMPARE(zipBytes, xzBytes);
+}
+
+void DecompressionTest::_testDecompressDeviceTruncated()
+{
+    QFile xzFile(QStringLiteral(":/manifest.json.xz"));
+    QVERIFY(xzFile.open(QIODevice::ReadOnly));
+    QByteArray xzBytes = xzFile.readAll();
+    xzBytes.chop(xzBytes.size() / 2);
+
+    QBuffer buffer(&xzBytes);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QGCDecompressDevice device(&buffer, QGCDecompressDevice::detectFormat(xzBytes));
+    QCOMPARE(device.format(), QGCDecompressDevice::Xz);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    (void) device.readAll();
+    QVERIFY(device.atEnd());
+    QVERIFY(!device.errorString().isEmpty());
+}
+
+void DecompressionTest::_testDetectFormat()
+{
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray("\xFD" "7zXZ\x00", 6)), QGCDecompressDevice::Xz);
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray("\x1F\x8B")), QGCDecompressDevice::Gzip);
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray("\x78\x9C")), QGCDecompressDevice::Zlib);
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray("{\n")), QGCDecompressDevice::Stored);
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray()), QGCDecompressDevice::Stored);
+
+    // Valid header checks, but a window larger than 32K and a preset dictionary
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray("\x88\x1C")), QGCDecompressDevice::Stored);
+    QCOMPARE(QGCDecompressDevice::detectFormat(QByteArray("\x78\x20")), QGCDecompressDevice::Stored);
+}
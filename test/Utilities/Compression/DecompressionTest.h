@@ -10,4 +10,8 @@ private slots:
     void _testDecompressGzip();
     void _testDecompressLZMA();
     void _testUnzip();
+    void _testDecompressDevice();
+    void _testDecompressDeviceZipEntry();
+    void _testDecompressDeviceTruncated();
+    void _testDetectFormat();
 };
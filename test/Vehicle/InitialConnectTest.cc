@@ -13,6 +13,9 @@
 #include "LinkManager.h"
 #include "MockLink.h"
 #include "Vehicle.h"
+#include "InitialConnectStateMachine.h"
+
+#include <QtCore/QElapsedTimer>
 
 #include <QtTest/QSignalSpy>
 #include <QtTest/QTest>
@@ -63,3 +66,40 @@ void InitialConnectTest::_boardVendorProductId(void)
 
     _linkManager->disconnectAll();
 }
+
+void InitialConnectTest::_timeToReadyWithLatency(void)
+{
+    static constexpr int latencyMSecs = 50;
+
+    auto *mvm = qgcApp()->toolbox()->multiVehicleManager();
+    QSignalSpy activeVehicleSpy{mvm, &MultiVehicleManager::activeVehicleChanged};
+
+    auto mockConfig = std::make_shared<MockConfiguration>(QString{"MockLink"});
+    mockConfig->setResponseLatencyMSecs(latencyMSecs);
+
+    QElapsedTimer timeToReady;
+    timeToReady.start();
+
+    SharedLinkConfigurationPtr linkConfig = mockConfig;
+    QVERIFY(_linkManager->createConnectedLink(linkConfig));
+
+    QVERIFY(activeVehicleSpy.wait());
+    auto *vehicle = mvm->activeVehicle();
+    QSignalSpy initialConnectCompleteSpy{vehicle, &Vehicle::initialConnectComplete};
+    QVERIFY(initialConnectCompleteSpy.wait(60000) || vehicle->isInitialConnectComplete());
+
+    const InitialConnectStateMachine* connectMachine = vehicle->initialConnectStateMachine();
+    qDebug() << "Time to ready with" << latencyMSecs << "msecs latency:" << timeToReady.elapsed() << "msecs, state machine" << connectMachine->totalDurationMSecs() << "msecs";
+    for (int i = 0; i < InitialConnectStateMachine::StepCount; i++) {
+        const auto step = static_cast<InitialConnectStateMachine::Step>(i);
+        qDebug() << step << "start" << connectMachine->stepStartMSecs(step) << "duration" << connectMachine->stepDurationMSecs(step);
+        QVERIFY(connectMachine->stepDurationMSecs(step) >= 0);
+    }
+
+    // Every response is delayed, so the plan downloads only overlap the parameter download if they really ran concurrently
+    const qint64 parametersEnd = connectMachine->stepStartMSecs(InitialConnectStateMachine::StepParameters) + connectMachine->stepDurationMSecs(InitialConnectStateMachine::StepParameters);
+    QVERIFY(connectMachine->stepStartMSecs(InitialConnectStateMachine::StepMission) < parametersEnd);
+    QVERIFY(connectMachine->totalDurationMSecs() <= timeToReady.elapsed());
+
+    _linkManager->disconnectAll();
+}
@@ -0,0 +1,190 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogBenchmark.h"
+#include "MAVLinkLogManager.h"
+#include "QGCApplication.h"
+#include "QGCToolbox.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kLoggingDataLength = 249;     ///< Size of the data field of LOGGING_DATA
+constexpr int kULogHeaderLength = 16;
+
+struct LoggingData_t {
+    uint16_t    sequence;
+    uint8_t     firstMessage;
+    QByteArray  data;
+};
+
+/// Builds a ULog header followed by messages of varying size and cuts it into LOGGING_DATA payloads
+QByteArray buildStream(qint64 size, QList<LoggingData_t>& messages)
+{
+    QByteArray stream;
+    stream.reserve(size + 512);
+    stream.append("ULog\x01\x12\x35\x01", 8);
+    stream.append(kULogHeaderLength - 8, '\0');
+
+    QList<qsizetype> messageStarts;
+    quint32 seed = 1;
+    while (stream.size() < size) {
+        seed = (seed * 1103515245) + 12345;
+        const int payloadLength = 8 + static_cast<int>((seed >> 16) % 180);
+        messageStarts.append(stream.size());
+        stream.append(static_cast<char>(payloadLength & 0xFF));
+        stream.append(static_cast<char>(payloadLength >> 8));
+        stream.append('D');
+        for (int i = 0; i < payloadLength; i++) {
+            stream.append(static_cast<char>((seed >> (i % 24)) & 0xFF));
+        }
+    }
+
+    // The first message starts with the header, its first message offset counts from the end of the header
+    messages.append({ 0, 0, stream.left(kLoggingDataLength) });
+    qsizetype offset = kLoggingDataLength;
+    auto nextStart = messageStarts.constBegin();
+    uint16_t sequence = 1;
+    while (offset < stream.size()) {
+        const qsizetype length = std::min<qsizetype>(kLoggingDataLength, stream.size() - offset);
+        while ((nextStart != messageStarts.constEnd()) && (*nextStart < offset)) {
+            nextStart++;
+        }
+        uint8_t firstMessage = 255;
+        if ((nextStart != messageStarts.constEnd()) && (*nextStart < offset + length)) {
+            firstMessage = static_cast<uint8_t>(*nextStart - offset);
+        }
+        messages.append({ sequence++, firstMessage, stream.mid(offset, length) });
+        offset += length;
+    }
+
+    return stream;
+}
+
+int envInt(const char* name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return (ok && (value > 0)) ? value : defaultValue;
+}
+
+}
+
+MAVLinkLogBenchmark::MAVLinkLogBenchmark(void)
+{
+    _mbytes = envInt("QGC_MAVLINK_LOG_MBYTES",  _mbytes);
+    _burst  = envInt("QGC_MAVLINK_LOG_BURST",   _burst);
+}
+
+void MAVLinkLogBenchmark::_replay_data(void)
+{
+    QTest::addColumn<int>("dropEvery");
+
+    QTest::newRow("no drops")       << 0;
+    QTest::newRow("1% drops")       << 100;
+}
+
+void MAVLinkLogBenchmark::_replay(void)
+{
+    QFETCH(int, dropEvery);
+
+    QList<LoggingData_t> messages;
+    const QByteArray stream = buildStream(static_cast<qint64>(_mbytes) * 1024 * 1024, messages);
+
+    QTemporaryDir logDir;
+    QVERIFY(logDir.isValid());
+
+    MAVLinkLogProcessor processor;
+    QVERIFY(processor.create(qgcApp()->toolbox()->mavlinkLogManager(), logDir.path(), 1));
+    QVERIFY(processor.valid());
+    const QString fileName = processor.fileName();
+
+    QElapsedTimer totalTimer;
+    QElapsedTimer burstTimer;
+    qint64 processNSecs = 0;
+    qint64 maxBurstNSecs = 0;
+    int dropped = 0;
+
+    totalTimer.start();
+    for (int i = 0; i < messages.count(); i += _burst) {
+        burstTimer.start();
+        const int burstEnd = std::min<int>(i + _burst, messages.count());
+        for (int j = i; j < burstEnd; j++) {
+            // Never drop the header
+            if ((dropEvery > 0) && (j > 0) && ((j % dropEvery) == 0)) {
+                dropped++;
+                continue;
+            }
+            const LoggingData_t& message = messages[j];
+            QVERIFY(processor.processStreamData(message.sequence, message.firstMessage, message.data));
+        }
+        const qint64 burstNSecs = burstTimer.nsecsElapsed();
+        processNSecs += burstNSecs;
+        maxBurstNSecs = std::max(maxBurstNSecs, burstNSecs);
+    }
+
+    QElapsedTimer drainTimer;
+    drainTimer.start();
+    processor.close();
+    const qint64 drainNSecs = drainTimer.nsecsElapsed();
+    const qint64 totalNSecs = totalTimer.nsecsElapsed();
+    delete processor.record();
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const qint64 fileSize = file.size();
+    if (dropEvery == 0) {
+        QCOMPARE(file.readAll(), stream);
+    }
+
+    const double mbytes = static_cast<double>(stream.size()) / (1024.0 * 1024.0);
+
+    QJsonObject result;
+    result[QStringLiteral("row")]               = QString::fromLatin1(QTest::currentDataTag());
+    result[QStringLiteral("streamBytes")]       = static_cast<double>(stream.size());
+    result[QStringLiteral("fileBytes")]         = static_cast<double>(fileSize);
+    result[QStringLiteral("loggingData")]       = messages.count();
+    result[QStringLiteral("dropped")]           = dropped;
+    result[QStringLiteral("burst")]             = _burst;
+    result[QStringLiteral("guiMBytesPerSec")]   = (processNSecs > 0) ? (mbytes * 1e9 / processNSecs) : 0.0;
+    result[QStringLiteral("maxBurstUSecs")]     = static_cast<double>(maxBurstNSecs / 1000);
+    result[QStringLiteral("drainMSecs")]        = static_cast<double>(drainNSecs / 1000000);
+    result[QStringLiteral("totalMBytesPerSec")] = (totalNSecs > 0) ? (mbytes * 1e9 / totalNSecs) : 0.0;
+    _results.append(result);
+}
+
+void MAVLinkLogBenchmark::cleanupTestCase(void)
+{
+    QJsonObject root;
+    root[QStringLiteral("benchmark")]   = QStringLiteral("MAVLinkLogBenchmark");
+    root[QStringLiteral("version")]     = QCoreApplication::applicationVersion();
+    root[QStringLiteral("timestamp")]   = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root[QStringLiteral("results")]     = _results;
+
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    const QString outputFile = qEnvironmentVariable("QGC_MAVLINK_LOG_OUTPUT");
+    if (outputFile.isEmpty()) {
+        qDebug().noquote() << json;
+        return;
+    }
+
+    QFile file(outputFile);
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    QCOMPARE(file.write(json), json.size());
+}
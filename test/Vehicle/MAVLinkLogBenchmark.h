@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QtCore/QJsonArray>
+
+/// Replays a synthetic ULog stream through MAVLinkLogProcessor the way high rate LOGGING_DATA arrives: bursts of
+/// messages handled back to back on the gui thread. It measures gui thread time per burst and how long the writer
+/// takes to drain once the stream ends. Rows without drops also check the file matches the stream byte for byte.
+///
+/// This is a standalone test, run it with --unittest:MAVLinkLogBenchmark. It is configured through the environment:
+///     QGC_MAVLINK_LOG_MBYTES      Size of the replayed stream in megabytes (default 32)
+///     QGC_MAVLINK_LOG_BURST       LOGGING_DATA messages per burst (default 200)
+///     QGC_MAVLINK_LOG_OUTPUT      File to write the json results to, they are logged if not set
+class MAVLinkLogBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLogBenchmark(void);
+
+private slots:
+    void _replay_data       (void);
+    void _replay            (void);
+    void cleanupTestCase    (void);
+
+private:
+    int         _mbytes     = 32;
+    int         _burst      = 200;
+    QJsonArray  _results;
+};
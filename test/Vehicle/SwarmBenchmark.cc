@@ -0,0 +1,523 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SwarmBenchmark.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "LinkStatistics.h"
+#include "MockLink.h"
+#include "MultiVehicleManager.h"
+#include "UDPLink.h"
+#include "Vehicle.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtNetwork/QUdpSocket>
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// Sends the telemetry of a swarm of vehicles to QGC over UDP from its own thread. Every message goes out as its own
+/// datagram from a single socket, the same way a set of simulators behind one router would arrive.
+class SwarmUdpGenerator : public QThread
+{
+public:
+    SwarmUdpGenerator(int vehicleCount, int rateHz, quint16 port, uint8_t mavlinkChannel)
+        : _vehicleCount     (vehicleCount)
+        , _rateHz           (rateHz)
+        , _port             (port)
+        , _mavlinkChannel   (mavlinkChannel)
+        , _sequences        (vehicleCount, 0)
+    {
+
+    }
+
+    quint64 messagesSent(void) const { return _messagesSent.load(std::memory_order_relaxed); }
+
+protected:
+    void run(void) final
+    {
+        QUdpSocket  socket;
+        QTimer      heartbeatTimer;
+        QTimer      streamTimer;
+
+        _runningTime.start();
+
+        // Packing goes through a channel QGC does not use, so the generator needs its own MAVLink 2 settings
+        mavlink_get_channel_status(_mavlinkChannel)->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+
+        (void) QObject::connect(&heartbeatTimer, &QTimer::timeout, &socket, [this, &socket]() { _sendHeartbeats(socket); });
+        (void) QObject::connect(&streamTimer, &QTimer::timeout, &socket, [this, &socket]() { _sendStream(socket); });
+
+        streamTimer.setTimerType(Qt::PreciseTimer);
+        heartbeatTimer.start(1000);
+        if (_rateHz > 0) {
+            streamTimer.start(qMax(1, 1000 / _rateHz));
+        }
+
+        _sendHeartbeats(socket);
+
+        (void) exec();
+    }
+
+private:
+    uint8_t _systemId(int vehicleIndex) const { return static_cast<uint8_t>(vehicleIndex + 1); }
+
+    /// Each vehicle has its own sequence numbers, so QGC does not see loss from all of them sharing one channel
+    void _setSequence(int vehicleIndex) { mavlink_get_channel_status(_mavlinkChannel)->current_tx_seq = _sequences[vehicleIndex]++; }
+
+    void _sendHeartbeats(QUdpSocket& socket)
+    {
+        for (int i = 0; i < _vehicleCount; i++) {
+            mavlink_message_t msg;
+
+            _setSequence(i);
+            (void) mavlink_msg_heartbeat_pack_chan(_systemId(i),
+                                                   MAV_COMP_ID_AUTOPILOT1,
+                                                   _mavlinkChannel,
+                                                   &msg,
+                                                   MAV_TYPE_QUADROTOR,
+                                                   MAV_AUTOPILOT_PX4,
+                                                   MAV_MODE_FLAG_CUSTOM_MODE_ENABLED,
+                                                   0,
+                                                   MAV_STATE_STANDBY);
+            _send(socket, msg);
+        }
+    }
+
+    void _sendStream(QUdpSocket& socket)
+    {
+        const uint32_t timeBootMSecs = static_cast<uint32_t>(_runningTime.elapsed());
+
+        for (int i = 0; i < _vehicleCount; i++) {
+            mavlink_message_t msg;
+
+            _setSequence(i);
+            (void) mavlink_msg_attitude_pack_chan(_systemId(i), MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &msg,
+                                                  timeBootMSecs,
+                                                  0.0f, 0.0f, static_cast<float>(i) / _vehicleCount,
+                                                  0.0f, 0.0f, 0.0f);
+            _send(socket, msg);
+
+            _setSequence(i);
+            (void) mavlink_msg_global_position_int_pack_chan(_systemId(i), MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &msg,
+                                                             timeBootMSecs,
+                                                             473970000 + (i * 1000),
+                                                             85455000 + (i * 1000),
+                                                             488000,
+                                                             10000,
+                                                             0, 0, 0,
+                                                             UINT16_MAX);
+            _send(socket, msg);
+
+            _setSequence(i);
+            (void) mavlink_msg_vfr_hud_pack_chan(_systemId(i), MAV_COMP_ID_AUTOPILOT1, _mavlinkChannel, &msg,
+                                                 0.0f, 0.0f, 0, 0, 488.0f, 0.0f);
+            _send(socket, msg);
+        }
+    }
+
+    void _send(QUdpSocket& socket, const mavlink_message_t& msg)
+    {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &msg);
+
+        if (socket.writeDatagram(reinterpret_cast<const char*>(buffer), length, QHostAddress::LocalHost, _port) == length) {
+            (void) _messagesSent.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const int               _vehicleCount;
+    const int               _rateHz;
+    const quint16           _port;
+    const uint8_t           _mavlinkChannel;
+    std::vector<uint8_t>    _sequences;
+    std::atomic<quint64>    _messagesSent{0};
+    QElapsedTimer           _runningTime;
+};
+
+int envInt(const char* name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return (ok && (value > 0)) ? value : defaultValue;
+}
+
+QJsonValue jsonOrNull(qint64 value)
+{
+    return (value < 0) ? QJsonValue() : QJsonValue(static_cast<double>(value));
+}
+
+}
+
+SwarmBenchmark::SwarmBenchmark(void)
+{
+    const QString counts = qEnvironmentVariable("QGC_SWARM_VEHICLE_COUNTS", QStringLiteral("1,10,50,100"));
+    for (const QString& count: counts.split(',', Qt::SkipEmptyParts)) {
+        const int vehicleCount = count.trimmed().toInt();
+        if (vehicleCount > 0) {
+            _vehicleCounts.append(vehicleCount);
+        }
+    }
+
+    _rateHz         = envInt("QGC_SWARM_RATE_HZ",           _rateHz);
+    _sampleSeconds  = envInt("QGC_SWARM_SECONDS",           _sampleSeconds);
+    _warmupSeconds  = envInt("QGC_SWARM_WARMUP_SECONDS",    _warmupSeconds);
+}
+
+void SwarmBenchmark::init(void)
+{
+    UnitTest::init();
+
+    _multiVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+
+    QCOMPARE(_linkManager->links().count(),         0);
+    QCOMPARE(_multiVehicleMgr->vehicles()->count(), 0);
+
+    _baselineResidentBytes = _residentBytes();
+}
+
+void SwarmBenchmark::cleanup(void)
+{
+    if (_linkManager->links().count()) {
+        _linkManager->disconnectAll();
+        QTRY_COMPARE_WITH_TIMEOUT(_multiVehicleMgr->vehicles()->count(), 0, 30000);
+        QTRY_COMPARE_WITH_TIMEOUT(_linkManager->links().count(), 0, 10000);
+    }
+
+    _multiVehicleMgr = nullptr;
+    FactGroup::setSignalBatchingEnabled(true);
+
+    UnitTest::cleanup();
+}
+
+void SwarmBenchmark::cleanupTestCase(void)
+{
+    QJsonObject root;
+    root[QStringLiteral("benchmark")]       = QStringLiteral("SwarmBenchmark");
+    root[QStringLiteral("version")]         = QCoreApplication::applicationVersion();
+    root[QStringLiteral("timestamp")]       = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root[QStringLiteral("streamRateHz")]    = _rateHz;
+    root[QStringLiteral("sampleSeconds")]   = _sampleSeconds;
+    root[QStringLiteral("warmupSeconds")]   = _warmupSeconds;
+    root[QStringLiteral("results")]         = _results;
+
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    const QString outputFile = qEnvironmentVariable("QGC_SWARM_OUTPUT");
+    if (outputFile.isEmpty()) {
+        qDebug().noquote() << json;
+        return;
+    }
+
+    QFile file(outputFile);
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+    QCOMPARE(file.write(json), json.size());
+}
+
+void SwarmBenchmark::_addVehicleCountRows(void)
+{
+    QTest::addColumn<int>("vehicleCount");
+
+    for (int vehicleCount: _vehicleCounts) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 vehicles").arg(vehicleCount))) << vehicleCount;
+    }
+}
+
+void SwarmBenchmark::_mockLinkSwarm_data(void)
+{
+    _addVehicleCountRows();
+}
+
+void SwarmBenchmark::_mockLinkSwarm(void)
+{
+    QFETCH(int, vehicleCount);
+
+    for (int i = 0; i < vehicleCount; i++) {
+        MockConfiguration* mockConfig = new MockConfiguration(QStringLiteral("Swarm MockLink %1").arg(i));
+        mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+        mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+        mockConfig->setStreamRateHz(_rateHz);
+        mockConfig->setDynamic(true);
+
+        SharedLinkConfigurationPtr config = _linkManager->addConfiguration(mockConfig);
+        if (!_linkManager->createConnectedLink(config)) {
+            _linkManager->removeConfiguration(config.get());
+
+            const QString reason = QStringLiteral("Only %1 MockLinks could be started, each one uses two of the %2 MAVLink channels").arg(i).arg(MAVLINK_COMM_NUM_BUFFERS);
+            QJsonObject result;
+            result[QStringLiteral("transport")]     = QStringLiteral("MockLink");
+            result[QStringLiteral("vehicleCount")]  = vehicleCount;
+            result[QStringLiteral("skipped")]       = reason;
+            _results.append(result);
+            QSKIP(qPrintable(reason));
+        }
+    }
+
+    // MockLink vehicles run the full initial connect sequence, which is part of the load until the warmup is over
+    QTRY_COMPARE_WITH_TIMEOUT(_multiVehicleMgr->vehicles()->count(), vehicleCount, 30000);
+    QTest::qWait(_warmupSeconds * 1000);
+
+    _results.append(_sample(QStringLiteral("MockLink"), vehicleCount, nullptr));
+}
+
+void SwarmBenchmark::_udpSwarm_data(void)
+{
+    _addVehicleCountRows();
+}
+
+void SwarmBenchmark::_udpSwarm(void)
+{
+    QFETCH(int, vehicleCount);
+
+    if (vehicleCount > _maxUdpVehicles) {
+        QSKIP(qPrintable(QStringLiteral("At most %1 vehicles are supported over UDP").arg(_maxUdpVehicles)));
+    }
+
+    // Let the OS pick a free port
+    quint16 port = 0;
+    {
+        QUdpSocket probe;
+        QVERIFY(probe.bind(QHostAddress::LocalHost, 0));
+        port = probe.localPort();
+    }
+
+    UDPConfiguration* udpConfig = new UDPConfiguration(QStringLiteral("Swarm UDP"));
+    udpConfig->setLocalPort(port);
+    udpConfig->setDynamic(true);
+
+    SharedLinkConfigurationPtr config = _linkManager->addConfiguration(udpConfig);
+    QVERIFY(_linkManager->createConnectedLink(config));
+
+    const uint8_t mavlinkChannel = _linkManager->allocateMavlinkChannel();
+    QVERIFY(mavlinkChannel != LinkManager::invalidMavlinkChannel());
+
+    SwarmUdpGenerator generator(vehicleCount, _rateHz, port, mavlinkChannel);
+    generator.start();
+
+    // These vehicles never answer, so their initial connect requests keep retrying in the background. That is left in
+    // on purpose since it is what QGC does with unresponsive vehicles in a real swarm.
+    const bool allVehicles = QTest::qWaitFor([this, vehicleCount]() { return _multiVehicleMgr->vehicles()->count() == vehicleCount; }, 30000);
+    if (allVehicles) {
+        QTest::qWait(_warmupSeconds * 1000);
+        _results.append(_sample(QStringLiteral("UDP"), vehicleCount, [&generator]() { return generator.messagesSent(); }));
+    }
+
+    generator.quit();
+    generator.wait();
+    _linkManager->freeMavlinkChannel(mavlinkChannel);
+
+    QCOMPARE(_multiVehicleMgr->vehicles()->count(), vehicleCount);
+}
+
+void SwarmBenchmark::_factSignals_data(void)
+{
+    QTest::addColumn<bool>("signalBatching");
+
+    QTest::newRow("batched")    << true;
+    QTest::newRow("unbatched")  << false;
+}
+
+void SwarmBenchmark::_factSignals(void)
+{
+    QFETCH(bool, signalBatching);
+
+    FactGroup::setSignalBatchingEnabled(signalBatching);
+
+    MockConfiguration* mockConfig = new MockConfiguration(QStringLiteral("Fact signals MockLink"));
+    mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+    mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+    mockConfig->setStreamRateHz(_rateHz);
+    mockConfig->setDynamic(true);
+
+    SharedLinkConfigurationPtr config = _linkManager->addConfiguration(mockConfig);
+    QVERIFY(_linkManager->createConnectedLink(config));
+    QTRY_COMPARE_WITH_TIMEOUT(_multiVehicleMgr->vehicles()->count(), 1, 30000);
+    QTest::qWait(_warmupSeconds * 1000);
+
+    Vehicle* vehicle = _multiVehicleMgr->vehicles()->value<Vehicle*>(0);
+
+    // Count the change signals of every telemetry fact, each one re-evaluates the Qml bindings on that fact
+    QObject counterContext;
+    quint64 factSignals = 0;
+    QList<FactGroup*> factGroups = { vehicle };
+    for (int i = 0; i < factGroups.count(); i++) {
+        FactGroup* factGroup = factGroups[i];
+        factGroups.append(factGroup->factGroups().values());
+        for (const QString& name: factGroup->factNames()) {
+            Fact* fact = factGroup->getFact(name);
+            (void) connect(fact, &Fact::rawValueChanged, &counterContext, [&factSignals]() { factSignals++; });
+            (void) connect(fact, &Fact::valueChanged, &counterContext, [&factSignals]() { factSignals++; });
+        }
+    }
+
+    const quint64 factSignalsStart  = factSignals;
+    const quint64 messagesStart     = vehicle->messagesReceived();
+
+    QJsonObject result = _sample(QStringLiteral("MockLink"), 1, nullptr);
+
+    const double signalCount = static_cast<double>(factSignals - factSignalsStart);
+    const quint64 messages = vehicle->messagesReceived() - messagesStart;
+    result[QStringLiteral("signalBatching")]        = signalBatching;
+    result[QStringLiteral("factSignals")]           = signalCount;
+    result[QStringLiteral("factSignalsPerSec")]     = signalCount / result[QStringLiteral("seconds")].toDouble();
+    result[QStringLiteral("factSignalsPerMessage")] = messages ? QJsonValue(signalCount / messages) : QJsonValue();
+    _results.append(result);
+
+    qDebug() << "SwarmBenchmark fact signals" << (signalBatching ? "batched" : "unbatched")
+             << "signals/sec" << result[QStringLiteral("factSignalsPerSec")].toDouble();
+}
+
+/// Samples the running swarm for _sampleSeconds while spinning the gui thread event loop
+///     @param offeredMessages Count of messages sent towards QGC, nullptr if not known
+QJsonObject SwarmBenchmark::_sample(const QString& transport, int vehicleCount, const std::function<quint64()>& offeredMessages)
+{
+    // Hold on to the links so none go away during the sample
+    const QList<SharedLinkInterfacePtr> links = _linkManager->links();
+
+    const auto linkMessages = [&links]() {
+        quint64 messages = 0;
+        for (const SharedLinkInterfacePtr& link: links) {
+            messages += link->statistics()->messagesReceived();
+        }
+        return messages;
+    };
+    const auto linkParseErrors = [&links]() {
+        quint64 parseErrors = 0;
+        for (const SharedLinkInterfacePtr& link: links) {
+            parseErrors += link->statistics()->parseErrors();
+        }
+        return parseErrors;
+    };
+    const auto vehicleMessages = [this]() {
+        quint64 messages = 0;
+        for (int i = 0; i < _multiVehicleMgr->vehicles()->count(); i++) {
+            messages += _multiVehicleMgr->vehicles()->value<Vehicle*>(i)->messagesReceived();
+        }
+        return messages;
+    };
+
+    // Event loop latency is how late a precise timer fires compared to its interval
+    QList<qint64> latenessNSecs;
+    latenessNSecs.reserve((_sampleSeconds * 1000) / _latencyProbeMSecs);
+    QElapsedTimer probeClock;
+    qint64 lastProbeNSecs = 0;
+    QTimer probeTimer;
+    probeTimer.setTimerType(Qt::PreciseTimer);
+    (void) connect(&probeTimer, &QTimer::timeout, this, [&]() {
+        const qint64 nowNSecs = probeClock.nsecsElapsed();
+        latenessNSecs.append(qMax<qint64>(0, nowNSecs - lastProbeNSecs - (_latencyProbeMSecs * 1000000LL)));
+        lastProbeNSecs = nowNSecs;
+    });
+
+    const quint64 linkMessagesStart     = linkMessages();
+    const quint64 parseErrorsStart      = linkParseErrors();
+    const quint64 vehicleMessagesStart  = vehicleMessages();
+    const quint64 offeredStart          = offeredMessages ? offeredMessages() : 0;
+    const qint64 cpuStartNSecs          = _threadCpuNSecs();
+
+    QElapsedTimer window;
+    window.start();
+    probeClock.start();
+    probeTimer.start(_latencyProbeMSecs);
+
+    QTest::qWait(_sampleSeconds * 1000);
+
+    probeTimer.stop();
+    const double seconds = window.nsecsElapsed() / 1e9;
+    const qint64 cpuEndNSecs = _threadCpuNSecs();
+
+    QJsonObject result;
+    result[QStringLiteral("transport")]                 = transport;
+    result[QStringLiteral("vehicleCount")]              = vehicleCount;
+    result[QStringLiteral("linkCount")]                 = links.count();
+    result[QStringLiteral("seconds")]                   = seconds;
+    result[QStringLiteral("linkMessagesPerSec")]        = (linkMessages() - linkMessagesStart) / seconds;
+    result[QStringLiteral("vehicleMessagesPerSec")]     = (vehicleMessages() - vehicleMessagesStart) / seconds;
+    result[QStringLiteral("offeredMessagesPerSec")]     = offeredMessages ? QJsonValue((offeredMessages() - offeredStart) / seconds) : QJsonValue();
+    result[QStringLiteral("parseErrors")]               = static_cast<double>(linkParseErrors() - parseErrorsStart);
+
+    if ((cpuStartNSecs >= 0) && (cpuEndNSecs >= 0)) {
+        const double cpuSeconds = (cpuEndNSecs - cpuStartNSecs) / 1e9;
+        result[QStringLiteral("guiThreadCpuSeconds")]   = cpuSeconds;
+        result[QStringLiteral("guiThreadCpuLoad")]      = cpuSeconds / seconds;
+    } else {
+        result[QStringLiteral("guiThreadCpuSeconds")]   = QJsonValue();
+        result[QStringLiteral("guiThreadCpuLoad")]      = QJsonValue();
+    }
+
+    QJsonObject latency;
+    if (!latenessNSecs.isEmpty()) {
+        std::sort(latenessNSecs.begin(), latenessNSecs.end());
+        qint64 totalNSecs = 0;
+        for (qint64 nsecs: latenessNSecs) {
+            totalNSecs += nsecs;
+        }
+        const auto percentile = [&latenessNSecs](double fraction) {
+            return latenessNSecs[qMin(latenessNSecs.count() - 1, static_cast<qsizetype>(fraction * latenessNSecs.count()))] / 1e6;
+        };
+        latency[QStringLiteral("samples")]  = static_cast<int>(latenessNSecs.count());
+        latency[QStringLiteral("meanMSecs")] = (totalNSecs / static_cast<double>(latenessNSecs.count())) / 1e6;
+        latency[QStringLiteral("p50MSecs")] = percentile(0.50);
+        latency[QStringLiteral("p99MSecs")] = percentile(0.99);
+        latency[QStringLiteral("maxMSecs")] = latenessNSecs.last() / 1e6;
+    }
+    result[QStringLiteral("eventLoopLatency")] = latency;
+
+    const qint64 residentBytes = _residentBytes();
+    result[QStringLiteral("residentBytes")]         = jsonOrNull(residentBytes);
+    result[QStringLiteral("residentBytesDelta")]    = ((residentBytes >= 0) && (_baselineResidentBytes >= 0)) ? QJsonValue(static_cast<double>(residentBytes - _baselineResidentBytes)) : QJsonValue();
+
+    qDebug() << "SwarmBenchmark" << transport << vehicleCount << "vehicles"
+             << "link msgs/sec" << result[QStringLiteral("linkMessagesPerSec")].toDouble()
+             << "gui cpu load" << result[QStringLiteral("guiThreadCpuLoad")].toDouble()
+             << "p99 latency ms" << latency[QStringLiteral("p99MSecs")].toDouble();
+
+    return result;
+}
+
+/// @return CPU time used by the calling thread, -1 if not supported on this platform
+qint64 SwarmBenchmark::_threadCpuNSecs(void)
+{
+#if defined(Q_OS_UNIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return (static_cast<qint64>(ts.tv_sec) * 1000000000LL) + ts.tv_nsec;
+    }
+#endif
+    return -1;
+}
+
+/// @return Resident set size of the process, -1 if not supported on this platform
+qint64 SwarmBenchmark::_residentBytes(void)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.count() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+
+#include <functional>
+
+class MultiVehicleManager;
+
+/// Load benchmark which connects a swarm of simulated vehicles and measures how well the gui thread keeps up.
+///
+/// Each row connects N vehicles, lets them settle and then samples for a fixed window: end to end message rate at the
+/// links and at Vehicle, gui thread cpu time, event loop latency and resident memory. The MockLink rows use one link per
+/// vehicle, so they are limited by the number of MAVLink channels. The UDP rows put all vehicles on a single UDPLink,
+/// which is also how a real swarm usually arrives. The fact signal rows run a single vehicle with FactGroup signal
+/// batching on and off and count the change signals its telemetry facts send.
+///
+/// This is a standalone test, run it with --unittest:SwarmBenchmark. It is configured through the environment:
+///     QGC_SWARM_VEHICLE_COUNTS    Comma separated vehicle counts (default 1,10,50,100)
+///     QGC_SWARM_RATE_HZ           Rate of the extra ATTITUDE, GLOBAL_POSITION_INT and VFR_HUD stream (default 50)
+///     QGC_SWARM_SECONDS           Length of the sample window (default 10)
+///     QGC_SWARM_WARMUP_SECONDS    Settle time between connecting and sampling (default 5)
+///     QGC_SWARM_OUTPUT            File to write the json results to, they are logged if not set
+class SwarmBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    SwarmBenchmark(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _mockLinkSwarm_data(void);
+    void _mockLinkSwarm     (void);
+    void _udpSwarm_data     (void);
+    void _udpSwarm          (void);
+    void _factSignals_data  (void);
+    void _factSignals       (void);
+    void cleanupTestCase    (void);
+
+private:
+    void        _addVehicleCountRows(void);
+    QJsonObject _sample             (const QString& transport, int vehicleCount, const std::function<quint64()>& offeredMessages);
+
+    static qint64 _threadCpuNSecs   (void);
+    static qint64 _residentBytes    (void);
+
+    MultiVehicleManager*    _multiVehicleMgr        = nullptr;
+    QList<int>              _vehicleCounts;
+    int                     _rateHz                 = 50;
+    int                     _sampleSeconds          = 10;
+    int                     _warmupSeconds          = 5;
+    qint64                  _baselineResidentBytes  = -1;
+    QJsonArray              _results;
+
+    static constexpr int    _latencyProbeMSecs      = 10;
+    static constexpr int    _maxUdpVehicles         = 250;  ///< Leaves the top system ids free for QGC and other GCS
+};
@@ -0,0 +1,146 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryPointsTest.h"
+#include "TrajectoryPoints.h"
+
+#include <QtCore/QtMath>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+#include <limits>
+
+namespace {
+
+const QGeoCoordinate kOrigin(47.3977, 8.5456);
+
+/// Distance in meters from point to the closest segment of the polyline
+double distanceToPolyline(const QVariantList& polyline, const QGeoCoordinate& point)
+{
+    double minDistance = std::numeric_limits<double>::max();
+    for (qsizetype i = 1; i < polyline.count(); i++) {
+        const QGeoCoordinate from = polyline[i - 1].value<QGeoCoordinate>();
+        const QGeoCoordinate to = polyline[i].value<QGeoCoordinate>();
+
+        // Local flat earth in meters relative to from
+        const double dx = from.distanceTo(QGeoCoordinate(from.latitude(), to.longitude())) * ((to.longitude() >= from.longitude()) ? 1 : -1);
+        const double dy = from.distanceTo(QGeoCoordinate(to.latitude(), from.longitude())) * ((to.latitude() >= from.latitude()) ? 1 : -1);
+        const double px = from.distanceTo(QGeoCoordinate(from.latitude(), point.longitude())) * ((point.longitude() >= from.longitude()) ? 1 : -1);
+        const double py = from.distanceTo(QGeoCoordinate(point.latitude(), from.longitude())) * ((point.latitude() >= from.latitude()) ? 1 : -1);
+
+        const double lengthSquared = (dx * dx) + (dy * dy);
+        const double t = (lengthSquared > 0) ? qBound(0.0, ((px * dx) + (py * dy)) / lengthSquared, 1.0) : 0.0;
+        minDistance = qMin(minDistance, qSqrt(qPow(px - (t * dx), 2) + qPow(py - (t * dy), 2)));
+    }
+    return minDistance;
+}
+
+}
+
+void TrajectoryPointsTest::_testStraightTrack(void)
+{
+    TrajectoryPoints trajectory(nullptr);
+
+    // 5 km straight north in 2.5 m steps
+    QGeoCoordinate coordinate = kOrigin;
+    for (int i = 0; i < 2000; i++) {
+        trajectory.addCoordinate(coordinate);
+        coordinate = coordinate.atDistanceAndAzimuth(2.5, 0);
+    }
+
+    // The straight line is fully represented by its start and current position, but the deviation window is
+    // bounded so long tracks get an intermediate point every so often
+    for (int lodLevel = 0; lodLevel < trajectory.lodCount(); lodLevel++) {
+        QVERIFY(trajectory.count(lodLevel) >= 2);
+        QVERIFY(trajectory.count(lodLevel) <= 5);
+        const QVariantList points = trajectory.list(lodLevel);
+        QCOMPARE(points.first().value<QGeoCoordinate>().latitude(), kOrigin.latitude());
+    }
+}
+
+void TrajectoryPointsTest::_testCurvedTrack(void)
+{
+    TrajectoryPoints trajectory(nullptr);
+
+    // Full circle of 2 km radius in 3 m steps
+    constexpr double radius = 2000;
+    const QGeoCoordinate center = kOrigin;
+    const int steps = static_cast<int>((2 * M_PI * radius) / 3.0);
+    QList<QGeoCoordinate> track;
+    for (int i = 0; i <= steps; i++) {
+        track.append(center.atDistanceAndAzimuth(radius, (360.0 * i) / steps));
+        trajectory.addCoordinate(track.last());
+    }
+
+    // Every level has to keep the shape of the circle and coarser levels need fewer points
+    constexpr double kTolerances[] = { 1.0, 8.0, 32.0, 128.0, 512.0 };
+    int previousCount = std::numeric_limits<int>::max();
+    for (int lodLevel = 0; lodLevel < trajectory.lodCount(); lodLevel++) {
+        const int count = trajectory.count(lodLevel);
+        QVERIFY2(count >= 4, qPrintable(QStringLiteral("level %1 count %2").arg(lodLevel).arg(count)));
+        QVERIFY(count <= previousCount);
+        previousCount = count;
+
+        const QVariantList points = trajectory.list(lodLevel);
+        double maxDeviation = 0;
+        for (const QGeoCoordinate& coordinate : track) {
+            maxDeviation = qMax(maxDeviation, distanceToPolyline(points, coordinate));
+        }
+        // Small allowance for the flat earth and 1e-7 degree packing error
+        QVERIFY2(maxDeviation <= kTolerances[lodLevel] + 0.5, qPrintable(QStringLiteral("level %1 deviation %2").arg(lodLevel).arg(maxDeviation)));
+    }
+}
+
+void TrajectoryPointsTest::_testLodLevelForZoom(void)
+{
+    TrajectoryPoints trajectory(nullptr);
+
+    // Allowed error is two pixels at the zoom level
+    QCOMPARE(trajectory.lodLevelForZoom(20), 0);
+    QCOMPARE(trajectory.lodLevelForZoom(16), 0);
+    QCOMPARE(trajectory.lodLevelForZoom(14), 1);
+    QCOMPARE(trajectory.lodLevelForZoom(12), 2);
+    QCOMPARE(trajectory.lodLevelForZoom(10), 3);
+    QCOMPARE(trajectory.lodLevelForZoom(8), 4);
+    QCOMPARE(trajectory.lodLevelForZoom(2), 4);
+
+    trajectory.setLodLevel(trajectory.lodLevelForZoom(12));
+    QCOMPARE(trajectory.lodLevel(), 2);
+    trajectory.setLodLevel(100);
+    QCOMPARE(trajectory.lodLevel(), trajectory.lodCount() - 1);
+}
+
+void TrajectoryPointsTest::_testLevelRevision(void)
+{
+    TrajectoryPoints trajectory(nullptr);
+    QSignalSpy spy(&trajectory, &TrajectoryPoints::levelRevisionChanged);
+    const int initialRevision = trajectory.levelRevision();
+
+    // Zig zag 10 m to each side so every point is kept, until the full resolution level hits its cap
+    QGeoCoordinate coordinate = kOrigin;
+    for (int i = 0; i <= 20000; i++) {
+        trajectory.addCoordinate(coordinate.atDistanceAndAzimuth(10, (i % 2) ? 90 : 270));
+        coordinate = coordinate.atDistanceAndAzimuth(3, 0);
+    }
+
+    // A level tolerance grew, so lodLevelForZoom bindings need to re-evaluate
+    QVERIFY(spy.count() > 0);
+    QVERIFY(trajectory.levelRevision() != initialRevision);
+    QCOMPARE(spy.last()[0].toInt(), trajectory.levelRevision());
+
+    // Clearing restores the tolerances
+    spy.clear();
+    trajectory.clear();
+    QCOMPARE(spy.count(), 1);
+
+    // Nothing to restore the second time
+    trajectory.clear();
+    QCOMPARE(spy.count(), 1);
+}
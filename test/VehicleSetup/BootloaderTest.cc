@@ -0,0 +1,493 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "BootloaderTest.h"
+#include "Bootloader.h"
+#include "FirmwareImage.h"
+#include "QGC.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint8_t kInSync       = 0x12;
+constexpr uint8_t kEOC          = 0x20;
+constexpr uint8_t kOK           = 0x10;
+constexpr uint8_t kInvalid      = 0x13;
+constexpr uint8_t kGetSync      = 0x21;
+constexpr uint8_t kGetDevice    = 0x22;
+constexpr uint8_t kChipErase    = 0x23;
+constexpr uint8_t kProgMulti    = 0x27;
+constexpr uint8_t kGetCRC       = 0x29;
+constexpr uint8_t kBoot         = 0x30;
+
+constexpr uint32_t kBootloaderRev   = 5;
+constexpr uint32_t kBoardId         = 50;
+constexpr uint32_t kFlashSize       = 512 * 1024;
+constexpr uint32_t kImageSize       = 200 * 1024;
+
+/// Pseudo random image bytes which don't compress
+QByteArray _imageBytes(uint32_t size)
+{
+    QByteArray imageBytes;
+    imageBytes.reserve(size);
+    quint32 seed = 1;
+    for (uint32_t i = 0; i < size; i++) {
+        seed = (seed * 1103515245) + 12345;
+        imageBytes.append(static_cast<char>(seed >> 16));
+    }
+    return imageBytes;
+}
+
+/// .px4 document for a compressed image stream
+QByteArray _px4FileBytes(const QByteArray &compressedImage, qsizetype imageSize)
+{
+    return QByteArray("{\n    \"board_id\": ") + QByteArray::number(kBoardId) +
+           ",\n    \"image_size\": " + QByteArray::number(imageSize) +
+           ",\n    \"image\": \"" + compressedImage.toBase64() + "\"\n}\n";
+}
+
+#ifdef Q_OS_LINUX
+
+/// PX4 bootloader protocol on the master side of a pseudo terminal. Commands are handled in the order they arrive.
+/// The simulator reads everything the host has sent so far, answers it and then pauses briefly, which gives the
+/// host the chance to queue up further packets. Like the real bootloader, a partial command is dropped once no
+/// more bytes arrive for it.
+class SimulatedBootloader : public QThread
+{
+public:
+    /// @param receiveBufferSize Bytes which are dropped beyond this many unhandled bytes, 0 for no limit
+    SimulatedBootloader(int fd, bool corrupt, uint32_t bootloaderRev, int receiveBufferSize)
+        : _fd                   (fd)
+        , _corrupt              (corrupt)
+        , _bootloaderRev        (bootloaderRev)
+        , _receiveBufferSize    (receiveBufferSize)
+        , _flash                (kFlashSize, '\xFF')
+    {
+
+    }
+
+    ~SimulatedBootloader()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        _stop = true;
+        (void) wait();
+    }
+
+    /// Largest number of PROG_MULTI packets which had arrived before the simulator got to answer any of them
+    int maxQueuedPrograms() const { return _maxQueuedPrograms; }
+
+    /// Total number of PROG_MULTI packets programmed
+    int programCount() const { return _programCount; }
+
+    /// Only valid once the simulator is stopped
+    const QByteArray& flash() const { return _flash; }
+
+protected:
+    void run() final
+    {
+        QByteArray input;
+
+        while (!_stop) {
+            struct pollfd pfd = { _fd, POLLIN, 0 };
+            if (poll(&pfd, 1, 20) <= 0) {
+                input.clear();
+                continue;
+            }
+            char buffer[4096];
+            const ssize_t bytesRead = ::read(_fd, buffer, sizeof(buffer));
+            if (bytesRead <= 0) {
+                continue;
+            }
+            input.append(buffer, bytesRead);
+            if ((_receiveBufferSize > 0) && (input.size() > _receiveBufferSize)) {
+                input.truncate(_receiveBufferSize);
+            }
+
+            QByteArray output;
+            qsizetype consumed = 0;
+            int queuedPrograms = 0;
+            forever {
+                bool program = false;
+                const qsizetype commandLength = _command(input, consumed, output, program);
+                if (commandLength == 0) {
+                    break;
+                }
+                consumed += commandLength;
+                if (program) {
+                    queuedPrograms++;
+                }
+            }
+            input.remove(0, consumed);
+            _maxQueuedPrograms = std::max(_maxQueuedPrograms.load(), queuedPrograms);
+
+            qsizetype written = 0;
+            while (written < output.size()) {
+                const ssize_t result = ::write(_fd, output.constData() + written, output.size() - written);
+                if (result <= 0) {
+                    break;
+                }
+                written += result;
+            }
+
+            QThread::msleep(1);
+        }
+    }
+
+private:
+    /// Handles the command at offset
+    /// @return Length of the command, 0 if it has not arrived completely
+    qsizetype _command(const QByteArray& input, qsizetype offset, QByteArray& output, bool& program)
+    {
+        const qsizetype available = input.size() - offset;
+        if (available < 2) {
+            return 0;
+        }
+
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input.constData()) + offset;
+        switch (bytes[0]) {
+        case kGetSync:
+        case kBoot:
+            break;
+        case kGetDevice:
+        {
+            if (available < 3) {
+                return 0;
+            }
+            uint32_t value = 0;
+            switch (bytes[1]) {
+            case 1:
+                value = _bootloaderRev;
+                break;
+            case 2:
+                value = kBoardId;
+                break;
+            case 4:
+                value = kFlashSize;
+                break;
+            }
+            output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            output.append(static_cast<char>(kInSync));
+            output.append(static_cast<char>(kOK));
+            return 3;
+        }
+        case kChipErase:
+            _flash.fill('\xFF');
+            _address = 0;
+            break;
+        case kProgMulti:
+        {
+            const qsizetype length = bytes[1];
+            if (available < length + 3) {
+                return 0;
+            }
+            (void) _flash.replace(_address, length, reinterpret_cast<const char*>(&bytes[2]), length);
+            if (_corrupt && (_address == 0)) {
+                _flash[0] = static_cast<char>(~_flash[0]);
+            }
+            _address += length;
+            _programCount++;
+            program = true;
+            output.append(static_cast<char>(kInSync));
+            output.append(static_cast<char>(kOK));
+            return length + 3;
+        }
+        case kGetCRC:
+        {
+            const uint32_t crc = QGC::crc32(reinterpret_cast<const quint8*>(_flash.constData()), _flash.size(), 0);
+            output.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+            break;
+        }
+        default:
+            output.append(static_cast<char>(kInSync));
+            output.append(static_cast<char>(kInvalid));
+            return 1;
+        }
+
+        if (bytes[1] != kEOC) {
+            output.append(static_cast<char>(kInSync));
+            output.append(static_cast<char>(kInvalid));
+            return 1;
+        }
+        output.append(static_cast<char>(kInSync));
+        output.append(static_cast<char>(kOK));
+        return 2;
+    }
+
+    const int           _fd;
+    const bool          _corrupt;
+    const uint32_t      _bootloaderRev;
+    const int           _receiveBufferSize;
+    QByteArray          _flash;
+    qsizetype           _address            = 0;
+    std::atomic<bool>   _stop               {false};
+    std::atomic<int>    _maxQueuedPrograms  {0};
+    std::atomic<int>    _programCount       {0};
+};
+
+#endif
+
+}
+
+void BootloaderTest::_flash(int programWindow, bool corrupt, bool px4Format, uint32_t bootloaderRev, int receiveBufferSize, int& maxQueuedPrograms)
+{
+#ifdef Q_OS_LINUX
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QByteArray imageBytes = _imageBytes(kImageSize);
+    QString imageFilename;
+    QByteArray imageFileBytes;
+    if (px4Format) {
+        // Odd size so the loader has to pad the image
+        imageBytes.chop(1);
+        imageFilename = tempDir.filePath(QStringLiteral("firmware.px4"));
+        // qCompress prefixes the zlib stream with the uncompressed size
+        imageFileBytes = _px4FileBytes(qCompress(imageBytes).mid(4), imageBytes.size());
+    } else {
+        imageFilename = tempDir.filePath(QStringLiteral("firmware.bin"));
+        imageFileBytes = imageBytes;
+    }
+    QFile imageFile(imageFilename);
+    QVERIFY(imageFile.open(QIODevice::WriteOnly));
+    QCOMPARE(imageFile.write(imageFileBytes), imageFileBytes.size());
+    imageFile.close();
+
+    FirmwareImage image;
+    QVERIFY(image.load(imageFilename, kBoardId));
+
+    const int masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    QVERIFY(masterFd >= 0);
+    QVERIFY((grantpt(masterFd) == 0) && (unlockpt(masterFd) == 0));
+    const QString portName = QString::fromLocal8Bit(ptsname(masterFd));
+
+    SimulatedBootloader simulator(masterFd, corrupt, bootloaderRev, receiveBufferSize);
+    simulator.start();
+
+    Bootloader bootloader(false /* sikRadio */);
+    if (programWindow > 0) {
+        bootloader.setProgramWindow(programWindow);
+    }
+    QVERIFY2(bootloader.open(portName), qPrintable(bootloader.errorString()));
+
+    uint32_t bootloaderVersion = 0;
+    uint32_t boardId = 0;
+    uint32_t flashSize = 0;
+    QVERIFY2(bootloader.getBoardInfo(bootloaderVersion, boardId, flashSize), qPrintable(bootloader.errorString()));
+    QCOMPARE(bootloaderVersion, bootloaderRev);
+    QCOMPARE(boardId, kBoardId);
+    QCOMPARE(flashSize, kFlashSize);
+
+    QVERIFY2(bootloader.erase(), qPrintable(bootloader.errorString()));
+    QVERIFY2(bootloader.program(&image), qPrintable(bootloader.errorString()));
+    const bool verified = bootloader.verify(&image);
+    const QString errorString = bootloader.errorString();
+    bootloader.close();
+
+    simulator.stop();
+    (void) ::close(masterFd);
+
+    if (corrupt) {
+        QVERIFY(!verified);
+        QVERIFY2(errorString.contains(QStringLiteral("CRC mismatch")), qPrintable(errorString));
+    } else {
+        QVERIFY2(verified, qPrintable(errorString));
+        QVERIFY(simulator.flash().left(imageBytes.size()) == imageBytes);
+        if (px4Format) {
+            QCOMPARE(image.imageSize(), kImageSize);
+            QCOMPARE(simulator.flash().at(imageBytes.size()), static_cast<char>(0xFF));
+        }
+    }
+    maxQueuedPrograms = simulator.maxQueuedPrograms();
+#else
+    Q_UNUSED(programWindow);
+    Q_UNUSED(corrupt);
+    Q_UNUSED(px4Format);
+    Q_UNUSED(bootloaderRev);
+    Q_UNUSED(receiveBufferSize);
+    Q_UNUSED(maxQueuedPrograms);
+#endif
+}
+
+void BootloaderTest::initTestCase(void)
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Simulated bootloader needs pseudo terminals");
+#endif
+}
+
+void BootloaderTest::_testProgramSequential(void)
+{
+    int maxQueuedPrograms = 0;
+    _flash(1, false /* corrupt */, false /* px4Format */, kBootloaderRev, 0 /* receiveBufferSize */, maxQueuedPrograms);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // Without a window the next packet only goes out after the response to the previous one
+    QCOMPARE(maxQueuedPrograms, 1);
+}
+
+void BootloaderTest::_testProgramWindowed(void)
+{
+    int maxQueuedPrograms = 0;
+    _flash(8, false /* corrupt */, false /* px4Format */, kBootloaderRev, 0 /* receiveBufferSize */, maxQueuedPrograms);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QVERIFY(maxQueuedPrograms > 1);
+    QVERIFY(maxQueuedPrograms <= 8);
+}
+
+void BootloaderTest::_testCRCMismatch(void)
+{
+    int maxQueuedPrograms = 0;
+    _flash(8, true /* corrupt */, false /* px4Format */, kBootloaderRev, 0 /* receiveBufferSize */, maxQueuedPrograms);
+}
+
+void BootloaderTest::_testProgramPx4(void)
+{
+    // The image is decompressed in the background while the board is being erased and programmed
+    int maxQueuedPrograms = 0;
+    _flash(8, false /* corrupt */, true /* px4Format */, kBootloaderRev, 0 /* receiveBufferSize */, maxQueuedPrograms);
+}
+
+void BootloaderTest::_testProgramWindowAutomatic(void)
+{
+    int maxQueuedPrograms = 0;
+    _flash(0 /* programWindow */, false /* corrupt */, false /* px4Format */, kBootloaderRev, 0 /* receiveBufferSize */, maxQueuedPrograms);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QVERIFY(maxQueuedPrograms > 1);
+}
+
+void BootloaderTest::_testProgramWindowOldBootloader(void)
+{
+    int maxQueuedPrograms = 0;
+    _flash(0 /* programWindow */, false /* corrupt */, false /* px4Format */, kBootloaderRev - 1, 0 /* receiveBufferSize */, maxQueuedPrograms);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // Older bootloaders are not trusted with a window
+    QCOMPARE(maxQueuedPrograms, 1);
+}
+
+void BootloaderTest::_testProgramWindowFallback(void)
+{
+    // A window of packets overruns the receive buffer, programming has to start over one packet at a time
+    int maxQueuedPrograms = 0;
+    _flash(0 /* programWindow */, false /* corrupt */, false /* px4Format */, kBootloaderRev, 256 /* receiveBufferSize */, maxQueuedPrograms);
+}
+
+void BootloaderTest::_testCorruptPx4Erased(void)
+{
+#ifdef Q_OS_LINUX
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Random bytes end up in stored deflate blocks, so the damage only shows up in the checksum at the very end
+    const QByteArray imageBytes = _imageBytes(kImageSize);
+    QByteArray compressedImage = qCompress(imageBytes).mid(4);
+    compressedImage[compressedImage.size() / 2] = static_cast<char>(~compressedImage[compressedImage.size() / 2]);
+
+    const QString imageFilename = tempDir.filePath(QStringLiteral("firmware.px4"));
+    QFile imageFile(imageFilename);
+    QVERIFY(imageFile.open(QIODevice::WriteOnly));
+    const QByteArray imageFileBytes = _px4FileBytes(compressedImage, imageBytes.size());
+    QCOMPARE(imageFile.write(imageFileBytes), imageFileBytes.size());
+    imageFile.close();
+
+    // Loading doesn't wait for the image to be decompressed
+    FirmwareImage image;
+    QVERIFY(image.load(imageFilename, kBoardId));
+
+    const int masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    QVERIFY(masterFd >= 0);
+    QVERIFY((grantpt(masterFd) == 0) && (unlockpt(masterFd) == 0));
+    const QString portName = QString::fromLocal8Bit(ptsname(masterFd));
+
+    SimulatedBootloader simulator(masterFd, false /* corrupt */, kBootloaderRev, 0 /* receiveBufferSize */);
+    simulator.start();
+
+    Bootloader bootloader(false /* sikRadio */);
+    QVERIFY2(bootloader.open(portName), qPrintable(bootloader.errorString()));
+    uint32_t bootloaderVersion = 0;
+    uint32_t boardId = 0;
+    uint32_t flashSize = 0;
+    QVERIFY2(bootloader.getBoardInfo(bootloaderVersion, boardId, flashSize), qPrintable(bootloader.errorString()));
+
+    // Everything but the held back end of the image gets programmed before the checksum fails
+    QVERIFY2(bootloader.erase(), qPrintable(bootloader.errorString()));
+    QVERIFY(!bootloader.program(&image));
+    const QString errorString = bootloader.errorString();
+    bootloader.close();
+
+    simulator.stop();
+    (void) ::close(masterFd);
+
+    QVERIFY2(errorString.contains(QStringLiteral("stays in the bootloader")), qPrintable(errorString));
+    QVERIFY(simulator.programCount() > 0);
+    QVERIFY(simulator.flash() == QByteArray(kFlashSize, '\xFF'));
+#endif
+}
+
+void BootloaderTest::_testPx4Keys(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QByteArray imageBytes = _imageBytes(1024);
+    const QByteArray compressedImage = qCompress(imageBytes).mid(4);
+    const QString imageFilename = tempDir.filePath(QStringLiteral("firmware.px4"));
+    auto load = [&imageFilename](const QByteArray& imageFileBytes) {
+        QFile imageFile(imageFilename);
+        if (!imageFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || (imageFile.write(imageFileBytes) != imageFileBytes.size())) {
+            return false;
+        }
+        imageFile.close();
+
+        FirmwareImage image;
+        return image.load(imageFilename, kBoardId);
+    };
+
+    QVERIFY(load(_px4FileBytes(compressedImage, imageBytes.size())));
+
+    // The keys are only picked up where they are keys, not from inside of a string. Board id 9 would not match.
+    QByteArray described = _px4FileBytes(compressedImage, imageBytes.size());
+    described.replace("\"board_id\": 50", "\"description\": \"\\\"board_id\\\": 9\", \"board_id\": 50");
+    QVERIFY(load(described));
+    QByteArray quotedBoardId = _px4FileBytes(compressedImage, imageBytes.size());
+    quotedBoardId.replace("\"board_id\": 50", "\"board_id\": \"50\"");
+    QVERIFY(!load(quotedBoardId));
+    QByteArray missingSize = _px4FileBytes(compressedImage, imageBytes.size());
+    missingSize.replace("\"image_size\"", "\"image_length\"");
+    QVERIFY(!load(missingSize));
+    QVERIFY(!load(QByteArray("not json")));
+}
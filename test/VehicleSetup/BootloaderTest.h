@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Flashes images through Bootloader against a simulated PX4 bootloader on the other end of a pseudo terminal
+class BootloaderTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase(void);
+    void _testProgramSequential(void);
+    void _testProgramWindowed(void);
+    void _testCRCMismatch(void);
+    void _testProgramPx4(void);
+    void _testProgramWindowAutomatic(void);
+    void _testProgramWindowOldBootloader(void);
+    void _testProgramWindowFallback(void);
+    void _testCorruptPx4Erased(void);
+    void _testPx4Keys(void);
+
+private:
+    /// @param programWindow 0 leaves the choice to Bootloader
+    void _flash(int programWindow, bool corrupt, bool px4Format, uint32_t bootloaderRev, int receiveBufferSize, int& maxQueuedPrograms);
+};
@@ -0,0 +1,256 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "OsmParserThreadTest.h"
+#include "OsmParserThread.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QtEndian>
+#include <QtTest/QTest>
+
+namespace {
+    enum BlobEncoding {
+        BlobRaw,
+        BlobZlib,
+        BlobLzma,   ///< Not supported by the reader
+    };
+
+    /// Square building, its corners 0.001 degrees apart
+    constexpr int64_t kWayId = 100;
+    constexpr double kMinLat = 47.0;
+    constexpr double kMinLon = 8.0;
+    constexpr double kSize = 0.001;
+
+    void _appendVarint(QByteArray &out, quint64 value)
+    {
+        while (value >= 0x80) {
+            out.append(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.append(static_cast<char>(value));
+    }
+
+    quint64 _zigZag(int64_t value)
+    {
+        return (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63);
+    }
+
+    void _appendVarintField(QByteArray &out, int field, quint64 value)
+    {
+        _appendVarint(out, static_cast<quint64>(field) << 3);
+        _appendVarint(out, value);
+    }
+
+    void _appendBytesField(QByteArray &out, int field, const QByteArray &bytes)
+    {
+        _appendVarint(out, (static_cast<quint64>(field) << 3) | 2);
+        _appendVarint(out, static_cast<quint64>(bytes.size()));
+        out.append(bytes);
+    }
+
+    /// Packed sint64 values, delta coded like all OSM PBF id and coordinate lists
+    QByteArray _packedDelta(const QList<int64_t> &values)
+    {
+        QByteArray packed;
+        int64_t previous = 0;
+        for (const int64_t value : values) {
+            _appendVarint(packed, _zigZag(value - previous));
+            previous = value;
+        }
+        return packed;
+    }
+
+    /// Blob with its BlobHeader and size prefix
+    QByteArray _blob(const QByteArray &type, const QByteArray &data, BlobEncoding encoding)
+    {
+        QByteArray blob;
+        switch (encoding) {
+        case BlobRaw:
+            _appendBytesField(blob, 1, data);
+            break;
+        case BlobZlib:
+            _appendVarintField(blob, 2, static_cast<quint64>(data.size()));
+            // qCompress prefixes the zlib stream with the uncompressed size
+            _appendBytesField(blob, 3, qCompress(data).mid(4));
+            break;
+        case BlobLzma:
+            _appendVarintField(blob, 2, static_cast<quint64>(data.size()));
+            _appendBytesField(blob, 4, data);
+            break;
+        }
+
+        QByteArray header;
+        _appendBytesField(header, 1, type);
+        _appendVarintField(header, 3, static_cast<quint64>(blob.size()));
+
+        QByteArray result(sizeof(quint32), Qt::Uninitialized);
+        qToBigEndian<quint32>(static_cast<quint32>(header.size()), result.data());
+        return result + header + blob;
+    }
+
+    /// HeaderBlock with a bounding box around the building
+    QByteArray _headerBlock()
+    {
+        QByteArray bbox;
+        _appendVarintField(bbox, 1, _zigZag(qRound64(kMinLon * 1e9)));
+        _appendVarintField(bbox, 2, _zigZag(qRound64((kMinLon + kSize) * 1e9)));
+        _appendVarintField(bbox, 3, _zigZag(qRound64((kMinLat + kSize) * 1e9)));
+        _appendVarintField(bbox, 4, _zigZag(qRound64(kMinLat * 1e9)));
+
+        QByteArray block;
+        _appendBytesField(block, 1, bbox);
+        return block;
+    }
+
+    /// PrimitiveBlock with the four corner nodes as DenseNodes and a closed building way through them
+    QByteArray _primitiveBlock()
+    {
+        QByteArray stringTable;
+        for (const char *string : { "", "building", "yes" }) {
+            _appendBytesField(stringTable, 1, QByteArray(string));
+        }
+
+        // Default granularity of 100 nanodegrees
+        const QList<int64_t> lats = { qRound64(kMinLat * 1e7), qRound64(kMinLat * 1e7), qRound64((kMinLat + kSize) * 1e7), qRound64((kMinLat + kSize) * 1e7) };
+        const QList<int64_t> lons = { qRound64(kMinLon * 1e7), qRound64((kMinLon + kSize) * 1e7), qRound64((kMinLon + kSize) * 1e7), qRound64(kMinLon * 1e7) };
+        QByteArray denseNodes;
+        _appendBytesField(denseNodes, 1, _packedDelta({ 1, 2, 3, 4 }));
+        _appendBytesField(denseNodes, 8, _packedDelta(lats));
+        _appendBytesField(denseNodes, 9, _packedDelta(lons));
+
+        QByteArray keys, values;
+        _appendVarint(keys, 1);
+        _appendVarint(values, 2);
+        QByteArray way;
+        _appendVarintField(way, 1, kWayId);
+        _appendBytesField(way, 2, keys);
+        _appendBytesField(way, 3, values);
+        _appendBytesField(way, 8, _packedDelta({ 1, 2, 3, 4, 1 }));
+
+        QByteArray nodeGroup, wayGroup;
+        _appendBytesField(nodeGroup, 2, denseNodes);
+        _appendBytesField(wayGroup, 3, way);
+
+        QByteArray block;
+        _appendBytesField(block, 1, stringTable);
+        _appendBytesField(block, 2, nodeGroup);
+        _appendBytesField(block, 2, wayGroup);
+        return block;
+    }
+
+    bool _parse(OsmParserThread &parser, QByteArray pbf)
+    {
+        QBuffer buffer(&pbf);
+        (void) buffer.open(QIODevice::ReadOnly);
+        return parser.parseOsmDevice(buffer, true /* isPbf */);
+    }
+
+    void _writeFile(const QString &fileName, qsizetype size, const QDateTime &modified)
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(QByteArray(size, 'x')), size);
+        QVERIFY(file.flush());
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    }
+}
+
+void OsmParserThreadTest::_testPbfBuildings()
+{
+    OsmParserThread parser;
+
+    for (const BlobEncoding encoding : { BlobRaw, BlobZlib }) {
+        const QByteArray pbf = _blob("OSMHeader", _headerBlock(), encoding) + _blob("OSMData", _primitiveBlock(), encoding);
+        QVERIFY(_parse(parser, pbf));
+
+        QCOMPARE(parser.mapBuildings.count(), 1);
+        QVERIFY(parser.mapBuildings.contains(kWayId));
+        const OsmParserThread::BuildingType_t &building = parser.mapBuildings[kWayId];
+        QCOMPARE(building.points_local.size(), size_t(5));
+        QCOMPARE(building.levels, 2.f);
+        QCOMPARE(building.height, 0.f);
+
+        QVERIFY(qAbs(parser.gpsRefPoint.latitude() - (kMinLat + (kSize / 2))) < 1e-7);
+        QVERIFY(qAbs(parser.gpsRefPoint.longitude() - (kMinLon + (kSize / 2))) < 1e-7);
+
+        // About 111m by 76m around the reference point
+        QVERIFY(qAbs(building.bb_max.x() - building.bb_min.x()) > 50);
+        QVERIFY(qAbs(building.bb_max.y() - building.bb_min.y()) > 50);
+    }
+}
+
+void OsmParserThreadTest::_testPbfWithoutBounds()
+{
+    OsmParserThread parser;
+
+    // The file is centered on its nodes instead
+    QVERIFY(_parse(parser, _blob("OSMData", _primitiveBlock(), BlobZlib)));
+    QCOMPARE(parser.mapBuildings.count(), 1);
+    QVERIFY(qAbs(parser.gpsRefPoint.latitude() - (kMinLat + (kSize / 2))) < 1e-7);
+    QVERIFY(qAbs(parser.gpsRefPoint.longitude() - (kMinLon + (kSize / 2))) < 1e-7);
+}
+
+void OsmParserThreadTest::_testPbfInvalid()
+{
+    OsmParserThread parser;
+
+    const QByteArray pbf = _blob("OSMHeader", _headerBlock(), BlobRaw) + _blob("OSMData", _primitiveBlock(), BlobZlib);
+
+    QByteArray truncated = pbf;
+    truncated.chop(10);
+    QVERIFY(!_parse(parser, truncated));
+    QVERIFY(parser.mapBuildings.isEmpty());
+
+    QVERIFY(!_parse(parser, _blob("OSMHeader", _headerBlock(), BlobRaw) + _blob("OSMData", _primitiveBlock(), BlobLzma)));
+    QVERIFY(parser.mapBuildings.isEmpty());
+
+    // Blob header size larger than the limit
+    QByteArray oversizeHeader(sizeof(quint32), Qt::Uninitialized);
+    qToBigEndian<quint32>(1024 * 1024, oversizeHeader.data());
+    QVERIFY(!_parse(parser, oversizeHeader + pbf));
+
+    // Corrupt zlib stream
+    QByteArray corrupt = _blob("OSMData", _primitiveBlock(), BlobZlib);
+    corrupt[corrupt.size() - 8] = static_cast<char>(~corrupt[corrupt.size() - 8]);
+    QVERIFY(!_parse(parser, corrupt));
+
+    // Still fine after all of the above
+    QVERIFY(_parse(parser, pbf));
+    QCOMPARE(parser.mapBuildings.count(), 1);
+}
+
+void OsmParserThreadTest::_testPruneCache()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QDir dir(tempDir.path());
+
+    const QDateTime now = QDateTime::currentDateTime();
+    _writeFile(dir.filePath(QStringLiteral("old.mesh")), 100, now.addSecs(-30));
+    _writeFile(dir.filePath(QStringLiteral("middle.osmcache")), 100, now.addSecs(-20));
+    _writeFile(dir.filePath(QStringLiteral("new.mesh")), 100, now.addSecs(-10));
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // Below the limit nothing goes
+    OsmParserThread::pruneCache(dir.path(), 300);
+    QCOMPARE(dir.entryList(QDir::Files).count(), 3);
+
+    // Least recently used goes first
+    OsmParserThread::pruneCache(dir.path(), 250);
+    QCOMPARE(dir.entryList(QDir::Files, QDir::Name), QStringList({ QStringLiteral("middle.osmcache"), QStringLiteral("new.mesh") }));
+
+    OsmParserThread::pruneCache(dir.path(), 100);
+    QCOMPARE(dir.entryList(QDir::Files), QStringList({ QStringLiteral("new.mesh") }));
+}